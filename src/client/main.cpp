@@ -2,7 +2,6 @@
 // Completely redesigned with hierarchical scene system, threading, and scheduling
 
 #include "../engine/core/Platform.h"
-#include <iostream>
 #include <chrono>
 #include <memory>
 
@@ -11,6 +10,11 @@
 #include "ui/LoginScene.h"
 #include "ui/MainMenuScene.h"
 #include "ui/UIText.h"
+#include "../common/Logger.h"
+
+namespace {
+    LogCategory clientLog("Client");
+}
 
 // Global variables
 HWND g_hwnd = nullptr;
@@ -156,7 +160,7 @@ bool initializeOpenGL() {
                           NULL, NULL, wc.hInstance, NULL);
 
     if (!g_hwnd) {
-        std::cout << "[Client] Failed to create window!" << std::endl;
+        LOG_ERROR(clientLog, "Failed to create window!");
         return false;
     }
 
@@ -196,14 +200,14 @@ bool initializeOpenGL() {
     ShowWindow(g_hwnd, SW_SHOW);
     UpdateWindow(g_hwnd);
 
-    std::cout << "[Client] OpenGL initialized with scene system" << std::endl;
+    LOG_INFO(clientLog, "OpenGL initialized with scene system");
 
     return true;
 }
 
 // Initialize scenes
 void initializeScenes() {
-    std::cout << "[Client] Initializing scene system..." << std::endl;
+    LOG_INFO(clientLog, "Initializing scene system...");
 
     // Create scene manager
     g_sceneManager = std::make_unique<SceneManager>();
@@ -218,22 +222,22 @@ void initializeScenes() {
 
     // Setup navigation callbacks for main menu
     g_mainMenuScene->setOnEnterLobby([]() {
-        std::cout << "[Client] Navigate to: Lobby" << std::endl;
+        LOG_INFO(clientLog, "Navigate to: Lobby");
         // TODO: Implement lobby scene
     });
 
     g_mainMenuScene->setOnViewStash([]() {
-        std::cout << "[Client] Navigate to: Stash" << std::endl;
+        LOG_INFO(clientLog, "Navigate to: Stash");
         // TODO: Implement stash scene
     });
 
     g_mainMenuScene->setOnOpenMerchants([]() {
-        std::cout << "[Client] Navigate to: Merchants" << std::endl;
+        LOG_INFO(clientLog, "Navigate to: Merchants");
         // TODO: Implement merchant scene
     });
 
     g_mainMenuScene->setOnLogout([]() {
-        std::cout << "[Client] Logging out..." << std::endl;
+        LOG_INFO(clientLog, "Logging out...");
         g_sceneManager->transitionTo("Login", true);
     });
 
@@ -243,7 +247,7 @@ void initializeScenes() {
     // Schedule a task to check for successful login
     g_sceneManager->getScheduler().scheduleRepeating([]() {
         if (g_loginScene && g_loginScene->getAccountId() != 0) {
-            std::cout << "[Client] Login successful! Transitioning to main menu..." << std::endl;
+            LOG_INFO(clientLog, "Login successful! Transitioning to main menu...");
 
             // Update main menu with account ID
             uint64_t accountId = g_loginScene->getAccountId();
@@ -252,16 +256,16 @@ void initializeScenes() {
 
             // Setup callbacks again
             g_mainMenuScene->setOnEnterLobby([]() {
-                std::cout << "[Client] Navigate to: Lobby" << std::endl;
+                LOG_INFO(clientLog, "Navigate to: Lobby");
             });
             g_mainMenuScene->setOnViewStash([]() {
-                std::cout << "[Client] Navigate to: Stash" << std::endl;
+                LOG_INFO(clientLog, "Navigate to: Stash");
             });
             g_mainMenuScene->setOnOpenMerchants([]() {
-                std::cout << "[Client] Navigate to: Merchants" << std::endl;
+                LOG_INFO(clientLog, "Navigate to: Merchants");
             });
             g_mainMenuScene->setOnLogout([]() {
-                std::cout << "[Client] Logging out..." << std::endl;
+                LOG_INFO(clientLog, "Logging out...");
                 g_sceneManager->transitionTo("Login", true);
             });
 
@@ -270,14 +274,14 @@ void initializeScenes() {
         }
     }, 0.1f); // Check every 100ms
 
-    std::cout << "[Client] Scene system initialized!" << std::endl;
-    std::cout << "[Client] Registered scenes: Login, MainMenu" << std::endl;
-    std::cout << "[Client] Current scene: Login" << std::endl;
+    LOG_INFO(clientLog, "Scene system initialized!");
+    LOG_INFO(clientLog, "Registered scenes: Login, MainMenu");
+    LOG_INFO(clientLog, "Current scene: Login");
 }
 
 // Cleanup
 void cleanup() {
-    std::cout << "[Client] Unloading all scenes..." << std::endl;
+    LOG_INFO(clientLog, "Unloading all scenes...");
 
     if (g_sceneManager) {
         g_sceneManager->unloadAllScenes();
@@ -304,15 +308,14 @@ void cleanup() {
 
 // Main entry point
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow) {
-    std::cout << "========================================" << std::endl;
-    std::cout << "  EXTRACTION SHOOTER - Scene System" << std::endl;
-    std::cout << "  with Threading & Hierarchy" << std::endl;
-    std::cout << "========================================" << std::endl;
-    std::cout << std::endl;
+    LOG_INFO(clientLog, "========================================");
+    LOG_INFO(clientLog, "  EXTRACTION SHOOTER - Scene System");
+    LOG_INFO(clientLog, "  with Threading & Hierarchy");
+    LOG_INFO(clientLog, "========================================");
 
     // Initialize OpenGL
     if (!initializeOpenGL()) {
-        std::cout << "[Client] Failed to initialize OpenGL!" << std::endl;
+        LOG_ERROR(clientLog, "Failed to initialize OpenGL!");
         return 1;
     }
 
@@ -320,23 +323,21 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
     g_networkClient = std::make_unique<NetworkClient>();
 
     // Connect to server
-    std::cout << "[Client] Connecting to server..." << std::endl;
+    LOG_INFO(clientLog, "Connecting to server...");
     if (!g_networkClient->connect("127.0.0.1", 7777)) {
-        std::cout << "[Client] Failed to connect to server!" << std::endl;
-        std::cout << "[Client] Make sure the server is running on port 7777" << std::endl;
+        LOG_ERROR(clientLog, "Failed to connect to server!");
+        LOG_INFO(clientLog, "Make sure the server is running on port 7777");
         cleanup();
         return 1;
     }
 
-    std::cout << "[Client] Connected to server successfully!" << std::endl;
+    LOG_INFO(clientLog, "Connected to server successfully!");
 
     // Initialize scene system
     initializeScenes();
 
-    std::cout << "[Client] Client initialized successfully!" << std::endl;
-    std::cout << "[Client] ThreadPool running with "
-              << g_sceneManager->getThreadPool().getThreadCount() << " threads" << std::endl;
-    std::cout << std::endl;
+    LOG_INFO(clientLog, "Client initialized successfully!");
+    LOG_INFO(clientLog, "ThreadPool running with {} threads", g_sceneManager->getThreadPool().getThreadCount());
 
     // Main game loop
     auto lastTime = std::chrono::high_resolution_clock::now();
@@ -374,9 +375,10 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine
     }
 
     // Cleanup
-    std::cout << "[Client] Shutting down..." << std::endl;
+    LOG_INFO(clientLog, "Shutting down...");
     cleanup();
-    std::cout << "[Client] Shutdown complete" << std::endl;
+    LOG_INFO(clientLog, "Shutdown complete");
+    Logger::shutdown();
 
     return 0;
 }
@@ -1,17 +1,38 @@
 #include "NetworkClient.h"
+#include "../../common/Logger.h"
 #include <cstring>
 
-NetworkClient::NetworkClient() : serverSocket(INVALID_SOCKET), initialized(false),
-                  connected(false), sessionToken(0), sequenceOut(0) {
+namespace {
+    LogCategory networkLog("NetworkClient");
+
+    // The I/O thread wakes on socket events and queued sends; this only
+    // bounds how long a missed wakeup could stall it
+    constexpr DWORD IO_WAIT_TIMEOUT_MS = 100;
+
+    // While the game thread is behind on received packets, check back this often
+    constexpr DWORD BLOCKED_RETRY_MS = 1;
+
+    // Drop sent bytes from the front of the send buffer past this much
+    constexpr size_t SEND_COMPACT_THRESHOLD = 64 * 1024;
+}
+
+NetworkClient::NetworkClient() : serverSocket(INVALID_SOCKET), datagramSocket(INVALID_SOCKET),
+                  datagramSequenceOut(0), initialized(false), connected(false), sessionToken(0),
+                  encodeBuffer(MAX_PACKET_SIZE), receivedPackets(RECEIVE_QUEUE_SIZE),
+                  outgoingPackets(SEND_QUEUE_SIZE), ioRunning(false), wakeEvent(WSA_INVALID_EVENT),
+                  sequenceOut(0), datagramSequenceIn(0), hasDatagramSequence(false), receiveBlocked(false),
+                  receiveBuffer(32768), sendOffset(0) {
+    memset(&serverAddress, 0, sizeof(serverAddress));
+
     // Initialize Winsock
     WSADATA wsaData;
     int result = WSAStartup(MAKEWORD(2, 2), &wsaData);
     if (result != 0) {
-        std::cout << "[NetworkClient] WSAStartup failed: " << result << std::endl;
+        LOG_ERROR(networkLog, "WSAStartup failed: {}", result);
         return;
     }
     initialized = true;
-    std::cout << "[NetworkClient] Winsock initialized" << std::endl;
+    LOG_INFO(networkLog, "Winsock initialized");
 }
 
 NetworkClient::~NetworkClient() {
@@ -23,14 +44,17 @@ NetworkClient::~NetworkClient() {
 
 bool NetworkClient::connect(const std::string& serverIP, int port) {
     if (!initialized) {
-        std::cout << "[NetworkClient] Cannot connect - not initialized" << std::endl;
+        LOG_WARN(networkLog, "Cannot connect - not initialized");
         return false;
     }
 
+    // Clean up after a connection the server ended
+    disconnect();
+
     // Create socket
     serverSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
     if (serverSocket == INVALID_SOCKET) {
-        std::cout << "[NetworkClient] Failed to create socket: " << WSAGetLastError() << std::endl;
+        LOG_ERROR(networkLog, "Failed to create socket: {}", WSAGetLastError());
         return false;
     }
 
@@ -49,7 +73,7 @@ bool NetworkClient::connect(const std::string& serverIP, int port) {
     if (result == SOCKET_ERROR) {
         int error = WSAGetLastError();
         if (error != WSAEWOULDBLOCK) {
-            std::cout << "[NetworkClient] Connect failed: " << error << std::endl;
+            LOG_WARN(networkLog, "Connect failed: {}", error);
             closesocket(serverSocket);
             serverSocket = INVALID_SOCKET;
             return false;
@@ -67,76 +91,155 @@ bool NetworkClient::connect(const std::string& serverIP, int port) {
 
     result = select(0, nullptr, &writeSet, nullptr, &timeout);
     if (result <= 0) {
-        std::cout << "[NetworkClient] Connection timeout" << std::endl;
+        LOG_INFO(networkLog, "Connection timeout");
         closesocket(serverSocket);
         serverSocket = INVALID_SOCKET;
         return false;
     }
 
+    wakeEvent = WSACreateEvent();
+    if (wakeEvent == WSA_INVALID_EVENT) {
+        LOG_ERROR(networkLog, "Failed to create wake event: {}", WSAGetLastError());
+        closesocket(serverSocket);
+        serverSocket = INVALID_SOCKET;
+        return false;
+    }
+
+    // Fresh I/O state; the previous thread (if any) has been joined
+    sequenceOut = 0;
+    receiveBlocked = false;
+    receiveBuffer.clear();
+    sendBuffer.clear();
+    sendOffset = 0;
+    receivedPackets.clear();
+    outgoingPackets.clear();
+
     connected = true;
-    std::cout << "[NetworkClient] Connected to " << serverIP << ":" << port << std::endl;
+    serverAddress = serverAddr;
+    ioRunning.store(true, std::memory_order_release);
+    ioThread = std::thread(&NetworkClient::ioThreadMain, this);
+    LOG_INFO(networkLog, "Connected to {}:{}", serverIP, port);
 
     return true;
 }
 
 void NetworkClient::disconnect() {
-    if (!connected) return;
+    if (!ioThread.joinable()) return;
+
+    // Send disconnect packet; the I/O thread writes what is queued before it stops
+    bool wasConnected = connected.load(std::memory_order_acquire);
+    if (wasConnected) {
+        sendPacket(PacketType::DISCONNECT, nullptr, 0);
+    }
 
-    // Send disconnect packet
-    sendPacket(PacketType::DISCONNECT, nullptr, 0);
+    ioRunning.store(false, std::memory_order_release);
+    WSASetEvent(wakeEvent);
+    ioThread.join();
 
     connected = false;
+    compressionDictionary = CompressionDictionary();
+    WSACloseEvent(wakeEvent);
+    wakeEvent = WSA_INVALID_EVENT;
 
     if (serverSocket != INVALID_SOCKET) {
         closesocket(serverSocket);
         serverSocket = INVALID_SOCKET;
     }
+    SOCKET datagram = datagramSocket.exchange(INVALID_SOCKET);
+    if (datagram != INVALID_SOCKET) {
+        closesocket(datagram);
+    }
 
-    std::cout << "[NetworkClient] Disconnected from server" << std::endl;
+    LOG_INFO(networkLog, "Disconnected from server");
 }
 
 void NetworkClient::update() {
-    if (!connected) return;
-    receiveData();
+    // Packets are received and framed on the I/O thread
+}
+
+bool NetworkClient::openDatagramChannel() {
+    if (!connected || sessionToken == 0) {
+        LOG_WARN(networkLog, "Cannot open datagram channel - not logged in");
+        return false;
+    }
+    if (hasDatagramChannel()) return true;
+
+    SOCKET datagram = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (datagram == INVALID_SOCKET) {
+        LOG_WARN(networkLog, "Failed to create datagram socket: {}", WSAGetLastError());
+        return false;
+    }
+
+    u_long mode = 1;
+    ioctlsocket(datagram, FIONBIO, &mode);
+
+    // A connected UDP socket only receives from the server
+    if (::connect(datagram, (sockaddr*)&serverAddress, sizeof(serverAddress)) == SOCKET_ERROR) {
+        LOG_WARN(networkLog, "Datagram connect failed: {}", WSAGetLastError());
+        closesocket(datagram);
+        return false;
+    }
+
+    // The I/O thread starts watching it on its next pass
+    datagramSequenceOut = 0;
+    datagramSocket.store(datagram, std::memory_order_release);
+    WSASetEvent(wakeEvent);
+    LOG_INFO(networkLog, "Datagram channel open");
+    return true;
+}
+
+bool NetworkClient::sendDatagram(PacketType type, const void* payload, uint32_t payloadSize) {
+    if (!hasDatagramChannel()) return false;
+    if (sizeof(DatagramHeader) + payloadSize > MAX_DATAGRAM_SIZE) {
+        LOG_WARN(networkLog, "Datagram too large: {} bytes", payloadSize);
+        return false;
+    }
+
+    DatagramHeader header;
+    header.sessionToken = sessionToken;
+    header.type = static_cast<uint16_t>(type);
+    header.sequence = datagramSequenceOut++;
+
+    OutgoingPacket packet;
+    packet.datagram = true;
+    packet.bytes.resize(sizeof(header) + payloadSize);
+    memcpy(packet.bytes.data(), &header, sizeof(header));
+    if (payloadSize > 0) {
+        memcpy(packet.bytes.data() + sizeof(header), payload, payloadSize);
+    }
+    return queueOutgoing(std::move(packet));
 }
 
 bool NetworkClient::sendPacket(PacketType type, const void* payload, uint32_t payloadSize) {
     if (!connected) {
-        std::cout << "[NetworkClient] Cannot send - not connected" << std::endl;
+        LOG_WARN(networkLog, "Cannot send - not connected");
         return false;
     }
 
-    // Build packet
+    // Build packet; the I/O thread stamps the sequence as it writes
     PacketHeader header;
     header.type = static_cast<uint16_t>(type);
     header.payloadSize = payloadSize;
     header.sessionToken = sessionToken;
-    header.sequence = sequenceOut++;
+    header.sequence = 0;
 
-    // Send header
-    int result = send(serverSocket, (char*)&header, sizeof(header), 0);
-    if (result == SOCKET_ERROR) {
-        int error = WSAGetLastError();
-        if (error != WSAEWOULDBLOCK) {
-            std::cout << "[NetworkClient] Failed to send header: " << error << std::endl;
-            connected = false;
-            return false;
-        }
-    }
-
-    // Send payload (if any)
+    OutgoingPacket packet;
+    packet.bytes.resize(sizeof(header) + payloadSize);
+    memcpy(packet.bytes.data(), &header, sizeof(header));
     if (payloadSize > 0 && payload != nullptr) {
-        result = send(serverSocket, (char*)payload, payloadSize, 0);
-        if (result == SOCKET_ERROR) {
-            int error = WSAGetLastError();
-            if (error != WSAEWOULDBLOCK) {
-                std::cout << "[NetworkClient] Failed to send payload: " << error << std::endl;
-                connected = false;
-                return false;
-            }
-        }
+        memcpy(packet.bytes.data() + sizeof(header), payload, payloadSize);
     }
+    return queueOutgoing(std::move(packet));
+}
 
+bool NetworkClient::queueOutgoing(OutgoingPacket&& packet) {
+    // Ring full: the I/O thread is behind, let it drain and retry
+    while (!outgoingPackets.push(std::move(packet))) {
+        if (!connected.load(std::memory_order_acquire)) return false;
+        WSASetEvent(wakeEvent);
+        std::this_thread::yield();
+    }
+    WSASetEvent(wakeEvent);
     return true;
 }
 
@@ -157,54 +260,167 @@ bool NetworkClient::hasPackets() const {
 }
 
 NetworkClient::ReceivedPacket NetworkClient::getNextPacket() {
-    if (receivedPackets.empty()) {
+    ReceivedPacket packet;
+    if (!receivedPackets.pop(packet)) {
         return ReceivedPacket();
     }
-
-    ReceivedPacket packet = receivedPackets.front();
-    receivedPackets.pop();
     return packet;
 }
 
 std::vector<NetworkClient::ReceivedPacket> NetworkClient::getAllPackets() {
     std::vector<ReceivedPacket> packets;
-    while (!receivedPackets.empty()) {
-        packets.push_back(receivedPackets.front());
-        receivedPackets.pop();
+    ReceivedPacket packet;
+    while (receivedPackets.pop(packet)) {
+        packets.push_back(std::move(packet));
     }
     return packets;
 }
 
-void NetworkClient::receiveData() {
-    char buffer[4096];
-    int result = recv(serverSocket, buffer, sizeof(buffer), 0);
+// ============================================================================
+// I/O THREAD
+// ============================================================================
+
+void NetworkClient::ioThreadMain() {
+    WSAEVENT socketEvent = WSACreateEvent();
+    WSAEVENT datagramEvent = WSACreateEvent();
+    WSAEventSelect(serverSocket, socketEvent, FD_READ | FD_WRITE | FD_CLOSE);
+    SOCKET watchedDatagram = INVALID_SOCKET;
+
+    while (ioRunning.load(std::memory_order_acquire) && connected.load(std::memory_order_acquire)) {
+        // Pick up a datagram channel opened since the last pass
+        SOCKET datagram = datagramSocket.load(std::memory_order_acquire);
+        if (datagram != watchedDatagram) {
+            WSAEventSelect(datagram, datagramEvent, FD_READ);
+            watchedDatagram = datagram;
+            hasDatagramSequence = false;
+        }
 
-    if (result > 0) {
-        // Append to receive buffer
-        receiveBuffer.insert(receiveBuffer.end(), buffer, buffer + result);
+        // Sleep until the server sends, the socket takes more data or the
+        // game thread queues a send
+        WSAEVENT events[3] = { wakeEvent, socketEvent, datagramEvent };
+        DWORD eventCount = watchedDatagram != INVALID_SOCKET ? 3 : 2;
+        WSAWaitForMultipleEvents(eventCount, events, FALSE, receiveBlocked ? BLOCKED_RETRY_MS : IO_WAIT_TIMEOUT_MS, FALSE);
+        WSAResetEvent(wakeEvent);
+
+        // Re-arms the events; reads below run until the sockets would block
+        WSANETWORKEVENTS networkEvents;
+        WSAEnumNetworkEvents(serverSocket, socketEvent, &networkEvents);
+        if (watchedDatagram != INVALID_SOCKET) {
+            WSAEnumNetworkEvents(watchedDatagram, datagramEvent, &networkEvents);
+            receiveDatagrams();
+        }
 
-        // Try to parse packets
-        parsePackets();
+        receiveData();
+        takeOutgoing();
+        flushSends();
     }
-    else if (result == 0) {
-        // Connection closed by server
-        connected = false;
-        std::cout << "[NetworkClient] Server closed connection" << std::endl;
+
+    // Best effort for what was queued last, e.g. DISCONNECT
+    if (connected.load(std::memory_order_acquire)) {
+        takeOutgoing();
+        flushSends();
     }
-    else {
-        int error = WSAGetLastError();
-        if (error != WSAEWOULDBLOCK) {
+
+    WSAEventSelect(serverSocket, socketEvent, 0);
+    if (watchedDatagram != INVALID_SOCKET) {
+        WSAEventSelect(watchedDatagram, datagramEvent, 0);
+    }
+    WSACloseEvent(socketEvent);
+    WSACloseEvent(datagramEvent);
+}
+
+void NetworkClient::receiveData() {
+    // recv() straight into the ring's free region until the socket would block
+    while (connected.load(std::memory_order_relaxed)) {
+        size_t freeLength;
+        uint8_t* region = receiveBuffer.writeRegion(freeLength);
+        if (freeLength == 0) {
+            // Ring is full: frame what we have to make room. If the game is
+            // behind nothing moves, and the rest waits in the socket.
+            size_t before = receiveBuffer.size();
+            parsePackets();
+            if (receiveBuffer.size() == before) break;
+            continue;
+        }
+
+        int result = recv(serverSocket, (char*)region, static_cast<int>(freeLength), 0);
+
+        if (result > 0) {
+            receiveBuffer.commitWrite(static_cast<size_t>(result));
+            continue;
+        }
+
+        if (result == 0) {
+            // Connection closed by server
             connected = false;
-            std::cout << "[NetworkClient] Receive failed: " << error << std::endl;
+            LOG_INFO(networkLog, "Server closed connection");
+        }
+        else {
+            int error = WSAGetLastError();
+            if (error != WSAEWOULDBLOCK) {
+                connected = false;
+                LOG_WARN(networkLog, "Receive failed: {}", error);
+            }
         }
+        break;
+    }
+
+    // Try to parse packets
+    parsePackets();
+}
+
+void NetworkClient::receiveDatagrams() {
+    SOCKET datagramSocketFd = datagramSocket.load(std::memory_order_relaxed);
+    uint8_t datagram[MAX_DATAGRAM_SIZE + 1];
+    while (true) {
+        int result = recv(datagramSocketFd, (char*)datagram, static_cast<int>(sizeof(datagram)), 0);
+        if (result == SOCKET_ERROR) {
+            int error = WSAGetLastError();
+            // ICMP unreachable (server not up yet) or an oversized datagram
+            if (error == WSAECONNRESET || error == WSAEMSGSIZE) continue;
+            return;
+        }
+
+        size_t length = static_cast<size_t>(result);
+        if (length < sizeof(DatagramHeader) || length > MAX_DATAGRAM_SIZE) continue;
+
+        DatagramHeader header;
+        memcpy(&header, datagram, sizeof(header));
+
+        // Late datagrams carry state that is already superseded
+        if (hasDatagramSequence && !isNewerSequence(header.sequence, datagramSequenceIn)) continue;
+        hasDatagramSequence = true;
+        datagramSequenceIn = header.sequence;
+
+        // Unreliable anyway: with the game behind, a datagram is dropped
+        // like a lost one
+        ReceivedPacket packet;
+        packet.type = static_cast<PacketType>(header.type);
+        packet.payload.assign(datagram + sizeof(header), datagram + length);
+        receivedPackets.push(std::move(packet));
     }
 }
 
 void NetworkClient::parsePackets() {
+    receiveBlocked = false;
     while (receiveBuffer.size() >= sizeof(PacketHeader)) {
-        // Read header
+        // Game thread behind: leave the rest framed in the ring for now
+        if (receivedPackets.size() >= receivedPackets.getCapacity()) {
+            receiveBlocked = true;
+            return;
+        }
+
+        // Read header (may straddle the wrap point)
         PacketHeader header;
-        memcpy(&header, receiveBuffer.data(), sizeof(PacketHeader));
+        receiveBuffer.peek(0, &header, sizeof(PacketHeader));
+
+        // A packet larger than the ring could never complete
+        if (header.payloadSize > MAX_PACKET_SIZE) {
+            LOG_WARN(networkLog, "Oversized packet from server: {}", header.payloadSize);
+            receiveBuffer.clear();
+            connected = false;
+            return;
+        }
 
         // Check if we have the full packet
         size_t totalSize = sizeof(PacketHeader) + header.payloadSize;
@@ -214,18 +430,98 @@ void NetworkClient::parsePackets() {
 
         // Extract payload
         ReceivedPacket packet;
-        packet.type = static_cast<PacketType>(header.type);
+        packet.type = static_cast<PacketType>(header.type & ~PACKET_FLAG_COMPRESSED);
 
         if (header.payloadSize > 0) {
             packet.payload.resize(header.payloadSize);
-            memcpy(packet.payload.data(), receiveBuffer.data() + sizeof(PacketHeader), header.payloadSize);
+            receiveBuffer.peek(sizeof(PacketHeader), packet.payload.data(), header.payloadSize);
+        }
+
+        // Release the frame; nothing behind it moves
+        receiveBuffer.consume(totalSize);
+
+        if (header.type & PACKET_FLAG_COMPRESSED) {
+            std::vector<uint8_t> compressed = std::move(packet.payload);
+            if (!decompressPayload(compressed.data(), compressed.size(), packet.payload, &compressionDictionary) ||
+                packet.payload.size() > MAX_PACKET_SIZE) {
+                LOG_WARN(networkLog, "Dropping {}: cannot decompress {} bytes", packetTypeToString(packet.type), compressed.size());
+                continue;
+            }
         }
 
-        receivedPackets.push(packet);
+        if (packet.type == PacketType::COMPRESSION_DICTIONARY) {
+            compressionDictionary = CompressionDictionary(packet.payload.data(), packet.payload.size());
+            LOG_DEBUG(networkLog, "Compression dictionary {} received ({} bytes)", compressionDictionary.id(), packet.payload.size());
+            continue;
+        }
+
+        // Server RTT probe: echo it from here, so the game's frame time
+        // stays out of the measurement
+        if (packet.type == PacketType::HEARTBEAT && !packet.payload.empty()) {
+            PacketHeader echo;
+            echo.type = static_cast<uint16_t>(PacketType::HEARTBEAT);
+            echo.payloadSize = static_cast<uint32_t>(packet.payload.size());
+            echo.sessionToken = 0;
+            echo.sequence = 0;
+
+            std::vector<uint8_t> frame(sizeof(echo) + packet.payload.size());
+            memcpy(frame.data(), &echo, sizeof(echo));
+            memcpy(frame.data() + sizeof(echo), packet.payload.data(), packet.payload.size());
+            appendFrame(frame.data(), frame.size());
+            continue;
+        }
+
+        LOG_TRACE(networkLog, "Received {}", packetTypeToString(packet.type));
 
-        // Remove processed packet from buffer
-        receiveBuffer.erase(receiveBuffer.begin(), receiveBuffer.begin() + totalSize);
+        receivedPackets.push(std::move(packet));
+    }
+}
+
+void NetworkClient::takeOutgoing() {
+    OutgoingPacket packet;
+    while (outgoingPackets.pop(packet)) {
+        if (packet.datagram) {
+            // Unreliable by design: a failed send is the same as a lost datagram
+            SOCKET datagram = datagramSocket.load(std::memory_order_relaxed);
+            if (datagram != INVALID_SOCKET) {
+                send(datagram, (const char*)packet.bytes.data(), static_cast<int>(packet.bytes.size()), 0);
+            }
+            continue;
+        }
+        appendFrame(packet.bytes.data(), packet.bytes.size());
+    }
+}
+
+void NetworkClient::appendFrame(uint8_t* frame, size_t size) {
+    PacketHeader header;
+    memcpy(&header, frame, sizeof(header));
+    header.sequence = sequenceOut++;
+    memcpy(frame, &header, sizeof(header));
+    sendBuffer.insert(sendBuffer.end(), frame, frame + size);
+}
+
+void NetworkClient::flushSends() {
+    // Everything queued goes out in as few send() calls as the socket allows;
+    // a short write resumes from the same byte on FD_WRITE
+    while (sendOffset < sendBuffer.size() && connected.load(std::memory_order_relaxed)) {
+        int result = send(serverSocket, (const char*)sendBuffer.data() + sendOffset,
+                          static_cast<int>(sendBuffer.size() - sendOffset), 0);
+        if (result == SOCKET_ERROR) {
+            int error = WSAGetLastError();
+            if (error != WSAEWOULDBLOCK) {
+                LOG_WARN(networkLog, "Send failed: {}", error);
+                connected = false;
+            }
+            break;
+        }
+        sendOffset += static_cast<size_t>(result);
+    }
 
-        std::cout << "[NetworkClient] Received " << packetTypeToString(packet.type) << std::endl;
+    if (sendOffset == sendBuffer.size()) {
+        sendBuffer.clear();
+        sendOffset = 0;
+    } else if (sendOffset > SEND_COMPACT_THRESHOLD) {
+        sendBuffer.erase(sendBuffer.begin(), sendBuffer.begin() + static_cast<std::ptrdiff_t>(sendOffset));
+        sendOffset = 0;
     }
 }
@@ -2,12 +2,21 @@
 #include "../../engine/core/Platform.h"
 #include "../../common/NetworkProtocol.h"
 #include "../../common/DataStructures.h"
+#include "../../common/RingBuffer.h"
+#include "../../common/Compression.h"
+#include "../../common/SpscQueue.h"
 #include <vector>
-#include <queue>
 #include <string>
+#include <atomic>
+#include <thread>
 #include <iostream>
 
-// Client-side network manager
+// Client-side network manager. Once connected, a dedicated I/O thread owns
+// the sockets: it drains them as data arrives, frames packets and hands them
+// to the game thread through a lock-free SPSC ring, so received packets are
+// ready the moment the game looks, whatever the frame rate. Sends take the
+// opposite ring and the I/O thread writes them (coalesced, resuming partial
+// writes). Everything except the I/O thread itself is game-thread API.
 class NetworkClient {
 public:
     NetworkClient();
@@ -16,15 +25,38 @@ public:
     // Connect to server
     bool connect(const std::string& serverIP, int port = 7777);
 
-    // Disconnect from server
+    // Disconnect from server (queued sends are written first)
     void disconnect();
 
-    // Update (receive data)
+    // Nothing left to pump: the I/O thread receives. Kept so existing frame
+    // loops need no change.
     void update();
 
-    // Send packet to server
+    // Queue packet for the I/O thread to send
     bool sendPacket(PacketType type, const void* payload, uint32_t payloadSize);
 
+    // Send a protocol struct, encoded through its PacketSchema
+    template <typename T>
+    bool sendMessage(PacketType type, const T& message) {
+        size_t size = encodePacket(message, encodeBuffer.data(), encodeBuffer.size());
+        return size > 0 && sendPacket(type, encodeBuffer.data(), static_cast<uint32_t>(size));
+    }
+
+    // Open the UDP gameplay channel to the server (after login: datagrams
+    // carry the session token). Datagrams are never retransmitted, so a lost
+    // one cannot hold up the ones behind it the way a lost TCP segment does.
+    bool openDatagramChannel();
+    bool hasDatagramChannel() const { return datagramSocket.load(std::memory_order_acquire) != INVALID_SOCKET; }
+
+    // Send one unreliable datagram (see isDatagramPacketType())
+    bool sendDatagram(PacketType type, const void* payload, uint32_t payloadSize);
+
+    template <typename T>
+    bool sendDatagramMessage(PacketType type, const T& message) {
+        size_t size = encodePacket(message, encodeBuffer.data(), encodeBuffer.size());
+        return size > 0 && sendDatagram(type, encodeBuffer.data(), static_cast<uint32_t>(size));
+    }
+
     // Check if connected
     bool isConnected() const;
 
@@ -50,14 +82,49 @@ public:
     std::vector<ReceivedPacket> getAllPackets();
 
 private:
+    // A packet for the I/O thread: a TCP header + payload (the I/O thread
+    // stamps the sequence) or a complete datagram
+    struct OutgoingPacket {
+        bool datagram = false;
+        std::vector<uint8_t> bytes;
+    };
+
+    static constexpr size_t RECEIVE_QUEUE_SIZE = 4096;
+    static constexpr size_t SEND_QUEUE_SIZE = 1024;
+
+    // Game thread
     SOCKET serverSocket;
+    std::atomic<SOCKET> datagramSocket;     // Created by the game thread, then read by the I/O thread
+    sockaddr_in serverAddress;
+    uint32_t datagramSequenceOut;
     bool initialized;
-    bool connected;
+    std::atomic<bool> connected;            // Cleared by either thread when the connection ends
     uint64_t sessionToken;
+    std::vector<uint8_t> encodeBuffer;      // Scratch for sendMessage
+
+    // Between the threads
+    SpscQueue<ReceivedPacket> receivedPackets;     // I/O -> game
+    SpscQueue<OutgoingPacket> outgoingPackets;     // Game -> I/O
+    std::thread ioThread;
+    std::atomic<bool> ioRunning;
+    WSAEVENT wakeEvent;                     // Set by the game thread after queuing a send
+
+    // I/O thread
     uint32_t sequenceOut;
-    std::vector<uint8_t> receiveBuffer;
-    std::queue<ReceivedPacket> receivedPackets;
+    uint32_t datagramSequenceIn;            // Newest accepted
+    bool hasDatagramSequence;
+    bool receiveBlocked;                    // receivedPackets was full; data waits in the socket
+    RingBuffer receiveBuffer;               // Framed in place, sized for one full packet plus slack
+    std::vector<uint8_t> sendBuffer;        // Bytes not yet accepted by the socket
+    size_t sendOffset;
+    CompressionDictionary compressionDictionary;    // Sent by the server on connect, if it uses one
 
+    bool queueOutgoing(OutgoingPacket&& packet);
+    void ioThreadMain();
     void receiveData();
+    void receiveDatagrams();
     void parsePackets();
+    void takeOutgoing();
+    void appendFrame(uint8_t* frame, size_t size);     // Stamps the sequence
+    void flushSends();
 };
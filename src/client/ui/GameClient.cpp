@@ -1,9 +1,23 @@
 #include "GameClient.h"
 #include "../../engine/core/Platform.h"
-#include <iostream>
+#include "../../common/Logger.h"
 #include <cstring>
 #include <algorithm>
 
+namespace {
+    LogCategory gameLog("GameClient");
+
+    // Unacknowledged inputs go to the server this often
+    constexpr float INPUT_SEND_INTERVAL = 1.0f / 30.0f;
+
+    // After a long frame, simulate at most this many steps and drop the rest
+    constexpr int MAX_STEPS_PER_FRAME = 10;
+
+    // PLAYER_STATE positions are quantized to 1 cm; closer than this to the
+    // prediction is a match
+    constexpr float RECONCILE_TOLERANCE = 0.02f;
+}
+
 // Manual gluPerspective implementation
 static void myPerspective(double fovy, double aspect, double zNear, double zFar) {
     double fH = std::tan(fovy / 360.0 * 3.14159265) * zNear;
@@ -20,7 +34,8 @@ GameClient::GameClient(NetworkClient* netClient, uint64_t accId)
       mouseCaptured(true), mouseSensitivity(0.2f),
       showInventory(false), inventoryAnimProgress(0.0f), selectedSlot(0),
       showMagCheck(false), magCheckTimer(0.0f), currentAmmo(30), reserveAmmo(120),
-      terrainSize(200), terrainScale(2.0f),
+      terrainSize(200), terrainScale(2.0f), predictedMoves(), nextInputSequence(1),
+      ackedInputSequence(0), inputAccumulator(0.0f), inputSendTimer(0.0f), serverEnemies(false),
       timeOfDay(12.0f), sunAngle(0.0f), rng(std::random_device{}())
 {
     // Initialize inventory with starter gear
@@ -56,9 +71,8 @@ GameClient::GameClient(NetworkClient* netClient, uint64_t accId)
     generateExtractionPoints();
     generateEnemies();
 
-    std::cout << "[GameClient] World generated - Terrain: " << terrainSize << "x" << terrainSize
-              << ", Trees: " << trees.size() << ", Houses: " << houses.size()
-              << ", Loot: " << lootSpawns.size() << ", Enemies: " << enemies.size() << std::endl;
+    LOG_INFO(gameLog, "World generated - Terrain: {}x{}, Trees: {}, Houses: {}, Loot: {}, Enemies: {}",
+             terrainSize, terrainSize, trees.size(), houses.size(), lootSpawns.size(), enemies.size());
 }
 
 void GameClient::update(float deltaTime) {
@@ -101,17 +115,23 @@ void GameClient::update(float deltaTime) {
             case PacketType::EXTRACTION_COMPLETE:
                 handleExtractionComplete(packet.payload);
                 break;
+            case PacketType::WORLD_SNAPSHOT:
+                handleWorldSnapshot(packet.payload);
+                break;
+            case PacketType::PLAYER_STATE:
+                handlePlayerState(packet.payload);
+                break;
             default:
                 break;
         }
     }
 
-    // Send position updates
-    static float syncTimer = 0;
-    syncTimer += deltaTime;
-    if (syncTimer >= 0.1f) {
-        sendPositionUpdate();
-        syncTimer = 0;
+    // Predict movement, then send the inputs the server has not applied yet
+    updateMovement(deltaTime);
+    inputSendTimer += deltaTime;
+    if (inputSendTimer >= INPUT_SEND_INTERVAL) {
+        sendPlayerInput();
+        inputSendTimer = 0;
     }
 }
 
@@ -161,26 +181,7 @@ void GameClient::handleInput(char key) {
         return;
     }
 
-    float moveSpeed = 5.0f;
-    float rad = playerYaw * 3.14159f / 180.0f;
-
-    // Movement - WASD
-    if (key == 'w' || key == 'W') {
-        playerX += sin(rad) * moveSpeed * 0.016f;
-        playerZ += cos(rad) * moveSpeed * 0.016f;
-    }
-    if (key == 's' || key == 'S') {
-        playerX -= sin(rad) * moveSpeed * 0.016f;
-        playerZ -= cos(rad) * moveSpeed * 0.016f;
-    }
-    if (key == 'a' || key == 'A') {
-        playerX -= cos(rad) * moveSpeed * 0.016f;
-        playerZ += sin(rad) * moveSpeed * 0.016f;
-    }
-    if (key == 'd' || key == 'D') {
-        playerX += cos(rad) * moveSpeed * 0.016f;
-        playerZ -= sin(rad) * moveSpeed * 0.016f;
-    }
+    // Movement (WASD) is sampled every step in updateMovement()
 
     // Leaning - Q/E
     if (key == 'q' || key == 'Q') {
@@ -220,9 +221,6 @@ void GameClient::handleInput(char key) {
         nextState = UIState::MAIN_MENU;
         changeState = true;
     }
-
-    // Update player Y based on terrain
-    playerY = getTerrainHeight(playerX, playerZ) + 1.7f;
 }
 
 void GameClient::handleMouseMove(float deltaX, float deltaY) {
@@ -242,7 +240,25 @@ void GameClient::handleMouseClick(float x, float y) {
     // Fire weapon (simplified)
     if (currentAmmo > 0) {
         currentAmmo--;
-        std::cout << "[GameClient] Fired! Ammo: " << currentAmmo << "/" << reserveAmmo << std::endl;
+        LOG_DEBUG(gameLog, "Fired! Ammo: {}/{}", currentAmmo, reserveAmmo);
+
+        // The server decides what it hit, against the world as we saw it
+        float yaw = playerYaw * 3.14159f / 180.0f;
+        float pitch = playerPitch * 3.14159f / 180.0f;
+        PlayerShoot shot;
+        shot.originX = playerX;
+        shot.originY = playerY;
+        shot.originZ = playerZ;
+        shot.dirX = std::sin(yaw) * std::cos(pitch);
+        shot.dirY = std::sin(pitch);
+        shot.dirZ = std::cos(yaw) * std::cos(pitch);
+        shot.weaponId = 0;  // Weapons have no numeric ids yet
+
+        if (networkClient->hasDatagramChannel()) {
+            networkClient->sendDatagramMessage(PacketType::PLAYER_SHOOT, shot);
+        } else {
+            networkClient->sendMessage(PacketType::PLAYER_SHOOT, shot);
+        }
     }
 }
 
@@ -848,6 +864,44 @@ void GameClient::updateCamera(float deltaTime) {
     // Camera is updated via mouse movement handled in handleMouseMove
 }
 
+void GameClient::updateMovement(float deltaTime) {
+    // Fixed steps, one command each, exactly as the server will run them
+    inputAccumulator = std::min(inputAccumulator + deltaTime, MAX_STEPS_PER_FRAME * MOVEMENT_STEP_SECONDS);
+    while (inputAccumulator >= MOVEMENT_STEP_SECONDS) {
+        inputAccumulator -= MOVEMENT_STEP_SECONDS;
+
+        // Only full if the server has applied nothing for INPUT_HISTORY
+        // steps; stop waiting for the oldest
+        if (nextInputSequence - ackedInputSequence > INPUT_HISTORY) {
+            ackedInputSequence = nextInputSequence - INPUT_HISTORY;
+        }
+
+        PredictedMove& move = predictedMoves[nextInputSequence % INPUT_HISTORY];
+        move.command = sampleMoveCommand();
+        move.result.x = playerX;
+        move.result.z = playerZ;
+        applyMoveCommand(move.result, move.command);
+        playerX = move.result.x;
+        playerZ = move.result.z;
+        nextInputSequence++;
+    }
+
+    // Height is ours alone: the server doesn't know the terrain
+    playerY = getTerrainHeight(playerX, playerZ) + 1.7f;
+}
+
+MoveCommand GameClient::sampleMoveCommand() {
+    MoveCommand command;
+    command.buttons = 0;
+    if (GetAsyncKeyState('W') & 0x8000) command.buttons |= MOVE_FORWARD;
+    if (GetAsyncKeyState('S') & 0x8000) command.buttons |= MOVE_BACK;
+    if (GetAsyncKeyState('A') & 0x8000) command.buttons |= MOVE_LEFT;
+    if (GetAsyncKeyState('D') & 0x8000) command.buttons |= MOVE_RIGHT;
+    command.yaw = quantizeAngle(playerYaw);
+    command.pitch = quantizeAngle(playerPitch);
+    return command;
+}
+
 void GameClient::updateLean(float deltaTime) {
     if (!isLeaning) {
         // Return to center
@@ -877,6 +931,9 @@ void GameClient::updateInventoryAnimation(float deltaTime) {
 }
 
 void GameClient::updateEnemies(float deltaTime) {
+    // Server-driven enemies only move with snapshots
+    if (serverEnemies) return;
+
     for (auto& enemy : enemies) {
         if (!enemy.alive) continue;
 
@@ -939,7 +996,7 @@ void GameClient::checkLootPickup() {
                 inventory.push_back(newItem);
             }
 
-            std::cout << "[GameClient] Picked up loot!" << std::endl;
+            LOG_INFO(gameLog, "Picked up loot!");
             break;
         }
     }
@@ -993,37 +1050,82 @@ ClientExtractionPoint* GameClient::getNearestExtraction() {
 }
 
 // ===== NETWORK =====
-void GameClient::sendPositionUpdate() {
-    PlayerMove move;
-    move.x = playerX;
-    move.y = playerY;
-    move.z = playerZ;
-    move.yaw = playerYaw;
-    move.pitch = playerPitch;
-    move.movementFlags = 0;
-
-    networkClient->sendPacket(PacketType::PLAYER_MOVE, &move, static_cast<uint32_t>(sizeof(move)));
+void GameClient::sendPlayerInput() {
+    uint32_t pending = nextInputSequence - ackedInputSequence - 1;
+    if (pending == 0) return;
+
+    // Every unacknowledged command (the newest, if there are too many), so
+    // a lost datagram is made up by the next one
+    uint32_t count = std::min(pending, static_cast<uint32_t>(MAX_INPUT_COMMANDS));
+    PlayerInput input;
+    input.firstSequence = nextInputSequence - count;
+    input.commandCount = static_cast<uint8_t>(count);
+    for (uint32_t i = 0; i < count; i++) {
+        input.commands[i] = predictedMoves[(input.firstSequence + i) % INPUT_HISTORY].command;
+    }
+
+    if (networkClient->hasDatagramChannel()) {
+        networkClient->sendDatagramMessage(PacketType::PLAYER_INPUT, input);
+    } else {
+        networkClient->sendMessage(PacketType::PLAYER_INPUT, input);
+    }
 }
 
-void GameClient::handleSpawnInfo(const std::vector<uint8_t>& payload) {
-    if (payload.size() < sizeof(SpawnInfo)) return;
+void GameClient::handlePlayerState(const std::vector<uint8_t>& payload) {
+    PlayerState state;
+    if (!decodePacket(payload, state)) return;
+
+    // Out of order, or from before commands we have since given up on
+    if (ackedInputSequence != 0 &&
+        (state.inputSequence == 0 || !isNewerSequence(state.inputSequence, ackedInputSequence))) {
+        return;
+    }
+    if (state.inputSequence != 0 && !isNewerSequence(nextInputSequence, state.inputSequence)) return;
+
+    // The server agrees with what we predicted for that command: the
+    // commands after it are still good too
+    uint32_t sequence = state.inputSequence;
+    ackedInputSequence = sequence;
+    if (sequence != 0) {
+        const MoveState& predicted = predictedMoves[sequence % INPUT_HISTORY].result;
+        if (std::fabs(predicted.x - state.x) <= RECONCILE_TOLERANCE &&
+            std::fabs(predicted.z - state.z) <= RECONCILE_TOLERANCE) {
+            return;
+        }
+    }
 
+    // Otherwise start over from the server's position and replay the
+    // commands it has not applied yet
+    MoveState position;
+    position.x = state.x;
+    position.z = state.z;
+    for (uint32_t pending = sequence + 1; pending != nextInputSequence; pending++) {
+        PredictedMove& move = predictedMoves[pending % INPUT_HISTORY];
+        applyMoveCommand(position, move.command);
+        move.result = position;
+    }
+
+    LOG_DEBUG(gameLog, "Corrected prediction at input {} by ({}, {})", sequence, position.x - playerX, position.z - playerZ);
+    playerX = position.x;
+    playerZ = position.z;
+    playerY = getTerrainHeight(playerX, playerZ) + 1.7f;
+}
+
+void GameClient::handleSpawnInfo(const std::vector<uint8_t>& payload) {
     SpawnInfo spawn;
-    memcpy(&spawn, payload.data(), sizeof(SpawnInfo));
+    if (!decodePacket(payload, spawn)) return;
 
     playerX = spawn.spawnX;
     playerY = spawn.spawnY;
     playerZ = spawn.spawnZ;
     playerYaw = spawn.spawnYaw;
 
-    std::cout << "[GameClient] Spawned at (" << playerX << ", " << playerY << ", " << playerZ << ")" << std::endl;
+    LOG_INFO(gameLog, "Spawned at ({}, {}, {})", playerX, playerY, playerZ);
 }
 
 void GameClient::handlePlayerDamage(const std::vector<uint8_t>& payload) {
-    if (payload.size() < sizeof(PlayerDamage)) return;
-
     PlayerDamage damage;
-    memcpy(&damage, payload.data(), sizeof(PlayerDamage));
+    if (!decodePacket(payload, damage)) return;
 
     if (damage.targetAccountId == accountId) {
         // Apply damage to random limb (simplified)
@@ -1035,7 +1137,7 @@ void GameClient::handlePlayerDamage(const std::vector<uint8_t>& payload) {
 
         if (*limbs[limbIndex] < 0) *limbs[limbIndex] = 0;
 
-        std::cout << "[GameClient] Took " << damage.damage << " damage!" << std::endl;
+        LOG_INFO(gameLog, "Took {} damage!", damage.damage);
 
         // Check for death
         if (limbHealth.getTotalHealth() <= 0) {
@@ -1045,35 +1147,113 @@ void GameClient::handlePlayerDamage(const std::vector<uint8_t>& payload) {
 }
 
 void GameClient::handlePlayerDeath(const std::vector<uint8_t>& payload) {
-    if (payload.size() < sizeof(PlayerDeath)) return;
-
     PlayerDeath death;
-    memcpy(&death, payload.data(), sizeof(PlayerDeath));
+    if (!decodePacket(payload, death)) return;
 
     if (death.victimAccountId == accountId) {
         alive = false;
-        std::cout << "[GameClient] Player died!" << std::endl;
+        LOG_INFO(gameLog, "Player died!");
     }
 }
 
 void GameClient::handleExtractionComplete(const std::vector<uint8_t>& payload) {
-    if (payload.size() < sizeof(ExtractionComplete)) return;
-
     ExtractionComplete extraction;
-    memcpy(&extraction, payload.data(), sizeof(ExtractionComplete));
+    if (!decodePacket(payload, extraction)) return;
 
     if (extraction.extracted) {
         extracted = true;
-        std::cout << "[GameClient] Extraction successful!" << std::endl;
+        LOG_INFO(gameLog, "Extraction successful!");
     }
 }
 
-void GameClient::handleOtherPlayerUpdate(const std::vector<uint8_t>& payload) {
-    // Not fully implemented - would sync other players for PvP
+void GameClient::handleWorldSnapshot(const std::vector<uint8_t>& payload) {
+    uint32_t sequence, baselineSequence;
+    if (!peekSnapshotBaseline(payload.data(), payload.size(), sequence, baselineSequence)) return;
+
+    // Snapshots arrive over UDP and (when too big) TCP, so order is not
+    // guaranteed; anything older than what we have is useless
+    if (!receivedSnapshots.empty() && !isNewerSequence(sequence, receivedSnapshots.back().sequence)) return;
+
+    const WorldSnapshot* baseline = nullptr;
+    if (baselineSequence != 0) {
+        for (const auto& received : receivedSnapshots) {
+            if (received.sequence == baselineSequence) {
+                baseline = &received;
+                break;
+            }
+        }
+        if (!baseline) {
+            // Baseline already evicted: ask for a full snapshot
+            sendSnapshotAck(0);
+            return;
+        }
+    }
+
+    WorldSnapshot snapshot;
+    if (!decodeSnapshot(payload.data(), payload.size(), baseline, snapshot)) {
+        LOG_WARN(gameLog, "Malformed world snapshot {}", sequence);
+        return;
+    }
+
+    receivedSnapshots.push_back(std::move(snapshot));
+    if (receivedSnapshots.size() > SNAPSHOT_HISTORY) {
+        receivedSnapshots.pop_front();
+    }
+
+    sendSnapshotAck(sequence);
+    applyWorldSnapshot(receivedSnapshots.back());
+}
+
+void GameClient::applyWorldSnapshot(const WorldSnapshot& snapshot) {
+    // Server heights assume flat ground; stand players and enemies on our terrain
+    otherPlayers.clear();
+    for (const auto& entity : snapshot.players) {
+        if (entity.id == accountId) continue;
+
+        OtherPlayer other;
+        other.accountId = entity.id;
+        other.x = dequantizePosition(entity.fields[PLAYER_X]);
+        other.z = dequantizePosition(entity.fields[PLAYER_Z]);
+        other.y = getTerrainHeight(other.x, other.z) + 1.7f;
+        other.yaw = dequantizeAngle(entity.fields[PLAYER_YAW]);
+        other.pitch = dequantizeAngle(entity.fields[PLAYER_PITCH]);
+        other.health = entity.fields[PLAYER_HEALTH];
+        other.alive = (entity.fields[PLAYER_FLAGS] & SNAPSHOT_FLAG_ALIVE) != 0;
+        otherPlayers[other.accountId] = other;
+    }
+
+    enemies.clear();
+    for (const auto& entity : snapshot.enemies) {
+        ClientEnemy enemy;
+        enemy.id = entity.id;
+        enemy.x = dequantizePosition(entity.fields[ENEMY_X]);
+        enemy.z = dequantizePosition(entity.fields[ENEMY_Z]);
+        enemy.y = getTerrainHeight(enemy.x, enemy.z) + 1.7f;
+        enemy.yaw = dequantizeAngle(entity.fields[ENEMY_YAW]);
+        enemy.health = entity.fields[ENEMY_HEALTH];
+        enemy.alive = (entity.fields[ENEMY_FLAGS] & SNAPSHOT_FLAG_ALIVE) != 0;
+        enemy.lastSeenPlayer = -1.0f;
+        enemy.patrolAngle = 0.0f;
+        enemies.push_back(enemy);
+    }
+    serverEnemies = true;
+
+    // snapshot.collectedLoot indexes the server's loot spawns; the local loot
+    // is still generated client-side, so there is nothing to match it to yet
+}
+
+void GameClient::sendSnapshotAck(uint32_t sequence) {
+    SnapshotAck ack;
+    ack.sequence = sequence;
+    if (networkClient->hasDatagramChannel()) {
+        networkClient->sendDatagramMessage(PacketType::SNAPSHOT_ACK, ack);
+    } else {
+        networkClient->sendMessage(PacketType::SNAPSHOT_ACK, ack);
+    }
 }
 
 void GameClient::requestExtraction() {
-    std::cout << "[GameClient] Requesting extraction..." << std::endl;
+    LOG_INFO(gameLog, "Requesting extraction...");
 
     // Send extraction request (simplified - would need proper packet)
     // For now, just set extracted to true after delay
@@ -4,6 +4,10 @@
 #include "../../common/NetworkProtocol.h"
 #include "../../common/DataStructures.h"
 #include "../../common/ItemDatabase.h"
+#include "../../common/WorldSnapshot.h"
+#include "../../common/PlayerMovement.h"
+#include <array>
+#include <deque>
 #include <vector>
 #include <cmath>
 #include <map>
@@ -44,7 +48,7 @@ struct ClientHouse {
 
 // Enemy (client-side simplified version)
 struct ClientEnemy {
-    uint32_t id;
+    uint64_t id;
     float x, y, z;
     float yaw;
     float health;
@@ -129,6 +133,24 @@ private:
     // Other players (for PvP)
     std::map<uint64_t, struct OtherPlayer> otherPlayers;
 
+    // Movement prediction: a command is sampled every movement step, applied
+    // here at once and kept until PLAYER_STATE says the server applied it
+    struct PredictedMove {
+        MoveCommand command;
+        MoveState result;           // Position right after applying it
+    };
+    static constexpr uint32_t INPUT_HISTORY = 128;              // ~2 s of steps
+    std::array<PredictedMove, INPUT_HISTORY> predictedMoves;    // Ring, by sequence % INPUT_HISTORY
+    uint32_t nextInputSequence;     // Sequences start at 1
+    uint32_t ackedInputSequence;    // Newest applied by the server, 0 = none
+    float inputAccumulator;         // Time not yet covered by a step
+    float inputSendTimer;
+
+    // Replication: recently decoded world snapshots (oldest first), kept as
+    // baselines for the server's deltas
+    std::deque<WorldSnapshot> receivedSnapshots;
+    bool serverEnemies;     // Enemies come from snapshots; stop the local patrol
+
     // Random generator
     std::mt19937 rng;
 
@@ -168,6 +190,8 @@ private:
 
     // Gameplay
     void updateCamera(float deltaTime);
+    void updateMovement(float deltaTime);
+    MoveCommand sampleMoveCommand();
     void updateLean(float deltaTime);
     void updateInventoryAnimation(float deltaTime);
     void updateEnemies(float deltaTime);
@@ -183,12 +207,15 @@ private:
     ClientExtractionPoint* getNearestExtraction();
 
     // Network
-    void sendPositionUpdate();
+    void sendPlayerInput();
+    void handlePlayerState(const std::vector<uint8_t>& payload);
     void handleSpawnInfo(const std::vector<uint8_t>& payload);
     void handlePlayerDamage(const std::vector<uint8_t>& payload);
     void handlePlayerDeath(const std::vector<uint8_t>& payload);
     void handleExtractionComplete(const std::vector<uint8_t>& payload);
-    void handleOtherPlayerUpdate(const std::vector<uint8_t>& payload);
+    void handleWorldSnapshot(const std::vector<uint8_t>& payload);
+    void applyWorldSnapshot(const WorldSnapshot& snapshot);
+    void sendSnapshotAck(uint32_t sequence);
     void requestExtraction();
 };
 
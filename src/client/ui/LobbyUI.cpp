@@ -1,8 +1,12 @@
 #include "LobbyUI.h"
 #include "../../engine/core/Platform.h"
-#include <iostream>
+#include "../../common/Logger.h"
 #include <cstring>
 
+namespace {
+    LogCategory lobbyUiLog("LobbyUI");
+}
+
 void LobbyUI::update(float deltaTime) {
     // Process server packets
     while (networkClient->hasPackets()) {
@@ -174,7 +178,7 @@ void LobbyUI::createLobby() {
     req.maxPlayers = 5;
     req.isPrivate = false;
 
-    networkClient->sendPacket(PacketType::LOBBY_CREATE, &req, static_cast<uint32_t>(sizeof(req)));
+    networkClient->sendMessage(PacketType::LOBBY_CREATE, req);
     statusMessage = "Creating lobby...";
 }
 
@@ -182,7 +186,7 @@ void LobbyUI::toggleReady() {
     LobbyReady req;
     req.ready = !isReady;
 
-    networkClient->sendPacket(PacketType::LOBBY_READY, &req, static_cast<uint32_t>(sizeof(req)));
+    networkClient->sendMessage(PacketType::LOBBY_READY, req);
 }
 
 void LobbyUI::leaveLobby() {
@@ -201,10 +205,8 @@ void LobbyUI::startQueue() {
 }
 
 void LobbyUI::handleLobbyCreateResponse(const std::vector<uint8_t>& payload) {
-    if (payload.size() < sizeof(LobbyCreateResponse)) return;
-
     LobbyCreateResponse resp;
-    memcpy(&resp, payload.data(), sizeof(LobbyCreateResponse));
+    if (!decodePacket(payload, resp)) return;
 
     if (resp.success) {
         inLobby = true;
@@ -217,10 +219,8 @@ void LobbyUI::handleLobbyCreateResponse(const std::vector<uint8_t>& payload) {
 }
 
 void LobbyUI::handleLobbyJoinResponse(const std::vector<uint8_t>& payload) {
-    if (payload.size() < sizeof(LobbyJoinResponse)) return;
-
     LobbyJoinResponse resp;
-    memcpy(&resp, payload.data(), sizeof(LobbyJoinResponse));
+    if (!decodePacket(payload, resp)) return;
 
     if (resp.success) {
         inLobby = true;
@@ -233,10 +233,8 @@ void LobbyUI::handleLobbyJoinResponse(const std::vector<uint8_t>& payload) {
 }
 
 void LobbyUI::handleLobbyUpdate(const std::vector<uint8_t>& payload) {
-    if (payload.size() < sizeof(LobbyUpdate)) return;
-
     LobbyUpdate update;
-    memcpy(&update, payload.data(), sizeof(LobbyUpdate));
+    if (!decodePacket(payload, update)) return;
 
     // Update lobby state
     currentLobbyId = update.lobbyId;
@@ -262,12 +260,10 @@ void LobbyUI::handleLobbyUpdate(const std::vector<uint8_t>& payload) {
 }
 
 void LobbyUI::handleMatchFound(const std::vector<uint8_t>& payload) {
-    if (payload.size() < sizeof(MatchFound)) return;
-
     MatchFound match;
-    memcpy(&match, payload.data(), sizeof(MatchFound));
+    if (!decodePacket(payload, match)) return;
 
-    std::cout << "[LobbyUI] Match found! Map: " << match.mapName << std::endl;
+    LOG_INFO(lobbyUiLog, "Match found! Map: {}", match.mapName);
 
     // Transition to in-game
     nextState = UIState::IN_GAME;
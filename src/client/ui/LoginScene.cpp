@@ -199,7 +199,7 @@ void LoginScene::attemptLogin() {
     LoginRequest req;
     strncpy_s(req.username, sizeof(req.username), username.c_str(), sizeof(req.username) - 1);
     strncpy_s(req.passwordHash, sizeof(req.passwordHash), password.c_str(), sizeof(req.passwordHash) - 1);
-    networkClient->sendPacket(PacketType::LOGIN_REQUEST, &req, static_cast<uint32_t>(sizeof(req)));
+    networkClient->sendMessage(PacketType::LOGIN_REQUEST, req);
 }
 
 void LoginScene::attemptRegister() {
@@ -223,7 +223,7 @@ void LoginScene::attemptRegister() {
     strncpy_s(req.username, sizeof(req.username), username.c_str(), sizeof(req.username) - 1);
     strncpy_s(req.passwordHash, sizeof(req.passwordHash), password.c_str(), sizeof(req.passwordHash) - 1);
     strncpy_s(req.email, sizeof(req.email), email.c_str(), sizeof(req.email) - 1);
-    networkClient->sendPacket(PacketType::REGISTER_REQUEST, &req, static_cast<uint32_t>(sizeof(req)));
+    networkClient->sendMessage(PacketType::REGISTER_REQUEST, req);
 }
 
 void LoginScene::processNetworkPackets() {
@@ -231,28 +231,30 @@ void LoginScene::processNetworkPackets() {
         NetworkClient::ReceivedPacket packet = networkClient->getNextPacket();
 
         if (packet.type == PacketType::LOGIN_RESPONSE) {
-            LoginResponse* resp = (LoginResponse*)packet.payload.data();
+            LoginResponse resp;
+            if (!decodePacket(packet.payload, resp)) continue;
             waitingForResponse = false;
-            if (resp->success) {
-                accountId = resp->accountId;
+            if (resp.success) {
+                accountId = resp.accountId;
                 statusMessage = "Login successful!";
                 // Scene transition will be handled by main application
             } else {
-                errorMessage = resp->errorMessage;
+                errorMessage = resp.errorMessage;
                 errorText->setText(errorMessage);
                 statusMessage.clear();
                 statusText->setText("");
             }
         }
         else if (packet.type == PacketType::REGISTER_RESPONSE) {
-            RegisterResponse* resp = (RegisterResponse*)packet.payload.data();
+            RegisterResponse resp;
+            if (!decodePacket(packet.payload, resp)) continue;
             waitingForResponse = false;
-            if (resp->success) {
+            if (resp.success) {
                 statusMessage = "Registration successful! Please login.";
                 statusText->setText(statusMessage);
                 switchMode(Mode::LOGIN);
             } else {
-                errorMessage = resp->errorMessage;
+                errorMessage = resp.errorMessage;
                 errorText->setText(errorMessage);
             }
         }
@@ -1,9 +1,13 @@
 #include "LoginUI.h"
 #include "../../engine/core/Platform.h"
-#include <iostream>
+#include "../../common/Logger.h"
 #include <cstring>
 #include <cmath>
 
+namespace {
+    LogCategory loginUiLog("LoginUI");
+}
+
 void LoginUI::update(float deltaTime) {
     // Update animation
     animTime += deltaTime;
@@ -327,7 +331,7 @@ void LoginUI::toggleMode() {
 }
 
 void LoginUI::sendLoginRequest() {
-    std::cout << "[LoginUI] Attempting login: " << username << std::endl;
+    LOG_INFO(loginUiLog, "Attempting login: {}", username);
 
     LoginRequest req;
     std::string passwordHash = simpleHash(password);
@@ -335,12 +339,12 @@ void LoginUI::sendLoginRequest() {
     strncpy_s(req.username, sizeof(req.username), username.c_str(), sizeof(req.username) - 1);
     strncpy_s(req.passwordHash, sizeof(req.passwordHash), passwordHash.c_str(), sizeof(req.passwordHash) - 1);
 
-    networkClient->sendPacket(PacketType::LOGIN_REQUEST, &req, static_cast<uint32_t>(sizeof(req)));
+    networkClient->sendMessage(PacketType::LOGIN_REQUEST, req);
     waitingForResponse = true;
 }
 
 void LoginUI::sendRegisterRequest() {
-    std::cout << "[LoginUI] Attempting registration: " << username << std::endl;
+    LOG_INFO(loginUiLog, "Attempting registration: {}", username);
 
     RegisterRequest req;
     std::string passwordHash = simpleHash(password);
@@ -349,27 +353,28 @@ void LoginUI::sendRegisterRequest() {
     strncpy_s(req.passwordHash, sizeof(req.passwordHash), passwordHash.c_str(), sizeof(req.passwordHash) - 1);
     strncpy_s(req.email, sizeof(req.email), email.c_str(), sizeof(req.email) - 1);
 
-    networkClient->sendPacket(PacketType::REGISTER_REQUEST, &req, static_cast<uint32_t>(sizeof(req)));
+    networkClient->sendMessage(PacketType::REGISTER_REQUEST, req);
     waitingForResponse = true;
 }
 
 void LoginUI::handleLoginResponse(const std::vector<uint8_t>& payload) {
     waitingForResponse = false;
 
-    if (payload.size() < sizeof(LoginResponse)) {
+    LoginResponse resp;
+    if (!decodePacket(payload, resp)) {
         errorMessage = "Invalid server response";
         return;
     }
 
-    LoginResponse resp;
-    memcpy(&resp, payload.data(), sizeof(LoginResponse));
-
     if (resp.success) {
         accountId = resp.accountId;
         networkClient->setSessionToken(resp.sessionToken);
+        if (!networkClient->openDatagramChannel()) {
+            LOG_WARN(loginUiLog, "UDP channel unavailable, gameplay packets will use TCP");
+        }
 
         statusMessage = "Login successful!";
-        std::cout << "[LoginUI] Login successful! AccountID: " << accountId << std::endl;
+        LOG_INFO(loginUiLog, "Login successful! AccountID: {}", accountId);
 
         // Transition to main menu
         nextState = UIState::MAIN_MENU;
@@ -382,17 +387,15 @@ void LoginUI::handleLoginResponse(const std::vector<uint8_t>& payload) {
 void LoginUI::handleRegisterResponse(const std::vector<uint8_t>& payload) {
     waitingForResponse = false;
 
-    if (payload.size() < sizeof(RegisterResponse)) {
+    RegisterResponse resp;
+    if (!decodePacket(payload, resp)) {
         errorMessage = "Invalid server response";
         return;
     }
 
-    RegisterResponse resp;
-    memcpy(&resp, payload.data(), sizeof(RegisterResponse));
-
     if (resp.success) {
         statusMessage = "Registration successful! You can now login.";
-        std::cout << "[LoginUI] Registration successful!" << std::endl;
+        LOG_INFO(loginUiLog, "Registration successful!");
 
         // Switch to login mode
         mode = Mode::LOGIN;
@@ -271,10 +271,8 @@ void MainMenuUI::selectOption() {
 }
 
 void MainMenuUI::handlePlayerDataResponse(const std::vector<uint8_t>& payload) {
-    if (payload.size() < sizeof(PlayerDataResponse)) return;
-
     PlayerDataResponse resp;
-    memcpy(&resp, payload.data(), sizeof(PlayerDataResponse));
+    if (!decodePacket(payload, resp)) return;
 
     playerStats = resp.stats;
 }
@@ -0,0 +1,140 @@
+#pragma once
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+
+// ============================================================================
+// BIT STREAMS
+// Bit-granular writer/reader for high-rate gameplay messages, where byte
+// alignment would waste a third of the payload. Bits are packed LSB first
+// into little-endian bytes; the last byte is zero-padded. Like ByteWriter,
+// writes past the end are only counted, so check overflowed() once at the end.
+//
+// Floats go on the wire quantized: a value in [min, max] at a given
+// precision takes quantizedBits(min, max, precision) bits and decodes to
+// within precision / 2 of the original (values outside the range clamp).
+// Angles wrap instead of clamping and use the full 2^bits steps per turn.
+// Both are limited to MAX_QUANTIZED_BITS.
+// ============================================================================
+
+constexpr uint8_t MAX_QUANTIZED_BITS = 32;
+
+// Bits needed for (max - min) / precision + 1 steps
+constexpr uint8_t quantizedBits(float min, float max, float precision) {
+    uint64_t steps = static_cast<uint64_t>((max - min) / precision + 0.5f);
+    uint8_t bits = 0;
+    while (bits < MAX_QUANTIZED_BITS && (1ull << bits) <= steps) bits++;
+    return bits;
+}
+
+class BitWriter {
+public:
+    BitWriter(uint8_t* data, size_t capacity) : data(data), capacity(capacity), bitPosition(0) {}
+
+    // Low `count` bits of `value`, count <= 64
+    void writeBits(uint64_t value, uint8_t count) {
+        for (uint8_t i = 0; i < count; i++, bitPosition++) {
+            size_t byte = bitPosition >> 3;
+            if (byte >= capacity) continue;
+            uint8_t mask = static_cast<uint8_t>(1u << (bitPosition & 7));
+            if ((bitPosition & 7) == 0) data[byte] = 0;
+            if ((value >> i) & 1) data[byte] |= mask;
+        }
+    }
+
+    void writeBool(bool value) {
+        writeBits(value ? 1 : 0, 1);
+    }
+
+    // 7-bit groups, each followed by a continuation bit
+    void writeVarint(uint64_t value) {
+        while (value >= 0x80) {
+            writeBits((value & 0x7F) | 0x80, 8);
+            value >>= 7;
+        }
+        writeBits(value, 8);
+    }
+
+    void writeQuantized(float value, float min, float max, float precision) {
+        uint8_t bits = quantizedBits(min, max, precision);
+        float clamped = value < min ? min : (value > max ? max : value);
+        uint64_t steps = static_cast<uint64_t>(std::lround((clamped - min) / precision));
+        uint64_t limit = (1ull << bits) - 1;
+        writeBits(steps > limit ? limit : steps, bits);
+    }
+
+    // Degrees, any range; 1 <= bits <= MAX_QUANTIZED_BITS
+    void writeAngle(float degrees, uint8_t bits) {
+        assert(bits >= 1 && bits <= MAX_QUANTIZED_BITS);
+        float turns = degrees / 360.0f;
+        turns -= std::floor(turns);
+        uint64_t steps = static_cast<uint64_t>(std::llround(turns * static_cast<double>(1ull << bits)));
+        writeBits(steps & ((1ull << bits) - 1), bits);
+    }
+
+    size_t bitSize() const { return bitPosition; }
+    size_t size() const { return (bitPosition + 7) >> 3; }
+    bool overflowed() const { return size() > capacity; }
+
+private:
+    uint8_t* data;
+    size_t capacity;
+    size_t bitPosition;
+};
+
+class BitReader {
+public:
+    BitReader(const uint8_t* data, size_t size) : data(data), bitSize(size * 8), bitPosition(0) {}
+
+    bool readBits(uint64_t& out, uint8_t count) {
+        if (bitSize - bitPosition < count) return false;
+        out = 0;
+        for (uint8_t i = 0; i < count; i++, bitPosition++) {
+            if ((data[bitPosition >> 3] >> (bitPosition & 7)) & 1) out |= 1ull << i;
+        }
+        return true;
+    }
+
+    bool readBool(bool& out) {
+        uint64_t bit;
+        if (!readBits(bit, 1)) return false;
+        out = bit != 0;
+        return true;
+    }
+
+    bool readVarint(uint64_t& out) {
+        out = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint64_t group;
+            if (!readBits(group, 8)) return false;
+            out |= (group & 0x7F) << shift;
+            if (!(group & 0x80)) return true;
+        }
+        return false;
+    }
+
+    bool readQuantized(float& out, float min, float max, float precision) {
+        uint64_t steps;
+        if (!readBits(steps, quantizedBits(min, max, precision))) return false;
+        float value = min + static_cast<float>(steps) * precision;
+        out = value > max ? max : value;
+        return true;
+    }
+
+    // Degrees in [0, 360); 1 <= bits <= MAX_QUANTIZED_BITS
+    bool readAngle(float& out, uint8_t bits) {
+        assert(bits >= 1 && bits <= MAX_QUANTIZED_BITS);
+        uint64_t steps;
+        if (!readBits(steps, bits)) return false;
+        out = static_cast<float>(static_cast<double>(steps) * 360.0 / static_cast<double>(1ull << bits));
+        return true;
+    }
+
+    size_t remainingBits() const { return bitSize - bitPosition; }
+
+private:
+    const uint8_t* data;
+    size_t bitSize;
+    size_t bitPosition;
+};
@@ -0,0 +1,588 @@
+#include "Compression.h"
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+    constexpr size_t MIN_MATCH = 4;
+    constexpr size_t MAX_OFFSET = 65535;
+    constexpr uint32_t MAX_LENGTH = 1u << 30;       // Longest literal run or match a decoder accepts
+    constexpr uint32_t MAX_EXPANSION = 255;         // Best case ratio; bounds claimed sizes in frames
+
+    // Per-message tables are sized to the input so small payloads clear little
+    constexpr int MIN_HASH_BITS = 8;
+    constexpr int MAX_HASH_BITS = 12;
+    constexpr int STREAM_HASH_BITS = 14;
+
+    // After 2^SKIP_STRENGTH misses in a row the search step grows by one, so
+    // incompressible data is skipped through quickly
+    constexpr uint32_t SKIP_STRENGTH = 6;
+
+    // Streams keep at least the last MAX_OFFSET bytes. The window is slid
+    // only once it grows well past that, so small chunks don't each move it.
+    constexpr size_t STREAM_HISTORY = 65536;
+    constexpr size_t STREAM_SLIDE_AT = 4 * STREAM_HISTORY;
+    constexpr size_t STREAM_BLOCK_SIZE = 65536;     // Largest chunk per stream frame
+
+    // Dictionary training: segments of SEGMENT_SIZE bytes scored by how many
+    // samples share their DMER_SIZE-byte substrings
+    constexpr size_t SEGMENT_SIZE = 64;
+    constexpr size_t DMER_SIZE = 8;
+
+    enum FrameMethod : uint8_t {
+        METHOD_STORED = 0,
+        METHOD_LZ = 1,
+        METHOD_LZ_DICTIONARY = 2
+    };
+
+    uint32_t read32(const uint8_t* p) {
+        uint32_t value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    uint64_t read64(const uint8_t* p) {
+        uint64_t value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    // Bytes a and b have in common, comparing at most limit
+    size_t commonLength(const uint8_t* a, const uint8_t* b, size_t limit) {
+        size_t length = 0;
+        while (length + 8 <= limit) {
+            uint64_t difference = read64(a + length) ^ read64(b + length);
+            if (difference != 0) {
+#if defined(_MSC_VER)
+                unsigned long bit;
+                _BitScanForward64(&bit, difference);
+                return length + (bit >> 3);
+#else
+                return length + (static_cast<size_t>(__builtin_ctzll(difference)) >> 3);
+#endif
+            }
+            length += 8;
+        }
+        while (length < limit && a[length] == b[length]) length++;
+        return length;
+    }
+
+    uint32_t hashSequence(uint32_t sequence, int bits) {
+        return (sequence * 2654435761u) >> (32 - bits);
+    }
+
+    void appendVarint(std::vector<uint8_t>& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    size_t varintSize(uint64_t value) {
+        size_t size = 1;
+        while (value >= 0x80) {
+            value >>= 7;
+            size++;
+        }
+        return size;
+    }
+
+    bool readVarint(const uint8_t*& p, const uint8_t* end, uint64_t& out) {
+        out = 0;
+        for (int shift = 0; shift < 64 && p < end; shift += 7) {
+            uint8_t byte = *p++;
+            out |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+    // Token overflow: 255s, then the remainder
+    bool writeLength(uint8_t*& op, const uint8_t* opEnd, size_t length) {
+        while (length >= 255) {
+            if (op >= opEnd) return false;
+            *op++ = 255;
+            length -= 255;
+        }
+        if (op >= opEnd) return false;
+        *op++ = static_cast<uint8_t>(length);
+        return true;
+    }
+
+    bool readLength(const uint8_t*& ip, const uint8_t* ipEnd, size_t& length) {
+        uint8_t byte;
+        do {
+            if (ip >= ipEnd || length > MAX_LENGTH) return false;
+            byte = *ip++;
+            length += byte;
+        } while (byte == 255);
+        return true;
+    }
+
+    // One sequence; offset 0 marks the literal-only last one. `readable` is
+    // how many bytes past `literals` may be read.
+    bool emitSequence(uint8_t*& op, const uint8_t* opEnd, const uint8_t* literals, size_t literalCount,
+                      size_t readable, size_t offset, size_t matchLength) {
+        if (op >= opEnd) return false;
+        uint8_t* token = op++;
+        size_t matchCode = offset ? matchLength - MIN_MATCH : 0;
+        *token = static_cast<uint8_t>((std::min<size_t>(literalCount, 15) << 4) | std::min<size_t>(matchCode, 15));
+
+        if (literalCount >= 15 && !writeLength(op, opEnd, literalCount - 15)) return false;
+        if (static_cast<size_t>(opEnd - op) < literalCount) return false;
+        if (literalCount <= 16 && readable >= 16 && opEnd - op >= 16) {
+            memcpy(op, literals, 16);
+        } else {
+            memcpy(op, literals, literalCount);
+        }
+        op += literalCount;
+        if (offset == 0) return true;
+
+        if (opEnd - op < 2) return false;
+        *op++ = static_cast<uint8_t>(offset);
+        *op++ = static_cast<uint8_t>(offset >> 8);
+        return matchCode < 15 || writeLength(op, opEnd, matchCode - 15);
+    }
+
+    // Compress window[start, end). Matches may start anywhere earlier in the
+    // window (up to MAX_OFFSET back) and, when start is 0, in the dictionary
+    // as if it came right before the window. `table` maps sequence hashes to
+    // window positions + 1 and is updated as the input is scanned.
+    size_t encodeSequences(const uint8_t* window, size_t start, size_t end, uint32_t* table, int hashBits,
+                           const CompressionDictionary* dictionary, uint8_t* dst, size_t capacity) {
+        uint8_t* op = dst;
+        const uint8_t* opEnd = dst + capacity;
+        const uint8_t* dict = dictionary ? dictionary->data() : nullptr;
+        const size_t dictSize = dictionary ? dictionary->size() : 0;
+
+        size_t anchor = start;
+        size_t ip = start;
+        uint32_t misses = 0;
+        while (ip + MIN_MATCH <= end) {
+            uint32_t sequence = read32(window + ip);
+            uint32_t hash = hashSequence(sequence, hashBits);
+            uint32_t candidate = table[hash];
+            table[hash] = static_cast<uint32_t>(ip + 1);
+
+            size_t matchLength = 0;
+            size_t offset = 0;
+            if (candidate != 0 && ip - (candidate - 1) <= MAX_OFFSET && read32(window + candidate - 1) == sequence) {
+                size_t ref = candidate - 1;
+                matchLength = MIN_MATCH + commonLength(window + ip + MIN_MATCH, window + ref + MIN_MATCH, end - ip - MIN_MATCH);
+                // Take back literals the match also covers
+                while (ip > anchor && ref > 0 && window[ip - 1] == window[ref - 1]) {
+                    ip--;
+                    ref--;
+                    matchLength++;
+                }
+                offset = ip - ref;
+            } else if (dict) {
+                uint32_t entry = dictionary->lookup(sequence);
+                size_t ref = entry - 1;
+                if (entry != 0 && ip + dictSize - ref <= MAX_OFFSET && read32(dict + ref) == sequence) {
+                    size_t limit = std::min(end - ip, dictSize - ref) - MIN_MATCH;
+                    matchLength = MIN_MATCH + commonLength(window + ip + MIN_MATCH, dict + ref + MIN_MATCH, limit);
+                    offset = ip + dictSize - ref;
+                }
+            }
+
+            if (matchLength == 0) {
+                ip += 1 + (misses++ >> SKIP_STRENGTH);
+                continue;
+            }
+            misses = 0;
+
+            if (!emitSequence(op, opEnd, window + anchor, ip - anchor, end - anchor, offset, matchLength)) return 0;
+            ip += matchLength;
+            anchor = ip;
+
+            // Index the tail of the match so a repeat right after it is found
+            if (ip + MIN_MATCH <= end + 2) {
+                table[hashSequence(read32(window + ip - 2), hashBits)] = static_cast<uint32_t>(ip - 2 + 1);
+            }
+        }
+
+        if (!emitSequence(op, opEnd, window + anchor, end - anchor, end - anchor, 0, 0)) return 0;
+        return static_cast<size_t>(op - dst);
+    }
+
+    // Decode into out[start, end). Matches may reach back into out[0, start)
+    // and past that into the dictionary.
+    bool decodeSequences(const uint8_t* src, size_t size, uint8_t* out, size_t start, size_t end,
+                         const CompressionDictionary* dictionary) {
+        const uint8_t* ip = src;
+        const uint8_t* ipEnd = src + size;
+        const size_t dictSize = dictionary ? dictionary->size() : 0;
+        size_t op = start;
+
+        while (ip < ipEnd) {
+            uint8_t token = *ip++;
+            size_t literalCount = token >> 4;
+            if (literalCount == 15 && !readLength(ip, ipEnd, literalCount)) return false;
+            if (literalCount > static_cast<size_t>(ipEnd - ip) || literalCount > end - op) return false;
+            // Short runs: one fixed 16-byte copy when both sides have room
+            // (none at all for an empty output, whose buffer may be null)
+            if (literalCount <= 16 && ipEnd - ip >= 16 && end - op >= 16) {
+                memcpy(out + op, ip, 16);
+            } else if (literalCount > 0) {
+                memcpy(out + op, ip, literalCount);
+            }
+            ip += literalCount;
+            op += literalCount;
+
+            // The last sequence has no match
+            if (ip == ipEnd) return op == end;
+
+            if (ipEnd - ip < 2) return false;
+            size_t offset = static_cast<size_t>(ip[0]) | (static_cast<size_t>(ip[1]) << 8);
+            ip += 2;
+            size_t matchLength = token & 15;
+            if (matchLength == 15 && !readLength(ip, ipEnd, matchLength)) return false;
+            matchLength += MIN_MATCH;
+            if (offset == 0 || offset > op + dictSize || matchLength > end - op) return false;
+
+            if (offset > op) {
+                size_t fromDictionary = std::min(offset - op, matchLength);
+                memcpy(out + op, dictionary->data() + dictSize - (offset - op), fromDictionary);
+                op += fromDictionary;
+                matchLength -= fromDictionary;
+            }
+
+            // 8-byte steps may overshoot into space the next sequence writes;
+            // an offset shorter than the match repeats the last `offset` bytes
+            if (offset >= 8 && end - op >= matchLength + 8) {
+                uint8_t* dst = out + op;
+                const uint8_t* ref = dst - offset;
+                for (size_t copied = 0; copied < matchLength; copied += 8) {
+                    memcpy(dst + copied, ref + copied, 8);
+                }
+            } else if (offset >= matchLength) {
+                memcpy(out + op, out + op - offset, matchLength);
+            } else {
+                for (size_t i = 0; i < matchLength; i++) {
+                    out[op + i] = out[op + i - offset];
+                }
+            }
+            op += matchLength;
+        }
+        return false;
+    }
+
+    uint32_t fnv1a(const uint8_t* data, size_t size) {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ data[i]) * 16777619u;
+        }
+        return hash;
+    }
+
+    // Drop window history beyond what matches can reach
+    void slideWindow(std::vector<uint8_t>& window, std::vector<uint32_t>* table) {
+        if (window.size() <= STREAM_SLIDE_AT) return;
+        size_t drop = window.size() - STREAM_HISTORY;
+        window.erase(window.begin(), window.begin() + static_cast<std::ptrdiff_t>(drop));
+        if (table) {
+            for (uint32_t& entry : *table) {
+                entry = entry > drop ? static_cast<uint32_t>(entry - drop) : 0;
+            }
+        }
+    }
+}
+
+// ============================================================================
+// DICTIONARY
+// ============================================================================
+
+CompressionDictionary::CompressionDictionary(const uint8_t* data, size_t size) {
+    // Keep the end; trained dictionaries put their best content there
+    if (size > MAX_DICTIONARY_SIZE) {
+        data += size - MAX_DICTIONARY_SIZE;
+        size = MAX_DICTIONARY_SIZE;
+    }
+    content.assign(data, data + size);
+    dictionaryId = fnv1a(data, size);
+
+    // Later positions overwrite earlier ones: nearer matches for the same hash
+    hashTable.assign(size_t(1) << HASH_BITS, 0);
+    for (size_t p = 0; p + MIN_MATCH <= size; p++) {
+        hashTable[hashSequence(read32(data + p), HASH_BITS)] = static_cast<uint32_t>(p + 1);
+    }
+}
+
+CompressionDictionary CompressionDictionary::train(const std::vector<std::vector<uint8_t>>& samples, size_t maxSize) {
+    maxSize = std::min(maxSize, MAX_DICTIONARY_SIZE);
+
+    std::vector<uint8_t> corpus;
+    for (const auto& sample : samples) {
+        corpus.insert(corpus.end(), sample.begin(), sample.end());
+    }
+    if (corpus.size() <= maxSize) {
+        return CompressionDictionary(corpus.data(), corpus.size());
+    }
+
+    // How many samples contain each d-mer. One seen in a single sample is
+    // not shared content and scores nothing.
+    struct DmerCount {
+        uint32_t samples = 0;
+        uint32_t lastSample = 0;
+    };
+    std::unordered_map<uint64_t, DmerCount> frequency;
+    std::vector<uint64_t> dmers(corpus.size(), 0);
+    std::vector<bool> hasDmer(corpus.size(), false);
+    size_t offset = 0;
+    for (uint32_t s = 0; s < samples.size(); s++) {
+        const auto& sample = samples[s];
+        for (size_t p = 0; p + DMER_SIZE <= sample.size(); p++) {
+            uint64_t dmer = read64(sample.data() + p);
+            dmers[offset + p] = dmer;
+            hasDmer[offset + p] = true;
+            DmerCount& count = frequency[dmer];
+            if (count.lastSample != s + 1) {
+                count.lastSample = s + 1;
+                count.samples++;
+            }
+        }
+        offset += sample.size();
+    }
+    for (auto& entry : frequency) {
+        if (entry.second.samples < 2) entry.second.samples = 0;
+    }
+
+    // Split the corpus into one epoch per segment and take the best segment
+    // of each: the window whose distinct d-mers are shared by the most
+    // samples. Chosen d-mers stop scoring, so later segments add new content.
+    struct Segment {
+        size_t start;
+        uint64_t score;
+    };
+    std::vector<Segment> segments;
+    const size_t epochs = maxSize / SEGMENT_SIZE;
+    const size_t epochSize = corpus.size() / std::max<size_t>(epochs, 1);
+    const size_t positions = SEGMENT_SIZE - DMER_SIZE + 1;     // D-mers wholly inside a segment
+
+    std::unordered_map<uint64_t, uint32_t> active;
+    for (size_t epoch = 0; epoch < epochs; epoch++) {
+        size_t begin = epoch * epochSize;
+        size_t end = std::min(begin + epochSize, corpus.size());
+        if (end - begin < SEGMENT_SIZE) continue;
+
+        auto score = [&](size_t p) -> uint64_t {
+            if (!hasDmer[p]) return 0;
+            auto it = frequency.find(dmers[p]);
+            return it != frequency.end() ? it->second.samples : 0;
+        };
+
+        // Slide a SEGMENT_SIZE window, counting each distinct d-mer once
+        active.clear();
+        uint64_t current = 0;
+        Segment best = { begin, 0 };
+        for (size_t p = begin; p + DMER_SIZE <= end; p++) {
+            if (hasDmer[p] && active[dmers[p]]++ == 0) current += score(p);
+            if (p >= begin + positions) {
+                size_t out = p - positions;
+                if (hasDmer[out] && --active[dmers[out]] == 0) current -= score(out);
+            }
+            if (p + 1 >= begin + positions && current > best.score) {
+                best = { p + 1 - positions, current };
+            }
+        }
+        if (best.score == 0) continue;
+
+        segments.push_back(best);
+        for (size_t p = best.start; p < best.start + positions; p++) {
+            if (hasDmer[p]) frequency[dmers[p]].samples = 0;
+        }
+    }
+
+    // Best segments last, where they sit closest to the data
+    std::sort(segments.begin(), segments.end(), [](const Segment& a, const Segment& b) { return a.score < b.score; });
+    std::vector<uint8_t> content;
+    for (const Segment& segment : segments) {
+        content.insert(content.end(), corpus.begin() + static_cast<std::ptrdiff_t>(segment.start),
+                       corpus.begin() + static_cast<std::ptrdiff_t>(segment.start + SEGMENT_SIZE));
+    }
+    return CompressionDictionary(content.data(), content.size());
+}
+
+// ============================================================================
+// BLOCKS
+// ============================================================================
+
+size_t compressBound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+size_t compressBlock(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity,
+                     const CompressionDictionary* dictionary) {
+    if (dictionary && dictionary->empty()) dictionary = nullptr;
+
+    int bits = MIN_HASH_BITS;
+    while (bits < MAX_HASH_BITS && (size_t(1) << bits) < size) bits++;
+
+    thread_local std::vector<uint32_t> table;
+    table.assign(size_t(1) << bits, 0);
+    return encodeSequences(src, 0, size, table.data(), bits, dictionary, dst, capacity);
+}
+
+bool decompressBlock(const uint8_t* src, size_t size, uint8_t* dst, size_t decompressedSize,
+                     const CompressionDictionary* dictionary) {
+    if (dictionary && dictionary->empty()) dictionary = nullptr;
+    return decodeSequences(src, size, dst, 0, decompressedSize, dictionary);
+}
+
+// ============================================================================
+// FRAMES
+// ============================================================================
+
+bool compressPayload(const uint8_t* data, size_t size, std::vector<uint8_t>& out,
+                     const CompressionDictionary* dictionary) {
+    if (dictionary && dictionary->empty()) dictionary = nullptr;
+    out.clear();
+
+    if (size >= (dictionary ? DICTIONARY_COMPRESSION_THRESHOLD : COMPRESSION_THRESHOLD)) {
+        out.push_back(dictionary ? METHOD_LZ_DICTIONARY : METHOD_LZ);
+        appendVarint(out, size);
+        if (dictionary) {
+            uint32_t id = dictionary->id();
+            for (int i = 0; i < 4; i++) out.push_back(static_cast<uint8_t>(id >> (i * 8)));
+        }
+
+        // Only worth it if the frame ends up smaller than the stored one
+        size_t headerSize = out.size();
+        size_t storedSize = 1 + varintSize(size) + size;
+        size_t limit = storedSize - headerSize - 1;
+        out.resize(headerSize + limit);
+        size_t compressed = compressBlock(data, size, out.data() + headerSize, limit, dictionary);
+        if (compressed > 0) {
+            out.resize(headerSize + compressed);
+            return true;
+        }
+        out.clear();
+    }
+
+    out.push_back(METHOD_STORED);
+    appendVarint(out, size);
+    out.insert(out.end(), data, data + size);
+    return false;
+}
+
+bool decompressPayload(const uint8_t* data, size_t size, std::vector<uint8_t>& out,
+                       const CompressionDictionary* dictionary) {
+    const uint8_t* p = data;
+    const uint8_t* end = data + size;
+    uint64_t rawSize;
+    if (size == 0) return false;
+    uint8_t method = *p++;
+    if (!readVarint(p, end, rawSize)) return false;
+    size_t remaining = static_cast<size_t>(end - p);
+
+    switch (method) {
+    case METHOD_STORED:
+        if (rawSize != remaining) return false;
+        out.assign(p, end);
+        return true;
+
+    case METHOD_LZ_DICTIONARY: {
+        if (remaining < 4 || !dictionary || dictionary->empty()) return false;
+        uint32_t id = static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+                      (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+        if (id != dictionary->id()) return false;
+        p += 4;
+        remaining -= 4;
+        break;
+    }
+
+    case METHOD_LZ:
+        dictionary = nullptr;
+        break;
+
+    default:
+        return false;
+    }
+
+    // Refuse sizes no block this short could expand to
+    if (rawSize > static_cast<uint64_t>(remaining) * MAX_EXPANSION + 16) return false;
+    out.resize(static_cast<size_t>(rawSize));
+    return decompressBlock(p, remaining, out.data(), out.size(), dictionary);
+}
+
+// ============================================================================
+// STREAMS
+// Frame: varint (chunkSize << 1 | stored), then the raw chunk or a varint
+// block size and the block.
+// ============================================================================
+
+CompressionStream::CompressionStream() : hashTable(size_t(1) << STREAM_HASH_BITS, 0) {
+}
+
+void CompressionStream::compress(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    while (size > 0) {
+        size_t chunk = std::min(size, STREAM_BLOCK_SIZE);
+        size_t historySize = window.size();
+        window.insert(window.end(), data, data + chunk);
+
+        block.resize(chunk);
+        size_t compressed = encodeSequences(window.data(), historySize, window.size(), hashTable.data(),
+                                            STREAM_HASH_BITS, nullptr, block.data(), chunk - 1);
+        if (compressed > 0) {
+            appendVarint(out, static_cast<uint64_t>(chunk) << 1);
+            appendVarint(out, compressed);
+            out.insert(out.end(), block.begin(), block.begin() + static_cast<std::ptrdiff_t>(compressed));
+        } else {
+            appendVarint(out, (static_cast<uint64_t>(chunk) << 1) | 1);
+            out.insert(out.end(), data, data + chunk);
+        }
+
+        slideWindow(window, &hashTable);
+        data += chunk;
+        size -= chunk;
+    }
+}
+
+void CompressionStream::reset() {
+    window.clear();
+    std::fill(hashTable.begin(), hashTable.end(), 0);
+}
+
+DecompressionStream::DecompressionStream() {
+}
+
+bool DecompressionStream::decompress(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    const uint8_t* p = data;
+    const uint8_t* end = data + size;
+    while (p < end) {
+        uint64_t header;
+        if (!readVarint(p, end, header)) return false;
+        uint64_t chunk = header >> 1;
+        if (chunk == 0 || chunk > STREAM_BLOCK_SIZE) return false;
+
+        size_t historySize = window.size();
+        if (header & 1) {
+            if (chunk > static_cast<uint64_t>(end - p)) return false;
+            window.insert(window.end(), p, p + chunk);
+            p += chunk;
+        } else {
+            uint64_t blockSize;
+            if (!readVarint(p, end, blockSize) || blockSize > static_cast<uint64_t>(end - p)) return false;
+            window.resize(historySize + static_cast<size_t>(chunk));
+            if (!decodeSequences(p, static_cast<size_t>(blockSize), window.data(), historySize, window.size(), nullptr)) {
+                window.resize(historySize);
+                return false;
+            }
+            p += blockSize;
+        }
+
+        out.insert(out.end(), window.begin() + static_cast<std::ptrdiff_t>(historySize), window.end());
+        slideWindow(window, nullptr);
+    }
+    return true;
+}
+
+void DecompressionStream::reset() {
+    window.clear();
+}
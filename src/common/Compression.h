@@ -0,0 +1,116 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// ============================================================================
+// COMPRESSION
+// Byte-oriented LZ77 codec for network payloads, in the LZ4 family: greedy
+// single-probe hash matching on 4-byte sequences, 16-bit offsets and no
+// entropy stage, so both directions run at memory speed on small messages.
+//
+// Block format, repeated until the output is full:
+//   token      high nibble literal count, low nibble match length - 4
+//              (15 = more: add following bytes until one is below 255)
+//   literals
+//   offset     u16 LE distance back from the current output position
+// The last sequence has literals only.
+//
+// Three ways to use it:
+//   - compressPayload/decompressPayload: one self-describing frame per
+//     message, stored raw below the threshold or when LZ doesn't win
+//   - with a CompressionDictionary: a block may also match into a shared
+//     dictionary trained from captured traffic (see train()), which is what
+//     makes short, repetitive game messages compress at all
+//   - CompressionStream/DecompressionStream: chunks of one long transfer
+//     reference the previous 64 KB, so a stash split into many packets
+//     compresses like one buffer
+// ============================================================================
+
+// Payloads below these sizes are sent as is. Schema-encoded messages have
+// little redundancy of their own, so plain LZ only pays off on larger ones;
+// a trained dictionary already covers their common content (compressbench).
+constexpr size_t COMPRESSION_THRESHOLD = 128;
+constexpr size_t DICTIONARY_COMPRESSION_THRESHOLD = 16;
+
+// Fits in one packet, so a server can hand its dictionary to clients
+constexpr size_t MAX_DICTIONARY_SIZE = 16384;
+
+// Shared dictionary: content both sides prepend to every block, plus a hash
+// table over it so compressing does not rebuild one per message.
+class CompressionDictionary {
+public:
+    CompressionDictionary() = default;
+    CompressionDictionary(const uint8_t* data, size_t size);
+
+    // Pick up to maxSize bytes of segments that recur across many samples
+    static CompressionDictionary train(const std::vector<std::vector<uint8_t>>& samples, size_t maxSize);
+
+    const uint8_t* data() const { return content.data(); }
+    size_t size() const { return content.size(); }
+    bool empty() const { return content.empty(); }
+
+    // Content hash; frames name the dictionary they need
+    uint32_t id() const { return dictionaryId; }
+
+    // Position + 1 of the last dictionary occurrence of a 4-byte sequence's
+    // hash, 0 if none; the caller checks the bytes really match
+    uint32_t lookup(uint32_t sequence) const {
+        return hashTable.empty() ? 0 : hashTable[(sequence * 2654435761u) >> (32 - HASH_BITS)];
+    }
+
+private:
+    static constexpr int HASH_BITS = 13;
+
+    std::vector<uint8_t> content;
+    std::vector<uint32_t> hashTable;
+    uint32_t dictionaryId = 0;
+};
+
+// Worst-case compressBlock output for `size` input bytes
+size_t compressBound(size_t size);
+
+// Compress into dst. Returns the compressed size, 0 if it doesn't fit.
+size_t compressBlock(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity,
+                     const CompressionDictionary* dictionary = nullptr);
+
+// Decompress exactly decompressedSize bytes. False on malformed input.
+bool decompressBlock(const uint8_t* src, size_t size, uint8_t* dst, size_t decompressedSize,
+                     const CompressionDictionary* dictionary = nullptr);
+
+// Frame: method byte, varint original size, [u32 dictionary id], data.
+// Returns true if the frame holds compressed data, false if stored raw.
+bool compressPayload(const uint8_t* data, size_t size, std::vector<uint8_t>& out,
+                     const CompressionDictionary* dictionary = nullptr);
+
+// False for malformed frames or a dictionary mismatch
+bool decompressPayload(const uint8_t* data, size_t size, std::vector<uint8_t>& out,
+                       const CompressionDictionary* dictionary = nullptr);
+
+// Compressing side of a long transfer. Each compress() appends one or more
+// frames to `out`; the receiving DecompressionStream must see every frame,
+// in order.
+class CompressionStream {
+public:
+    CompressionStream();
+
+    void compress(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+    void reset();
+
+private:
+    std::vector<uint8_t> window;        // History followed by the chunk being compressed
+    std::vector<uint32_t> hashTable;    // Window position + 1
+    std::vector<uint8_t> block;         // Scratch for one compressed chunk
+};
+
+class DecompressionStream {
+public:
+    DecompressionStream();
+
+    // Decode whole frames from compress() and append them to `out`
+    bool decompress(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+    void reset();
+
+private:
+    std::vector<uint8_t> window;
+};
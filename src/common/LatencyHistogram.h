@@ -0,0 +1,112 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+// ============================================================================
+// LATENCY HISTOGRAM
+// Fixed-size log-linear histogram for latency samples (any unit, usually
+// microseconds). Values below 32 get exact buckets; above that every power of
+// two is split into 16 buckets, so a reported percentile is within ~6% of the
+// true value. Recording is a few instructions and never allocates, and two
+// histograms merge by adding counts, so per-thread histograms can be combined
+// for reporting.
+// ============================================================================
+
+class LatencyHistogram {
+public:
+    static constexpr int LINEAR_BUCKETS = 32;
+    static constexpr int SUB_BUCKETS = 16;
+    static constexpr int BUCKET_COUNT = LINEAR_BUCKETS + (64 - 5) * SUB_BUCKETS;
+
+    LatencyHistogram() { reset(); }
+
+    void record(uint64_t value) {
+        counts[bucketOf(value)]++;
+        total++;
+        sum += value;
+        if (value < minValue) minValue = value;
+        if (value > maxValue) maxValue = value;
+    }
+
+    void merge(const LatencyHistogram& other) {
+        if (other.total == 0) return;
+        for (int i = 0; i < BUCKET_COUNT; i++) {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+        sum += other.sum;
+        if (other.minValue < minValue) minValue = other.minValue;
+        if (other.maxValue > maxValue) maxValue = other.maxValue;
+    }
+
+    void reset() {
+        memset(counts, 0, sizeof(counts));
+        total = 0;
+        sum = 0;
+        minValue = UINT64_MAX;
+        maxValue = 0;
+    }
+
+    uint64_t getCount() const { return total; }
+    uint64_t getMin() const { return total > 0 ? minValue : 0; }
+    uint64_t getMax() const { return maxValue; }
+    double getMean() const { return total > 0 ? static_cast<double>(sum) / total : 0.0; }
+
+    // Value at or below which `percent` of the samples fall (0-100). Reports
+    // the middle of the matching bucket, clamped to the recorded min/max.
+    uint64_t getPercentile(double percent) const {
+        if (total == 0) return 0;
+
+        uint64_t rank = static_cast<uint64_t>(percent / 100.0 * total + 0.5);
+        if (rank < 1) rank = 1;
+        if (rank > total) rank = total;
+
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKET_COUNT; i++) {
+            seen += counts[i];
+            if (seen >= rank) {
+                uint64_t value = bucketLow(i) + bucketWidth(i) / 2;
+                if (value < minValue) value = minValue;
+                if (value > maxValue) value = maxValue;
+                return value;
+            }
+        }
+        return maxValue;
+    }
+
+private:
+    uint64_t counts[BUCKET_COUNT];
+    uint64_t total;
+    uint64_t sum;
+    uint64_t minValue;
+    uint64_t maxValue;
+
+    static int highestBit(uint64_t value) {
+        int bit = 0;
+        while (value >>= 1) bit++;
+        return bit;
+    }
+
+    static int bucketOf(uint64_t value) {
+        if (value < LINEAR_BUCKETS) return static_cast<int>(value);
+
+        // Top five bits select the bucket: 1xxxx, shifted down by `shift`
+        int msb = highestBit(value);
+        int shift = msb - 4;
+        int sub = static_cast<int>(value >> shift) - SUB_BUCKETS;
+        return LINEAR_BUCKETS + (msb - 5) * SUB_BUCKETS + sub;
+    }
+
+    static uint64_t bucketLow(int index) {
+        if (index < LINEAR_BUCKETS) return static_cast<uint64_t>(index);
+        int group = (index - LINEAR_BUCKETS) / SUB_BUCKETS;
+        int sub = (index - LINEAR_BUCKETS) % SUB_BUCKETS;
+        return static_cast<uint64_t>(SUB_BUCKETS + sub) << (group + 1);
+    }
+
+    static uint64_t bucketWidth(int index) {
+        if (index < LINEAR_BUCKETS) return 1;
+        int group = (index - LINEAR_BUCKETS) / SUB_BUCKETS;
+        return 1ull << (group + 1);
+    }
+};
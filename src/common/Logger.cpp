@@ -0,0 +1,507 @@
+#include "Logger.h"
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using logdetail::ArgType;
+using logdetail::RecordHeader;
+
+std::atomic<uint8_t> Logger::runtimeLevel{ LOG_MIN_LEVEL };
+
+// ============================================================================
+// LogCategory
+// ============================================================================
+
+namespace {
+    LogCategory*& categoryHead() {
+        static LogCategory* head = nullptr;
+        return head;
+    }
+}
+
+LogCategory::LogCategory(const char* name, uint32_t maxPerSecond)
+    : name(name), maxPerSecond(maxPerSecond), next(categoryHead()) {
+    // Categories are created during static initialization (single-threaded)
+    categoryHead() = this;
+}
+
+LogCategory* LogCategory::getFirst() {
+    return categoryHead();
+}
+
+uint64_t logdetail::nowNanos() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+// ============================================================================
+// Per-thread ring buffers and the writer thread
+// ============================================================================
+
+namespace {
+    constexpr uint8_t PAD_LEVEL = 0xFF;     // Filler record at the end of the ring
+
+    // Single-producer/single-consumer byte ring owned by one logging thread.
+    // Positions run freely and are masked.
+    struct ThreadBuffer {
+        static constexpr size_t CAPACITY = 256 * 1024;
+        static constexpr size_t MASK = CAPACITY - 1;
+        static constexpr size_t MAX_RECORD = CAPACITY / 4;
+
+        std::unique_ptr<uint8_t[]> storage{ new uint8_t[CAPACITY] };
+        alignas(64) std::atomic<uint64_t> writePos{ 0 };
+        alignas(64) std::atomic<uint64_t> readPos{ 0 };
+        alignas(64) uint64_t pendingEnd = 0;    // Producer only: end of the reserved record
+        std::atomic<uint64_t> dropped{ 0 };
+        std::atomic<bool> retired{ false };     // Owning thread exited
+        std::atomic<bool> wakeRequested{ false };   // Producer asked for an early drain
+    };
+
+    struct LoggerState {
+        std::mutex buffersMutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+        std::mutex wakeMutex;
+        std::condition_variable wakeCv;
+        std::condition_variable flushedCv;
+        uint64_t flushRequested = 0;
+        uint64_t flushCompleted = 0;
+        bool urgent = false;
+
+        std::atomic<bool> running{ false };
+        std::thread writer;
+
+        std::mutex syncMutex;                   // Direct writes once stopped
+        std::atomic<uint64_t> retiredDropped{ 0 };  // Drops of freed rings
+        uint64_t reportedDropped = 0;
+
+        // Writer-thread scratch
+        std::string output;
+        int64_t cachedSecond = -1;
+        char cachedTime[16] = {};
+
+        LoggerState() {
+            running.store(true, std::memory_order_release);
+            writer = std::thread(&LoggerState::writerMain, this);
+        }
+
+        ~LoggerState() {
+            stop();
+        }
+
+        void stop() {
+            if (!running.exchange(false, std::memory_order_acq_rel)) return;
+            {
+                std::lock_guard<std::mutex> lock(wakeMutex);
+                urgent = true;
+            }
+            wakeCv.notify_one();
+            if (writer.joinable()) {
+                writer.join();
+            }
+        }
+
+        ThreadBuffer* registerThread() {
+            auto buffer = std::make_unique<ThreadBuffer>();
+            ThreadBuffer* raw = buffer.get();
+            std::lock_guard<std::mutex> lock(buffersMutex);
+            buffers.push_back(std::move(buffer));
+            return raw;
+        }
+
+        void writerMain();
+        void drain();
+        void reportLosses();
+        void formatRecord(const RecordHeader& header, const uint8_t* args);
+        void appendArg(const uint8_t*& cursor);
+        void appendTimestamp(uint64_t timestampNanos);
+        void writeOutput();
+        uint64_t countDropped();
+    };
+
+    LoggerState& state() {
+        static LoggerState instance;
+        return instance;
+    }
+
+    // Marks the thread's ring as retired when the thread exits, so the writer
+    // can free it once drained
+    struct ThreadBufferHandle {
+        ThreadBuffer* buffer = nullptr;
+        ~ThreadBufferHandle() {
+            if (buffer) buffer->retired.store(true, std::memory_order_release);
+        }
+    };
+
+    thread_local ThreadBufferHandle threadBuffer;
+    thread_local std::vector<uint8_t> syncScratch;
+    thread_local bool syncRecord = false;
+
+    const char* levelName(uint8_t level) {
+        switch (level) {
+            case LOG_LEVEL_TRACE: return "TRACE";
+            case LOG_LEVEL_DEBUG: return "DEBUG";
+            case LOG_LEVEL_INFO:  return "INFO ";
+            case LOG_LEVEL_WARN:  return "WARN ";
+            default:              return "ERROR";
+        }
+    }
+}
+
+void LoggerState::writerMain() {
+    auto lastReport = std::chrono::steady_clock::now();
+
+    while (true) {
+        uint64_t flushTarget;
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wakeCv.wait_for(lock, std::chrono::milliseconds(5), [this] {
+                return urgent || flushRequested != flushCompleted;
+            });
+            urgent = false;
+            flushTarget = flushRequested;
+        }
+
+        drain();
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastReport >= std::chrono::seconds(1)) {
+            reportLosses();
+            lastReport = now;
+        }
+
+        writeOutput();
+
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            flushCompleted = flushTarget;
+        }
+        flushedCv.notify_all();
+
+        if (!running.load(std::memory_order_acquire)) {
+            // Producers may have raced with stop(); one last pass
+            drain();
+            reportLosses();
+            writeOutput();
+            return;
+        }
+    }
+}
+
+void LoggerState::drain() {
+    std::vector<ThreadBuffer*> active;
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+        active.reserve(buffers.size());
+        for (auto& buffer : buffers) {
+            active.push_back(buffer.get());
+        }
+    }
+
+    std::vector<uint64_t> limits(active.size());
+    for (size_t i = 0; i < active.size(); i++) {
+        limits[i] = active[i]->writePos.load(std::memory_order_acquire);
+    }
+
+    // Merge the rings by timestamp so lines from different threads interleave
+    // in the order they were logged
+    while (true) {
+        size_t best = active.size();
+        uint64_t bestTime = 0;
+
+        for (size_t i = 0; i < active.size(); i++) {
+            ThreadBuffer& buffer = *active[i];
+            uint64_t pos = buffer.readPos.load(std::memory_order_relaxed);
+
+            while (pos < limits[i]) {
+                const uint8_t* record = &buffer.storage[pos & ThreadBuffer::MASK];
+                uint32_t size;
+                memcpy(&size, record, sizeof(size));
+                if (record[offsetof(RecordHeader, level)] != PAD_LEVEL) break;
+                pos += size;
+                buffer.readPos.store(pos, std::memory_order_release);
+            }
+            if (pos >= limits[i]) continue;
+
+            RecordHeader header;
+            memcpy(&header, &buffer.storage[pos & ThreadBuffer::MASK], sizeof(header));
+            if (best == active.size() || header.timestampNanos < bestTime) {
+                best = i;
+                bestTime = header.timestampNanos;
+            }
+        }
+
+        if (best == active.size()) break;
+
+        ThreadBuffer& buffer = *active[best];
+        uint64_t pos = buffer.readPos.load(std::memory_order_relaxed);
+        const uint8_t* record = &buffer.storage[pos & ThreadBuffer::MASK];
+        RecordHeader header;
+        memcpy(&header, record, sizeof(header));
+        formatRecord(header, record + sizeof(header));
+        buffer.readPos.store(pos + header.size, std::memory_order_release);
+
+        if (output.size() >= 64 * 1024) {
+            writeOutput();
+        }
+    }
+
+    for (ThreadBuffer* buffer : active) {
+        buffer->wakeRequested.store(false, std::memory_order_relaxed);
+    }
+
+    // Free rings of exited threads once everything in them is written
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    for (size_t i = 0; i < buffers.size();) {
+        ThreadBuffer& buffer = *buffers[i];
+        if (buffer.retired.load(std::memory_order_acquire) &&
+            buffer.readPos.load(std::memory_order_relaxed) == buffer.writePos.load(std::memory_order_acquire)) {
+            retiredDropped.fetch_add(buffer.dropped.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            buffers[i] = std::move(buffers.back());
+            buffers.pop_back();
+        } else {
+            i++;
+        }
+    }
+}
+
+uint64_t LoggerState::countDropped() {
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    uint64_t total = retiredDropped.load(std::memory_order_relaxed);
+    for (auto& buffer : buffers) {
+        total += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void LoggerState::reportLosses() {
+    uint64_t total = countDropped();
+    uint64_t dropped = total - reportedDropped;
+    reportedDropped = total;
+    if (dropped > 0) {
+        appendTimestamp(logdetail::nowNanos());
+        output += " WARN  [Logger] ";
+        output += std::to_string(dropped);
+        output += " messages dropped (log buffer full)\n";
+    }
+
+    for (LogCategory* category = LogCategory::getFirst(); category; category = category->getNext()) {
+        uint64_t suppressed = category->takeSuppressed();
+        if (suppressed > 0) {
+            appendTimestamp(logdetail::nowNanos());
+            output += " WARN  [";
+            output += category->getName();
+            output += "] ";
+            output += std::to_string(suppressed);
+            output += " messages suppressed by rate limit\n";
+        }
+    }
+}
+
+void LoggerState::appendTimestamp(uint64_t timestampNanos) {
+    int64_t second = static_cast<int64_t>(timestampNanos / 1000000000ull);
+    if (second != cachedSecond) {
+        time_t t = static_cast<time_t>(second);
+        std::tm local;
+#ifdef _WIN32
+        localtime_s(&local, &t);
+#else
+        localtime_r(&t, &local);
+#endif
+        strftime(cachedTime, sizeof(cachedTime), "%H:%M:%S", &local);
+        cachedSecond = second;
+    }
+
+    char millis[8];
+    snprintf(millis, sizeof(millis), ".%03u", static_cast<unsigned>((timestampNanos / 1000000ull) % 1000));
+    output += cachedTime;
+    output += millis;
+}
+
+void LoggerState::formatRecord(const RecordHeader& header, const uint8_t* args) {
+    appendTimestamp(header.timestampNanos);
+    output += ' ';
+    output += levelName(header.level);
+    output += " [";
+    output += header.category->getName();
+    output += "] ";
+
+    const uint8_t* cursor = args;
+    uint32_t remaining = header.argCount;
+    for (const char* p = header.format; *p; p++) {
+        if (p[0] == '{' && p[1] == '}' && remaining > 0) {
+            appendArg(cursor);
+            remaining--;
+            p++;
+        } else {
+            output += *p;
+        }
+    }
+    output += '\n';
+}
+
+void LoggerState::appendArg(const uint8_t*& cursor) {
+    ArgType type = static_cast<ArgType>(*cursor++);
+
+    if (type == ArgType::STRING) {
+        uint16_t length;
+        memcpy(&length, cursor, sizeof(length));
+        cursor += sizeof(length);
+        output.append(reinterpret_cast<const char*>(cursor), length);
+        cursor += length;
+        return;
+    }
+
+    if (type == ArgType::BOOL) {
+        output += *cursor++ ? "true" : "false";
+        return;
+    }
+
+    uint64_t bits;
+    memcpy(&bits, cursor, sizeof(bits));
+    cursor += sizeof(bits);
+
+    char text[32];
+    char* end = text;
+    switch (type) {
+        case ArgType::INT:
+            end = std::to_chars(text, text + sizeof(text), static_cast<int64_t>(bits)).ptr;
+            break;
+        case ArgType::UINT:
+            end = std::to_chars(text, text + sizeof(text), bits).ptr;
+            break;
+        case ArgType::DOUBLE: {
+            double value;
+            memcpy(&value, &bits, sizeof(value));
+            int written = snprintf(text, sizeof(text), "%g", value);
+            end = text + (written > 0 ? written : 0);
+            break;
+        }
+        case ArgType::POINTER: {
+            int written = snprintf(text, sizeof(text), "0x%llx", static_cast<unsigned long long>(bits));
+            end = text + (written > 0 ? written : 0);
+            break;
+        }
+        default:
+            break;
+    }
+    output.append(text, end);
+}
+
+void LoggerState::writeOutput() {
+    if (output.empty()) return;
+    fwrite(output.data(), 1, output.size(), stdout);
+    fflush(stdout);
+    output.clear();
+}
+
+// ============================================================================
+// Logger
+// ============================================================================
+
+uint8_t* Logger::reserve(size_t size) {
+    LoggerState& s = state();
+
+    if (!s.running.load(std::memory_order_acquire)) {
+        // Writer stopped: format on this thread
+        syncScratch.resize(size);
+        syncRecord = true;
+        return syncScratch.data();
+    }
+    syncRecord = false;
+
+    ThreadBuffer* buffer = threadBuffer.buffer;
+    if (!buffer) {
+        buffer = s.registerThread();
+        threadBuffer.buffer = buffer;
+    }
+
+    size_t aligned = (size + 7) & ~static_cast<size_t>(7);
+    if (aligned > ThreadBuffer::MAX_RECORD) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    uint64_t pos = buffer->writePos.load(std::memory_order_relaxed);
+    uint64_t read = buffer->readPos.load(std::memory_order_acquire);
+    size_t offset = static_cast<size_t>(pos & ThreadBuffer::MASK);
+    size_t contiguous = ThreadBuffer::CAPACITY - offset;
+    size_t padding = contiguous < aligned ? contiguous : 0;
+
+    if (pos + padding + aligned - read > ThreadBuffer::CAPACITY) {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    if (padding > 0) {
+        // Records never wrap; fill the tail and start over at offset 0
+        uint8_t* pad = &buffer->storage[offset];
+        uint32_t padSize = static_cast<uint32_t>(padding);
+        memcpy(pad, &padSize, sizeof(padSize));
+        pad[offsetof(RecordHeader, level)] = PAD_LEVEL;
+        pos += padding;
+        offset = 0;
+    }
+
+    buffer->pendingEnd = pos + aligned;
+    return &buffer->storage[offset];
+}
+
+void Logger::commit(uint8_t* record, size_t size, bool urgent) {
+    LoggerState& s = state();
+
+    if (syncRecord) {
+        RecordHeader header;
+        memcpy(&header, record, sizeof(header));
+        std::lock_guard<std::mutex> lock(s.syncMutex);
+        s.output.clear();
+        s.formatRecord(header, record + sizeof(header));
+        s.writeOutput();
+        return;
+    }
+
+    ThreadBuffer* buffer = threadBuffer.buffer;
+    uint32_t aligned = static_cast<uint32_t>((size + 7) & ~static_cast<size_t>(7));
+    memcpy(record, &aligned, sizeof(aligned));
+    buffer->writePos.store(buffer->pendingEnd, std::memory_order_release);
+
+    // Wake the writer early when the ring is half full instead of waiting
+    // for its next poll
+    if (!urgent && buffer->pendingEnd - buffer->readPos.load(std::memory_order_relaxed) > ThreadBuffer::CAPACITY / 2) {
+        urgent = !buffer->wakeRequested.exchange(true, std::memory_order_relaxed);
+    }
+
+    if (urgent) {
+        {
+            std::lock_guard<std::mutex> lock(s.wakeMutex);
+            s.urgent = true;
+        }
+        s.wakeCv.notify_one();
+    }
+}
+
+void Logger::flush() {
+    LoggerState& s = state();
+    if (!s.running.load(std::memory_order_acquire)) return;
+
+    std::unique_lock<std::mutex> lock(s.wakeMutex);
+    uint64_t target = ++s.flushRequested;
+    s.wakeCv.notify_one();
+    s.flushedCv.wait(lock, [&] {
+        return s.flushCompleted >= target || !s.running.load(std::memory_order_acquire);
+    });
+}
+
+void Logger::shutdown() {
+    state().stop();
+}
+
+uint64_t Logger::getDroppedCount() {
+    return state().countDropped();
+}
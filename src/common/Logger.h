@@ -0,0 +1,255 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+// ============================================================================
+// Asynchronous logger
+//
+// Call sites copy their format string pointer and raw arguments into a
+// lock-free ring owned by the calling thread; a background thread formats
+// and writes them. Levels below LOG_MIN_LEVEL are compiled out entirely.
+//
+//   LOG_INFO(authLog, "User logged in: {} (Session: {})", username, token);
+//
+// Format strings must be string literals (only the pointer is stored).
+// Each "{}" is replaced by the next argument.
+// ============================================================================
+
+#define LOG_LEVEL_TRACE 0
+#define LOG_LEVEL_DEBUG 1
+#define LOG_LEVEL_INFO  2
+#define LOG_LEVEL_WARN  3
+#define LOG_LEVEL_ERROR 4
+
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+enum class LogLevel : uint8_t {
+    TRACE = LOG_LEVEL_TRACE,
+    DEBUG = LOG_LEVEL_DEBUG,
+    INFO = LOG_LEVEL_INFO,
+    WARN = LOG_LEVEL_WARN,
+    ERR = LOG_LEVEL_ERROR       // windows.h defines ERROR
+};
+
+// A named log source, printed as "[name]". maxPerSecond > 0 rate-limits the
+// category; excess messages are counted and reported instead of written.
+// Categories are meant to be namespace-scope objects.
+class LogCategory {
+public:
+    explicit LogCategory(const char* name, uint32_t maxPerSecond = 0);
+
+    LogCategory(const LogCategory&) = delete;
+    LogCategory& operator=(const LogCategory&) = delete;
+
+    const char* getName() const { return name; }
+
+    // Rate limiter; true if a message may be logged now
+    bool admit(uint64_t nowNanos) {
+        if (maxPerSecond == 0) return true;
+
+        uint64_t second = nowNanos / 1000000000ull;
+        uint64_t current = windowSecond.load(std::memory_order_relaxed);
+        if (second != current && windowSecond.compare_exchange_strong(current, second, std::memory_order_relaxed)) {
+            windowCount.store(0, std::memory_order_relaxed);
+        }
+        if (windowCount.fetch_add(1, std::memory_order_relaxed) < maxPerSecond) {
+            return true;
+        }
+        suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    uint64_t takeSuppressed() { return suppressed.exchange(0, std::memory_order_relaxed); }
+
+    LogCategory* getNext() const { return next; }
+    static LogCategory* getFirst();
+
+private:
+    const char* name;
+    uint32_t maxPerSecond;
+    std::atomic<uint64_t> windowSecond{ 0 };
+    std::atomic<uint32_t> windowCount{ 0 };
+    std::atomic<uint64_t> suppressed{ 0 };
+    LogCategory* next;      // Registry of all categories, built during static init
+};
+
+// Binary argument encoding shared by the call sites and the formatter
+namespace logdetail {
+    enum class ArgType : uint8_t {
+        INT,
+        UINT,
+        DOUBLE,
+        BOOL,
+        STRING,
+        POINTER
+    };
+
+    constexpr size_t MAX_STRING_ARG = 512;
+
+    // Every record starts with this header, followed by the encoded args
+    struct RecordHeader {
+        uint32_t size;          // Whole record, 8-byte aligned
+        uint8_t level;
+        uint8_t argCount;
+        uint16_t flags;
+        const LogCategory* category;
+        const char* format;
+        uint64_t timestampNanos;
+    };
+
+    template <typename T>
+    struct IsCharArray : std::false_type {};
+    template <size_t N>
+    struct IsCharArray<char[N]> : std::true_type {};
+
+    template <typename T>
+    inline size_t stringLength(const T& value) {
+        size_t length;
+        if constexpr (IsCharArray<T>::value) {
+            length = strnlen(value, sizeof(T));
+        } else if constexpr (std::is_same<T, std::string>::value) {
+            length = value.size();
+        } else {
+            length = value ? strlen(value) : 0;
+        }
+        return length < MAX_STRING_ARG ? length : MAX_STRING_ARG;
+    }
+
+    template <typename T>
+    constexpr bool isString() {
+        return IsCharArray<T>::value || std::is_same<T, std::string>::value ||
+               std::is_same<T, const char*>::value || std::is_same<T, char*>::value;
+    }
+
+    template <typename T>
+    inline size_t encodedSize(const T& value) {
+        if constexpr (isString<T>()) {
+            return 1 + sizeof(uint16_t) + stringLength(value);
+        } else if constexpr (std::is_same<T, bool>::value) {
+            return 2;
+        } else {
+            return 1 + sizeof(uint64_t);
+        }
+    }
+
+    template <typename T>
+    inline uint8_t* encode(uint8_t* dst, const T& value) {
+        if constexpr (isString<T>()) {
+            uint16_t length = static_cast<uint16_t>(stringLength(value));
+            const char* chars;
+            if constexpr (std::is_same<T, std::string>::value) {
+                chars = value.data();
+            } else {
+                chars = value;
+            }
+            *dst++ = static_cast<uint8_t>(ArgType::STRING);
+            memcpy(dst, &length, sizeof(length));
+            dst += sizeof(length);
+            if (length > 0) memcpy(dst, chars, length);
+            return dst + length;
+        } else if constexpr (std::is_same<T, bool>::value) {
+            *dst++ = static_cast<uint8_t>(ArgType::BOOL);
+            *dst++ = value ? 1 : 0;
+            return dst;
+        } else {
+            uint64_t bits;
+            ArgType type;
+            if constexpr (std::is_floating_point<T>::value) {
+                double d = static_cast<double>(value);
+                memcpy(&bits, &d, sizeof(bits));
+                type = ArgType::DOUBLE;
+            } else if constexpr (std::is_enum<T>::value) {
+                bits = static_cast<uint64_t>(static_cast<int64_t>(value));
+                type = ArgType::INT;
+            } else if constexpr (std::is_pointer<T>::value) {
+                bits = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value));
+                type = ArgType::POINTER;
+            } else if constexpr (std::is_signed<T>::value) {
+                bits = static_cast<uint64_t>(static_cast<int64_t>(value));
+                type = ArgType::INT;
+            } else {
+                static_assert(std::is_unsigned<T>::value, "unsupported log argument type");
+                bits = static_cast<uint64_t>(value);
+                type = ArgType::UINT;
+            }
+            *dst++ = static_cast<uint8_t>(type);
+            memcpy(dst, &bits, sizeof(bits));
+            return dst + sizeof(bits);
+        }
+    }
+
+    uint64_t nowNanos();
+}
+
+class Logger {
+public:
+    // Message severity filter applied at runtime on top of LOG_MIN_LEVEL
+    static void setLevel(LogLevel level) { runtimeLevel.store(static_cast<uint8_t>(level), std::memory_order_relaxed); }
+    static LogLevel getLevel() { return static_cast<LogLevel>(runtimeLevel.load(std::memory_order_relaxed)); }
+
+    template <typename... Args>
+    static void write(LogLevel level, LogCategory& category, const char* format, const Args&... args) {
+        if (static_cast<uint8_t>(level) < runtimeLevel.load(std::memory_order_relaxed)) return;
+
+        uint64_t timestamp = logdetail::nowNanos();
+        if (!category.admit(timestamp)) return;
+
+        size_t size = sizeof(logdetail::RecordHeader);
+        ((size += logdetail::encodedSize(args)), ...);
+
+        uint8_t* record = reserve(size);
+        if (!record) return;    // Ring full: counted as dropped
+
+        logdetail::RecordHeader header;
+        header.size = 0;        // Filled in by commit()
+        header.level = static_cast<uint8_t>(level);
+        header.argCount = static_cast<uint8_t>(sizeof...(Args));
+        header.flags = 0;
+        header.category = &category;
+        header.format = format;
+        header.timestampNanos = timestamp;
+        memcpy(record, &header, sizeof(header));
+
+        uint8_t* dst = record + sizeof(header);
+        ((dst = logdetail::encode(dst, args)), ...);
+        (void)dst;
+
+        commit(record, size, level >= LogLevel::ERR);
+    }
+
+    // Block until everything logged so far has been written
+    static void flush();
+
+    // Write what is left and stop the background thread. Later messages are
+    // formatted and written synchronously.
+    static void shutdown();
+
+    // Messages lost because a thread's ring was full
+    static uint64_t getDroppedCount();
+
+private:
+    static std::atomic<uint8_t> runtimeLevel;
+
+    // Space for one record in the calling thread's ring, or nullptr
+    static uint8_t* reserve(size_t size);
+    static void commit(uint8_t* record, size_t size, bool urgent);
+};
+
+#define LOG_AT(levelValue, category, ...) \
+    do { \
+        if constexpr ((levelValue) >= LOG_MIN_LEVEL) { \
+            Logger::write(static_cast<LogLevel>(levelValue), category, __VA_ARGS__); \
+        } \
+    } while (0)
+
+#define LOG_TRACE(category, ...) LOG_AT(LOG_LEVEL_TRACE, category, __VA_ARGS__)
+#define LOG_DEBUG(category, ...) LOG_AT(LOG_LEVEL_DEBUG, category, __VA_ARGS__)
+#define LOG_INFO(category, ...)  LOG_AT(LOG_LEVEL_INFO, category, __VA_ARGS__)
+#define LOG_WARN(category, ...)  LOG_AT(LOG_LEVEL_WARN, category, __VA_ARGS__)
+#define LOG_ERROR(category, ...) LOG_AT(LOG_LEVEL_ERROR, category, __VA_ARGS__)
@@ -1,11 +1,13 @@
 #pragma once
 #include "DataStructures.h"
+#include "Serialization.h"
 #include <cstdint>
 #include <string>
 #include <vector>
 
 // Network Protocol for Extraction Shooter
-// All packets use this header + payload structure
+// All packets use this header + payload structure. Payloads are the structs
+// below, encoded through their PacketSchema (see Serialization.h).
 
 enum class PacketType : uint16_t {
     // Authentication (0-99)
@@ -44,15 +46,19 @@ enum class PacketType : uint16_t {
     SPAWN_INFO = 303,
     PLAYER_SPAWN = 304,
     EXTRACTION_COMPLETE = 305,
+    WORLD_SNAPSHOT = 306,       // Server -> client, payload encoded by WorldSnapshot.h
+    SNAPSHOT_ACK = 307,
 
     // Gameplay (400-499)
-    PLAYER_MOVE = 400,
+    PLAYER_MOVE = 400,          // Position report; raids now move players by PLAYER_INPUT
     PLAYER_SHOOT = 401,
     PLAYER_DAMAGE = 402,
     PLAYER_DEATH = 403,
     PLAYER_LOOT = 404,
     PLAYER_RELOAD = 405,
     PLAYER_USE_ITEM = 406,
+    PLAYER_INPUT = 407,         // Client -> server movement commands (see PlayerMovement.h)
+    PLAYER_STATE = 408,         // Server -> client result of the commands applied so far
 
     // Merchant/Economy (500-599)
     MERCHANT_LIST_REQUEST = 500,
@@ -69,9 +75,10 @@ enum class PacketType : uint16_t {
     LOADOUT_UPDATE = 604,
 
     // Heartbeat & Connection (700-799)
-    HEARTBEAT = 700,
+    HEARTBEAT = 700,                // Empty: client keep-alive; else a HeartbeatProbe (see below)
     DISCONNECT = 701,
     SERVER_SHUTDOWN = 702,
+    COMPRESSION_DICTIONARY = 703,   // Server -> client on connect, payload is the raw dictionary
 
     // Error Messages (800-899)
     ERROR_RESPONSE = 800,
@@ -93,6 +100,47 @@ struct PacketHeader {
 // Maximum packet size (16KB)
 constexpr size_t MAX_PACKET_SIZE = 16384;
 
+// Set in PacketHeader::type when the payload is a Compression.h frame rather
+// than the message itself (server -> client only). The size limit applies to
+// the decompressed payload as well.
+constexpr uint16_t PACKET_FLAG_COMPRESSED = 0x8000;
+
+// Unreliable gameplay channel: UDP on the same port as the TCP control
+// connection. Each datagram is one packet, with no retransmission and no
+// ordering; receivers drop anything older than the newest sequence seen.
+// Clients identify themselves with the session token from LoginResponse.
+#pragma pack(push, 1)
+struct DatagramHeader {
+    uint64_t sessionToken;  // Sender's session (client -> server); 0 from the server
+    uint16_t type;          // PacketType
+    uint32_t sequence;      // Per-sender counter, wraps
+};
+#pragma pack(pop)
+
+// Header + payload; stays under common path MTUs so datagrams never fragment
+constexpr size_t MAX_DATAGRAM_SIZE = 1200;
+
+// Packets allowed on the datagram channel: high-rate gameplay state where a
+// retransmitted copy would arrive too late to be worth having
+inline bool isDatagramPacketType(PacketType type) {
+    switch (type) {
+        case PacketType::PLAYER_MOVE:
+        case PacketType::PLAYER_SHOOT:
+        case PacketType::PLAYER_INPUT:
+        case PacketType::PLAYER_STATE:
+        case PacketType::WORLD_SNAPSHOT:
+        case PacketType::SNAPSHOT_ACK:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Wrap-safe "a was sent after b" for datagram sequences
+inline bool isNewerSequence(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) > 0;
+}
+
 // ============================================================================
 // AUTHENTICATION PACKETS
 // ============================================================================
@@ -102,6 +150,13 @@ struct LoginRequest {
     char passwordHash[64];  // SHA-256 hash
 };
 
+template <> struct PacketSchema<LoginRequest> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&LoginRequest::username),
+        schemaField(&LoginRequest::passwordHash));
+};
+
 struct LoginResponse {
     bool success;
     uint64_t accountId;
@@ -109,18 +164,43 @@ struct LoginResponse {
     char errorMessage[256];
 };
 
+template <> struct PacketSchema<LoginResponse> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&LoginResponse::success),
+        schemaField(&LoginResponse::accountId),
+        schemaFixed(&LoginResponse::sessionToken),
+        schemaField(&LoginResponse::errorMessage));
+};
+
 struct RegisterRequest {
     char username[32];
     char passwordHash[64];
     char email[256];
 };
 
+template <> struct PacketSchema<RegisterRequest> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&RegisterRequest::username),
+        schemaField(&RegisterRequest::passwordHash),
+        schemaField(&RegisterRequest::email));
+};
+
 struct RegisterResponse {
     bool success;
     uint64_t accountId;
     char errorMessage[256];
 };
 
+template <> struct PacketSchema<RegisterResponse> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&RegisterResponse::success),
+        schemaField(&RegisterResponse::accountId),
+        schemaField(&RegisterResponse::errorMessage));
+};
+
 // ============================================================================
 // LOBBY PACKETS
 // ============================================================================
@@ -131,23 +211,54 @@ struct LobbyCreateRequest {
     bool isPrivate;
 };
 
+template <> struct PacketSchema<LobbyCreateRequest> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&LobbyCreateRequest::lobbyName),
+        schemaField(&LobbyCreateRequest::maxPlayers),
+        schemaField(&LobbyCreateRequest::isPrivate));
+};
+
 struct LobbyCreateResponse {
     bool success;
     uint64_t lobbyId;
     char errorMessage[256];
 };
 
+template <> struct PacketSchema<LobbyCreateResponse> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&LobbyCreateResponse::success),
+        schemaField(&LobbyCreateResponse::lobbyId),
+        schemaField(&LobbyCreateResponse::errorMessage));
+};
+
 struct LobbyJoinRequest {
     uint64_t lobbyId;
     char password[64];      // For private lobbies
 };
 
+template <> struct PacketSchema<LobbyJoinRequest> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&LobbyJoinRequest::lobbyId),
+        schemaField(&LobbyJoinRequest::password));
+};
+
 struct LobbyJoinResponse {
     bool success;
     uint64_t lobbyId;
     char errorMessage[256];
 };
 
+template <> struct PacketSchema<LobbyJoinResponse> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&LobbyJoinResponse::success),
+        schemaField(&LobbyJoinResponse::lobbyId),
+        schemaField(&LobbyJoinResponse::errorMessage));
+};
+
 struct LobbyMemberInfo {
     uint64_t accountId;
     char username[32];
@@ -155,6 +266,15 @@ struct LobbyMemberInfo {
     bool isOwner;
 };
 
+template <> struct PacketSchema<LobbyMemberInfo> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&LobbyMemberInfo::accountId),
+        schemaField(&LobbyMemberInfo::username),
+        schemaField(&LobbyMemberInfo::isReady),
+        schemaField(&LobbyMemberInfo::isOwner));
+};
+
 struct LobbyUpdate {
     uint64_t lobbyId;
     uint8_t memberCount;
@@ -162,14 +282,34 @@ struct LobbyUpdate {
     bool inQueue;
 };
 
+template <> struct PacketSchema<LobbyUpdate> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&LobbyUpdate::lobbyId),
+        schemaArray(&LobbyUpdate::members, &LobbyUpdate::memberCount),
+        schemaField(&LobbyUpdate::inQueue));
+};
+
 struct LobbyKick {
     uint64_t targetAccountId;
 };
 
+template <> struct PacketSchema<LobbyKick> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&LobbyKick::targetAccountId));
+};
+
 struct LobbyReady {
     bool ready;
 };
 
+template <> struct PacketSchema<LobbyReady> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&LobbyReady::ready));
+};
+
 // ============================================================================
 // FRIEND PACKETS
 // ============================================================================
@@ -178,14 +318,32 @@ struct FriendRequest {
     char targetUsername[32];
 };
 
+template <> struct PacketSchema<FriendRequest> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&FriendRequest::targetUsername));
+};
+
 struct FriendAccept {
     uint64_t friendAccountId;
 };
 
+template <> struct PacketSchema<FriendAccept> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&FriendAccept::friendAccountId));
+};
+
 struct FriendRemove {
     uint64_t friendAccountId;
 };
 
+template <> struct PacketSchema<FriendRemove> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&FriendRemove::friendAccountId));
+};
+
 struct FriendInfo {
     uint64_t accountId;
     char username[32];
@@ -193,22 +351,52 @@ struct FriendInfo {
     uint64_t lobbyId;       // 0 if not in lobby
 };
 
+template <> struct PacketSchema<FriendInfo> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&FriendInfo::accountId),
+        schemaField(&FriendInfo::username),
+        schemaField(&FriendInfo::isOnline),
+        schemaField(&FriendInfo::lobbyId));
+};
+
 struct FriendListResponse {
     uint8_t friendCount;
     FriendInfo friends[100];  // Max 100 friends
 };
 
+template <> struct PacketSchema<FriendListResponse> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaArray(&FriendListResponse::friends, &FriendListResponse::friendCount));
+};
+
 struct FriendStatusUpdate {
     uint64_t accountId;
     bool isOnline;
     uint64_t lobbyId;
 };
 
+template <> struct PacketSchema<FriendStatusUpdate> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&FriendStatusUpdate::accountId),
+        schemaField(&FriendStatusUpdate::isOnline),
+        schemaField(&FriendStatusUpdate::lobbyId));
+};
+
 struct FriendInviteLobby {
     uint64_t friendAccountId;
     uint64_t lobbyId;
 };
 
+template <> struct PacketSchema<FriendInviteLobby> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&FriendInviteLobby::friendAccountId),
+        schemaField(&FriendInviteLobby::lobbyId));
+};
+
 // ============================================================================
 // MATCH PACKETS
 // ============================================================================
@@ -218,6 +406,13 @@ struct MatchFound {
     char mapName[64];
 };
 
+template <> struct PacketSchema<MatchFound> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&MatchFound::matchId),
+        schemaField(&MatchFound::mapName));
+};
+
 struct SpawnInfo {
     float spawnX;
     float spawnY;
@@ -227,12 +422,32 @@ struct SpawnInfo {
     uint64_t playerIds[5];  // All players in this match
 };
 
+template <> struct PacketSchema<SpawnInfo> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&SpawnInfo::spawnX),
+        schemaField(&SpawnInfo::spawnY),
+        schemaField(&SpawnInfo::spawnZ),
+        schemaField(&SpawnInfo::spawnYaw),
+        schemaArray(&SpawnInfo::playerIds, &SpawnInfo::playerCount));
+};
+
 struct PlayerSpawn {
     uint64_t accountId;
     float x, y, z;
     float yaw;
 };
 
+template <> struct PacketSchema<PlayerSpawn> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&PlayerSpawn::accountId),
+        schemaField(&PlayerSpawn::x),
+        schemaField(&PlayerSpawn::y),
+        schemaField(&PlayerSpawn::z),
+        schemaField(&PlayerSpawn::yaw));
+};
+
 struct ExtractionComplete {
     bool extracted;         // true = extracted, false = died
     uint32_t roubles;       // Money gained/lost
@@ -240,47 +455,197 @@ struct ExtractionComplete {
     // Items follow in separate packets
 };
 
+template <> struct PacketSchema<ExtractionComplete> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&ExtractionComplete::extracted),
+        schemaField(&ExtractionComplete::roubles),
+        schemaField(&ExtractionComplete::itemCount));
+};
+
+// Newest WORLD_SNAPSHOT the client has decoded; the server encodes later
+// snapshots against it
+struct SnapshotAck {
+    uint32_t sequence;
+};
+
+template <> struct PacketSchema<SnapshotAck> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&SnapshotAck::sequence));
+};
+
 // ============================================================================
 // GAMEPLAY PACKETS
 // ============================================================================
 
+// Movement and shots are bit-packed (see Serialization.h). Positions are
+// kept to 1 cm within the playable map: +-200 m horizontally, -40..120 m up.
+constexpr float MAP_EXTENT = 200.0f;
+constexpr float MAP_MIN_HEIGHT = -40.0f;
+constexpr float MAP_MAX_HEIGHT = 120.0f;
+constexpr float POSITION_PRECISION = 0.01f;
+
 struct PlayerMove {
     float x, y, z;
     float yaw, pitch;
     uint8_t movementFlags;  // Bitfield: walking, sprinting, crouching
 };
 
+// 71 bits: 9 bytes
+template <> struct PacketSchema<PlayerMove> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr bool BIT_PACKED = true;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaQuantized(&PlayerMove::x, -MAP_EXTENT, MAP_EXTENT, POSITION_PRECISION),          // 16 bits
+        schemaQuantized(&PlayerMove::y, MAP_MIN_HEIGHT, MAP_MAX_HEIGHT, POSITION_PRECISION),   // 14 bits
+        schemaQuantized(&PlayerMove::z, -MAP_EXTENT, MAP_EXTENT, POSITION_PRECISION),          // 16 bits
+        schemaAngle(&PlayerMove::yaw, 11),                                                     // 0.18 deg
+        schemaQuantized(&PlayerMove::pitch, -90.0f, 90.0f, 0.36f),                             // 9 bits
+        schemaBits(&PlayerMove::movementFlags, 3));
+};
+
+// Movement keys held during one input step
+enum MoveButton : uint8_t {
+    MOVE_FORWARD = 1 << 0,
+    MOVE_BACK = 1 << 1,
+    MOVE_LEFT = 1 << 2,
+    MOVE_RIGHT = 1 << 3
+};
+
+// One fixed-length step of player input (PlayerMovement.h). Angles are in
+// 1/65536 of a turn, as in world snapshots, so both sides simulate exactly
+// the values that went on the wire.
+struct MoveCommand {
+    uint8_t buttons;        // MoveButton bits
+    uint16_t yaw;
+    uint16_t pitch;
+};
+
+template <> struct PacketSchema<MoveCommand> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&MoveCommand::buttons),
+        schemaField(&MoveCommand::yaw),
+        schemaField(&MoveCommand::pitch));
+};
+
+// Half a second of commands at the movement tick rate
+constexpr size_t MAX_INPUT_COMMANDS = 32;
+
+// The newest commands the server has not acknowledged, oldest first:
+// commands[i] has sequence firstSequence + i. Every packet repeats the
+// unacknowledged ones, so a lost datagram is covered by the next.
+struct PlayerInput {
+    uint32_t firstSequence;
+    uint8_t commandCount;
+    MoveCommand commands[MAX_INPUT_COMMANDS];
+};
+
+template <> struct PacketSchema<PlayerInput> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&PlayerInput::firstSequence),
+        schemaArray(&PlayerInput::commands, &PlayerInput::commandCount));
+};
+
+// Where the server's simulation has the player after the last command it
+// applied. Height is not simulated (the terrain is client-side).
+struct PlayerState {
+    uint32_t inputSequence;     // 0 = no command applied yet
+    float x, z;
+};
+
+// 66 bits: 9 bytes
+template <> struct PacketSchema<PlayerState> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr bool BIT_PACKED = true;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaBits(&PlayerState::inputSequence, 32),
+        schemaQuantized(&PlayerState::x, -MAP_EXTENT, MAP_EXTENT, POSITION_PRECISION),
+        schemaQuantized(&PlayerState::z, -MAP_EXTENT, MAP_EXTENT, POSITION_PRECISION));
+};
+
 struct PlayerShoot {
     float originX, originY, originZ;
-    float dirX, dirY, dirZ;
+    float dirX, dirY, dirZ;     // Unit vector
     uint32_t weaponId;
 };
 
+// 81 bits + weaponId varint: 12 bytes for ids below 128
+template <> struct PacketSchema<PlayerShoot> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr bool BIT_PACKED = true;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaQuantized(&PlayerShoot::originX, -MAP_EXTENT, MAP_EXTENT, POSITION_PRECISION),
+        schemaQuantized(&PlayerShoot::originY, MAP_MIN_HEIGHT, MAP_MAX_HEIGHT, POSITION_PRECISION),
+        schemaQuantized(&PlayerShoot::originZ, -MAP_EXTENT, MAP_EXTENT, POSITION_PRECISION),
+        schemaQuantized(&PlayerShoot::dirX, -1.0f, 1.0f, 0.001f),                              // 11 bits
+        schemaQuantized(&PlayerShoot::dirY, -1.0f, 1.0f, 0.001f),
+        schemaQuantized(&PlayerShoot::dirZ, -1.0f, 1.0f, 0.001f),
+        schemaBitVarint(&PlayerShoot::weaponId));
+};
+
 struct PlayerDamage {
     uint64_t targetAccountId;
     float damage;
     uint32_t weaponId;
 };
 
+template <> struct PacketSchema<PlayerDamage> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&PlayerDamage::targetAccountId),
+        schemaField(&PlayerDamage::damage),
+        schemaField(&PlayerDamage::weaponId));
+};
+
 struct PlayerDeath {
     uint64_t victimAccountId;
     uint64_t killerAccountId;
 };
 
+template <> struct PacketSchema<PlayerDeath> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&PlayerDeath::victimAccountId),
+        schemaField(&PlayerDeath::killerAccountId));
+};
+
 struct PlayerLoot {
     uint64_t lootEntityId;  // Item on ground or corpse
     uint32_t itemId;
 };
 
+template <> struct PacketSchema<PlayerLoot> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&PlayerLoot::lootEntityId),
+        schemaField(&PlayerLoot::itemId));
+};
+
 struct PlayerReload {
     uint32_t weaponId;
 };
 
+template <> struct PacketSchema<PlayerReload> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&PlayerReload::weaponId));
+};
+
 struct PlayerUseItem {
     uint32_t itemId;
     uint8_t slotIndex;      // Inventory slot
 };
 
+template <> struct PacketSchema<PlayerUseItem> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&PlayerUseItem::itemId),
+        schemaField(&PlayerUseItem::slotIndex));
+};
+
 // ============================================================================
 // MERCHANT PACKETS
 // ============================================================================
@@ -292,36 +657,90 @@ struct MerchantItem {
     uint16_t stock;         // 0 = unlimited
 };
 
+template <> struct PacketSchema<MerchantItem> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&MerchantItem::itemId),
+        schemaField(&MerchantItem::itemName),
+        schemaField(&MerchantItem::price),
+        schemaField(&MerchantItem::stock));
+};
+
 struct MerchantListResponse {
     uint8_t merchantId;     // 0=Fence, 1=Prapor, etc.
     uint16_t itemCount;
     MerchantItem items[200]; // Max 200 items per merchant
 };
 
+template <> struct PacketSchema<MerchantListResponse> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&MerchantListResponse::merchantId),
+        schemaArray(&MerchantListResponse::items, &MerchantListResponse::itemCount));
+};
+
 struct MerchantBuy {
     uint8_t merchantId;
     uint32_t itemId;
     uint16_t quantity;
 };
 
+template <> struct PacketSchema<MerchantBuy> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&MerchantBuy::merchantId),
+        schemaField(&MerchantBuy::itemId),
+        schemaField(&MerchantBuy::quantity));
+};
+
 struct MerchantSell {
     uint8_t merchantId;
     uint32_t itemId;
     uint16_t quantity;
 };
 
+template <> struct PacketSchema<MerchantSell> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&MerchantSell::merchantId),
+        schemaField(&MerchantSell::itemId),
+        schemaField(&MerchantSell::quantity));
+};
+
 struct MerchantTransactionResponse {
     bool success;
     uint32_t newBalance;    // Updated roubles
     char errorMessage[256];
 };
 
+template <> struct PacketSchema<MerchantTransactionResponse> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&MerchantTransactionResponse::success),
+        schemaField(&MerchantTransactionResponse::newBalance),
+        schemaField(&MerchantTransactionResponse::errorMessage));
+};
+
 // ============================================================================
 // PLAYER DATA PACKETS
 // ============================================================================
 
 // PlayerStats is defined in DataStructures.h
 
+template <> struct PacketSchema<PlayerStats> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&PlayerStats::level),
+        schemaField(&PlayerStats::experience),
+        schemaField(&PlayerStats::roubles),
+        schemaField(&PlayerStats::raidsCompleted),
+        schemaField(&PlayerStats::raidsExtracted),
+        schemaField(&PlayerStats::raidsDied),
+        schemaField(&PlayerStats::kills),
+        schemaField(&PlayerStats::deaths),
+        schemaField(&PlayerStats::survivalRate));
+};
+
 struct ItemData {
     uint32_t itemId;
     char itemName[64];
@@ -331,6 +750,17 @@ struct ItemData {
     uint16_t durability;
 };
 
+template <> struct PacketSchema<ItemData> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&ItemData::itemId),
+        schemaField(&ItemData::itemName),
+        schemaField(&ItemData::stackSize),
+        schemaField(&ItemData::foundInRaid),
+        schemaField(&ItemData::currentAmmo),
+        schemaField(&ItemData::durability));
+};
+
 struct PlayerDataResponse {
     uint64_t accountId;
     char username[32];
@@ -339,11 +769,26 @@ struct PlayerDataResponse {
     // Items follow in separate packets
 };
 
+template <> struct PacketSchema<PlayerDataResponse> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&PlayerDataResponse::accountId),
+        schemaField(&PlayerDataResponse::username),
+        schemaField(&PlayerDataResponse::stats),
+        schemaField(&PlayerDataResponse::stashItemCount));
+};
+
 struct StashUpdate {
     uint16_t itemCount;
     // Items follow
 };
 
+template <> struct PacketSchema<StashUpdate> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&StashUpdate::itemCount));
+};
+
 struct LoadoutUpdate {
     uint32_t primaryWeaponId;
     uint32_t secondaryWeaponId;
@@ -352,6 +797,33 @@ struct LoadoutUpdate {
     uint32_t backpackId;
 };
 
+template <> struct PacketSchema<LoadoutUpdate> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&LoadoutUpdate::primaryWeaponId),
+        schemaField(&LoadoutUpdate::secondaryWeaponId),
+        schemaField(&LoadoutUpdate::armorId),
+        schemaField(&LoadoutUpdate::helmetId),
+        schemaField(&LoadoutUpdate::backpackId));
+};
+
+// ============================================================================
+// CONNECTION PACKETS
+// ============================================================================
+
+// The server sends a HEARTBEAT carrying a probe about once a second; clients
+// echo the payload back unchanged as soon as they read it, and the server
+// takes the round trip from the echo. Opaque to clients.
+struct HeartbeatProbe {
+    uint64_t sentNanos;     // Server clock
+};
+
+template <> struct PacketSchema<HeartbeatProbe> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaFixed(&HeartbeatProbe::sentNanos));
+};
+
 // ============================================================================
 // ERROR PACKETS
 // ============================================================================
@@ -361,6 +833,13 @@ struct ErrorResponse {
     char errorMessage[256];
 };
 
+template <> struct PacketSchema<ErrorResponse> {
+    static constexpr uint8_t VERSION = 1;
+    static constexpr auto FIELDS = std::make_tuple(
+        schemaField(&ErrorResponse::errorCode),
+        schemaField(&ErrorResponse::errorMessage));
+};
+
 // ============================================================================
 // UTILITY FUNCTIONS
 // ============================================================================
@@ -376,6 +855,8 @@ inline const char* packetTypeToString(PacketType type) {
         case PacketType::FRIEND_REQUEST: return "FRIEND_REQUEST";
         case PacketType::MATCH_START: return "MATCH_START";
         case PacketType::PLAYER_MOVE: return "PLAYER_MOVE";
+        case PacketType::PLAYER_INPUT: return "PLAYER_INPUT";
+        case PacketType::PLAYER_STATE: return "PLAYER_STATE";
         case PacketType::MERCHANT_BUY: return "MERCHANT_BUY";
         case PacketType::MERCHANT_SELL: return "MERCHANT_SELL";
         case PacketType::ERROR_RESPONSE: return "ERROR_RESPONSE";
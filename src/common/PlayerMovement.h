@@ -0,0 +1,56 @@
+#pragma once
+#include "NetworkProtocol.h"
+#include "WorldSnapshot.h"
+#include <cmath>
+#include <cstdint>
+
+// ============================================================================
+// PLAYER MOVEMENT
+// The movement simulation both sides run. The client samples its input once
+// per step into a MoveCommand, applies it locally at once (prediction) and
+// sends it with a sequence number in PLAYER_INPUT. The server applies the
+// same commands to its authoritative copy, at most one per simulation tick,
+// and answers with PLAYER_STATE: the position after the last one applied.
+// The client compares that with what it predicted for the same command and,
+// if they differ, restarts from the server's position and replays the
+// commands still in flight (reconciliation).
+//
+// Anything the step depends on must be in the command: the same command
+// from the same position gives the same position on both sides.
+// ============================================================================
+
+// One command per step; the server's simulation tick rate must match
+constexpr int MOVEMENT_TICK_RATE = 60;
+constexpr float MOVEMENT_STEP_SECONDS = 1.0f / MOVEMENT_TICK_RATE;
+
+// Metres per second
+constexpr float WALK_SPEED = 5.0f;
+
+// Horizontal position; height follows the terrain on the client
+struct MoveState {
+    float x = 0.0f;
+    float z = 0.0f;
+};
+
+inline void applyMoveCommand(MoveState& state, const MoveCommand& command) {
+    float forward = 0.0f;
+    float right = 0.0f;
+    if (command.buttons & MOVE_FORWARD) forward += 1.0f;
+    if (command.buttons & MOVE_BACK) forward -= 1.0f;
+    if (command.buttons & MOVE_RIGHT) right += 1.0f;
+    if (command.buttons & MOVE_LEFT) right -= 1.0f;
+    if (forward == 0.0f && right == 0.0f) return;
+
+    // Diagonals are no faster than straight lines
+    float length = std::sqrt(forward * forward + right * right);
+    float step = WALK_SPEED * MOVEMENT_STEP_SECONDS / length;
+
+    float radians = dequantizeAngle(command.yaw) * 3.14159265f / 180.0f;
+    float sinYaw = std::sin(radians);
+    float cosYaw = std::cos(radians);
+
+    state.x += (sinYaw * forward + cosYaw * right) * step;
+    state.z += (cosYaw * forward - sinYaw * right) * step;
+    state.x = std::fmin(std::fmax(state.x, -MAP_EXTENT), MAP_EXTENT);
+    state.z = std::fmin(std::fmax(state.z, -MAP_EXTENT), MAP_EXTENT);
+}
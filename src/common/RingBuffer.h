@@ -0,0 +1,108 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+
+// ============================================================================
+// RING BUFFER
+// Fixed-capacity byte ring used to frame TCP streams. Sockets recv() straight
+// into the free region and packets are parsed in place, so nothing is shifted
+// when a packet is consumed. Capacity is always a power of two so positions
+// wrap with a mask; readPos/writePos run freely and only their difference
+// matters.
+// ============================================================================
+
+class RingBuffer {
+public:
+    explicit RingBuffer(size_t minCapacity = 32768)
+        : capacity(roundUpPow2(minCapacity)), mask(capacity - 1),
+          storage(new uint8_t[capacity]), readPos(0), writePos(0) {}
+
+    RingBuffer(RingBuffer&&) = default;
+    RingBuffer& operator=(RingBuffer&&) = default;
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    size_t getCapacity() const { return capacity; }
+    size_t size() const { return writePos - readPos; }
+    size_t freeSpace() const { return capacity - size(); }
+    bool empty() const { return readPos == writePos; }
+
+    // Contiguous writable region at the tail. At the wrap point this is
+    // shorter than freeSpace(); write it, commit, then ask again.
+    uint8_t* writeRegion(size_t& outLength) {
+        size_t tail = writePos & mask;
+        size_t untilWrap = capacity - tail;
+        size_t available = freeSpace();
+        outLength = available < untilWrap ? available : untilWrap;
+        return storage.get() + tail;
+    }
+
+    void commitWrite(size_t length) {
+        writePos += length;
+    }
+
+    // Append bytes (copying), handling the wrap. Returns false if they don't fit.
+    bool write(const void* data, size_t length) {
+        if (length > freeSpace()) return false;
+        const uint8_t* src = static_cast<const uint8_t*>(data);
+        while (length > 0) {
+            size_t chunk;
+            uint8_t* dst = writeRegion(chunk);
+            if (chunk > length) chunk = length;
+            memcpy(dst, src, chunk);
+            commitWrite(chunk);
+            src += chunk;
+            length -= chunk;
+        }
+        return true;
+    }
+
+    // Contiguous readable region starting `offset` bytes past the head
+    const uint8_t* readRegion(size_t offset, size_t& outLength) const {
+        size_t head = (readPos + offset) & mask;
+        size_t untilWrap = capacity - head;
+        size_t available = size() - offset;
+        outLength = available < untilWrap ? available : untilWrap;
+        return storage.get() + head;
+    }
+
+    // Copy `length` bytes starting `offset` past the head, across the wrap if needed.
+    // Caller guarantees offset + length <= size().
+    void peek(size_t offset, void* dst, size_t length) const {
+        size_t head = (readPos + offset) & mask;
+        size_t first = capacity - head;
+        if (first > length) first = length;
+        memcpy(dst, storage.get() + head, first);
+        if (first < length) {
+            memcpy(static_cast<uint8_t*>(dst) + first, storage.get(), length - first);
+        }
+    }
+
+    // Drop `length` bytes from the head
+    void consume(size_t length) {
+        readPos += length;
+        if (readPos == writePos) {
+            // Re-align an empty ring so the next recv gets the full contiguous span
+            readPos = writePos = 0;
+        }
+    }
+
+    void clear() {
+        readPos = writePos = 0;
+    }
+
+private:
+    size_t capacity;
+    size_t mask;
+    std::unique_ptr<uint8_t[]> storage;
+    size_t readPos;
+    size_t writePos;
+
+    static size_t roundUpPow2(size_t value) {
+        size_t result = 1;
+        while (result < value) result <<= 1;
+        return result;
+    }
+};
@@ -0,0 +1,478 @@
+#pragma once
+#include "BitStream.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+// ============================================================================
+// BINARY SERIALIZATION
+// Schema-driven wire encoding for the protocol structs. Each struct lists its
+// fields once in a PacketSchema specialization next to its definition, and
+// encodePacket/decodePacket walk that list at compile time. Compared to
+// sending the raw struct:
+//   - unsigned integers are varints, signed ones zigzag varints; values that
+//     are random bits (session tokens) can be marked fixed-width instead
+//   - char arrays are length-prefixed strings, so an empty errorMessage[256]
+//     costs one byte
+//   - fixed arrays are count-prefixed and only the used entries are sent
+//   - everything is little-endian regardless of host layout or padding
+//
+// Every message starts with its schema's VERSION byte. A field added later
+// names the version it appeared in; decoding an older message leaves such
+// fields at their defaults, and trailing fields from a newer message are
+// ignored. Element structs inside arrays are versioned with the message that
+// carries them.
+//
+// High-rate gameplay messages can instead set BIT_PACKED and list bit fields
+// (schemaQuantized and friends): the whole message is then one bitstream
+// (BitStream.h) with floats quantized to a declared range and precision, and
+// the VERSION takes 2 bits instead of a byte.
+// ============================================================================
+
+// Little-endian writer into a caller-provided buffer. Writes past the end
+// are dropped and only counted, so encoding needs no checks until the end:
+// overflowed() tells whether the message fit.
+class ByteWriter {
+public:
+    ByteWriter(uint8_t* data, size_t capacity) : data(data), capacity(capacity), position(0) {}
+
+    void writeU8(uint8_t value) {
+        if (position < capacity) data[position] = value;
+        position++;
+    }
+
+    void writeFixed(uint64_t value, size_t bytes) {
+        for (size_t i = 0; i < bytes; i++) {
+            writeU8(static_cast<uint8_t>(value >> (i * 8)));
+        }
+    }
+
+    void writeVarint(uint64_t value) {
+        while (value >= 0x80) {
+            writeU8(static_cast<uint8_t>(value) | 0x80);
+            value >>= 7;
+        }
+        writeU8(static_cast<uint8_t>(value));
+    }
+
+    void writeFloat(float value) {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        writeFixed(bits, sizeof(bits));
+    }
+
+    void writeBytes(const void* bytes, size_t size) {
+        if (size <= capacity && position <= capacity - size) {
+            memcpy(data + position, bytes, size);
+        }
+        position += size;
+    }
+
+    size_t size() const { return position; }
+    bool overflowed() const { return position > capacity; }
+
+private:
+    uint8_t* data;
+    size_t capacity;
+    size_t position;
+};
+
+// Bounds-checked little-endian reader. Every read fails instead of running
+// past the end, so a truncated or hostile payload cannot overread.
+class ByteReader {
+public:
+    ByteReader(const uint8_t* data, size_t size) : data(data), size(size), position(0) {}
+
+    bool readU8(uint8_t& out) {
+        if (position >= size) return false;
+        out = data[position++];
+        return true;
+    }
+
+    bool readFixed(uint64_t& out, size_t bytes) {
+        if (size - position < bytes) return false;
+        out = 0;
+        for (size_t i = 0; i < bytes; i++) {
+            out |= static_cast<uint64_t>(data[position + i]) << (i * 8);
+        }
+        position += bytes;
+        return true;
+    }
+
+    bool readVarint(uint64_t& out) {
+        out = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (position >= size) return false;
+            uint8_t byte = data[position++];
+            out |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) return true;
+        }
+        return false;   // More than 10 bytes: not a valid varint
+    }
+
+    bool readFloat(float& out) {
+        uint64_t bits;
+        if (!readFixed(bits, sizeof(uint32_t))) return false;
+        uint32_t bits32 = static_cast<uint32_t>(bits);
+        memcpy(&out, &bits32, sizeof(out));
+        return true;
+    }
+
+    bool readBytes(void* out, size_t count) {
+        if (size - position < count) return false;
+        memcpy(out, data + position, count);
+        position += count;
+        return true;
+    }
+
+    size_t remaining() const { return size - position; }
+
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t position;
+};
+
+// ============================================================================
+// SCHEMAS
+// ============================================================================
+
+// Specialize for every struct that goes on the wire:
+//   template <> struct PacketSchema<LoginResponse> {
+//       static constexpr uint8_t VERSION = 1;
+//       static constexpr auto FIELDS = std::make_tuple(
+//           schemaField(&LoginResponse::success),
+//           schemaFixed(&LoginResponse::sessionToken),
+//           schemaField(&LoginResponse::errorMessage));
+//   };
+// Fields are encoded in list order; only ever append to a list, and give
+// appended fields the VERSION they were introduced in.
+template <typename T>
+struct PacketSchema;
+
+enum class IntEncoding : uint8_t {
+    VARINT,
+    FIXED
+};
+
+template <typename Struct, typename Member>
+struct SchemaField {
+    Member Struct::* member;
+    uint8_t since;
+    IntEncoding encoding;
+};
+
+// Array member with a separate count member. The count is written as part of
+// the array, so it is not listed as a field of its own.
+template <typename Struct, typename Element, size_t N, typename Count>
+struct SchemaArray {
+    Element (Struct::* member)[N];
+    Count Struct::* count;
+    uint8_t since;
+};
+
+template <typename Struct, typename Member>
+constexpr SchemaField<Struct, Member> schemaField(Member Struct::* member, uint8_t since = 1) {
+    return SchemaField<Struct, Member>{ member, since, IntEncoding::VARINT };
+}
+
+// Integer sent as its full width, for values that are random bits
+template <typename Struct, typename Member>
+constexpr SchemaField<Struct, Member> schemaFixed(Member Struct::* member, uint8_t since = 1) {
+    static_assert(std::is_integral<Member>::value, "schemaFixed needs an integer member");
+    return SchemaField<Struct, Member>{ member, since, IntEncoding::FIXED };
+}
+
+template <typename Struct, typename Element, size_t N, typename Count>
+constexpr SchemaArray<Struct, Element, N, Count> schemaArray(Element (Struct::* member)[N], Count Struct::* count, uint8_t since = 1) {
+    return SchemaArray<Struct, Element, N, Count>{ member, count, since };
+}
+
+// Bit-packed field encodings (BIT_PACKED schemas only)
+enum class BitEncoding : uint8_t {
+    QUANTIZED,      // Float in [min, max] at `precision`
+    ANGLE,          // Float degrees, wrapping, `bits` per turn
+    UNSIGNED,       // Integer in `bits` bits
+    VARINT          // Integer in 8-bit groups
+};
+
+template <typename Struct, typename Member>
+struct SchemaBits {
+    Member Struct::* member;
+    BitEncoding encoding;
+    float min, max, precision;
+    uint8_t bits;
+    uint8_t since;
+};
+
+template <typename Struct>
+constexpr SchemaBits<Struct, float> schemaQuantized(float Struct::* member, float min, float max, float precision, uint8_t since = 1) {
+    return SchemaBits<Struct, float>{ member, BitEncoding::QUANTIZED, min, max, precision, quantizedBits(min, max, precision), since };
+}
+
+// Out-of-range bits fail to compile in a constexpr schema (the throw is not a
+// constant expression)
+template <typename Struct>
+constexpr SchemaBits<Struct, float> schemaAngle(float Struct::* member, uint8_t bits, uint8_t since = 1) {
+    return bits >= 1 && bits <= MAX_QUANTIZED_BITS
+        ? SchemaBits<Struct, float>{ member, BitEncoding::ANGLE, 0.0f, 0.0f, 0.0f, bits, since }
+        : throw "schemaAngle needs 1 to MAX_QUANTIZED_BITS bits";
+}
+
+template <typename Struct, typename Member>
+constexpr SchemaBits<Struct, Member> schemaBits(Member Struct::* member, uint8_t bits, uint8_t since = 1) {
+    static_assert(std::is_unsigned<Member>::value, "schemaBits needs an unsigned member");
+    return SchemaBits<Struct, Member>{ member, BitEncoding::UNSIGNED, 0.0f, 0.0f, 0.0f, bits, since };
+}
+
+template <typename Struct, typename Member>
+constexpr SchemaBits<Struct, Member> schemaBitVarint(Member Struct::* member, uint8_t since = 1) {
+    static_assert(std::is_unsigned<Member>::value, "schemaBitVarint needs an unsigned member");
+    return SchemaBits<Struct, Member>{ member, BitEncoding::VARINT, 0.0f, 0.0f, 0.0f, 0, since };
+}
+
+namespace detail {
+    template <typename T>
+    struct IsCharArray : std::false_type {};
+
+    template <size_t N>
+    struct IsCharArray<char[N]> : std::true_type {};
+
+    inline uint64_t zigzagEncode(int64_t value) {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    inline int64_t zigzagDecode(uint64_t value) {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    template <typename T>
+    void encodeFields(ByteWriter& writer, const T& value);
+
+    template <typename T>
+    bool decodeFields(ByteReader& reader, T& value, uint8_t version);
+
+    template <typename T>
+    void encodeValue(ByteWriter& writer, const T& value, IntEncoding encoding) {
+        if constexpr (std::is_same<T, bool>::value) {
+            writer.writeU8(value ? 1 : 0);
+        } else if constexpr (std::is_enum<T>::value) {
+            encodeValue(writer, static_cast<typename std::underlying_type<T>::type>(value), encoding);
+        } else if constexpr (std::is_same<T, float>::value) {
+            writer.writeFloat(value);
+        } else if constexpr (std::is_integral<T>::value) {
+            if (sizeof(T) == 1) {
+                writer.writeU8(static_cast<uint8_t>(value));
+            } else if (encoding == IntEncoding::FIXED) {
+                writer.writeFixed(static_cast<uint64_t>(value), sizeof(T));
+            } else if (std::is_signed<T>::value) {
+                writer.writeVarint(zigzagEncode(static_cast<int64_t>(value)));
+            } else {
+                writer.writeVarint(static_cast<uint64_t>(value));
+            }
+        } else if constexpr (IsCharArray<T>::value) {
+            size_t length = strnlen(value, sizeof(T));
+            writer.writeVarint(length);
+            writer.writeBytes(value, length);
+        } else {
+            encodeFields(writer, value);
+        }
+    }
+
+    template <typename T>
+    bool decodeValue(ByteReader& reader, T& value, IntEncoding encoding, uint8_t version) {
+        if constexpr (std::is_same<T, bool>::value) {
+            uint8_t byte;
+            if (!reader.readU8(byte)) return false;
+            value = byte != 0;
+            return true;
+        } else if constexpr (std::is_enum<T>::value) {
+            typename std::underlying_type<T>::type raw;
+            if (!decodeValue(reader, raw, encoding, version)) return false;
+            value = static_cast<T>(raw);
+            return true;
+        } else if constexpr (std::is_same<T, float>::value) {
+            return reader.readFloat(value);
+        } else if constexpr (std::is_integral<T>::value) {
+            uint64_t raw;
+            if (sizeof(T) == 1) {
+                uint8_t byte;
+                if (!reader.readU8(byte)) return false;
+                raw = byte;
+            } else if (encoding == IntEncoding::FIXED) {
+                if (!reader.readFixed(raw, sizeof(T))) return false;
+            } else {
+                if (!reader.readVarint(raw)) return false;
+                if (std::is_signed<T>::value) {
+                    raw = static_cast<uint64_t>(zigzagDecode(raw));
+                }
+            }
+            value = static_cast<T>(raw);
+            return true;
+        } else if constexpr (IsCharArray<T>::value) {
+            uint64_t length;
+            if (!reader.readVarint(length) || length >= sizeof(T)) return false;
+            if (!reader.readBytes(value, static_cast<size_t>(length))) return false;
+            value[length] = '\0';
+            return true;
+        } else {
+            return decodeFields(reader, value, version);
+        }
+    }
+
+    // Default for a field the message predates
+    template <typename T>
+    void resetValue(T& value) {
+        if constexpr (IsCharArray<T>::value) {
+            value[0] = '\0';
+        } else {
+            value = T{};
+        }
+    }
+
+    template <typename S, typename M>
+    void encodeField(ByteWriter& writer, const S& value, const SchemaField<S, M>& field) {
+        encodeValue(writer, value.*field.member, field.encoding);
+    }
+
+    template <typename S, typename E, size_t N, typename C>
+    void encodeField(ByteWriter& writer, const S& value, const SchemaArray<S, E, N, C>& field) {
+        size_t count = std::min(static_cast<size_t>(value.*field.count), N);
+        writer.writeVarint(count);
+        const E* elements = value.*field.member;
+        for (size_t i = 0; i < count; i++) {
+            encodeValue(writer, elements[i], IntEncoding::VARINT);
+        }
+    }
+
+    template <typename S, typename M>
+    bool decodeField(ByteReader& reader, S& value, const SchemaField<S, M>& field, uint8_t version) {
+        if (field.since > version) {
+            resetValue(value.*field.member);
+            return true;
+        }
+        return decodeValue(reader, value.*field.member, field.encoding, version);
+    }
+
+    template <typename S, typename E, size_t N, typename C>
+    bool decodeField(ByteReader& reader, S& value, const SchemaArray<S, E, N, C>& field, uint8_t version) {
+        if (field.since > version) {
+            value.*field.count = C{};
+            return true;
+        }
+
+        uint64_t count;
+        if (!reader.readVarint(count) || count > N) return false;
+        value.*field.count = static_cast<C>(count);
+
+        E* elements = value.*field.member;
+        for (size_t i = 0; i < count; i++) {
+            if (!decodeValue(reader, elements[i], IntEncoding::VARINT, version)) return false;
+        }
+        return true;
+    }
+
+    template <typename T, typename = void>
+    struct IsBitPacked : std::false_type {};
+
+    template <typename T>
+    struct IsBitPacked<T, std::void_t<decltype(PacketSchema<T>::BIT_PACKED)>>
+        : std::integral_constant<bool, PacketSchema<T>::BIT_PACKED> {};
+
+    constexpr uint8_t BIT_VERSION_BITS = 2;
+
+    template <typename S, typename M>
+    void encodeBitField(BitWriter& writer, const S& value, const SchemaBits<S, M>& field) {
+        const M& member = value.*field.member;
+        if constexpr (std::is_same<M, float>::value) {
+            if (field.encoding == BitEncoding::ANGLE) writer.writeAngle(member, field.bits);
+            else writer.writeQuantized(member, field.min, field.max, field.precision);
+        } else {
+            if (field.encoding == BitEncoding::VARINT) writer.writeVarint(member);
+            else writer.writeBits(member, field.bits);
+        }
+    }
+
+    template <typename S, typename M>
+    bool decodeBitField(BitReader& reader, S& value, const SchemaBits<S, M>& field, uint8_t version) {
+        M& member = value.*field.member;
+        if (field.since > version) {
+            member = M{};
+            return true;
+        }
+        if constexpr (std::is_same<M, float>::value) {
+            if (field.encoding == BitEncoding::ANGLE) return reader.readAngle(member, field.bits);
+            return reader.readQuantized(member, field.min, field.max, field.precision);
+        } else {
+            uint64_t raw;
+            bool ok = field.encoding == BitEncoding::VARINT ? reader.readVarint(raw) : reader.readBits(raw, field.bits);
+            if (!ok) return false;
+            member = static_cast<M>(raw);
+            return true;
+        }
+    }
+
+    template <typename T>
+    void encodeFields(ByteWriter& writer, const T& value) {
+        std::apply([&](const auto&... fields) {
+            (encodeField(writer, value, fields), ...);
+        }, PacketSchema<T>::FIELDS);
+    }
+
+    template <typename T>
+    bool decodeFields(ByteReader& reader, T& value, uint8_t version) {
+        return std::apply([&](const auto&... fields) {
+            return (decodeField(reader, value, fields, version) && ...);
+        }, PacketSchema<T>::FIELDS);
+    }
+}
+
+// Encode a message into `buffer`. Returns the encoded size, or 0 if it does
+// not fit in `capacity` bytes.
+template <typename T>
+size_t encodePacket(const T& message, uint8_t* buffer, size_t capacity) {
+    if constexpr (detail::IsBitPacked<T>::value) {
+        static_assert(PacketSchema<T>::VERSION >= 1 && PacketSchema<T>::VERSION < (1 << detail::BIT_VERSION_BITS),
+                      "bit-packed VERSION must fit in 2 bits");
+        BitWriter writer(buffer, capacity);
+        writer.writeBits(PacketSchema<T>::VERSION, detail::BIT_VERSION_BITS);
+        std::apply([&](const auto&... fields) {
+            (detail::encodeBitField(writer, message, fields), ...);
+        }, PacketSchema<T>::FIELDS);
+        return writer.overflowed() ? 0 : writer.size();
+    } else {
+        ByteWriter writer(buffer, capacity);
+        writer.writeU8(PacketSchema<T>::VERSION);
+        detail::encodeFields(writer, message);
+        return writer.overflowed() ? 0 : writer.size();
+    }
+}
+
+// Decode a payload into `out`. Returns false for a truncated or malformed
+// payload, in which case `out` is partially written. Array entries past the
+// decoded count and string bytes past the terminator are left untouched.
+template <typename T>
+bool decodePacket(const uint8_t* data, size_t size, T& out) {
+    if constexpr (detail::IsBitPacked<T>::value) {
+        BitReader reader(data, size);
+        uint64_t version;
+        if (!reader.readBits(version, detail::BIT_VERSION_BITS) || version == 0) return false;
+        return std::apply([&](const auto&... fields) {
+            return (detail::decodeBitField(reader, out, fields, static_cast<uint8_t>(version)) && ...);
+        }, PacketSchema<T>::FIELDS);
+    } else {
+        ByteReader reader(data, size);
+        uint8_t version;
+        if (!reader.readU8(version) || version == 0) return false;
+        return detail::decodeFields(reader, out, version);
+    }
+}
+
+template <typename T>
+bool decodePacket(const std::vector<uint8_t>& payload, T& out) {
+    return decodePacket(payload.data(), payload.size(), out);
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. Each side keeps a cached copy of the other side's position and
+// only reloads it when the queue looks full (or empty), so a push or pop
+// normally touches no cache line the other thread writes. Capacity is
+// rounded up to a power of two; push() fails instead of blocking when full.
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t minCapacity)
+        : capacity(roundUpPow2(minCapacity < 2 ? 2 : minCapacity)), mask(capacity - 1),
+          slots(new T[capacity]), tailPos(0), cachedHead(0), headPos(0), cachedTail(0) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer thread only
+    bool push(T&& value) {
+        size_t tail = tailPos.load(std::memory_order_relaxed);
+        if (tail - cachedHead == capacity) {
+            cachedHead = headPos.load(std::memory_order_acquire);
+            if (tail - cachedHead == capacity) return false;   // Full
+        }
+        slots[tail & mask] = std::move(value);
+        tailPos.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only
+    bool pop(T& out) {
+        size_t head = headPos.load(std::memory_order_relaxed);
+        if (head == cachedTail) {
+            cachedTail = tailPos.load(std::memory_order_acquire);
+            if (head == cachedTail) return false;   // Empty
+        }
+        out = std::move(slots[head & mask]);
+        slots[head & mask] = T();   // Free the element's buffers now, not on reuse
+        headPos.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side: nothing to pop right now
+    bool empty() const {
+        return headPos.load(std::memory_order_relaxed) == tailPos.load(std::memory_order_acquire);
+    }
+
+    // Either side, approximate while the other one runs
+    size_t size() const {
+        return tailPos.load(std::memory_order_acquire) - headPos.load(std::memory_order_acquire);
+    }
+
+    size_t getCapacity() const { return capacity; }
+
+    // With both threads stopped
+    void clear() {
+        T discarded;
+        while (pop(discarded)) {}
+    }
+
+private:
+    size_t capacity;
+    size_t mask;
+    std::unique_ptr<T[]> slots;
+
+    // Producer and consumer state on separate cache lines
+    alignas(64) std::atomic<size_t> tailPos;
+    size_t cachedHead;
+    alignas(64) std::atomic<size_t> headPos;
+    size_t cachedTail;
+
+    static size_t roundUpPow2(size_t value) {
+        size_t result = 1;
+        while (result < value) result <<= 1;
+        return result;
+    }
+};
@@ -22,12 +22,11 @@ inline std::string simpleHash(const std::string& input) {
     return ss.str();
 }
 
-// Generate random session token
+// Generate random session token. Drawn straight from the OS entropy source:
+// a seeded engine would make every token predictable from one of them.
 inline uint64_t generateSessionToken() {
     static std::random_device rd;
-    static std::mt19937_64 gen(rd());
-    static std::uniform_int_distribution<uint64_t> dis;
-    return dis(gen);
+    return (static_cast<uint64_t>(rd()) << 32) | rd();
 }
 
 // Generate random unique ID
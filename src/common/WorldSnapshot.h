@@ -0,0 +1,290 @@
+#pragma once
+#include "Serialization.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+// ============================================================================
+// WORLD SNAPSHOTS
+// Raid state replicated from the server at the network tick rate: players,
+// AI enemies and which loot spawns have been collected. Every field is
+// quantized to 16 bits (positions to 1/32 m within +-1024 m, angles to
+// 1/65536 of a turn, health to whole points) and a snapshot is sent as a
+// delta against an older one the client has acknowledged:
+//   - entities whose quantized fields all match the baseline are omitted
+//   - changed entities send a dirty mask plus only the dirty fields, each as
+//     a zigzag varint of the 16-bit difference (a step of a few cm is 1 byte)
+//   - entities missing from the current snapshot are listed as removed
+//   - loot sends only the indices collected since the baseline
+// An unchanged raid therefore costs a few header bytes per snapshot however
+// many entities it holds. Baseline 0 means a full snapshot.
+//
+// Payload: version byte, sequence, baseline sequence, server tick, then the
+// player list, enemy list and loot list (all varints).
+// ============================================================================
+
+constexpr uint8_t SNAPSHOT_VERSION = 1;
+constexpr size_t MAX_SNAPSHOT_ENTITIES = 1024;      // Per list; decoding rejects more
+constexpr size_t SNAPSHOT_HISTORY = 32;             // Snapshots kept on each side for baselines
+
+// Quantization
+constexpr float SNAPSHOT_POSITION_RANGE = 1024.0f;  // Metres either side of the origin
+constexpr float SNAPSHOT_POSITION_SCALE = 32.0f;    // Steps per metre
+
+inline uint16_t quantizePosition(float value) {
+    float scaled = std::round((value + SNAPSHOT_POSITION_RANGE) * SNAPSHOT_POSITION_SCALE);
+    return static_cast<uint16_t>(std::min(std::max(scaled, 0.0f), 65535.0f));
+}
+
+inline float dequantizePosition(uint16_t value) {
+    return static_cast<float>(value) / SNAPSHOT_POSITION_SCALE - SNAPSHOT_POSITION_RANGE;
+}
+
+// Degrees, any range; wraps to one turn
+inline uint16_t quantizeAngle(float degrees) {
+    float turns = degrees / 360.0f;
+    turns -= std::floor(turns);
+    return static_cast<uint16_t>(static_cast<uint32_t>(std::lround(turns * 65536.0f)) & 0xFFFF);
+}
+
+inline float dequantizeAngle(uint16_t value) {
+    return static_cast<float>(value) * (360.0f / 65536.0f);
+}
+
+inline uint16_t quantizeHealth(float health) {
+    return static_cast<uint16_t>(std::min(std::max(std::round(health), 0.0f), 65535.0f));
+}
+
+// One replicated entity: an id plus N quantized fields
+template <size_t N>
+struct SnapshotEntity {
+    static constexpr size_t FIELD_COUNT = N;
+    static_assert(N <= 8, "dirty mask is one byte");
+
+    uint64_t id = 0;
+    uint16_t fields[N] = {};
+};
+
+// Player fields (id = accountId)
+enum SnapshotPlayerField : uint8_t {
+    PLAYER_X,
+    PLAYER_Y,
+    PLAYER_Z,
+    PLAYER_YAW,
+    PLAYER_PITCH,
+    PLAYER_HEALTH,
+    PLAYER_FLAGS,           // SNAPSHOT_FLAG_*
+    PLAYER_FIELD_COUNT
+};
+
+// Enemy fields (id = entityId)
+enum SnapshotEnemyField : uint8_t {
+    ENEMY_X,
+    ENEMY_Y,
+    ENEMY_Z,
+    ENEMY_YAW,
+    ENEMY_HEALTH,
+    ENEMY_FLAGS,            // SNAPSHOT_FLAG_* | AIType << 4
+    ENEMY_FIELD_COUNT
+};
+
+enum SnapshotFlags : uint16_t {
+    SNAPSHOT_FLAG_ALIVE     = 1 << 0,
+    SNAPSHOT_FLAG_EXTRACTED = 1 << 1,
+    SNAPSHOT_FLAG_AGGROED   = 1 << 2
+};
+
+using SnapshotPlayer = SnapshotEntity<PLAYER_FIELD_COUNT>;
+using SnapshotEnemy = SnapshotEntity<ENEMY_FIELD_COUNT>;
+
+// Decoded or captured world state. Entity lists and loot indices are sorted
+// ascending; the encoder relies on it.
+struct WorldSnapshot {
+    uint32_t sequence = 0;      // Starts at 1 for each recipient
+    uint32_t tick = 0;          // Server tick it was captured on
+    std::vector<SnapshotPlayer> players;
+    std::vector<SnapshotEnemy> enemies;
+    std::vector<uint32_t> collectedLoot;    // Indices into the match's loot spawns
+};
+
+namespace detail {
+    template <size_t N>
+    void encodeEntityDelta(ByteWriter& writer, const std::vector<SnapshotEntity<N>>& current,
+                           const std::vector<SnapshotEntity<N>>* baseline) {
+        static const std::vector<SnapshotEntity<N>> empty;
+        const std::vector<SnapshotEntity<N>>& base = baseline ? *baseline : empty;
+
+        // Changed or new entities, merged against the sorted baseline
+        struct Changed {
+            const SnapshotEntity<N>* entity;
+            const SnapshotEntity<N>* previous;
+            uint8_t mask;
+        };
+        std::vector<Changed> changed;
+        std::vector<uint64_t> removed;
+        size_t b = 0;
+        for (const auto& entity : current) {
+            while (b < base.size() && base[b].id < entity.id) {
+                removed.push_back(base[b++].id);
+            }
+
+            const SnapshotEntity<N>* previous = (b < base.size() && base[b].id == entity.id) ? &base[b++] : nullptr;
+            uint8_t mask = 0;
+            for (size_t f = 0; f < N; f++) {
+                uint16_t before = previous ? previous->fields[f] : 0;
+                if (!previous || entity.fields[f] != before) mask |= static_cast<uint8_t>(1u << f);
+            }
+            if (mask != 0) {
+                changed.push_back({ &entity, previous, mask });
+            }
+        }
+        while (b < base.size()) {
+            removed.push_back(base[b++].id);
+        }
+
+        // New entities are sent with every field dirty against zero, which is
+        // exactly how the decoder builds them
+        writer.writeVarint(changed.size());
+        uint64_t previousId = 0;
+        for (const Changed& entry : changed) {
+            writer.writeVarint(entry.entity->id - previousId);
+            previousId = entry.entity->id;
+            writer.writeU8(entry.mask);
+            for (size_t f = 0; f < N; f++) {
+                if (!(entry.mask & (1u << f))) continue;
+                uint16_t before = entry.previous ? entry.previous->fields[f] : 0;
+                int16_t difference = static_cast<int16_t>(static_cast<uint16_t>(entry.entity->fields[f] - before));
+                writer.writeVarint(zigzagEncode(difference));
+            }
+        }
+
+        writer.writeVarint(removed.size());
+        previousId = 0;
+        for (uint64_t id : removed) {
+            writer.writeVarint(id - previousId);
+            previousId = id;
+        }
+    }
+
+    template <size_t N>
+    bool decodeEntityDelta(ByteReader& reader, std::vector<SnapshotEntity<N>>& entities) {
+        uint64_t count;
+        if (!reader.readVarint(count) || count > MAX_SNAPSHOT_ENTITIES) return false;
+
+        uint64_t id = 0;
+        for (uint64_t i = 0; i < count; i++) {
+            uint64_t idDelta;
+            uint8_t mask;
+            if (!reader.readVarint(idDelta) || !reader.readU8(mask)) return false;
+            if (i > 0 && idDelta == 0) return false;
+            id += idDelta;
+
+            auto it = std::lower_bound(entities.begin(), entities.end(), id,
+                                       [](const SnapshotEntity<N>& e, uint64_t value) { return e.id < value; });
+            if (it == entities.end() || it->id != id) {
+                SnapshotEntity<N> entity;
+                entity.id = id;
+                it = entities.insert(it, entity);
+                if (entities.size() > MAX_SNAPSHOT_ENTITIES) return false;
+            }
+
+            for (size_t f = 0; f < N; f++) {
+                if (!(mask & (1u << f))) continue;
+                uint64_t encoded;
+                if (!reader.readVarint(encoded)) return false;
+                it->fields[f] = static_cast<uint16_t>(it->fields[f] + static_cast<uint16_t>(zigzagDecode(encoded)));
+            }
+        }
+
+        uint64_t removedCount;
+        if (!reader.readVarint(removedCount) || removedCount > MAX_SNAPSHOT_ENTITIES) return false;
+        id = 0;
+        for (uint64_t i = 0; i < removedCount; i++) {
+            uint64_t idDelta;
+            if (!reader.readVarint(idDelta)) return false;
+            id += idDelta;
+            auto it = std::lower_bound(entities.begin(), entities.end(), id,
+                                       [](const SnapshotEntity<N>& e, uint64_t value) { return e.id < value; });
+            if (it != entities.end() && it->id == id) entities.erase(it);
+        }
+        return true;
+    }
+}
+
+// Encode `current` as a delta against `baseline` (nullptr = full snapshot).
+// Returns the encoded size, or 0 if it does not fit in `capacity` bytes.
+inline size_t encodeSnapshot(const WorldSnapshot& current, const WorldSnapshot* baseline,
+                             uint8_t* buffer, size_t capacity) {
+    ByteWriter writer(buffer, capacity);
+    writer.writeU8(SNAPSHOT_VERSION);
+    writer.writeVarint(current.sequence);
+    writer.writeVarint(baseline ? baseline->sequence : 0);
+    writer.writeVarint(current.tick);
+
+    detail::encodeEntityDelta(writer, current.players, baseline ? &baseline->players : nullptr);
+    detail::encodeEntityDelta(writer, current.enemies, baseline ? &baseline->enemies : nullptr);
+
+    // Loot only ever goes from uncollected to collected
+    std::vector<uint32_t> collected;
+    if (baseline) {
+        std::set_difference(current.collectedLoot.begin(), current.collectedLoot.end(),
+                            baseline->collectedLoot.begin(), baseline->collectedLoot.end(),
+                            std::back_inserter(collected));
+    }
+    const std::vector<uint32_t>& loot = baseline ? collected : current.collectedLoot;
+    writer.writeVarint(loot.size());
+    uint32_t previous = 0;
+    for (uint32_t index : loot) {
+        writer.writeVarint(index - previous);
+        previous = index;
+    }
+
+    return writer.overflowed() ? 0 : writer.size();
+}
+
+// Baseline sequence a snapshot payload was encoded against (0 = full)
+inline bool peekSnapshotBaseline(const uint8_t* data, size_t size, uint32_t& outSequence, uint32_t& outBaseline) {
+    ByteReader reader(data, size);
+    uint8_t version;
+    uint64_t sequence, baseline;
+    if (!reader.readU8(version) || version != SNAPSHOT_VERSION) return false;
+    if (!reader.readVarint(sequence) || !reader.readVarint(baseline)) return false;
+    outSequence = static_cast<uint32_t>(sequence);
+    outBaseline = static_cast<uint32_t>(baseline);
+    return true;
+}
+
+// Decode a snapshot payload. `baseline` must be the snapshot named by
+// peekSnapshotBaseline (nullptr when that is 0).
+inline bool decodeSnapshot(const uint8_t* data, size_t size, const WorldSnapshot* baseline, WorldSnapshot& out) {
+    ByteReader reader(data, size);
+    uint8_t version;
+    uint64_t sequence, baselineSequence, tick;
+    if (!reader.readU8(version) || version != SNAPSHOT_VERSION) return false;
+    if (!reader.readVarint(sequence) || !reader.readVarint(baselineSequence) || !reader.readVarint(tick)) return false;
+    if ((baselineSequence != 0) != (baseline != nullptr)) return false;
+    if (baseline && baseline->sequence != baselineSequence) return false;
+
+    out = baseline ? *baseline : WorldSnapshot();
+    out.sequence = static_cast<uint32_t>(sequence);
+    out.tick = static_cast<uint32_t>(tick);
+
+    if (!detail::decodeEntityDelta(reader, out.players)) return false;
+    if (!detail::decodeEntityDelta(reader, out.enemies)) return false;
+
+    uint64_t lootCount;
+    if (!reader.readVarint(lootCount) || lootCount > MAX_SNAPSHOT_ENTITIES) return false;
+    uint64_t index = 0;
+    for (uint64_t i = 0; i < lootCount; i++) {
+        uint64_t delta;
+        if (!reader.readVarint(delta)) return false;
+        index += delta;
+        auto it = std::lower_bound(out.collectedLoot.begin(), out.collectedLoot.end(), static_cast<uint32_t>(index));
+        if (it == out.collectedLoot.end() || *it != index) {
+            out.collectedLoot.insert(it, static_cast<uint32_t>(index));
+        }
+    }
+    return true;
+}
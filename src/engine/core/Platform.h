@@ -47,3 +47,34 @@
 // Common types
 #include <cstdint>
 #include <cstddef>
+
+// POSIX sockets (Linux/Mac dedicated server builds)
+#ifndef _WIN32
+    #include <sys/types.h>
+    #include <sys/socket.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <arpa/inet.h>
+    #include <unistd.h>
+    #include <fcntl.h>
+    #include <cerrno>
+    #include <cstring>
+
+    // Winsock names so shared socket code compiles unchanged
+    typedef int SOCKET;
+    #define INVALID_SOCKET (-1)
+    #define SOCKET_ERROR   (-1)
+
+    inline int closesocket(SOCKET s) {
+        return close(s);
+    }
+
+    // MSVC secure CRT subset used by the server (always null-terminates)
+    template <size_t N>
+    inline int strncpy_s(char (&dest)[N], const char* src, size_t count) {
+        size_t len = strnlen(src, count < N - 1 ? count : N - 1);
+        memcpy(dest, src, len);
+        dest[len] = '\0';
+        return 0;
+    }
+#endif
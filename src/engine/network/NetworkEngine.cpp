@@ -0,0 +1,1057 @@
+#include "NetworkEngine.h"
+#include "../../common/Logger.h"
+#include "../../common/Compression.h"
+#include <algorithm>
+
+#ifndef _WIN32
+#include <netdb.h>
+#endif
+
+namespace {
+    LogCategory netLog("NetworkEngine", 200);
+
+    constexpr float CONNECT_RETRY_INTERVAL = 0.25f;
+    constexpr float MIN_RTO = 0.05f;
+    constexpr float MAX_RTO = 2.0f;
+    constexpr float MIN_CONGESTION_WINDOW = 4.0f;
+    constexpr float MAX_CONGESTION_WINDOW = 512.0f;
+    constexpr float QUEUEING_DELAY_FLOOR = 0.05f;       // RTT rise below this is not congestion
+    constexpr float REASSEMBLY_TIMEOUT = 1.0f;          // Unreliable fragments
+    constexpr size_t MAX_UNRELIABLE_REASSEMBLIES = 64;
+    constexpr uint32_t ORDERED_RECEIVE_WINDOW = 4096;   // Messages buffered ahead of delivery
+    constexpr float LOSS_SMOOTHING = 0.02f;             // EWMA weight of one packet outcome
+    constexpr uint32_t IMMEDIATE_ACK_THRESHOLD = 16;    // Ack before the 33-packet ack window slides past
+
+    int lastSocketError() {
+#ifdef PLATFORM_WINDOWS
+        return WSAGetLastError();
+#else
+        return errno;
+#endif
+    }
+
+    bool isWouldBlock(int error) {
+#ifdef PLATFORM_WINDOWS
+        return error == WSAEWOULDBLOCK;
+#else
+        return error == EWOULDBLOCK || error == EAGAIN;
+#endif
+    }
+
+    // Wrap-safe "a was sent after b"
+    bool sequenceGreater(uint32_t a, uint32_t b) {
+        return static_cast<int32_t>(a - b) > 0;
+    }
+
+    uint64_t fragmentKey(uint32_t messageId, uint16_t fragmentIndex) {
+        return (static_cast<uint64_t>(messageId) << 16) | fragmentIndex;
+    }
+}
+
+NetworkEngine::NetworkEngine()
+    : socket(INVALID_SOCKET), protocol(NetProtocol::RELIABLE_UDP), initialized(false),
+      serverMode(false), currentTime(0.0f), natType(NATType::UNKNOWN),
+      timeoutDuration(10.0f), keepAliveInterval(1.0f), lastKeepAlive(0.0f), maxRetransmits(10),
+      statsWindowTime(0.0f), statsWindowBytes(0),
+      simulatedPacketLoss(0.0f), simulatedLatency(0.0f), simulationRng(std::random_device{}()),
+      callback(nullptr), debugLogging(false) {
+    memset(&localAddress, 0, sizeof(localAddress));
+    memset(&publicAddress, 0, sizeof(publicAddress));
+}
+
+NetworkEngine::~NetworkEngine() {
+    shutdown();
+}
+
+// ============================================================================
+// Lifecycle
+// ============================================================================
+
+bool NetworkEngine::initialize(NetProtocol protocol) {
+    if (protocol == NetProtocol::TCP) {
+        LOG_ERROR(netLog, "TCP is not supported by NetworkEngine; use UDP or RELIABLE_UDP");
+        return false;
+    }
+
+#ifdef PLATFORM_WINDOWS
+    if (!initialized) {
+        WSADATA wsaData;
+        int result = WSAStartup(MAKEWORD(2, 2), &wsaData);
+        if (result != 0) {
+            LOG_ERROR(netLog, "WSAStartup failed: {}", result);
+            return false;
+        }
+    }
+#endif
+
+    this->protocol = protocol;
+    initialized = true;
+    return true;
+}
+
+void NetworkEngine::shutdown() {
+    if (!initialized) return;
+
+    if (serverMode) {
+        stopServer();
+    } else {
+        disconnect();
+    }
+    closeSocket();
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        sendQueue = std::queue<NetPacket>();
+        receiveQueue = std::queue<NetPacket>();
+    }
+
+#ifdef PLATFORM_WINDOWS
+    WSACleanup();
+#endif
+    initialized = false;
+}
+
+bool NetworkEngine::startServer(uint16_t port) {
+    if (!initialized) return false;
+
+    if (!createSocket()) return false;
+    setReuseAddress();
+    if (!bindSocket(port)) {
+        closeSocket();
+        return false;
+    }
+
+    serverMode = true;
+    LOG_INFO(netLog, "Listening on UDP port {}", getPort(localAddress));
+    return true;
+}
+
+void NetworkEngine::stopServer() {
+    disconnect();
+    closeSocket();
+    serverMode = false;
+}
+
+bool NetworkEngine::connect(const std::string& address, uint16_t port) {
+    if (!initialized) return false;
+
+    sockaddr_in serverAddr;
+    if (!stringToAddress(address, serverAddr)) {
+        LOG_ERROR(netLog, "Could not resolve {}", address);
+        return false;
+    }
+    serverAddr.sin_port = htons(port);
+
+    if (socket == INVALID_SOCKET) {
+        if (!createSocket() || !bindSocket(0)) {
+            closeSocket();
+            return false;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(peersMutex);
+    if (peers.find(addressToString(serverAddr)) != peers.end()) return true;
+
+    Peer* peer = createPeer(serverAddr, ConnectionState::CONNECTING);
+    transmitPacket(peer, NetChannel::UNRELIABLE, NET_FLAG_CONNECT, nullptr, 0);
+    LOG_INFO(netLog, "Connecting to {}", peer->id);
+    return true;
+}
+
+void NetworkEngine::disconnect() {
+    {
+        std::lock_guard<std::mutex> lock(peersMutex);
+        for (auto& entry : peers) {
+            Peer* peer = entry.second.get();
+            if (peer->state == ConnectionState::CONNECTED) {
+                // Best effort; the peer times out if this is lost
+                transmitPacket(peer, NetChannel::UNRELIABLE, NET_FLAG_DISCONNECT, nullptr, 0);
+                peerEvents.emplace_back(PeerEvent::DISCONNECTED, peer->id);
+            }
+        }
+        peers.clear();
+    }
+
+    // Delayed packets (latency simulation) still go out, the DISCONNECTs included
+    processOutgoingPackets();
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        while (!sendQueue.empty()) {
+            NetPacket& packet = sendQueue.front();
+            if (socket != INVALID_SOCKET) {
+                sendto(socket, (const char*)packet.data.data(), static_cast<int>(packet.data.size()), 0,
+                       (const sockaddr*)&packet.address, sizeof(packet.address));
+            }
+            sendQueue.pop();
+        }
+    }
+    dispatchEvents();
+}
+
+// ============================================================================
+// Public send / receive
+// ============================================================================
+
+bool NetworkEngine::send(const std::string& peerId, const void* data, size_t size, bool reliable) {
+    if (size == 0 || size > MAX_FRAGMENTS * MAX_FRAGMENT_SIZE) return false;
+
+    std::lock_guard<std::mutex> lock(peersMutex);
+    auto it = peers.find(peerId);
+    if (it == peers.end() || it->second->state != ConnectionState::CONNECTED) return false;
+
+    sendPacket(it->second.get(), data, size, reliable);
+    return true;
+}
+
+bool NetworkEngine::sendToAll(const void* data, size_t size, bool reliable) {
+    if (size == 0 || size > MAX_FRAGMENTS * MAX_FRAGMENT_SIZE) return false;
+
+    std::lock_guard<std::mutex> lock(peersMutex);
+    bool sent = false;
+    for (auto& entry : peers) {
+        if (entry.second->state != ConnectionState::CONNECTED) continue;
+        sendPacket(entry.second.get(), data, size, reliable);
+        sent = true;
+    }
+    return sent;
+}
+
+bool NetworkEngine::sendKeepAlive(const std::string& peerId) {
+    std::lock_guard<std::mutex> lock(peersMutex);
+    auto it = peers.find(peerId);
+    if (it == peers.end()) return false;
+
+    transmitPacket(it->second.get(), NetChannel::UNRELIABLE, NET_FLAG_KEEPALIVE, nullptr, 0);
+    return true;
+}
+
+void NetworkEngine::update(float deltaTime) {
+    currentTime += deltaTime;
+
+    pollMessages();
+
+    {
+        std::lock_guard<std::mutex> lock(peersMutex);
+
+        std::vector<std::string> failed;
+        for (auto& entry : peers) {
+            Peer* peer = entry.second.get();
+            if (!updateReliability(peer, deltaTime)) {
+                failed.push_back(peer->id);
+                continue;
+            }
+            updatePing(peer, deltaTime);
+        }
+        for (const std::string& peerId : failed) {
+            LOG_WARN(netLog, "Peer {} stopped acking reliable data", peerId);
+            peerEvents.emplace_back(PeerEvent::DISCONNECTED, peerId);
+            removePeer(peerId);
+        }
+
+        checkTimeouts(deltaTime);
+        updateStats(deltaTime);
+    }
+
+    processOutgoingPackets();
+    dispatchEvents();
+}
+
+void NetworkEngine::pollMessages() {
+    {
+        std::lock_guard<std::mutex> lock(peersMutex);
+        processIncomingPackets();
+    }
+    dispatchEvents();
+}
+
+void NetworkEngine::dispatchEvents() {
+    std::vector<std::pair<PeerEvent, std::string>> events;
+    std::queue<NetPacket> messages;
+    {
+        std::lock_guard<std::mutex> lock(peersMutex);
+        events.swap(peerEvents);
+    }
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        messages.swap(receiveQueue);
+    }
+
+    // Callbacks run without locks held so they can send
+    if (!callback) return;
+
+    for (const auto& event : events) {
+        switch (event.first) {
+            case PeerEvent::CONNECTED:
+                callback->onConnected(event.second);
+                break;
+            case PeerEvent::DISCONNECTED:
+                callback->onDisconnected(event.second);
+                break;
+            case PeerEvent::FAILED:
+                callback->onConnectionFailed("Connection to " + event.second + " timed out");
+                break;
+        }
+    }
+
+    while (!messages.empty()) {
+        const NetPacket& message = messages.front();
+        callback->onDataReceived(addressToString(message.address), message.data.data(), message.data.size());
+        messages.pop();
+    }
+}
+
+// ============================================================================
+// Peer management
+// ============================================================================
+
+Peer* NetworkEngine::getPeer(const std::string& peerId) {
+    std::lock_guard<std::mutex> lock(peersMutex);
+    auto it = peers.find(peerId);
+    return it != peers.end() ? it->second.get() : nullptr;
+}
+
+std::vector<Peer*> NetworkEngine::getAllPeers() {
+    std::lock_guard<std::mutex> lock(peersMutex);
+    std::vector<Peer*> result;
+    result.reserve(peers.size());
+    for (auto& entry : peers) {
+        result.push_back(entry.second.get());
+    }
+    return result;
+}
+
+Peer* NetworkEngine::createPeer(const sockaddr_in& address, ConnectionState state) {
+    auto peer = std::make_unique<Peer>();
+    peer->id = addressToString(address);
+    peer->address = address;
+    peer->state = state;
+    peer->connectStartTime = currentTime;
+    peer->lastReceiveTime = currentTime;
+    peer->lastSendTime = currentTime;
+    peer->sentPackets.resize(SENT_HISTORY);
+
+    Peer* raw = peer.get();
+    peers[raw->id] = std::move(peer);
+    return raw;
+}
+
+void NetworkEngine::removePeer(const std::string& peerId) {
+    peers.erase(peerId);
+}
+
+void NetworkEngine::resetStats() {
+    stats = NetworkStats();
+    statsWindowTime = 0.0f;
+    statsWindowBytes = 0;
+}
+
+// ============================================================================
+// Sockets
+// ============================================================================
+
+bool NetworkEngine::createSocket() {
+    socket = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (socket == INVALID_SOCKET) {
+        LOG_ERROR(netLog, "Failed to create UDP socket: {}", lastSocketError());
+        return false;
+    }
+    return setNonBlocking();
+}
+
+void NetworkEngine::closeSocket() {
+    if (socket != INVALID_SOCKET) {
+        closesocket(socket);
+        socket = INVALID_SOCKET;
+    }
+}
+
+bool NetworkEngine::bindSocket(uint16_t port) {
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = INADDR_ANY;
+    address.sin_port = htons(port);
+
+    if (bind(socket, (sockaddr*)&address, sizeof(address)) == SOCKET_ERROR) {
+        LOG_ERROR(netLog, "UDP bind to port {} failed: {}", port, lastSocketError());
+        return false;
+    }
+
+    socklen_t length = sizeof(localAddress);
+    getsockname(socket, (sockaddr*)&localAddress, &length);
+    return true;
+}
+
+bool NetworkEngine::setNonBlocking() {
+#ifdef PLATFORM_WINDOWS
+    u_long mode = 1;
+    return ioctlsocket(socket, FIONBIO, &mode) == 0;
+#else
+    int flags = fcntl(socket, F_GETFL, 0);
+    return flags != -1 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) != -1;
+#endif
+}
+
+bool NetworkEngine::setReuseAddress() {
+    int reuse = 1;
+    return setsockopt(socket, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse)) == 0;
+}
+
+// ============================================================================
+// Packet I/O
+// ============================================================================
+
+void NetworkEngine::processIncomingPackets() {
+    if (socket == INVALID_SOCKET) return;
+
+    uint8_t buffer[MTU + 1];    // One spare byte detects oversized datagrams
+    while (true) {
+        sockaddr_in from;
+        socklen_t fromLength = sizeof(from);
+        int received = static_cast<int>(recvfrom(socket, (char*)buffer, static_cast<int>(sizeof(buffer)), 0,
+                                                 (sockaddr*)&from, &fromLength));
+        if (received < 0) {
+            int error = lastSocketError();
+#ifdef PLATFORM_WINDOWS
+            // ICMP unreachable from a departed peer, or an oversized datagram
+            if (error == WSAECONNRESET || error == WSAEMSGSIZE) continue;
+#else
+            if (error == EINTR) continue;
+#endif
+            if (!isWouldBlock(error)) {
+                LOG_WARN(netLog, "UDP receive failed: {}", error);
+            }
+            return;
+        }
+
+        size_t length = static_cast<size_t>(received);
+        if (length < sizeof(PacketHeader) || length > MTU) continue;
+
+        stats.packetsReceived++;
+        stats.bytesReceived += length;
+
+        NetPacket packet;
+        packet.data.assign(buffer, buffer + length);
+        packet.address = from;
+        handlePacket(packet, from);
+    }
+}
+
+void NetworkEngine::processOutgoingPackets() {
+    if (socket == INVALID_SOCKET) return;
+
+    std::lock_guard<std::mutex> lock(queueMutex);
+    while (!sendQueue.empty() && sendQueue.front().timestamp <= currentTime) {
+        const NetPacket& packet = sendQueue.front();
+        sendto(socket, (const char*)packet.data.data(), static_cast<int>(packet.data.size()), 0,
+               (const sockaddr*)&packet.address, sizeof(packet.address));
+        sendQueue.pop();
+    }
+}
+
+void NetworkEngine::sendDatagram(const sockaddr_in& address, std::vector<uint8_t>&& datagram) {
+    if (socket == INVALID_SOCKET) return;
+
+    stats.packetsSent++;
+    stats.bytesSent += datagram.size();
+
+    if (simulatedPacketLoss > 0.0f) {
+        std::uniform_real_distribution<float> roll(0.0f, 100.0f);
+        if (roll(simulationRng) < simulatedPacketLoss) return;
+    }
+
+    if (simulatedLatency > 0.0f) {
+        // Constant delay keeps the queue in release order
+        NetPacket packet;
+        packet.data = std::move(datagram);
+        packet.address = address;
+        packet.timestamp = currentTime + simulatedLatency / 1000.0f;
+        std::lock_guard<std::mutex> lock(queueMutex);
+        sendQueue.push(std::move(packet));
+        return;
+    }
+
+    // Unreliable by design: a full socket buffer is the same as a lost packet
+    sendto(socket, (const char*)datagram.data(), static_cast<int>(datagram.size()), 0,
+           (const sockaddr*)&address, sizeof(address));
+}
+
+uint32_t NetworkEngine::transmitPacket(Peer* peer, NetChannel channel, uint8_t flags, const uint8_t* body, size_t bodySize) {
+    PacketHeader header;
+    header.sequenceNumber = peer->localSequence++;
+    header.ackNumber = peer->remoteSequence;
+    header.ackBits = peer->remoteAckBits;
+    header.size = static_cast<uint16_t>(bodySize);
+    header.protocol = static_cast<uint8_t>(channel);
+    header.flags = flags | (peer->hasRemoteSequence ? NET_FLAG_HAS_ACK : 0);
+
+    std::vector<uint8_t> datagram(sizeof(header) + bodySize);
+    memcpy(datagram.data(), &header, sizeof(header));
+    if (bodySize > 0) {
+        memcpy(datagram.data() + sizeof(header), body, bodySize);
+    }
+
+    // Pure acks are never acked back, so there is nothing to wait for
+    if (!(flags & NET_FLAG_ACK)) {
+        SentPacketRecord& record = peer->sentPackets[header.sequenceNumber % SENT_HISTORY];
+        if (record.pending && record.sequence != header.sequenceNumber) {
+            // Overwritten before an ack or a verdict: count it lost
+            onPacketLost(peer, record);
+        }
+        record.sequence = header.sequenceNumber;
+        record.sendTime = currentTime;
+        record.pending = true;
+        record.hasFragment = false;
+    }
+
+    peer->packetsToAck = 0;
+    peer->lastSendTime = currentTime;
+    sendDatagram(peer->address, std::move(datagram));
+    return header.sequenceNumber;
+}
+
+void NetworkEngine::sendPacket(Peer* peer, const void* data, size_t size, bool reliable) {
+    if (reliable && protocol == NetProtocol::RELIABLE_UDP) {
+        sendReliablePacket(peer, data, size);
+        return;
+    }
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    MessageHeader message;
+    message.messageId = peer->nextUnreliableMessageId++;
+    message.fragmentCount = static_cast<uint16_t>((size + MAX_FRAGMENT_SIZE - 1) / MAX_FRAGMENT_SIZE);
+
+    uint8_t body[sizeof(MessageHeader) + MAX_FRAGMENT_SIZE];
+    for (uint16_t i = 0; i < message.fragmentCount; i++) {
+        size_t offset = static_cast<size_t>(i) * MAX_FRAGMENT_SIZE;
+        size_t chunk = std::min(MAX_FRAGMENT_SIZE, size - offset);
+        message.fragmentIndex = i;
+        memcpy(body, &message, sizeof(message));
+        memcpy(body + sizeof(message), bytes + offset, chunk);
+        transmitPacket(peer, NetChannel::UNRELIABLE, NET_FLAG_DATA, body, sizeof(message) + chunk);
+    }
+}
+
+void NetworkEngine::handlePacket(const NetPacket& packet, const sockaddr_in& from) {
+    PacketHeader header;
+    memcpy(&header, packet.data.data(), sizeof(header));
+    if (sizeof(header) + header.size != packet.data.size()) return;
+
+    std::string peerId = addressToString(from);
+    auto it = peers.find(peerId);
+    Peer* peer = it != peers.end() ? it->second.get() : nullptr;
+
+    if (!peer) {
+        // Only servers take new peers, and only from a CONNECT
+        if (!serverMode || !(header.flags & NET_FLAG_CONNECT)) return;
+        peer = createPeer(from, ConnectionState::CONNECTED);
+        peerEvents.emplace_back(PeerEvent::CONNECTED, peer->id);
+        if (debugLogging) {
+            LOG_DEBUG(netLog, "Peer {} connected", peer->id);
+        }
+    }
+
+    peer->lastReceiveTime = currentTime;
+
+    if (header.flags & NET_FLAG_DISCONNECT) {
+        if (peer->state == ConnectionState::CONNECTED) {
+            peerEvents.emplace_back(PeerEvent::DISCONNECTED, peer->id);
+        }
+        removePeer(peerId);
+        return;
+    }
+
+    bool duplicate = false;
+    receiveSequence(peer, header.sequenceNumber, duplicate);
+    if (header.flags & NET_FLAG_HAS_ACK) {
+        processAcks(peer, header.ackNumber, header.ackBits);
+    }
+    if (duplicate) return;
+
+    // Bursts (a fragmented message) get acked as they arrive, so every
+    // packet is covered by some ack before it leaves the bitfield
+    if (!(header.flags & NET_FLAG_ACK) && ++peer->packetsToAck >= IMMEDIATE_ACK_THRESHOLD) {
+        transmitPacket(peer, NetChannel::UNRELIABLE, NET_FLAG_ACK, nullptr, 0);
+    }
+
+    if (header.flags & NET_FLAG_CONNECT) {
+        // A repeated CONNECT means our ACCEPT was lost
+        if (serverMode) {
+            transmitPacket(peer, NetChannel::UNRELIABLE, NET_FLAG_ACCEPT, nullptr, 0);
+        }
+        return;
+    }
+
+    if ((header.flags & NET_FLAG_ACCEPT) && peer->state == ConnectionState::CONNECTING) {
+        peer->state = ConnectionState::CONNECTED;
+        peerEvents.emplace_back(PeerEvent::CONNECTED, peer->id);
+        LOG_INFO(netLog, "Connected to {}", peer->id);
+    }
+
+    if (!(header.flags & NET_FLAG_DATA) || peer->state != ConnectionState::CONNECTED) return;
+
+    const uint8_t* body = packet.data.data() + sizeof(header);
+    if (header.protocol == static_cast<uint8_t>(NetChannel::RELIABLE_ORDERED)) {
+        handleReliablePacket(peer, header, body, header.size);
+    } else {
+        handleUnreliablePacket(peer, body, header.size);
+    }
+}
+
+// ============================================================================
+// Acks and loss
+// ============================================================================
+
+void NetworkEngine::receiveSequence(Peer* peer, uint32_t sequence, bool& duplicate) {
+    duplicate = false;
+
+    if (!peer->hasRemoteSequence) {
+        peer->hasRemoteSequence = true;
+        peer->remoteSequence = sequence;
+        peer->remoteAckBits = 0;
+        return;
+    }
+
+    if (sequenceGreater(sequence, peer->remoteSequence)) {
+        // The old newest becomes bit shift - 1
+        uint32_t shift = sequence - peer->remoteSequence;
+        if (shift < 32) {
+            peer->remoteAckBits = (peer->remoteAckBits << shift) | (1u << (shift - 1));
+        } else {
+            peer->remoteAckBits = shift == 32 ? 1u << 31 : 0;
+        }
+        peer->remoteSequence = sequence;
+        return;
+    }
+
+    uint32_t behind = peer->remoteSequence - sequence;
+    if (behind == 0) {
+        duplicate = true;
+        return;
+    }
+
+    stats.packetsOutOfOrder++;
+    if (behind > 32) return;     // Too old to ack; the sender has written it off
+
+    uint32_t bit = 1u << (behind - 1);
+    if (peer->remoteAckBits & bit) {
+        duplicate = true;
+        return;
+    }
+    peer->remoteAckBits |= bit;
+}
+
+void NetworkEngine::processAcks(Peer* peer, uint32_t ackNumber, uint32_t ackBits) {
+    if (!sequenceGreater(peer->localSequence, ackNumber)) return;
+
+    for (uint32_t i = 0; i <= 32; i++) {
+        if (i > 0 && !(ackBits & (1u << (i - 1)))) continue;
+
+        uint32_t sequence = ackNumber - i;
+        SentPacketRecord& record = peer->sentPackets[sequence % SENT_HISTORY];
+        if (record.pending && record.sequence == sequence) {
+            onPacketAcked(peer, record);
+        }
+    }
+
+    // Anything older than the ack window that is still unacked was lost
+    uint32_t horizon = ackNumber - 32;
+    uint32_t checked = 0;
+    while (sequenceGreater(horizon, peer->lossCheckSequence) && checked < SENT_HISTORY) {
+        SentPacketRecord& record = peer->sentPackets[peer->lossCheckSequence % SENT_HISTORY];
+        if (record.pending && record.sequence == peer->lossCheckSequence) {
+            onPacketLost(peer, record);
+        }
+        peer->lossCheckSequence++;
+        checked++;
+    }
+}
+
+void NetworkEngine::onPacketAcked(Peer* peer, SentPacketRecord& record) {
+    record.pending = false;
+    updateRtt(peer, currentTime - record.sendTime);
+    stats.packetLoss *= 1.0f - LOSS_SMOOTHING;
+
+    if (!record.hasFragment) return;
+
+    auto it = peer->pendingRetransmits.find(record.fragmentKey);
+    if (it == peer->pendingRetransmits.end()) return;
+    peer->pendingRetransmits.erase(it);
+
+    // Grow while the path shows neither loss nor queueing delay: one
+    // fragment per ack in slow start, about one per window after. The delay
+    // floor absorbs acks that wait for the peer's next update().
+    bool queueing = peer->hasRttSample &&
+                    peer->smoothedRtt - peer->minRtt > std::max(peer->minRtt, QUEUEING_DELAY_FLOOR);
+    if (!queueing) {
+        if (peer->congestionWindow < peer->slowStartThreshold) {
+            peer->congestionWindow += 1.0f;
+        } else {
+            peer->congestionWindow += 1.0f / peer->congestionWindow;
+        }
+        peer->congestionWindow = std::min(peer->congestionWindow, MAX_CONGESTION_WINDOW);
+    }
+}
+
+void NetworkEngine::onPacketLost(Peer* peer, SentPacketRecord& record) {
+    record.pending = false;
+    stats.packetsLost++;
+    stats.packetLoss = stats.packetLoss * (1.0f - LOSS_SMOOTHING) + 100.0f * LOSS_SMOOTHING;
+
+    // Resend now rather than waiting out the RTO
+    if (record.hasFragment) {
+        auto it = peer->pendingRetransmits.find(record.fragmentKey);
+        if (it != peer->pendingRetransmits.end() && it->second.sequenceNumber == record.sequence) {
+            onCongestion(peer);
+            resendFragment(peer, it->second);
+        }
+    }
+}
+
+void NetworkEngine::onCongestion(Peer* peer) {
+    // At most one reduction per round trip, however many packets it lost
+    if (peer->lastCongestionTime >= 0.0f && currentTime - peer->lastCongestionTime < peer->smoothedRtt) return;
+
+    peer->lastCongestionTime = currentTime;
+    peer->slowStartThreshold = std::max(peer->congestionWindow / 2.0f, MIN_CONGESTION_WINDOW);
+    peer->congestionWindow = peer->slowStartThreshold;
+    if (debugLogging) {
+        LOG_DEBUG(netLog, "Congestion on {}: window {}", peer->id, peer->congestionWindow);
+    }
+}
+
+void NetworkEngine::updateRtt(Peer* peer, float sample) {
+    // RFC 6298 smoothing
+    if (!peer->hasRttSample) {
+        peer->hasRttSample = true;
+        peer->smoothedRtt = sample;
+        peer->rttVariance = sample / 2.0f;
+        peer->minRtt = sample;
+    } else {
+        float error = sample > peer->smoothedRtt ? sample - peer->smoothedRtt : peer->smoothedRtt - sample;
+        peer->rttVariance = 0.75f * peer->rttVariance + 0.25f * error;
+        peer->smoothedRtt = 0.875f * peer->smoothedRtt + 0.125f * sample;
+        peer->minRtt = std::min(peer->minRtt, sample);
+    }
+
+    float timeout = peer->smoothedRtt + std::max(4.0f * peer->rttVariance, 0.01f);
+    peer->retransmitTimeout = std::min(std::max(timeout, MIN_RTO), MAX_RTO);
+}
+
+void NetworkEngine::updatePing(Peer* peer, float /*deltaTime*/) {
+    peer->ping = peer->smoothedRtt * 1000.0f;
+}
+
+// ============================================================================
+// Reliable channel
+// ============================================================================
+
+void NetworkEngine::sendReliablePacket(Peer* peer, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    MessageHeader message;
+    message.messageId = peer->nextReliableMessageId++;
+    message.fragmentCount = static_cast<uint16_t>((size + MAX_FRAGMENT_SIZE - 1) / MAX_FRAGMENT_SIZE);
+
+    for (uint16_t i = 0; i < message.fragmentCount; i++) {
+        size_t offset = static_cast<size_t>(i) * MAX_FRAGMENT_SIZE;
+        size_t chunk = std::min(MAX_FRAGMENT_SIZE, size - offset);
+        message.fragmentIndex = i;
+
+        NetPacket fragment;
+        fragment.reliable = true;
+        fragment.address = peer->address;
+        fragment.data.resize(sizeof(message) + chunk);
+        memcpy(fragment.data.data(), &message, sizeof(message));
+        memcpy(fragment.data.data() + sizeof(message), bytes + offset, chunk);
+        peer->sendWindowQueue.push_back(std::move(fragment));
+    }
+
+    fillSendWindow(peer);
+}
+
+void NetworkEngine::fillSendWindow(Peer* peer) {
+    while (!peer->sendWindowQueue.empty() &&
+           static_cast<float>(peer->pendingRetransmits.size()) < peer->congestionWindow) {
+        NetPacket fragment = std::move(peer->sendWindowQueue.front());
+        peer->sendWindowQueue.pop_front();
+
+        MessageHeader message;
+        memcpy(&message, fragment.data.data(), sizeof(message));
+        uint64_t key = fragmentKey(message.messageId, message.fragmentIndex);
+
+        NetPacket& pending = peer->pendingRetransmits[key];
+        pending = std::move(fragment);
+        pending.retransmitCount = 0;
+        pending.sequenceNumber = transmitPacket(peer, NetChannel::RELIABLE_ORDERED, NET_FLAG_DATA,
+                                                pending.data.data(), pending.data.size());
+        pending.timestamp = currentTime;
+
+        SentPacketRecord& record = peer->sentPackets[pending.sequenceNumber % SENT_HISTORY];
+        record.hasFragment = true;
+        record.fragmentKey = key;
+    }
+}
+
+bool NetworkEngine::resendFragment(Peer* peer, NetPacket& fragment) {
+    if (fragment.retransmitCount >= maxRetransmits) return false;
+
+    fragment.retransmitCount++;
+    stats.packetsRetransmitted++;
+
+    MessageHeader message;
+    memcpy(&message, fragment.data.data(), sizeof(message));
+
+    // Each copy goes out under a new sequence, so its ack gives a clean RTT sample
+    fragment.sequenceNumber = transmitPacket(peer, NetChannel::RELIABLE_ORDERED, NET_FLAG_DATA,
+                                             fragment.data.data(), fragment.data.size());
+    fragment.timestamp = currentTime;
+
+    SentPacketRecord& record = peer->sentPackets[fragment.sequenceNumber % SENT_HISTORY];
+    record.hasFragment = true;
+    record.fragmentKey = fragmentKey(message.messageId, message.fragmentIndex);
+    return true;
+}
+
+bool NetworkEngine::retransmitPackets(Peer* peer) {
+    for (auto& entry : peer->pendingRetransmits) {
+        NetPacket& fragment = entry.second;
+
+        // Exponential backoff on repeated timeouts
+        float timeout = peer->retransmitTimeout * static_cast<float>(1 << std::min(fragment.retransmitCount, 5));
+        timeout = std::min(timeout, MAX_RTO);
+        if (currentTime - fragment.timestamp < timeout) continue;
+
+        onCongestion(peer);
+        if (!resendFragment(peer, fragment)) return false;
+        if (debugLogging) {
+            LOG_DEBUG(netLog, "Retransmit {} to {} (attempt {})", entry.first, peer->id, fragment.retransmitCount);
+        }
+    }
+    return true;
+}
+
+bool NetworkEngine::updateReliability(Peer* peer, float /*deltaTime*/) {
+    if (peer->state == ConnectionState::CONNECTING) {
+        if (currentTime - peer->lastSendTime >= CONNECT_RETRY_INTERVAL) {
+            transmitPacket(peer, NetChannel::UNRELIABLE, NET_FLAG_CONNECT, nullptr, 0);
+        }
+        return true;
+    }
+    if (peer->state != ConnectionState::CONNECTED) return true;
+
+    if (!retransmitPackets(peer)) return false;
+    fillSendWindow(peer);
+
+    if (currentTime - peer->lastSendTime >= keepAliveInterval) {
+        transmitPacket(peer, NetChannel::UNRELIABLE, NET_FLAG_KEEPALIVE, nullptr, 0);
+    } else if (peer->packetsToAck > 0) {
+        // Nothing went out since the last ack-eliciting packet arrived
+        transmitPacket(peer, NetChannel::UNRELIABLE, NET_FLAG_ACK, nullptr, 0);
+    }
+
+    // Unreliable fragments that will never complete
+    for (auto it = peer->unreliableReceive.begin(); it != peer->unreliableReceive.end();) {
+        if (currentTime - it->second.firstReceiveTime > REASSEMBLY_TIMEOUT) {
+            it = peer->unreliableReceive.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return true;
+}
+
+bool NetworkEngine::addFragment(MessageReassembly& message, const MessageHeader& header, const uint8_t* data, size_t size) {
+    if (message.fragmentCount == 0) {
+        message.fragmentCount = header.fragmentCount;
+        message.firstReceiveTime = currentTime;
+        message.fragments.resize(header.fragmentCount);
+    }
+    if (message.fragmentCount != header.fragmentCount) return false;
+
+    std::vector<uint8_t>& fragment = message.fragments[header.fragmentIndex];
+    if (!fragment.empty()) return false;    // Duplicate
+    fragment.assign(data, data + size);
+    message.receivedCount++;
+    return true;
+}
+
+void NetworkEngine::deliverMessage(Peer* peer, MessageReassembly& message) {
+    NetPacket packet;
+    packet.address = peer->address;
+    if (message.fragmentCount == 1) {
+        packet.data = std::move(message.fragments[0]);
+    } else {
+        size_t total = 0;
+        for (const auto& fragment : message.fragments) total += fragment.size();
+        packet.data.reserve(total);
+        for (const auto& fragment : message.fragments) {
+            packet.data.insert(packet.data.end(), fragment.begin(), fragment.end());
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(queueMutex);
+    receiveQueue.push(std::move(packet));
+}
+
+void NetworkEngine::handleReliablePacket(Peer* peer, const PacketHeader& /*header*/, const uint8_t* data, size_t size) {
+    if (size <= sizeof(MessageHeader)) return;
+
+    MessageHeader message;
+    memcpy(&message, data, sizeof(message));
+    if (message.fragmentCount == 0 || message.fragmentCount > MAX_FRAGMENTS ||
+        message.fragmentIndex >= message.fragmentCount) {
+        return;
+    }
+
+    // Already delivered (a retransmit whose ack was lost), or too far ahead
+    if (sequenceGreater(peer->nextDeliverMessageId, message.messageId)) return;
+    if (message.messageId - peer->nextDeliverMessageId >= ORDERED_RECEIVE_WINDOW) return;
+
+    MessageReassembly& pending = peer->orderedReceive[message.messageId];
+    addFragment(pending, message, data + sizeof(message), size - sizeof(message));
+
+    // Deliver every complete message at the head of the stream
+    while (true) {
+        auto it = peer->orderedReceive.find(peer->nextDeliverMessageId);
+        if (it == peer->orderedReceive.end() || it->second.receivedCount < it->second.fragmentCount) break;
+        deliverMessage(peer, it->second);
+        peer->orderedReceive.erase(it);
+        peer->nextDeliverMessageId++;
+    }
+}
+
+void NetworkEngine::handleUnreliablePacket(Peer* peer, const uint8_t* data, size_t size) {
+    if (size <= sizeof(MessageHeader)) return;
+
+    MessageHeader message;
+    memcpy(&message, data, sizeof(message));
+    if (message.fragmentCount == 0 || message.fragmentCount > MAX_FRAGMENTS ||
+        message.fragmentIndex >= message.fragmentCount) {
+        return;
+    }
+
+    if (message.fragmentCount == 1) {
+        MessageReassembly single;
+        addFragment(single, message, data + sizeof(message), size - sizeof(message));
+        deliverMessage(peer, single);
+        return;
+    }
+
+    if (peer->unreliableReceive.size() >= MAX_UNRELIABLE_REASSEMBLIES &&
+        peer->unreliableReceive.find(message.messageId) == peer->unreliableReceive.end()) {
+        return;
+    }
+
+    MessageReassembly& pending = peer->unreliableReceive[message.messageId];
+    if (addFragment(pending, message, data + sizeof(message), size - sizeof(message)) &&
+        pending.receivedCount == pending.fragmentCount) {
+        deliverMessage(peer, pending);
+        peer->unreliableReceive.erase(message.messageId);
+    }
+}
+
+// ============================================================================
+// Timeouts and stats
+// ============================================================================
+
+void NetworkEngine::checkTimeouts(float /*deltaTime*/) {
+    std::vector<std::string> expired;
+    for (auto& entry : peers) {
+        Peer* peer = entry.second.get();
+        if (peer->state == ConnectionState::CONNECTING) {
+            if (currentTime - peer->connectStartTime > timeoutDuration) {
+                peer->state = ConnectionState::FAILED;
+                peerEvents.emplace_back(PeerEvent::FAILED, peer->id);
+                expired.push_back(peer->id);
+            }
+        } else if (currentTime - peer->lastReceiveTime > timeoutDuration) {
+            LOG_INFO(netLog, "Peer {} timed out", peer->id);
+            peerEvents.emplace_back(PeerEvent::DISCONNECTED, peer->id);
+            expired.push_back(peer->id);
+        }
+    }
+
+    for (const std::string& peerId : expired) {
+        removePeer(peerId);
+    }
+}
+
+void NetworkEngine::updateStats(float deltaTime) {
+    float latencySum = 0.0f;
+    int latencyCount = 0;
+    for (auto& entry : peers) {
+        if (entry.second->hasRttSample) {
+            latencySum += entry.second->ping;
+            latencyCount++;
+        }
+    }
+    stats.averageLatency = latencyCount > 0 ? latencySum / latencyCount : 0.0f;
+
+    // Bandwidth over roughly one-second windows
+    statsWindowTime += deltaTime;
+    if (statsWindowTime >= 1.0f) {
+        uint64_t bytes = stats.bytesSent + stats.bytesReceived;
+        stats.bandwidth = static_cast<float>(bytes - statsWindowBytes) / 1024.0f / statsWindowTime;
+        statsWindowBytes = bytes;
+        statsWindowTime = 0.0f;
+    }
+}
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+std::string NetworkEngine::addressToString(const sockaddr_in& addr) {
+    char ip[INET_ADDRSTRLEN] = {};
+    inet_ntop(AF_INET, &addr.sin_addr, ip, sizeof(ip));
+    return std::string(ip) + ":" + std::to_string(ntohs(addr.sin_port));
+}
+
+bool NetworkEngine::stringToAddress(const std::string& str, sockaddr_in& addr) {
+    // "host" or "host:port"
+    std::string host = str;
+    uint16_t port = 0;
+    size_t colon = str.rfind(':');
+    if (colon != std::string::npos) {
+        host = str.substr(0, colon);
+        port = static_cast<uint16_t>(atoi(str.c_str() + colon + 1));
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) == 1) return true;
+
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+
+    addrinfo* result = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0 || !result) return false;
+    addr.sin_addr = reinterpret_cast<sockaddr_in*>(result->ai_addr)->sin_addr;
+    freeaddrinfo(result);
+    return true;
+}
+
+uint16_t NetworkEngine::getPort(const sockaddr_in& addr) {
+    return ntohs(addr.sin_port);
+}
+
+// ============================================================================
+// NetworkUtils
+// ============================================================================
+
+std::vector<uint8_t> NetworkUtils::compress(const void* data, size_t size) {
+    std::vector<uint8_t> frame;
+    compressPayload(static_cast<const uint8_t*>(data), size, frame);
+    return frame;
+}
+
+std::vector<uint8_t> NetworkUtils::decompress(const void* data, size_t size) {
+    std::vector<uint8_t> out;
+    if (!decompressPayload(static_cast<const uint8_t*>(data), size, out)) {
+        out.clear();
+    }
+    return out;
+}
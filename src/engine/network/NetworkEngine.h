@@ -7,7 +7,9 @@
 #include <memory>
 #include <functional>
 #include <queue>
+#include <deque>
 #include <mutex>
+#include <random>
 #include <cstring>
 
 // Network protocol types
@@ -36,16 +38,47 @@ enum class ConnectionState {
     FAILED
 };
 
-// Packet header for reliable UDP
+// Channels carried over RELIABLE_UDP. Ordered-reliable messages are
+// retransmitted until acked and delivered in send order; unreliable ones are
+// sent once and delivered as they arrive (or not at all).
+enum class NetChannel : uint8_t {
+    UNRELIABLE = 0,
+    RELIABLE_ORDERED = 1
+};
+
+// PacketHeader::flags
+enum NetPacketFlags : uint8_t {
+    NET_FLAG_CONNECT    = 1 << 0,
+    NET_FLAG_ACCEPT     = 1 << 1,
+    NET_FLAG_DISCONNECT = 1 << 2,
+    NET_FLAG_KEEPALIVE  = 1 << 3,   // Asks for an ack (keeps RTT fresh while idle)
+    NET_FLAG_ACK        = 1 << 4,   // Carries acks only; never acked itself
+    NET_FLAG_DATA       = 1 << 5,   // MessageHeader + fragment follow
+    NET_FLAG_HAS_ACK    = 1 << 6    // ackNumber/ackBits are valid
+};
+
+#pragma pack(push, 1)
+// Packet header for reliable UDP. Every packet has its own sequence number and
+// acks the newest packet received plus the 32 before it (bit n of ackBits is
+// ackNumber - 1 - n), so each ack is repeated in many packets.
 struct PacketHeader {
     uint32_t sequenceNumber;
     uint32_t ackNumber;
     uint32_t ackBits;
-    uint16_t size;
-    uint8_t protocol;
-    uint8_t flags;
+    uint16_t size;          // Bytes after this header
+    uint8_t protocol;       // NetChannel
+    uint8_t flags;          // NetPacketFlags
 };
 
+// Follows PacketHeader on DATA packets. Messages above the MTU are split into
+// fragments that share a messageId.
+struct MessageHeader {
+    uint32_t messageId;     // Per channel and peer
+    uint16_t fragmentIndex;
+    uint16_t fragmentCount;
+};
+#pragma pack(pop)
+
 // Network packet
 struct NetPacket {
     std::vector<uint8_t> data;
@@ -58,6 +91,23 @@ struct NetPacket {
     NetPacket() : reliable(false), sequenceNumber(0), timestamp(0.0f), retransmitCount(0) {}
 };
 
+// Sent packet, kept until acked or declared lost
+struct SentPacketRecord {
+    uint32_t sequence = 0;
+    float sendTime = 0.0f;
+    bool pending = false;       // Neither acked nor lost yet
+    bool hasFragment = false;   // Carried a reliable fragment
+    uint64_t fragmentKey = 0;
+};
+
+// Fragments of one message being put back together
+struct MessageReassembly {
+    uint16_t fragmentCount = 0;
+    uint16_t receivedCount = 0;
+    float firstReceiveTime = 0.0f;
+    std::vector<std::vector<uint8_t>> fragments;
+};
+
 // Peer information
 struct Peer {
     std::string id;
@@ -71,13 +121,42 @@ struct Peer {
     float ping;
 
     // Reliability
-    uint32_t localSequence;
-    uint32_t remoteSequence;
-    std::vector<uint32_t> ackHistory;
+    uint32_t localSequence;         // Next packet sequence
+    uint32_t remoteSequence;        // Newest packet received
+    uint32_t remoteAckBits;         // Bit n: remoteSequence - 1 - n received
+    bool hasRemoteSequence;
+    uint32_t packetsToAck;          // Ack-eliciting packets received since our last send
+    uint32_t lossCheckSequence;     // Oldest sent sequence not yet judged
+    std::vector<SentPacketRecord> sentPackets;          // Ring by sequence
+    std::map<uint64_t, NetPacket> pendingRetransmits;   // Unacked reliable fragments
+    std::deque<NetPacket> sendWindowQueue;              // Reliable fragments waiting for the window
+
+    // Channels
+    uint32_t nextReliableMessageId;
+    uint32_t nextUnreliableMessageId;
+    uint32_t nextDeliverMessageId;                      // Ordered channel
+    std::map<uint32_t, MessageReassembly> orderedReceive;
+    std::map<uint32_t, MessageReassembly> unreliableReceive;
+
+    // RTT and congestion (seconds / fragments in flight)
+    float connectStartTime;
+    float smoothedRtt;
+    float rttVariance;
+    float minRtt;
+    float retransmitTimeout;
+    float congestionWindow;
+    float slowStartThreshold;
+    float lastCongestionTime;
+    bool hasRttSample;
 
     Peer() : natType(NATType::UNKNOWN), state(ConnectionState::DISCONNECTED),
              lastReceiveTime(0.0f), lastSendTime(0.0f), ping(0.0f),
-             localSequence(0), remoteSequence(0) {}
+             localSequence(0), remoteSequence(0), remoteAckBits(0),
+             hasRemoteSequence(false), packetsToAck(0), lossCheckSequence(0),
+             nextReliableMessageId(0), nextUnreliableMessageId(0), nextDeliverMessageId(0),
+             connectStartTime(0.0f), smoothedRtt(0.0f), rttVariance(0.0f), minRtt(0.0f),
+             retransmitTimeout(0.25f), congestionWindow(32.0f), slowStartThreshold(512.0f),
+             lastCongestionTime(-1.0f), hasRttSample(false) {}
 };
 
 // STUN server
@@ -110,13 +189,14 @@ struct NetworkStats {
     uint64_t packetsReceived;
     uint64_t packetsLost;
     uint64_t packetsOutOfOrder;
-    float averageLatency;
-    float packetLoss;
-    float bandwidth;  // KB/s
+    uint64_t packetsRetransmitted;  // Reliable fragments sent again
+    float averageLatency;   // Mean smoothed RTT over connected peers, ms
+    float packetLoss;       // Recent loss of sent packets, percent
+    float bandwidth;        // KB/s, sent + received
 
     NetworkStats() : bytesSent(0), bytesReceived(0), packetsSent(0),
                     packetsReceived(0), packetsLost(0), packetsOutOfOrder(0),
-                    averageLatency(0.0f), packetLoss(0.0f), bandwidth(0.0f) {}
+                    packetsRetransmitted(0), averageLatency(0.0f), packetLoss(0.0f), bandwidth(0.0f) {}
 };
 
 // Network callbacks
@@ -130,9 +210,21 @@ public:
     virtual void onNATTypeDetected(NATType type) {}
 };
 
-// Network engine with NAT traversal
+// Network engine with NAT traversal.
+//
+// RELIABLE_UDP runs a reliability layer over one UDP socket: per-packet
+// sequence numbers with ack bitfields, RTT-based retransmit timeouts, an
+// ordered-reliable and an unreliable channel, fragmentation above the MTU,
+// and a congestion window sized from loss and RTT. Plain UDP sends
+// everything on the unreliable channel. Driven entirely by update().
 class NetworkEngine {
 public:
+    // Largest datagram sent; stays under common path MTUs
+    static constexpr size_t MTU = 1200;
+    static constexpr size_t MAX_FRAGMENT_SIZE = MTU - sizeof(PacketHeader) - sizeof(MessageHeader);
+    static constexpr size_t MAX_FRAGMENTS = 256;
+    static constexpr size_t SENT_HISTORY = 1024;
+
     NetworkEngine();
     ~NetworkEngine();
 
@@ -160,7 +252,8 @@ public:
     bool punchHole(const sockaddr_in& targetPublic, const sockaddr_in& targetLocal);
     bool sendKeepAlive(const std::string& peerId);
 
-    // Data transmission
+    // Data transmission (only to CONNECTED peers; false if the message is
+    // empty or over MAX_FRAGMENTS * MAX_FRAGMENT_SIZE bytes)
     bool send(const std::string& peerId, const void* data, size_t size, bool reliable = true);
     bool sendToAll(const void* data, size_t size, bool reliable = true);
     bool broadcast(const void* data, size_t size);  // Local network broadcast
@@ -181,6 +274,7 @@ public:
     void setTimeoutDuration(float seconds) { timeoutDuration = seconds; }
     void setKeepAliveInterval(float seconds) { keepAliveInterval = seconds; }
     void setMaxRetransmits(int max) { maxRetransmits = max; }
+    // Applied to outgoing packets only: drop this percentage, delay the rest
     void setPacketLossSimulation(float percentage) { simulatedPacketLoss = percentage; }
     void setLatencySimulation(float ms) { simulatedLatency = ms; }
 
@@ -209,16 +303,33 @@ private:
     void processOutgoingPackets();
     void handlePacket(const NetPacket& packet, const sockaddr_in& from);
     void sendPacket(Peer* peer, const void* data, size_t size, bool reliable);
+    uint32_t transmitPacket(Peer* peer, NetChannel channel, uint8_t flags, const uint8_t* body, size_t bodySize);
+    void sendDatagram(const sockaddr_in& address, std::vector<uint8_t>&& datagram);
+    Peer* createPeer(const sockaddr_in& address, ConnectionState state);
+    void removePeer(const std::string& peerId);
 
     // Reliability layer
     void sendReliablePacket(Peer* peer, const void* data, size_t size);
     void handleReliablePacket(Peer* peer, const PacketHeader& header, const uint8_t* data, size_t size);
-    void updateReliability(Peer* peer, float deltaTime);
-    void retransmitPackets(Peer* peer);
+    void handleUnreliablePacket(Peer* peer, const uint8_t* data, size_t size);
+    bool addFragment(MessageReassembly& message, const MessageHeader& header, const uint8_t* data, size_t size);
+    void deliverMessage(Peer* peer, MessageReassembly& message);
+    void receiveSequence(Peer* peer, uint32_t sequence, bool& duplicate);
+    void processAcks(Peer* peer, uint32_t ackNumber, uint32_t ackBits);
+    void onPacketAcked(Peer* peer, SentPacketRecord& record);
+    void onPacketLost(Peer* peer, SentPacketRecord& record);
+    void onCongestion(Peer* peer);
+    void updateRtt(Peer* peer, float sample);
+    void fillSendWindow(Peer* peer);
+    bool resendFragment(Peer* peer, NetPacket& fragment);
+    bool updateReliability(Peer* peer, float deltaTime);    // false if the peer failed
+    bool retransmitPackets(Peer* peer);
 
     // Connection management
     void checkTimeouts(float deltaTime);
     void updatePing(Peer* peer, float deltaTime);
+    void updateStats(float deltaTime);
+    void dispatchEvents();
 
     // Helpers
     std::string addressToString(const sockaddr_in& addr);
@@ -228,7 +339,9 @@ private:
     // Socket
     SOCKET socket;
     NetProtocol protocol;
+    bool initialized;
     bool serverMode;
+    float currentTime;      // Sum of update() deltas, seconds
 
     // Addresses
     sockaddr_in localAddress;
@@ -239,12 +352,22 @@ private:
     std::map<std::string, std::unique_ptr<Peer>> peers;
     std::mutex peersMutex;
 
-    // Packet queues
+    // Packet queues. sendQueue holds datagrams delayed by the latency
+    // simulation (timestamp = release time); receiveQueue holds complete
+    // messages for pollMessages(). Unacked reliable fragments live on their
+    // Peer (pendingRetransmits).
     std::queue<NetPacket> sendQueue;
     std::queue<NetPacket> receiveQueue;
-    std::vector<NetPacket> pendingRetransmits;
     std::mutex queueMutex;
 
+    // Connection events raised under peersMutex, reported by dispatchEvents()
+    enum class PeerEvent : uint8_t {
+        CONNECTED,
+        DISCONNECTED,
+        FAILED
+    };
+    std::vector<std::pair<PeerEvent, std::string>> peerEvents;
+
     // Timing
     float timeoutDuration;
     float keepAliveInterval;
@@ -253,10 +376,13 @@ private:
 
     // Statistics
     NetworkStats stats;
+    float statsWindowTime;
+    uint64_t statsWindowBytes;
 
     // Simulation
     float simulatedPacketLoss;
     float simulatedLatency;
+    std::mt19937 simulationRng;
 
     // Callback
     INetworkCallback* callback;
@@ -276,7 +402,9 @@ namespace NetworkUtils {
     // Checksum
     uint16_t calculateChecksum(const void* data, size_t size);
 
-    // Compression
+    // Compression: self-describing Compression.h frames, stored as is below
+    // COMPRESSION_THRESHOLD or when LZ doesn't help. decompress() returns an
+    // empty vector for a malformed frame.
     std::vector<uint8_t> compress(const void* data, size_t size);
     std::vector<uint8_t> decompress(const void* data, size_t size);
 
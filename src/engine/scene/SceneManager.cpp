@@ -1,5 +1,9 @@
 #include "SceneManager.h"
-#include <iostream>
+#include "../../common/Logger.h"
+
+namespace {
+    LogCategory sceneLog("SceneManager");
+}
 
 SceneManager::SceneManager()
     : active(nullptr), accumulator(0.0f) {
@@ -11,11 +15,11 @@ SceneManager::~SceneManager() {
 
 bool SceneManager::switchTo(const std::string& key) {
     if (scenes.find(key) == scenes.end()) {
-        std::cerr << "[SceneManager] Scene '" << key << "' not found!" << std::endl;
+        LOG_ERROR(sceneLog, "Scene '{}' not found!", key);
         return false;
     }
 
-    std::cout << "[SceneManager] Scheduling switch to: " << key << std::endl;
+    LOG_INFO(sceneLog, "Scheduling switch to: {}", key);
     pendingSwitch = key;
     return true;
 }
@@ -47,7 +51,7 @@ void SceneManager::tick(float dt, float fixedDt) {
 void SceneManager::doSwitch() {
     // Exit current scene
     if (active) {
-        std::cout << "[SceneManager] Exiting scene: " << active->name() << std::endl;
+        LOG_INFO(sceneLog, "Exiting scene: {}", active->name());
         active->onExit();
         active = nullptr;
     }
@@ -56,10 +60,10 @@ void SceneManager::doSwitch() {
     auto it = scenes.find(pendingSwitch);
     if (it != scenes.end()) {
         active = it->second.get();
-        std::cout << "[SceneManager] Entering scene: " << active->name() << std::endl;
+        LOG_INFO(sceneLog, "Entering scene: {}", active->name());
 
         if (!active->onEnter()) {
-            std::cerr << "[SceneManager] Scene failed to initialize!" << std::endl;
+            LOG_ERROR(sceneLog, "Scene failed to initialize!");
             active = nullptr;
         }
     }
@@ -1,9 +1,13 @@
 #include "MenuScene.h"
 #include "../../engine/GameEngine.h"
 #include "../../common/NetworkProtocol.h"
-#include <iostream>
+#include "../../common/Logger.h"
 #include <cmath>
 
+namespace {
+    LogCategory menuLog("MenuScene");
+}
+
 MenuScene::MenuScene(NetworkClient* netClient)
     : networkClient(netClient),
       inMatchmaking(false),
@@ -16,7 +20,7 @@ MenuScene::~MenuScene() {
 }
 
 bool MenuScene::onEnter() {
-    std::cout << "[MenuScene] Entering menu" << std::endl;
+    LOG_INFO(menuLog, "Entering menu");
 
     setupUI();
 
@@ -31,13 +35,13 @@ bool MenuScene::onEnter() {
 }
 
 void MenuScene::onExit() {
-    std::cout << "[MenuScene] Exiting menu" << std::endl;
+    LOG_INFO(menuLog, "Exiting menu");
 
     // Stop matchmaking if active
     if (inMatchmaking) {
         LobbyReady stopQueue;
         stopQueue.ready = false;
-        networkClient->sendPacket(PacketType::LOBBY_STOP_QUEUE, &stopQueue, static_cast<uint32_t>(sizeof(stopQueue)));
+        networkClient->sendMessage(PacketType::LOBBY_STOP_QUEUE, stopQueue);
         inMatchmaking = false;
     }
 
@@ -158,13 +162,13 @@ void MenuScene::setupUI() {
 }
 
 void MenuScene::onPlayClicked() {
-    std::cout << "[MenuScene] Play clicked - starting matchmaking" << std::endl;
+    LOG_INFO(menuLog, "Play clicked - starting matchmaking");
 
     if (!inMatchmaking) {
         // Start matchmaking
         LobbyReady startQueue;
         startQueue.ready = true;
-        networkClient->sendPacket(PacketType::LOBBY_START_QUEUE, &startQueue, static_cast<uint32_t>(sizeof(startQueue)));
+        networkClient->sendMessage(PacketType::LOBBY_START_QUEUE, startQueue);
 
         inMatchmaking = true;
         matchmakingTime = 0.0f;
@@ -173,19 +177,19 @@ void MenuScene::onPlayClicked() {
 }
 
 void MenuScene::onStashClicked() {
-    std::cout << "[MenuScene] Stash clicked" << std::endl;
+    LOG_INFO(menuLog, "Stash clicked");
     // TODO: Switch to stash scene
     statusText->setText("Stash not implemented yet");
 }
 
 void MenuScene::onSettingsClicked() {
-    std::cout << "[MenuScene] Settings clicked" << std::endl;
+    LOG_INFO(menuLog, "Settings clicked");
     // TODO: Switch to settings scene
     statusText->setText("Settings not implemented yet");
 }
 
 void MenuScene::onQuitClicked() {
-    std::cout << "[MenuScene] Quit clicked" << std::endl;
+    LOG_INFO(menuLog, "Quit clicked");
     // TODO: Signal GameEngine to shutdown
     exit(0);
 }
@@ -195,7 +199,7 @@ void MenuScene::processNetworkPackets() {
         NetworkClient::ReceivedPacket packet = networkClient->getNextPacket();
 
         if (packet.type == PacketType::MATCH_FOUND) {
-            std::cout << "[MenuScene] Match found! Switching to raid scene" << std::endl;
+            LOG_INFO(menuLog, "Match found! Switching to raid scene");
 
             inMatchmaking = false;
             statusText->setText("Match found! Loading raid...");
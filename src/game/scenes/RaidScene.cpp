@@ -2,7 +2,11 @@
 #include "../../engine/GameEngine.h"
 #include "../../common/NetworkProtocol.h"
 #include "../../common/ItemDatabase.h"
-#include <iostream>
+#include "../../common/Logger.h"
+
+namespace {
+    LogCategory raidLog("RaidScene");
+}
 
 RaidScene::RaidScene(NetworkClient* netClient, uint64_t playerAccId)
     : networkClient(netClient),
@@ -21,7 +25,7 @@ RaidScene::~RaidScene() {
 }
 
 bool RaidScene::onEnter() {
-    std::cout << "[RaidScene] Entering raid" << std::endl;
+    LOG_INFO(raidLog, "Entering raid");
 
     // Initialize prefabs from ItemDatabase
     auto& itemDb = ItemDatabase::getInstance();
@@ -57,12 +61,12 @@ bool RaidScene::onEnter() {
     // Register network callbacks
     // TODO: Set up network packet handlers for PLAYER_MOVE, PLAYER_SHOOT, etc.
 
-    std::cout << "[RaidScene] Raid initialized with " << entities.size() << " entities" << std::endl;
+    LOG_INFO(raidLog, "Raid initialized with {} entities", entities.size());
     return true;
 }
 
 void RaidScene::onExit() {
-    std::cout << "[RaidScene] Exiting raid" << std::endl;
+    LOG_INFO(raidLog, "Exiting raid");
 
     // Cleanup all entities
     entities.clear();
@@ -146,7 +150,7 @@ void RaidScene::render() {
 }
 
 void RaidScene::loadMap() {
-    std::cout << "[RaidScene] Loading map..." << std::endl;
+    LOG_INFO(raidLog, "Loading map...");
 
     // TODO: Load map geometry, navmesh, spawn points
     // For now, just create a ground plane
@@ -164,7 +168,7 @@ void RaidScene::loadMap() {
 }
 
 void RaidScene::spawnPlayer() {
-    std::cout << "[RaidScene] Spawning player..." << std::endl;
+    LOG_INFO(raidLog, "Spawning player...");
 
     Transform playerTransform;
     playerTransform.position = Vec3(0, 2, 0);  // Spawn above ground
@@ -177,7 +181,7 @@ void RaidScene::spawnPlayer() {
 }
 
 void RaidScene::spawnAI() {
-    std::cout << "[RaidScene] Spawning AI..." << std::endl;
+    LOG_INFO(raidLog, "Spawning AI...");
 
     // Spawn 3 scavs
     for (int i = 0; i < 3; i++) {
@@ -197,7 +201,7 @@ void RaidScene::spawnAI() {
 }
 
 void RaidScene::spawnLoot() {
-    std::cout << "[RaidScene] Spawning loot..." << std::endl;
+    LOG_INFO(raidLog, "Spawning loot...");
 
     // Spawn some loot crates
     for (int i = 0; i < 5; i++) {
@@ -231,7 +235,7 @@ EntityId RaidScene::spawnEntity(const Prefab& prefab, const Transform& transform
 
     entities[eid] = entity;
 
-    std::cout << "[RaidScene] Spawned entity: " << prefab.displayName << " (ID: " << eid << ")" << std::endl;
+    LOG_INFO(raidLog, "Spawned entity: {} (ID: {})", prefab.displayName, eid);
 
     return eid;
 }
@@ -239,7 +243,7 @@ EntityId RaidScene::spawnEntity(const Prefab& prefab, const Transform& transform
 void RaidScene::destroyEntity(EntityId eid) {
     auto it = entities.find(eid);
     if (it != entities.end()) {
-        std::cout << "[RaidScene] Destroyed entity ID: " << eid << std::endl;
+        LOG_INFO(raidLog, "Destroyed entity ID: {}", eid);
         entities.erase(it);
     }
 }
@@ -272,7 +276,7 @@ void RaidScene::processNetworkPackets() {
                 break;
 
             case PacketType::EXTRACTION_COMPLETE:
-                std::cout << "[RaidScene] Extraction complete! Returning to menu..." << std::endl;
+                LOG_INFO(raidLog, "Extraction complete! Returning to menu...");
                 ENGINE.getSceneManager()->switchTo("menu");
                 break;
 
@@ -345,7 +349,7 @@ void RaidScene::handleInput(char key) {
         case 'a': case 'A': moveLeft = true; break;
         case 'd': case 'D': moveRight = true; break;
         case 'e': case 'E':
-            std::cout << "[RaidScene] Extract key pressed" << std::endl;
+            LOG_INFO(raidLog, "Extract key pressed");
             // TODO: Check if near extraction point
             break;
     }
@@ -353,7 +357,7 @@ void RaidScene::handleInput(char key) {
 
 void RaidScene::handleMouseClick(float x, float y) {
     // TODO: Raycast and shoot
-    std::cout << "[RaidScene] Mouse click at " << x << ", " << y << std::endl;
+    LOG_DEBUG(raidLog, "Mouse click at {}, {}", x, y);
 }
 
 void RaidScene::handleMouseMove(float x, float y) {
@@ -0,0 +1,114 @@
+#include "TickScheduler.h"
+#include "../common/Logger.h"
+#include <cstdio>
+
+namespace {
+    LogCategory tickLog("TickScheduler");
+
+    uint64_t toNanos(TickScheduler::Clock::duration d) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+    }
+}
+
+TickScheduler::TickScheduler(int tickRateHz, int maxCatchUpTicks)
+    : period(std::chrono::duration_cast<Clock::duration>(std::chrono::seconds(1)) / (tickRateHz > 0 ? tickRateHz : 1)),
+      deltaTime(1.0f / (tickRateHz > 0 ? tickRateHz : 1)),
+      maxCatchUpTicks(maxCatchUpTicks) {
+    nextTick = Clock::now();
+    windowStart = nextTick;
+}
+
+int TickScheduler::addPhase(const char* name) {
+    if (phaseCount >= MAX_PHASES) return MAX_PHASES - 1;
+    phases[phaseCount].name = name;
+    return phaseCount++;
+}
+
+bool TickScheduler::beginTick() {
+    Clock::time_point now = Clock::now();
+    if (now < nextTick) return false;
+
+    // Too far behind to catch up: drop the missed ticks and restart the timeline
+    Clock::duration behind = now - nextTick;
+    if (behind > period * maxCatchUpTicks) {
+        uint64_t missed = static_cast<uint64_t>(behind / period);
+        skippedTicks += missed;
+        tickNumber += missed;
+        nextTick = now;
+        behind = Clock::duration::zero();
+    }
+
+    uint64_t lateness = toNanos(behind);
+    if (lateness > maxLatenessNanos) maxLatenessNanos = lateness;
+
+    tickStart = now;
+    tickNumber++;
+    nextTick += period;
+    return true;
+}
+
+void TickScheduler::endTick() {
+    Clock::duration elapsed = Clock::now() - tickStart;
+    uint64_t nanos = toNanos(elapsed);
+
+    ticks++;
+    totalTickNanos += nanos;
+    if (nanos > maxTickNanos) maxTickNanos = nanos;
+    if (elapsed > period) {
+        overruns++;
+        LOG_DEBUG(tickLog, "Tick {} overran: {} us (budget {} us)", tickNumber, nanos / 1000, toNanos(period) / 1000);
+    }
+}
+
+int TickScheduler::getMillisUntilNextTick() const {
+    Clock::duration remaining = nextTick - Clock::now();
+    if (remaining <= Clock::duration::zero()) return 0;
+
+    auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(remaining);
+    if (millis < remaining) millis += std::chrono::milliseconds(1);
+    return static_cast<int>(millis.count());
+}
+
+void TickScheduler::recordPhase(int phase, Clock::duration elapsed) {
+    PhaseStats& stats = phases[phase];
+    uint64_t nanos = toNanos(elapsed);
+    stats.calls++;
+    stats.totalNanos += nanos;
+    if (nanos > stats.maxNanos) stats.maxNanos = nanos;
+}
+
+void TickScheduler::logStats() const {
+    double seconds = std::chrono::duration<double>(Clock::now() - windowStart).count();
+    double rate = seconds > 0.0 ? ticks / seconds : 0.0;
+    double avgTickMicros = ticks > 0 ? static_cast<double>(totalTickNanos) / ticks / 1000.0 : 0.0;
+
+    char line[160];
+    snprintf(line, sizeof(line), "%llu ticks (%.1f Hz), tick avg %.1f us max %.1f us, overruns %llu, skipped %llu, late max %.1f us",
+             static_cast<unsigned long long>(ticks), rate, avgTickMicros, maxTickNanos / 1000.0,
+             static_cast<unsigned long long>(overruns), static_cast<unsigned long long>(skippedTicks),
+             maxLatenessNanos / 1000.0);
+    LOG_INFO(tickLog, "{}", line);
+
+    for (int i = 0; i < phaseCount; i++) {
+        const PhaseStats& stats = phases[i];
+        double avgMicros = stats.calls > 0 ? static_cast<double>(stats.totalNanos) / stats.calls / 1000.0 : 0.0;
+        snprintf(line, sizeof(line), "  %-16s %10llu calls, avg %8.1f us, max %8.1f us",
+                 stats.name, static_cast<unsigned long long>(stats.calls), avgMicros, stats.maxNanos / 1000.0);
+        LOG_INFO(tickLog, "{}", line);
+    }
+}
+
+void TickScheduler::resetStats() {
+    for (int i = 0; i < phaseCount; i++) {
+        phases[i].calls = 0;
+        phases[i].totalNanos = 0;
+        phases[i].maxNanos = 0;
+    }
+    windowStart = Clock::now();
+    ticks = 0;
+    overruns = 0;
+    skippedTicks = 0;
+    totalTickNanos = 0;
+    maxTickNanos = 0;
+    maxLatenessNanos = 0;
+}
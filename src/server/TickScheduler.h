@@ -0,0 +1,92 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+// Fixed-rate tick clock for the server main loop. Ticks are scheduled on an
+// absolute timeline (start + n * period), so time spent working never
+// stretches the period. A loop that falls behind runs ticks back to back
+// until it has caught up. If it is more than maxCatchUpTicks behind, the
+// missed ticks are skipped and the timeline restarts from now.
+//
+// Named phases are timed with measure(); logStats() reports per-phase
+// average/max, tick overruns (work longer than one period), lateness and
+// skipped ticks.
+class TickScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int MAX_PHASES = 8;
+
+    explicit TickScheduler(int tickRateHz, int maxCatchUpTicks = 5);
+
+    // Register a timed phase; returns its id for measure()
+    int addPhase(const char* name);
+
+    // Start the next tick if it is due. Returns false if it is not due yet.
+    bool beginTick();
+
+    // Close the tick started by beginTick()
+    void endTick();
+
+    // Simulation step for every tick, in seconds
+    float getDeltaTime() const { return deltaTime; }
+    uint64_t getTickNumber() const { return tickNumber; }
+
+    // True on every nth tick, for work that runs at a fraction of the rate
+    bool isEveryNthTick(uint32_t n) const { return n <= 1 || tickNumber % n == 0; }
+
+    // Time left until the next tick is due, rounded up to whole milliseconds
+    int getMillisUntilNextTick() const;
+
+    // Times one phase for as long as it is in scope
+    class PhaseTimer {
+    public:
+        PhaseTimer(TickScheduler& scheduler, int phase)
+            : scheduler(scheduler), phase(phase), start(Clock::now()) {}
+        ~PhaseTimer() { scheduler.recordPhase(phase, Clock::now() - start); }
+
+        PhaseTimer(const PhaseTimer&) = delete;
+        PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+    private:
+        TickScheduler& scheduler;
+        int phase;
+        Clock::time_point start;
+    };
+
+    PhaseTimer measure(int phase) { return PhaseTimer(*this, phase); }
+
+    // Log tick and phase stats since the last reset
+    void logStats() const;
+    void resetStats();
+
+private:
+    struct PhaseStats {
+        const char* name = nullptr;
+        uint64_t calls = 0;
+        uint64_t totalNanos = 0;
+        uint64_t maxNanos = 0;
+    };
+
+    Clock::duration period;
+    float deltaTime;
+    int maxCatchUpTicks;
+
+    Clock::time_point nextTick;
+    Clock::time_point tickStart;
+    uint64_t tickNumber = 0;
+
+    PhaseStats phases[MAX_PHASES];
+    int phaseCount = 0;
+
+    // Window stats, cleared by resetStats()
+    Clock::time_point windowStart;
+    uint64_t ticks = 0;
+    uint64_t overruns = 0;
+    uint64_t skippedTicks = 0;
+    uint64_t totalTickNanos = 0;
+    uint64_t maxTickNanos = 0;
+    uint64_t maxLatenessNanos = 0;
+
+    void recordPhase(int phase, Clock::duration elapsed);
+};
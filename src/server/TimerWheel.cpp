@@ -0,0 +1,142 @@
+#include "TimerWheel.h"
+#include <cmath>
+
+TimerWheel::TimerWheel(int tickRateHz)
+    : ticksPerSecond(tickRateHz > 0 ? tickRateHz : 1), currentTick(0), pendingCount(0),
+      slotHeads(SLOT_COUNT, NONE), freeHead(NONE) {}
+
+TimerWheel::TimerId TimerWheel::schedule(double delaySeconds, Callback callback) {
+    double ticks = std::ceil(delaySeconds * ticksPerSecond);
+    uint64_t delayTicks = ticks > 0.0 ? static_cast<uint64_t>(ticks) : 0;
+    return scheduleTicks(delayTicks, std::move(callback));
+}
+
+TimerWheel::TimerId TimerWheel::scheduleTicks(uint64_t delayTicks, Callback callback) {
+    uint32_t index;
+    if (freeHead != NONE) {
+        index = freeHead;
+        freeHead = nodes[index].next;
+    } else {
+        index = static_cast<uint32_t>(nodes.size());
+        nodes.emplace_back();
+    }
+
+    Node& node = nodes[index];
+    node.expires = currentTick + (delayTicks > 0 ? delayTicks : 1);
+    node.callback = std::move(callback);
+    insert(index);
+    pendingCount++;
+
+    // Index + 1 so that no live timer has id 0
+    return (static_cast<uint64_t>(node.generation) << 32) | (index + 1);
+}
+
+bool TimerWheel::cancel(TimerId id) {
+    if (id == 0) return false;
+
+    uint32_t index = static_cast<uint32_t>(id & 0xFFFFFFFFu) - 1;
+    if (index >= nodes.size()) return false;
+
+    Node& node = nodes[index];
+    if (node.slot == NONE || node.generation != static_cast<uint32_t>(id >> 32)) return false;
+
+    unlink(index);
+    release(index);
+    return true;
+}
+
+void TimerWheel::advance() {
+    currentTick++;
+
+    // Each time a level wraps, the next slot of the level above comes due
+    for (int level = 1; level < LEVELS; level++) {
+        int shift = LEVEL0_BITS + (level - 1) * LEVEL_BITS;
+        if ((currentTick & ((1ull << shift) - 1)) != 0) break;
+        cascade(level);
+    }
+
+    uint32_t slot = static_cast<uint32_t>(currentTick & (LEVEL0_SLOTS - 1));
+    while (slotHeads[slot] != NONE) {
+        uint32_t index = slotHeads[slot];
+        unlink(index);
+
+        // Parked beyond the wheel's range: not due yet
+        if (nodes[index].expires > currentTick) {
+            insert(index);
+            continue;
+        }
+
+        // Free the node before running the callback, which may schedule
+        // into it or try to cancel itself
+        Callback callback = std::move(nodes[index].callback);
+        release(index);
+        callback();
+    }
+}
+
+void TimerWheel::insert(uint32_t index) {
+    Node& node = nodes[index];
+    uint64_t expires = node.expires;
+    uint64_t delta = expires > currentTick ? expires - currentTick : 0;
+    if (delta > MAX_DELAY_TICKS) {
+        delta = MAX_DELAY_TICKS;
+        expires = currentTick + delta;
+    }
+
+    uint32_t slot;
+    if (delta < LEVEL0_SLOTS) {
+        slot = static_cast<uint32_t>(expires & (LEVEL0_SLOTS - 1));
+    } else {
+        int level = 1;
+        int shift = LEVEL0_BITS;
+        while (level < LEVELS - 1 && delta >= (1ull << (shift + LEVEL_BITS))) {
+            level++;
+            shift += LEVEL_BITS;
+        }
+        slot = LEVEL0_SLOTS + (level - 1) * LEVEL_SLOTS +
+               static_cast<uint32_t>((expires >> shift) & (LEVEL_SLOTS - 1));
+    }
+
+    node.slot = slot;
+    node.prev = NONE;
+    node.next = slotHeads[slot];
+    if (node.next != NONE) nodes[node.next].prev = index;
+    slotHeads[slot] = index;
+}
+
+void TimerWheel::unlink(uint32_t index) {
+    Node& node = nodes[index];
+    if (node.prev != NONE) {
+        nodes[node.prev].next = node.next;
+    } else {
+        slotHeads[node.slot] = node.next;
+    }
+    if (node.next != NONE) nodes[node.next].prev = node.prev;
+    node.prev = NONE;
+    node.next = NONE;
+}
+
+void TimerWheel::release(uint32_t index) {
+    Node& node = nodes[index];
+    node.slot = NONE;
+    node.generation++;
+    node.callback = nullptr;
+    node.next = freeHead;
+    freeHead = index;
+    pendingCount--;
+}
+
+void TimerWheel::cascade(int level) {
+    int shift = LEVEL0_BITS + (level - 1) * LEVEL_BITS;
+    uint32_t slot = LEVEL0_SLOTS + (level - 1) * LEVEL_SLOTS +
+                    static_cast<uint32_t>((currentTick >> shift) & (LEVEL_SLOTS - 1));
+
+    // Everything here now expires within one turn of the level below
+    uint32_t index = slotHeads[slot];
+    slotHeads[slot] = NONE;
+    while (index != NONE) {
+        uint32_t next = nodes[index].next;
+        insert(index);
+        index = next;
+    }
+}
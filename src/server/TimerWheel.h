@@ -0,0 +1,74 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Hierarchical timing wheel for the server's timeouts (session expiry, raid
+// end, queue timeouts, lobby cleanup). advance() is called once per
+// simulation tick and only touches the slot that is due, so its cost
+// follows the timers that fire rather than how many are pending; schedule()
+// and cancel() are O(1).
+//
+// Four levels: 256 one-tick slots, then three levels of 64 slots, each slot
+// spanning a full turn of the level below - 2^26 ticks (about 13 days at
+// 60 Hz). When a higher-level slot comes due, its timers are redistributed
+// into the levels below (cascading). Longer delays are parked at the top
+// level and rescheduled when they surface.
+//
+// Timers live in a pool of intrusive list nodes reused through a free list;
+// ids carry a generation, so cancelling a timer that has already fired (or
+// whose node was reused) is a harmless no-op. Callbacks run inside advance()
+// and may schedule or cancel timers, including their own.
+class TimerWheel {
+public:
+    using TimerId = uint64_t;       // 0 = no timer
+    using Callback = std::function<void()>;
+
+    explicit TimerWheel(int tickRateHz);
+
+    // Run `callback` once, `delaySeconds` from now (at least one tick)
+    TimerId schedule(double delaySeconds, Callback callback);
+    TimerId scheduleTicks(uint64_t delayTicks, Callback callback);
+
+    // Drop a pending timer. False if it already fired or was cancelled.
+    bool cancel(TimerId id);
+
+    // Move time forward one tick and run the timers that came due
+    void advance();
+
+    uint64_t getTick() const { return currentTick; }
+    size_t getPendingCount() const { return pendingCount; }
+
+private:
+    static constexpr int LEVEL0_BITS = 8;
+    static constexpr int LEVEL_BITS = 6;
+    static constexpr int LEVELS = 4;
+    static constexpr uint32_t LEVEL0_SLOTS = 1u << LEVEL0_BITS;
+    static constexpr uint32_t LEVEL_SLOTS = 1u << LEVEL_BITS;
+    static constexpr uint32_t SLOT_COUNT = LEVEL0_SLOTS + (LEVELS - 1) * LEVEL_SLOTS;
+    static constexpr uint64_t MAX_DELAY_TICKS = (1ull << (LEVEL0_BITS + (LEVELS - 1) * LEVEL_BITS)) - 1;
+    static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+    struct Node {
+        uint64_t expires = 0;       // Absolute tick
+        uint32_t generation = 0;
+        uint32_t slot = NONE;       // NONE while free
+        uint32_t prev = NONE;
+        uint32_t next = NONE;       // Also links the free list
+        Callback callback;
+    };
+
+    double ticksPerSecond;
+    uint64_t currentTick;
+    size_t pendingCount;
+
+    std::vector<Node> nodes;
+    std::vector<uint32_t> slotHeads;    // Level 0 first, then each higher level
+    uint32_t freeHead;
+
+    void insert(uint32_t index);
+    void unlink(uint32_t index);
+    void release(uint32_t index);
+    void cascade(int level);
+};
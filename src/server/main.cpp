@@ -1,4 +1,5 @@
 #include "network/NetworkServer.h"
+#include "network/PacketDispatcher.h"
 #include "managers/AuthManager.h"
 #include "managers/LobbyManager.h"
 #include "managers/FriendManager.h"
@@ -6,12 +7,43 @@
 #include "managers/PersistenceManager.h"
 #include "managers/MerchantManager.h"
 #include "../common/ItemDatabase.h"
-#include <iostream>
+#include "../common/Logger.h"
+#include "../common/PlayerMovement.h"
+#include "TickScheduler.h"
+#include "TimerWheel.h"
 #include <thread>
 #include <chrono>
 #include <cstring>
+#include <unordered_map>
+
+namespace {
+    LogCategory serverLog("Server");
+
+    // Rejected packets are remote-triggered; a misbehaving client must not
+    // flood the log
+    LogCategory rejectLog("PacketReject", 20);
+
+    // A client sending with a dead session hears about it at most this often
+    constexpr uint64_t INVALID_SESSION_NOTICE_INTERVAL = 1;    // Seconds
+    std::unordered_map<uint64_t, uint64_t> lastInvalidSessionNotice;   // clientId -> timestamp
+}
+
+// Simulation (raid) tick rate and the lower rate for lobby/social work
+constexpr int SIMULATION_TICK_RATE = 60;
+constexpr int LOBBY_TICK_RATE = 10;
+
+// Raids apply one client movement command per simulation tick
+static_assert(SIMULATION_TICK_RATE == MOVEMENT_TICK_RATE, "movement commands are one simulation tick long");
+
+// World snapshots sent to each raid player per second
+constexpr int SNAPSHOT_RATE = 20;
+
+// Clients draw each snapshot as it arrives, so what a player aims at is on
+// average half a snapshot interval older than its arrival
+constexpr float SNAPSHOT_VIEW_DELAY = 0.5f / SNAPSHOT_RATE;
 
 // Global managers
+TimerWheel* g_timerWheel = nullptr;
 NetworkServer* g_networkServer = nullptr;
 AuthManager* g_authManager = nullptr;
 LobbyManager* g_lobbyManager = nullptr;
@@ -19,80 +51,250 @@ FriendManager* g_friendManager = nullptr;
 MatchManager* g_matchManager = nullptr;
 PersistenceManager* g_persistenceManager = nullptr;
 MerchantManager* g_merchantManager = nullptr;
+PacketDispatcher* g_packetDispatcher = nullptr;
 
 // Forward declarations
 void processPackets();
-void handleLoginRequest(uint64_t clientId, const std::vector<uint8_t>& payload);
-void handleRegisterRequest(uint64_t clientId, const std::vector<uint8_t>& payload);
-void handleLobbyCreate(uint64_t clientId, uint64_t sessionToken, const std::vector<uint8_t>& payload);
-void handleLobbyJoin(uint64_t clientId, uint64_t sessionToken, const std::vector<uint8_t>& payload);
-void handleLobbyLeave(uint64_t clientId, uint64_t sessionToken);
-void handleLobbyReady(uint64_t clientId, uint64_t sessionToken, const std::vector<uint8_t>& payload);
-void handleLobbyStartQueue(uint64_t clientId, uint64_t sessionToken);
-void handleFriendRequest(uint64_t clientId, uint64_t sessionToken, const std::vector<uint8_t>& payload);
-void handleFriendAccept(uint64_t clientId, uint64_t sessionToken, const std::vector<uint8_t>& payload);
-void handleMerchantBuy(uint64_t clientId, uint64_t sessionToken, const std::vector<uint8_t>& payload);
-void handleMerchantSell(uint64_t clientId, uint64_t sessionToken, const std::vector<uint8_t>& payload);
+void handleLoginRequest(const PacketContext& ctx, const LoginRequest& req);
+void handleRegisterRequest(const PacketContext& ctx, const RegisterRequest& req);
+void handleLogout(const PacketContext& ctx);
+void handleLobbyCreate(const PacketContext& ctx, const LobbyCreateRequest& req);
+void handleLobbyJoin(const PacketContext& ctx, const LobbyJoinRequest& req);
+void handleLobbyLeave(const PacketContext& ctx);
+void handleLobbyKick(const PacketContext& ctx, const LobbyKick& req);
+void handleLobbyReady(const PacketContext& ctx, const LobbyReady& req);
+void handleLobbyStartQueue(const PacketContext& ctx);
+void handleLobbyStopQueue(const PacketContext& ctx);
+void handleFriendRequest(const PacketContext& ctx, const FriendRequest& req);
+void handleFriendAccept(const PacketContext& ctx, const FriendAccept& req);
+void handleFriendDecline(const PacketContext& ctx, const FriendAccept& req);
+void handleFriendRemove(const PacketContext& ctx, const FriendRemove& req);
+void handlePlayerInput(const PacketContext& ctx, const PlayerInput& req);
+void handlePlayerShoot(const PacketContext& ctx, const PlayerShoot& req);
+void handleSnapshotAck(const PacketContext& ctx, const SnapshotAck& req);
+void handleMerchantBuy(const PacketContext& ctx, const MerchantBuy& req);
+void handleMerchantSell(const PacketContext& ctx, const MerchantSell& req);
+void handleHeartbeat(const PacketContext& ctx);
+void handleDisconnect(const PacketContext& ctx);
+void handleSessionEnd(uint64_t clientId);
+bool validatePacketSession(uint64_t sessionToken, uint64_t& outAccountId);
+void rejectPacket(const PacketView& packet, PacketReject reason);
 void updateMatchmaking();
+void replicateSnapshots(uint32_t tick);
 void sendLobbyUpdate(uint64_t lobbyId);
 
-int main() {
-    std::cout << "========================================" << std::endl;
-    std::cout << "  EXTRACTION SHOOTER - Dedicated Server " << std::endl;
-    std::cout << "========================================" << std::endl;
-    std::cout << std::endl;
+// Packet routes: payload struct and session requirement per type. The table
+// is built at compile time; add a handler by adding a line here.
+constexpr PacketRoute PACKET_ROUTES[] = {
+    makeRoute<PacketType::LOGIN_REQUEST,     PacketAuth::NONE,    LoginRequest,       &handleLoginRequest>(),
+    makeRoute<PacketType::REGISTER_REQUEST,  PacketAuth::NONE,    RegisterRequest,    &handleRegisterRequest>(),
+    makeRoute<PacketType::LOGOUT,            PacketAuth::SESSION,                     &handleLogout>(),
+    makeRoute<PacketType::LOBBY_CREATE,      PacketAuth::SESSION, LobbyCreateRequest, &handleLobbyCreate>(),
+    makeRoute<PacketType::LOBBY_JOIN,        PacketAuth::SESSION, LobbyJoinRequest,   &handleLobbyJoin>(),
+    makeRoute<PacketType::LOBBY_LEAVE,       PacketAuth::SESSION,                     &handleLobbyLeave>(),
+    makeRoute<PacketType::LOBBY_KICK,        PacketAuth::SESSION, LobbyKick,          &handleLobbyKick>(),
+    makeRoute<PacketType::LOBBY_READY,       PacketAuth::SESSION, LobbyReady,         &handleLobbyReady>(),
+    makeRoute<PacketType::LOBBY_START_QUEUE, PacketAuth::SESSION,                     &handleLobbyStartQueue>(),
+    makeRoute<PacketType::LOBBY_STOP_QUEUE,  PacketAuth::SESSION,                     &handleLobbyStopQueue>(),
+    makeRoute<PacketType::FRIEND_REQUEST,    PacketAuth::SESSION, FriendRequest,      &handleFriendRequest>(),
+    makeRoute<PacketType::FRIEND_ACCEPT,     PacketAuth::SESSION, FriendAccept,       &handleFriendAccept>(),
+    makeRoute<PacketType::FRIEND_DECLINE,    PacketAuth::SESSION, FriendAccept,       &handleFriendDecline>(),
+    makeRoute<PacketType::FRIEND_REMOVE,     PacketAuth::SESSION, FriendRemove,       &handleFriendRemove>(),
+    makeRoute<PacketType::PLAYER_INPUT,      PacketAuth::SESSION, PlayerInput,        &handlePlayerInput>(),
+    makeRoute<PacketType::PLAYER_SHOOT,      PacketAuth::SESSION, PlayerShoot,        &handlePlayerShoot>(),
+    makeRoute<PacketType::SNAPSHOT_ACK,      PacketAuth::SESSION, SnapshotAck,        &handleSnapshotAck>(),
+    makeRoute<PacketType::MERCHANT_BUY,      PacketAuth::SESSION, MerchantBuy,        &handleMerchantBuy>(),
+    makeRoute<PacketType::MERCHANT_SELL,     PacketAuth::SESSION, MerchantSell,       &handleMerchantSell>(),
+    makeRoute<PacketType::HEARTBEAT,         PacketAuth::NONE,                        &handleHeartbeat>(),
+    makeRoute<PacketType::DISCONNECT,        PacketAuth::NONE,                        &handleDisconnect>(),
+};
+
+constexpr PacketDispatchTable PACKET_DISPATCH_TABLE = buildDispatchTable(PACKET_ROUTES);
+
+int main(int argc, char* argv[]) {
+    // --capture <file>      record inbound traffic while serving
+    // --replay <file>       serve a capture instead of sockets, then exit
+    // --replay-fast         replay as fast as possible instead of at recorded speed
+    // --compression-dictionary <file>   compress against a trained dictionary (compressbench --train)
+    // --no-compression      send every payload as is
+    std::string capturePath;
+    std::string replayPath;
+    std::string dictionaryPath;
+    bool replayRealtime = true;
+    bool compression = true;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--capture" && i + 1 < argc) {
+            capturePath = argv[++i];
+        } else if (arg == "--replay" && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else if (arg == "--replay-fast") {
+            replayRealtime = false;
+        } else if (arg == "--compression-dictionary" && i + 1 < argc) {
+            dictionaryPath = argv[++i];
+        } else if (arg == "--no-compression") {
+            compression = false;
+        } else {
+            LOG_WARN(serverLog, "Ignoring unknown argument: {}", arg);
+        }
+    }
+
+    LOG_INFO(serverLog, "========================================");
+    LOG_INFO(serverLog, "  EXTRACTION SHOOTER - Dedicated Server ");
+    LOG_INFO(serverLog, "========================================");
 
     // Initialize item database
     auto& itemDb = ItemDatabase::getInstance();
-    std::cout << "[Server] Item database initialized" << std::endl;
+    LOG_INFO(serverLog, "Item database initialized");
 
     // Create managers
+    g_timerWheel = new TimerWheel(SIMULATION_TICK_RATE);
     g_networkServer = new NetworkServer();
-    g_authManager = new AuthManager();
+    g_authManager = new AuthManager(g_timerWheel);
     g_persistenceManager = new PersistenceManager();
-    g_lobbyManager = new LobbyManager();
-    g_matchManager = new MatchManager();
+    g_lobbyManager = new LobbyManager(g_timerWheel, g_authManager);
+    g_matchManager = new MatchManager(g_timerWheel);
     g_friendManager = new FriendManager(g_authManager, g_lobbyManager);
     g_merchantManager = new MerchantManager(g_persistenceManager);
+    g_packetDispatcher = new PacketDispatcher(PACKET_DISPATCH_TABLE, &validatePacketSession, &rejectPacket);
+    g_authManager->setSessionEndHandler(&handleSessionEnd);
 
-    // Start server
-    if (!g_networkServer->start(7777)) {
-        std::cout << "[Server] Failed to start server!" << std::endl;
+    if (!g_authManager->isReady()) {
+        LOG_ERROR(serverLog, "Account storage is unusable; fix or restore the files in Server/ and restart");
+        return 1;
+    }
+
+    std::string errorMsg;
+    g_networkServer->setCompressionEnabled(compression);
+    if (!dictionaryPath.empty() && !g_networkServer->loadCompressionDictionary(dictionaryPath, errorMsg)) {
+        LOG_ERROR(serverLog, "Failed to load compression dictionary: {}", errorMsg);
         return 1;
     }
 
-    std::cout << "[Server] Server is running on port 7777" << std::endl;
-    std::cout << "[Server] Press Ctrl+C to shutdown" << std::endl;
-    std::cout << std::endl;
+    if (!replayPath.empty()) {
+        // Replays run the full manager stack and write its data files:
+        // run them from a scratch copy of the server's data directory
+        if (!g_networkServer->startReplay(replayPath, replayRealtime, errorMsg)) {
+            LOG_ERROR(serverLog, "Failed to start replay: {}", errorMsg);
+            return 1;
+        }
+    } else {
+        // Start server; socket I/O runs on its own threads, handlers stay here
+        unsigned int ioThreads = std::thread::hardware_concurrency() / 2;
+        if (ioThreads == 0) ioThreads = 1;
+        if (!g_networkServer->start(7777, static_cast<int>(ioThreads))) {
+            LOG_ERROR(serverLog, "Failed to start server!");
+            return 1;
+        }
+
+        if (!capturePath.empty() && !g_networkServer->startCapture(capturePath, errorMsg)) {
+            LOG_ERROR(serverLog, "Failed to start capture: {}", errorMsg);
+            return 1;
+        }
+
+        LOG_INFO(serverLog, "Server is running on port 7777");
+        LOG_INFO(serverLog, "Press Ctrl+C to shutdown");
+    }
+
+    // Main loop: simulation ticks on a fixed timeline; between ticks the
+    // loop wakes on network activity to handle packets right away
+    TickScheduler scheduler(SIMULATION_TICK_RATE);
+    const int networkPhase = scheduler.addPhase("network");
+    const int dispatchPhase = scheduler.addPhase("dispatch");
+    const int timerPhase = scheduler.addPhase("timers");
+    const int matchmakingPhase = scheduler.addPhase("matchmaking");
+    const int matchUpdatePhase = scheduler.addPhase("match update");
+    const int replicationPhase = scheduler.addPhase("replication");
+    const int flushPhase = scheduler.addPhase("flush");
 
-    // Main loop
     bool running = true;
-    auto lastTime = std::chrono::high_resolution_clock::now();
+    auto lastStatsTime = TickScheduler::Clock::now();
 
     while (running) {
-        auto currentTime = std::chrono::high_resolution_clock::now();
-        float deltaTime = std::chrono::duration<float>(currentTime - lastTime).count();
-        lastTime = currentTime;
+        bool tick = scheduler.beginTick();
 
         // Update network
-        g_networkServer->update();
+        {
+            auto timer = scheduler.measure(networkPhase);
+            g_networkServer->update();
+        }
 
         // Process packets
-        processPackets();
+        {
+            auto timer = scheduler.measure(dispatchPhase);
+            processPackets();
+        }
 
-        // Update matchmaking
-        updateMatchmaking();
+        if (tick) {
+            // Session expiry, raid end, queue timeouts, lobby cleanup. Ticks
+            // the scheduler skipped after a stall still count, so timers
+            // keep to wall time.
+            {
+                auto timer = scheduler.measure(timerPhase);
+                while (g_timerWheel->getTick() < scheduler.getTickNumber()) {
+                    g_timerWheel->advance();
+                }
+            }
 
-        // Update matches
-        g_matchManager->update();
+            // Lobby and social work runs at a lower rate than the simulation
+            if (scheduler.isEveryNthTick(SIMULATION_TICK_RATE / LOBBY_TICK_RATE)) {
+                auto timer = scheduler.measure(matchmakingPhase);
+                updateMatchmaking();
+            }
 
-        // Sleep to avoid 100% CPU usage
-        std::this_thread::sleep_for(std::chrono::milliseconds(16));  // ~60 FPS
+            // Update matches
+            {
+                auto timer = scheduler.measure(matchUpdatePhase);
+                g_matchManager->update(1.0f / SIMULATION_TICK_RATE);
+            }
+
+            // Replicate raid state at the snapshot rate
+            if (scheduler.isEveryNthTick(SIMULATION_TICK_RATE / SNAPSHOT_RATE)) {
+                auto timer = scheduler.measure(replicationPhase);
+                replicateSnapshots(static_cast<uint32_t>(scheduler.getTickNumber()));
+            }
+        }
+
+        // Write everything queued this pass, coalesced per client
+        {
+            auto timer = scheduler.measure(flushPhase);
+            g_networkServer->flushOutbound();
+        }
+
+        if (tick) {
+            scheduler.endTick();
+        }
+
+        if (g_networkServer->isReplayFinished()) {
+            running = false;
+        }
+
+        // Report tick, handler and network stats once a minute
+        auto now = TickScheduler::Clock::now();
+        if (now - lastStatsTime >= std::chrono::seconds(60)) {
+            scheduler.logStats();
+            scheduler.resetStats();
+            g_packetDispatcher->logStats();
+            g_packetDispatcher->resetStats();
+            g_networkServer->logNetworkStats();
+            lastStatsTime = now;
+        }
+
+        // Sleep until the next tick, waking early when network activity arrives
+        g_networkServer->waitForActivity(scheduler.getMillisUntilNextTick());
     }
 
     // Cleanup
-    std::cout << "[Server] Shutting down..." << std::endl;
+    LOG_INFO(serverLog, "Shutting down...");
+
+    if (g_networkServer->isReplaying()) {
+        g_networkServer->logReplayStats();
+        scheduler.logStats();
+    }
+    g_packetDispatcher->logStats();
+    g_networkServer->logNetworkStats();
 
+    delete g_packetDispatcher;
     delete g_merchantManager;
     delete g_friendManager;
     delete g_matchManager;
@@ -100,83 +302,62 @@ int main() {
     delete g_persistenceManager;
     delete g_authManager;
     delete g_networkServer;
+    delete g_timerWheel;
 
-    std::cout << "[Server] Shutdown complete" << std::endl;
+    LOG_INFO(serverLog, "Shutdown complete");
+    Logger::shutdown();
 
     return 0;
 }
 
 void processPackets() {
-    auto packets = g_networkServer->getReceivedPackets();
+    // Reused every tick; swapping with the server's queue keeps both capacities
+    static std::vector<PacketView> packets;
+    g_networkServer->getReceivedPackets(packets);
 
     for (const auto& packet : packets) {
-        switch (packet.type) {
-            case PacketType::LOGIN_REQUEST:
-                handleLoginRequest(packet.clientId, packet.payload);
-                break;
-
-            case PacketType::REGISTER_REQUEST:
-                handleRegisterRequest(packet.clientId, packet.payload);
-                break;
-
-            case PacketType::LOBBY_CREATE:
-                handleLobbyCreate(packet.clientId, packet.sessionToken, packet.payload);
-                break;
-
-            case PacketType::LOBBY_JOIN:
-                handleLobbyJoin(packet.clientId, packet.sessionToken, packet.payload);
-                break;
-
-            case PacketType::LOBBY_LEAVE:
-                handleLobbyLeave(packet.clientId, packet.sessionToken);
-                break;
-
-            case PacketType::LOBBY_READY:
-                handleLobbyReady(packet.clientId, packet.sessionToken, packet.payload);
-                break;
-
-            case PacketType::LOBBY_START_QUEUE:
-                handleLobbyStartQueue(packet.clientId, packet.sessionToken);
-                break;
+        g_packetDispatcher->dispatch(packet);
+    }
 
-            case PacketType::FRIEND_REQUEST:
-                handleFriendRequest(packet.clientId, packet.sessionToken, packet.payload);
-                break;
+    // Return payload slabs to the pool before the next network update
+    packets.clear();
+}
 
-            case PacketType::FRIEND_ACCEPT:
-                handleFriendAccept(packet.clientId, packet.sessionToken, packet.payload);
-                break;
+bool validatePacketSession(uint64_t sessionToken, uint64_t& outAccountId) {
+    return g_authManager->validateSession(sessionToken, outAccountId);
+}
 
-            case PacketType::MERCHANT_BUY:
-                handleMerchantBuy(packet.clientId, packet.sessionToken, packet.payload);
-                break;
+void rejectPacket(const PacketView& packet, PacketReject reason) {
+    switch (reason) {
+        case PacketReject::UNHANDLED:
+            LOG_WARN(rejectLog, "Unhandled packet type {} from client {}", static_cast<int>(packet.type), packet.clientId);
+            break;
 
-            case PacketType::MERCHANT_SELL:
-                handleMerchantSell(packet.clientId, packet.sessionToken, packet.payload);
-                break;
+        case PacketReject::MALFORMED:
+            LOG_WARN(rejectLog, "Malformed {} payload from client {}", packetTypeToString(packet.type), packet.clientId);
+            break;
 
-            case PacketType::DISCONNECT:
-                g_authManager->handleClientDisconnect(packet.clientId);
+        case PacketReject::INVALID_SESSION: {
+            uint64_t now = getCurrentTimestamp();
+            auto sent = lastInvalidSessionNotice.find(packet.clientId);
+            if (sent != lastInvalidSessionNotice.end() && now < sent->second + INVALID_SESSION_NOTICE_INTERVAL) {
                 break;
+            }
+            lastInvalidSessionNotice[packet.clientId] = now;
 
-            default:
-                std::cout << "[Server] Unhandled packet type: " << static_cast<int>(packet.type) << std::endl;
-                break;
+            ErrorResponse err;
+            err.errorCode = 403;
+            strncpy_s(err.errorMessage, "Invalid session", sizeof(err.errorMessage));
+            g_networkServer->sendMessage(packet.clientId, PacketType::ERROR_RESPONSE, err);
+            break;
         }
     }
 }
 
-void handleLoginRequest(uint64_t clientId, const std::vector<uint8_t>& payload) {
-    if (payload.size() < sizeof(LoginRequest)) {
-        std::cout << "[Server] Invalid LOGIN_REQUEST payload size" << std::endl;
-        return;
-    }
-
-    LoginRequest req;
-    memcpy(&req, payload.data(), sizeof(LoginRequest));
-
-    std::string username(req.username);
-    std::string passwordHash(req.passwordHash);
+void handleLoginRequest(const PacketContext& ctx, const LoginRequest& req) {
+    uint64_t clientId = ctx.clientId;
+    std::string username(req.username, strnlen(req.username, sizeof(req.username)));
+    std::string passwordHash(req.passwordHash, strnlen(req.passwordHash, sizeof(req.passwordHash)));
 
     LoginResponse resp;
     uint64_t accountId, sessionToken;
@@ -193,31 +374,27 @@ void handleLoginRequest(uint64_t clientId, const std::vector<uint8_t>& payload)
             g_persistenceManager->createPlayerData(accountId, username);
         }
 
-        std::cout << "[Server] Login successful: " << username << std::endl;
+        // Gameplay datagrams from this session now reach the client's handlers
+        g_networkServer->bindDatagramSession(clientId, sessionToken);
+
+        LOG_INFO(serverLog, "Login successful: {}", username);
     } else {
         resp.success = false;
         resp.accountId = 0;
         resp.sessionToken = 0;
         strncpy_s(resp.errorMessage, errorMsg.c_str(), sizeof(resp.errorMessage));
 
-        std::cout << "[Server] Login failed: " << errorMsg << std::endl;
+        LOG_WARN(serverLog, "Login failed: {}", errorMsg);
     }
 
-    g_networkServer->sendPacket(clientId, PacketType::LOGIN_RESPONSE, &resp, static_cast<uint32_t>(sizeof(resp)));
+    g_networkServer->sendMessage(clientId, PacketType::LOGIN_RESPONSE, resp);
 }
 
-void handleRegisterRequest(uint64_t clientId, const std::vector<uint8_t>& payload) {
-    if (payload.size() < sizeof(RegisterRequest)) {
-        std::cout << "[Server] Invalid REGISTER_REQUEST payload size" << std::endl;
-        return;
-    }
-
-    RegisterRequest req;
-    memcpy(&req, payload.data(), sizeof(RegisterRequest));
-
-    std::string username(req.username);
-    std::string passwordHash(req.passwordHash);
-    std::string email(req.email);
+void handleRegisterRequest(const PacketContext& ctx, const RegisterRequest& req) {
+    uint64_t clientId = ctx.clientId;
+    std::string username(req.username, strnlen(req.username, sizeof(req.username)));
+    std::string passwordHash(req.passwordHash, strnlen(req.passwordHash, sizeof(req.passwordHash)));
+    std::string email(req.email, strnlen(req.email, sizeof(req.email)));
 
     RegisterResponse resp;
     uint64_t accountId;
@@ -231,42 +408,36 @@ void handleRegisterRequest(uint64_t clientId, const std::vector<uint8_t>& payloa
         // Create player data
         g_persistenceManager->createPlayerData(accountId, username);
 
-        std::cout << "[Server] Registration successful: " << username << std::endl;
+        LOG_INFO(serverLog, "Registration successful: {}", username);
     } else {
         resp.success = false;
         resp.accountId = 0;
         strncpy_s(resp.errorMessage, errorMsg.c_str(), sizeof(resp.errorMessage));
 
-        std::cout << "[Server] Registration failed: " << errorMsg << std::endl;
+        LOG_WARN(serverLog, "Registration failed: {}", errorMsg);
     }
 
-    g_networkServer->sendPacket(clientId, PacketType::REGISTER_RESPONSE, &resp, static_cast<uint32_t>(sizeof(resp)));
+    g_networkServer->sendMessage(clientId, PacketType::REGISTER_RESPONSE, resp);
 }
 
-void handleLobbyCreate(uint64_t clientId, uint64_t sessionToken, const std::vector<uint8_t>& payload) {
-    // Validate session
-    uint64_t accountId;
-    if (!g_authManager->validateSession(sessionToken, accountId)) {
-        ErrorResponse err;
-        err.errorCode = 403;
-        strncpy_s(err.errorMessage, "Invalid session", sizeof(err.errorMessage));
-        g_networkServer->sendPacket(clientId, PacketType::ERROR_RESPONSE, &err, static_cast<uint32_t>(sizeof(err)));
-        return;
-    }
+void handleLogout(const PacketContext& ctx) {
+    // Unbinds the datagram session through handleSessionEnd
+    g_authManager->logout(ctx.packet.sessionToken);
+}
 
-    if (payload.size() < sizeof(LobbyCreateRequest)) {
-        std::cout << "[Server] Invalid LOBBY_CREATE payload size" << std::endl;
-        return;
-    }
+void handleSessionEnd(uint64_t clientId) {
+    // Datagrams of an ended session would each fail validation and draw a 403
+    g_networkServer->unbindDatagramSession(clientId);
+}
 
-    LobbyCreateRequest req;
-    memcpy(&req, payload.data(), sizeof(LobbyCreateRequest));
+void handleLobbyCreate(const PacketContext& ctx, const LobbyCreateRequest& req) {
+    std::string lobbyName(req.lobbyName, strnlen(req.lobbyName, sizeof(req.lobbyName)));
 
     LobbyCreateResponse resp;
     uint64_t lobbyId;
     std::string errorMsg;
 
-    if (g_lobbyManager->createLobby(accountId, req.lobbyName, req.maxPlayers, req.isPrivate, lobbyId, errorMsg)) {
+    if (g_lobbyManager->createLobby(ctx.accountId, lobbyName, req.maxPlayers, req.isPrivate, lobbyId, errorMsg)) {
         resp.success = true;
         resp.lobbyId = lobbyId;
         strncpy_s(resp.errorMessage, "", sizeof(resp.errorMessage));
@@ -279,27 +450,14 @@ void handleLobbyCreate(uint64_t clientId, uint64_t sessionToken, const std::vect
         strncpy_s(resp.errorMessage, errorMsg.c_str(), sizeof(resp.errorMessage));
     }
 
-    g_networkServer->sendPacket(clientId, PacketType::LOBBY_CREATE_RESPONSE, &resp, static_cast<uint32_t>(sizeof(resp)));
+    g_networkServer->sendMessage(ctx.clientId, PacketType::LOBBY_CREATE_RESPONSE, resp);
 }
 
-void handleLobbyJoin(uint64_t clientId, uint64_t sessionToken, const std::vector<uint8_t>& payload) {
-    // Validate session
-    uint64_t accountId;
-    if (!g_authManager->validateSession(sessionToken, accountId)) {
-        return;
-    }
-
-    if (payload.size() < sizeof(LobbyJoinRequest)) {
-        return;
-    }
-
-    LobbyJoinRequest req;
-    memcpy(&req, payload.data(), sizeof(LobbyJoinRequest));
-
+void handleLobbyJoin(const PacketContext& ctx, const LobbyJoinRequest& req) {
     LobbyJoinResponse resp;
     std::string errorMsg;
 
-    if (g_lobbyManager->joinLobby(accountId, req.lobbyId, errorMsg)) {
+    if (g_lobbyManager->joinLobby(ctx.accountId, req.lobbyId, errorMsg)) {
         resp.success = true;
         resp.lobbyId = req.lobbyId;
         strncpy_s(resp.errorMessage, "", sizeof(resp.errorMessage));
@@ -312,21 +470,15 @@ void handleLobbyJoin(uint64_t clientId, uint64_t sessionToken, const std::vector
         strncpy_s(resp.errorMessage, errorMsg.c_str(), sizeof(resp.errorMessage));
     }
 
-    g_networkServer->sendPacket(clientId, PacketType::LOBBY_JOIN_RESPONSE, &resp, static_cast<uint32_t>(sizeof(resp)));
+    g_networkServer->sendMessage(ctx.clientId, PacketType::LOBBY_JOIN_RESPONSE, resp);
 }
 
-void handleLobbyLeave(uint64_t clientId, uint64_t sessionToken) {
-    // Validate session
-    uint64_t accountId;
-    if (!g_authManager->validateSession(sessionToken, accountId)) {
-        return;
-    }
-
-    Lobby* lobby = g_lobbyManager->getPlayerLobby(accountId);
+void handleLobbyLeave(const PacketContext& ctx) {
+    Lobby* lobby = g_lobbyManager->getPlayerLobby(ctx.accountId);
     uint64_t lobbyId = lobby ? lobby->lobbyId : 0;
 
     std::string errorMsg;
-    g_lobbyManager->leaveLobby(accountId, errorMsg);
+    g_lobbyManager->leaveLobby(ctx.accountId, errorMsg);
 
     // Send lobby update to remaining members
     if (lobbyId != 0) {
@@ -334,105 +486,122 @@ void handleLobbyLeave(uint64_t clientId, uint64_t sessionToken) {
     }
 }
 
-void handleLobbyReady(uint64_t clientId, uint64_t sessionToken, const std::vector<uint8_t>& payload) {
-    // Validate session
-    uint64_t accountId;
-    if (!g_authManager->validateSession(sessionToken, accountId)) {
-        return;
-    }
+void handleLobbyKick(const PacketContext& ctx, const LobbyKick& req) {
+    Lobby* lobby = g_lobbyManager->getPlayerLobby(ctx.accountId);
+    uint64_t lobbyId = lobby ? lobby->lobbyId : 0;
 
-    if (payload.size() < sizeof(LobbyReady)) {
-        return;
+    std::string errorMsg;
+    if (g_lobbyManager->kickPlayer(ctx.accountId, req.targetAccountId, errorMsg)) {
+        sendLobbyUpdate(lobbyId);
     }
+}
 
-    LobbyReady req;
-    memcpy(&req, payload.data(), sizeof(LobbyReady));
-
+void handleLobbyReady(const PacketContext& ctx, const LobbyReady& req) {
     std::string errorMsg;
-    g_lobbyManager->setReady(accountId, req.ready, errorMsg);
+    g_lobbyManager->setReady(ctx.accountId, req.ready, errorMsg);
 
     // Send lobby update
-    Lobby* lobby = g_lobbyManager->getPlayerLobby(accountId);
+    Lobby* lobby = g_lobbyManager->getPlayerLobby(ctx.accountId);
     if (lobby) {
         sendLobbyUpdate(lobby->lobbyId);
     }
 }
 
-void handleLobbyStartQueue(uint64_t clientId, uint64_t sessionToken) {
-    // Validate session
-    uint64_t accountId;
-    if (!g_authManager->validateSession(sessionToken, accountId)) {
-        return;
+void handleLobbyStartQueue(const PacketContext& ctx) {
+    std::string errorMsg;
+    if (g_lobbyManager->startQueue(ctx.accountId, errorMsg)) {
+        Lobby* lobby = g_lobbyManager->getPlayerLobby(ctx.accountId);
+        if (lobby) {
+            sendLobbyUpdate(lobby->lobbyId);
+        }
     }
+}
 
+void handleLobbyStopQueue(const PacketContext& ctx) {
     std::string errorMsg;
-    if (g_lobbyManager->startQueue(accountId, errorMsg)) {
-        Lobby* lobby = g_lobbyManager->getPlayerLobby(accountId);
+    if (g_lobbyManager->stopQueue(ctx.accountId, errorMsg)) {
+        Lobby* lobby = g_lobbyManager->getPlayerLobby(ctx.accountId);
         if (lobby) {
             sendLobbyUpdate(lobby->lobbyId);
         }
     }
 }
 
-void handleFriendRequest(uint64_t clientId, uint64_t sessionToken, const std::vector<uint8_t>& payload) {
-    // Validate session
-    uint64_t accountId;
-    if (!g_authManager->validateSession(sessionToken, accountId)) {
-        return;
-    }
+void handleFriendRequest(const PacketContext& ctx, const FriendRequest& req) {
+    std::string targetUsername(req.targetUsername, strnlen(req.targetUsername, sizeof(req.targetUsername)));
+    std::string errorMsg;
+    g_friendManager->sendFriendRequest(ctx.accountId, targetUsername, errorMsg);
+}
 
-    if (payload.size() < sizeof(FriendRequest)) {
-        return;
-    }
+void handleFriendAccept(const PacketContext& ctx, const FriendAccept& req) {
+    std::string errorMsg;
+    g_friendManager->acceptFriendRequest(ctx.accountId, req.friendAccountId, errorMsg);
+}
 
-    FriendRequest req;
-    memcpy(&req, payload.data(), sizeof(FriendRequest));
+void handleFriendDecline(const PacketContext& ctx, const FriendAccept& req) {
+    std::string errorMsg;
+    g_friendManager->declineFriendRequest(ctx.accountId, req.friendAccountId, errorMsg);
+}
 
+void handleFriendRemove(const PacketContext& ctx, const FriendRemove& req) {
     std::string errorMsg;
-    g_friendManager->sendFriendRequest(accountId, req.targetUsername, errorMsg);
+    g_friendManager->removeFriend(ctx.accountId, req.friendAccountId, errorMsg);
 }
 
-void handleFriendAccept(uint64_t clientId, uint64_t sessionToken, const std::vector<uint8_t>& payload) {
-    // Validate session
-    uint64_t accountId;
-    if (!g_authManager->validateSession(sessionToken, accountId)) {
-        return;
-    }
+void handlePlayerInput(const PacketContext& ctx, const PlayerInput& req) {
+    g_matchManager->queuePlayerInput(ctx.accountId, req);
+}
 
-    if (payload.size() < sizeof(FriendAccept)) {
-        return;
-    }
+void handlePlayerShoot(const PacketContext& ctx, const PlayerShoot& req) {
+    Match* match = g_matchManager->getPlayerMatch(ctx.accountId);
+    if (!match) return;
 
-    FriendAccept req;
-    memcpy(&req, payload.data(), sizeof(FriendAccept));
+    // The world the shooter aimed at left the server a round trip plus the
+    // snapshot's age before the shot got here
+    float viewDelay = g_networkServer->getRttMicros(ctx.clientId) / 1000000.0f + SNAPSHOT_VIEW_DELAY;
 
-    std::string errorMsg;
-    g_friendManager->acceptFriendRequest(accountId, req.friendAccountId, errorMsg);
-}
+    ShotResult result;
+    if (!g_matchManager->playerShoot(ctx.accountId, req, viewDelay, result) || !result.hit) return;
 
-void handleMerchantBuy(uint64_t clientId, uint64_t sessionToken, const std::vector<uint8_t>& payload) {
-    // Validate session
-    uint64_t accountId;
-    if (!g_authManager->validateSession(sessionToken, accountId)) {
-        return;
+    // Victim and shooter (as a hit confirmation) both hear about the damage
+    PlayerDamage damage;
+    damage.targetAccountId = result.targetAccountId;
+    damage.damage = result.damage;
+    damage.weaponId = req.weaponId;
+
+    uint64_t clientId;
+    if (g_authManager->getClientForAccount(result.targetAccountId, clientId)) {
+        g_networkServer->sendMessage(clientId, PacketType::PLAYER_DAMAGE, damage);
     }
+    g_networkServer->sendMessage(ctx.clientId, PacketType::PLAYER_DAMAGE, damage);
 
-    if (payload.size() < sizeof(MerchantBuy)) {
-        return;
+    if (!result.killed) return;
+
+    PlayerDeath death;
+    death.victimAccountId = result.targetAccountId;
+    death.killerAccountId = ctx.accountId;
+    for (const auto& player : match->players) {
+        if (player.extracted) continue;
+        if (g_authManager->getClientForAccount(player.accountId, clientId)) {
+            g_networkServer->sendMessage(clientId, PacketType::PLAYER_DEATH, death);
+        }
     }
+}
 
-    MerchantBuy req;
-    memcpy(&req, payload.data(), sizeof(MerchantBuy));
+void handleSnapshotAck(const PacketContext& ctx, const SnapshotAck& req) {
+    g_matchManager->acknowledgeSnapshot(ctx.accountId, req.sequence);
+}
 
+void handleMerchantBuy(const PacketContext& ctx, const MerchantBuy& req) {
     MerchantTransactionResponse resp;
     std::string errorMsg;
 
     // Convert itemId to string (simplified)
     std::string itemId = "ak74";  // TODO: Proper ID mapping
 
-    if (g_merchantManager->buyItem(accountId, static_cast<MerchantType>(req.merchantId), itemId, req.quantity, errorMsg)) {
+    if (g_merchantManager->buyItem(ctx.accountId, static_cast<MerchantType>(req.merchantId), itemId, req.quantity, errorMsg)) {
         resp.success = true;
-        PlayerData* playerData = g_persistenceManager->getPlayerData(accountId);
+        PlayerData* playerData = g_persistenceManager->getPlayerData(ctx.accountId);
         resp.newBalance = playerData ? playerData->stats.roubles : 0;
         strncpy_s(resp.errorMessage, "", sizeof(resp.errorMessage));
     } else {
@@ -441,17 +610,47 @@ void handleMerchantBuy(uint64_t clientId, uint64_t sessionToken, const std::vect
         strncpy_s(resp.errorMessage, errorMsg.c_str(), sizeof(resp.errorMessage));
     }
 
-    g_networkServer->sendPacket(clientId, PacketType::MERCHANT_TRANSACTION_RESPONSE, &resp, static_cast<uint32_t>(sizeof(resp)));
+    g_networkServer->sendMessage(ctx.clientId, PacketType::MERCHANT_TRANSACTION_RESPONSE, resp);
 }
 
-void handleMerchantSell(uint64_t clientId, uint64_t sessionToken, const std::vector<uint8_t>& payload) {
-    // Similar to handleMerchantBuy
-    // Implementation omitted for brevity
+void handleMerchantSell(const PacketContext& ctx, const MerchantSell& req) {
+    MerchantTransactionResponse resp;
+    std::string errorMsg;
+
+    // itemId is the stash item's instance ID
+    if (g_merchantManager->sellItem(ctx.accountId, static_cast<MerchantType>(req.merchantId), req.itemId, errorMsg)) {
+        resp.success = true;
+        PlayerData* playerData = g_persistenceManager->getPlayerData(ctx.accountId);
+        resp.newBalance = playerData ? playerData->stats.roubles : 0;
+        strncpy_s(resp.errorMessage, "", sizeof(resp.errorMessage));
+    } else {
+        resp.success = false;
+        resp.newBalance = 0;
+        strncpy_s(resp.errorMessage, errorMsg.c_str(), sizeof(resp.errorMessage));
+    }
+
+    g_networkServer->sendMessage(ctx.clientId, PacketType::MERCHANT_TRANSACTION_RESPONSE, resp);
+}
+
+void handleHeartbeat(const PacketContext& /*ctx*/) {
+    // Keep-alive only; receiving it is enough
+}
+
+void handleDisconnect(const PacketContext& ctx) {
+    g_authManager->handleClientDisconnect(ctx.clientId);
+    lastInvalidSessionNotice.erase(ctx.clientId);
 }
 
 void updateMatchmaking() {
-    // Get queued lobbies
-    const auto& queuedLobbies = g_lobbyManager->getQueuedLobbies();
+    // Lobbies whose queue timed out are back to READY; tell their members
+    static std::vector<uint64_t> expiredQueues;
+    g_lobbyManager->takeExpiredQueues(expiredQueues);
+    for (uint64_t lobbyId : expiredQueues) {
+        sendLobbyUpdate(lobbyId);
+    }
+
+    // Copy: matched lobbies leave the queue while we iterate
+    std::vector<uint64_t> queuedLobbies = g_lobbyManager->getQueuedLobbies();
 
     // For now, create a match for each queued lobby immediately
     for (uint64_t lobbyId : queuedLobbies) {
@@ -469,14 +668,51 @@ void updateMatchmaking() {
             matchFound.matchId = matchId;
             strncpy_s(matchFound.mapName, "Factory", sizeof(matchFound.mapName));
 
+            std::vector<uint64_t> recipients;
             for (const auto& member : lobby->members) {
                 uint64_t clientId;
                 if (g_authManager->getClientForAccount(member.accountId, clientId)) {
-                    g_networkServer->sendPacket(clientId, PacketType::MATCH_FOUND, &matchFound, static_cast<uint32_t>(sizeof(matchFound)));
+                    recipients.push_back(clientId);
                 }
             }
+            g_networkServer->broadcastMessageToClients(recipients, PacketType::MATCH_FOUND, matchFound);
+
+            LOG_INFO(serverLog, "Match created for lobby {}", lobbyId);
+        }
+    }
+}
+
+void replicateSnapshots(uint32_t tick) {
+    static std::vector<uint8_t> buffer(MAX_PACKET_SIZE - sizeof(PacketHeader));
+    constexpr size_t MAX_DATAGRAM_PAYLOAD = MAX_DATAGRAM_SIZE - sizeof(DatagramHeader);
+
+    g_matchManager->captureSnapshots(tick);
+
+    for (uint64_t accountId : g_matchManager->getRaidPlayers()) {
+        uint64_t clientId;
+        if (!g_authManager->getClientForAccount(accountId, clientId)) continue;
+        bool datagram = g_networkServer->hasDatagramAddress(clientId);
+
+        // Tell the client where its inputs so far have put it; superseded
+        // by the next one, so never worth a retransmit
+        PlayerState state;
+        if (g_matchManager->getPlayerState(accountId, state)) {
+            if (datagram) {
+                g_networkServer->sendDatagramMessage(clientId, PacketType::PLAYER_STATE, state);
+            } else {
+                g_networkServer->sendMessage(clientId, PacketType::PLAYER_STATE, state);
+            }
+        }
+
+        size_t size = g_matchManager->encodeSnapshot(accountId, buffer.data(), buffer.size());
+        if (size == 0) continue;
 
-            std::cout << "[Server] Match created for lobby " << lobbyId << std::endl;
+        // Deltas are against acknowledged state, so a lost datagram only
+        // costs its own update; full snapshots too big for one go over TCP
+        if (datagram && size <= MAX_DATAGRAM_PAYLOAD) {
+            g_networkServer->sendDatagram(clientId, PacketType::WORLD_SNAPSHOT, buffer.data(), static_cast<uint32_t>(size));
+        } else {
+            g_networkServer->sendPacket(clientId, PacketType::WORLD_SNAPSHOT, buffer.data(), static_cast<uint32_t>(size));
         }
     }
 }
@@ -499,11 +735,13 @@ void sendLobbyUpdate(uint64_t lobbyId) {
         update.members[i].isOwner = member.isOwner;
     }
 
-    // Send to all members
+    // Send to all members (encoded once, shared by every recipient)
+    std::vector<uint64_t> recipients;
     for (const auto& member : lobby->members) {
         uint64_t clientId;
         if (g_authManager->getClientForAccount(member.accountId, clientId)) {
-            g_networkServer->sendPacket(clientId, PacketType::LOBBY_UPDATE, &update, static_cast<uint32_t>(sizeof(update)));
+            recipients.push_back(clientId);
         }
     }
+    g_networkServer->broadcastMessageToClients(recipients, PacketType::LOBBY_UPDATE, update);
 }
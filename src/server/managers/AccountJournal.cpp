@@ -0,0 +1,456 @@
+#include "AccountJournal.h"
+#include "../../engine/core/Platform.h"
+#include "../../common/Logger.h"
+#include "../../common/Serialization.h"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+
+#ifdef PLATFORM_WINDOWS
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+    LogCategory journalLog("AccountJournal");
+
+    const char SNAPSHOT_MAGIC[8] = { 'T', 'D', 'S', 'A', 'C', 'S', 'N', 0 };
+    const char JOURNAL_MAGIC[8] = { 'T', 'D', 'S', 'A', 'C', 'J', 'R', 0 };
+
+    enum class RecordKind : uint8_t {
+        CREATE = 1,     // Whole account
+        LOGIN = 2       // accountId, lastLogin
+    };
+
+    // Larger than any account the server accepts (fixed-size protocol strings)
+    constexpr size_t MAX_RECORD_SIZE = 1024;
+
+    uint32_t fnv1a(const uint8_t* data, size_t size) {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ data[i]) * 16777619u;
+        }
+        return hash;
+    }
+
+    void writeString(ByteWriter& writer, const std::string& value) {
+        writer.writeVarint(value.size());
+        writer.writeBytes(value.data(), value.size());
+    }
+
+    bool readString(ByteReader& reader, std::string& out) {
+        uint64_t length;
+        if (!reader.readVarint(length) || length > reader.remaining()) return false;
+        out.resize(static_cast<size_t>(length));
+        return reader.readBytes(&out[0], out.size());
+    }
+
+    void encodeCreate(ByteWriter& writer, const Account& account) {
+        writer.writeU8(static_cast<uint8_t>(RecordKind::CREATE));
+        writer.writeVarint(account.accountId);
+        writer.writeVarint(account.created);
+        writer.writeVarint(account.lastLogin);
+        writeString(writer, account.username);
+        writeString(writer, account.passwordHash);
+        writeString(writer, account.email);
+    }
+
+    void appendFramed(std::vector<uint8_t>& out, const uint8_t* payload, size_t size) {
+        JournalRecordHeader header;
+        header.payloadSize = static_cast<uint32_t>(size);
+        header.checksum = fnv1a(payload, size);
+
+        const uint8_t* headerBytes = reinterpret_cast<const uint8_t*>(&header);
+        out.insert(out.end(), headerBytes, headerBytes + sizeof(header));
+        out.insert(out.end(), payload, payload + size);
+    }
+
+    // Unknown kinds are skipped, so older servers can read newer journals
+    bool applyRecord(const uint8_t* payload, size_t size, std::map<uint64_t, Account>& accounts) {
+        ByteReader reader(payload, size);
+        uint8_t kind;
+        if (!reader.readU8(kind)) return false;
+
+        switch (static_cast<RecordKind>(kind)) {
+            case RecordKind::CREATE: {
+                Account account;
+                if (!reader.readVarint(account.accountId) ||
+                    !reader.readVarint(account.created) ||
+                    !reader.readVarint(account.lastLogin) ||
+                    !readString(reader, account.username) ||
+                    !readString(reader, account.passwordHash) ||
+                    !readString(reader, account.email)) {
+                    return false;
+                }
+                // Ids only grow, so the hint makes loading sorted files linear
+                uint64_t accountId = account.accountId;
+                accounts.insert_or_assign(accounts.end(), accountId, std::move(account));
+                return true;
+            }
+            case RecordKind::LOGIN: {
+                uint64_t accountId, lastLogin;
+                if (!reader.readVarint(accountId) || !reader.readVarint(lastLogin)) return false;
+                auto it = accounts.find(accountId);
+                if (it != accounts.end()) it->second.lastLogin = lastLogin;
+                return true;
+            }
+        }
+        return true;
+    }
+
+    // Replay one snapshot or journal file into `accounts`. `validBytes` is
+    // where the last intact record ends. False if the file exists but is
+    // unreadable or not this kind of file; a missing file is empty.
+    bool readAccountFile(const std::string& path, const char* magic, std::map<uint64_t, Account>& accounts,
+                         uint64_t& validBytes, std::string& errorMsg) {
+        validBytes = 0;
+        std::error_code ec;
+        if (!fs::exists(path, ec)) return true;
+
+        uint64_t fileSize = fs::file_size(path, ec);
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (ec || !file) {
+            if (file) std::fclose(file);
+            errorMsg = "Cannot read " + path;
+            return false;
+        }
+
+        // One read of the whole file; parsing from memory is what keeps
+        // startup fast
+        std::vector<uint8_t> data(static_cast<size_t>(fileSize));
+        size_t read = data.empty() ? 0 : std::fread(data.data(), 1, data.size(), file);
+        std::fclose(file);
+        if (read != data.size()) {
+            errorMsg = "Cannot read " + path;
+            return false;
+        }
+
+        AccountFileHeader header;
+        if (data.size() < sizeof(header)) {
+            // Created but never written: treat as empty
+            if (data.empty()) return true;
+            errorMsg = path + " is truncated";
+            return false;
+        }
+        memcpy(&header, data.data(), sizeof(header));
+        if (memcmp(header.magic, magic, sizeof(header.magic)) != 0 || header.version != AccountJournal::VERSION) {
+            errorMsg = path + " is not a version " + std::to_string(AccountJournal::VERSION) + " account file";
+            return false;
+        }
+
+        size_t position = sizeof(header);
+        while (data.size() - position >= sizeof(JournalRecordHeader)) {
+            JournalRecordHeader record;
+            memcpy(&record, data.data() + position, sizeof(record));
+            const uint8_t* payload = data.data() + position + sizeof(record);
+            if (record.payloadSize > data.size() - position - sizeof(record)) break;
+            if (fnv1a(payload, record.payloadSize) != record.checksum) break;
+            if (!applyRecord(payload, record.payloadSize, accounts)) break;
+            position += sizeof(record) + record.payloadSize;
+        }
+
+        validBytes = position;
+        if (position < data.size()) {
+            LOG_WARN(journalLog, "{}: ignoring {} bytes after the last intact record", path, data.size() - position);
+        }
+        return true;
+    }
+
+    bool syncFile(std::FILE* file) {
+        if (std::fflush(file) != 0) return false;
+#ifdef PLATFORM_WINDOWS
+        return _commit(_fileno(file)) == 0;
+#else
+        return fsync(fileno(file)) == 0;
+#endif
+    }
+}
+
+AccountJournal::AccountJournal(const std::string& directory)
+    : snapshotPath(directory + "/accounts.snapshot"),
+      journalPath(directory + "/accounts.journal"),
+      oldJournalPath(directory + "/accounts.journal.old") {}
+
+AccountJournal::~AccountJournal() {
+    stop();
+}
+
+bool AccountJournal::load(std::map<uint64_t, Account>& accounts, std::string& errorMsg) {
+    uint64_t validBytes;
+    if (!readAccountFile(snapshotPath, SNAPSHOT_MAGIC, accounts, validBytes, errorMsg)) return false;
+    if (!readAccountFile(oldJournalPath, JOURNAL_MAGIC, accounts, validBytes, errorMsg)) return false;
+    if (!readAccountFile(journalPath, JOURNAL_MAGIC, accounts, loadedJournalBytes, errorMsg)) return false;
+    loaded = true;
+    return true;
+}
+
+bool AccountJournal::start(std::string& errorMsg) {
+    if (writer.joinable()) return true;
+    if (!loaded) {
+        errorMsg = "Accounts were not loaded; leaving " + journalPath + " untouched";
+        return false;
+    }
+
+    // First start: nothing has created the data directory yet
+    std::error_code ec;
+    fs::create_directories(fs::path(journalPath).parent_path(), ec);
+
+    // Opening cuts off a torn last record, so new records follow the last
+    // intact one
+    journalBytes = loadedJournalBytes;
+    if (!openJournal()) {
+        errorMsg = "Cannot open " + journalPath;
+        return false;
+    }
+
+    stopping = false;
+    writer = std::thread(&AccountJournal::writerMain, this);
+    return true;
+}
+
+void AccountJournal::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeCv.notify_one();
+    if (writer.joinable()) {
+        writer.join();
+    }
+    if (journal) {
+        std::fclose(journal);
+        journal = nullptr;
+    }
+}
+
+void AccountJournal::recordCreate(const Account& account) {
+    uint8_t payload[MAX_RECORD_SIZE];
+    ByteWriter writer(payload, sizeof(payload));
+    encodeCreate(writer, account);
+    if (writer.overflowed()) {
+        LOG_ERROR(journalLog, "Account {} too large to journal", account.accountId);
+        return;
+    }
+    append(payload, writer.size());
+}
+
+void AccountJournal::recordLogin(uint64_t accountId, uint64_t lastLogin) {
+    uint8_t payload[32];
+    ByteWriter writer(payload, sizeof(payload));
+    writer.writeU8(static_cast<uint8_t>(RecordKind::LOGIN));
+    writer.writeVarint(accountId);
+    writer.writeVarint(lastLogin);
+    append(payload, writer.size());
+}
+
+bool AccountJournal::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    uint64_t target = recorded;
+    if (!writer.joinable()) return committed >= target;
+
+    committedCv.wait(lock, [this, target]() { return committed >= target || writeFailing; });
+    return committed >= target;
+}
+
+void AccountJournal::append(const uint8_t* payload, size_t size) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        appendFramed(pending, payload, size);
+        recorded++;
+    }
+    wakeCv.notify_one();
+}
+
+void AccountJournal::writerMain() {
+    // A compaction interrupted by a stop or crash: finish it first
+    std::error_code ec;
+    if (fs::exists(oldJournalPath, ec)) {
+        compact();
+    }
+
+    std::vector<uint8_t> batch;
+    for (;;) {
+        uint64_t target;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeCv.wait(lock, [this]() { return !pending.empty() || stopping; });
+            if (pending.empty()) break;     // Stopping with nothing left
+
+            // Everything recorded while the last commit was syncing goes
+            // out together, under one fsync
+            batch.swap(pending);
+            target = recorded;
+        }
+
+        if (!commit(batch)) {
+            // Put the batch back ahead of anything recorded since and retry
+            // it; nothing counts as committed until it is on disk
+            bool giveUp;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                batch.insert(batch.end(), pending.begin(), pending.end());
+                pending.swap(batch);
+                writeFailing = true;
+                giveUp = stopping;
+                if (giveUp) {
+                    LOG_ERROR(journalLog, "Stopping with {} account changes not on disk", recorded - committed);
+                }
+            }
+            batch.clear();
+            committedCv.notify_all();
+            if (giveUp) break;
+
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeCv.wait_for(lock, std::chrono::milliseconds(RETRY_MILLIS), [this]() { return stopping; });
+            continue;
+        }
+        batch.clear();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            committed = target;
+            writeFailing = false;
+        }
+        committedCv.notify_all();
+
+        if (journalBytes >= compactAt) {
+            rotate();
+        }
+    }
+}
+
+void AccountJournal::rotate() {
+    // A compaction that failed earlier left records in the old journal;
+    // fold them in before another rotation would overwrite it
+    std::error_code ec;
+    if (fs::exists(oldJournalPath, ec) && !compact()) {
+        compactAt = journalBytes + COMPACT_THRESHOLD;
+        return;
+    }
+
+    // Start a new journal, then fold the full one into the snapshot
+    std::fclose(journal);
+    journal = nullptr;
+    fs::rename(journalPath, oldJournalPath, ec);
+    if (ec) {
+        LOG_ERROR(journalLog, "Cannot rotate {}: {}", journalPath, ec.message());
+        compactAt = journalBytes + COMPACT_THRESHOLD;
+    } else {
+        compactAt = COMPACT_THRESHOLD;
+        journalBytes = 0;
+    }
+    if (!openJournal()) {
+        // The next commit tries again and keeps its batch until it can
+        LOG_ERROR(journalLog, "Cannot open {}", journalPath);
+        return;
+    }
+    if (!ec) {
+        compact();
+    }
+}
+
+bool AccountJournal::commit(const std::vector<uint8_t>& batch) {
+    // Closed by a failed write or rotation: reopen, which also cuts the file
+    // back to the last commit
+    if (!journal && !openJournal()) {
+        LOG_ERROR(journalLog, "Cannot open {}; {} bytes of account changes waiting", journalPath, batch.size());
+        return false;
+    }
+
+    if (std::fwrite(batch.data(), 1, batch.size(), journal) != batch.size() || !syncFile(journal)) {
+        // Part of the batch may have reached the file. Close it so the retry
+        // reopens it, dropping that part instead of appending after it.
+        LOG_ERROR(journalLog, "Failed to write {} bytes to {}", batch.size(), journalPath);
+        std::fclose(journal);
+        journal = nullptr;
+        return false;
+    }
+
+    journalBytes += batch.size();
+    return true;
+}
+
+bool AccountJournal::openJournal() {
+    // Anything past journalBytes was never committed (a torn or failed
+    // write); records must follow the last intact one
+    std::error_code ec;
+    if (fs::exists(journalPath, ec)) {
+        uint64_t fileSize = fs::file_size(journalPath, ec);
+        if (!ec && journalBytes < sizeof(AccountFileHeader)) {
+            fs::remove(journalPath, ec);
+        } else if (!ec && fileSize > journalBytes) {
+            fs::resize_file(journalPath, journalBytes, ec);
+        }
+        if (ec) return false;
+    }
+
+    journal = std::fopen(journalPath.c_str(), "ab");
+    if (!journal) return false;
+
+    journalBytes = fs::file_size(journalPath, ec);
+    if (ec || journalBytes == 0) {
+        AccountFileHeader header;
+        memcpy(header.magic, JOURNAL_MAGIC, sizeof(header.magic));
+        header.version = VERSION;
+        header.reserved = 0;
+        if (std::fwrite(&header, sizeof(header), 1, journal) != 1 || !syncFile(journal)) {
+            std::fclose(journal);
+            journal = nullptr;
+            journalBytes = 0;   // Whatever did get written is removed on the next open
+            return false;
+        }
+        journalBytes = sizeof(header);
+    }
+    return true;
+}
+
+bool AccountJournal::compact() {
+    auto start = std::chrono::steady_clock::now();
+
+    std::map<uint64_t, Account> accounts;
+    std::string errorMsg;
+    uint64_t validBytes;
+    if (!readAccountFile(snapshotPath, SNAPSHOT_MAGIC, accounts, validBytes, errorMsg) ||
+        !readAccountFile(oldJournalPath, JOURNAL_MAGIC, accounts, validBytes, errorMsg)) {
+        LOG_ERROR(journalLog, "Compaction failed: {}", errorMsg);
+        return false;
+    }
+
+    std::vector<uint8_t> data;
+    AccountFileHeader header;
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = VERSION;
+    header.reserved = 0;
+    const uint8_t* headerBytes = reinterpret_cast<const uint8_t*>(&header);
+    data.insert(data.end(), headerBytes, headerBytes + sizeof(header));
+
+    uint8_t payload[MAX_RECORD_SIZE];
+    for (const auto& pair : accounts) {
+        ByteWriter writer(payload, sizeof(payload));
+        encodeCreate(writer, pair.second);
+        if (!writer.overflowed()) appendFramed(data, payload, writer.size());
+    }
+
+    // Replace the snapshot only once the new one is fully on disk
+    std::string tempPath = snapshotPath + ".tmp";
+    std::FILE* file = std::fopen(tempPath.c_str(), "wb");
+    bool written = file && std::fwrite(data.data(), 1, data.size(), file) == data.size() && syncFile(file);
+    if (file) std::fclose(file);
+
+    std::error_code ec;
+    if (written) fs::rename(tempPath, snapshotPath, ec);
+    if (!written || ec) {
+        LOG_ERROR(journalLog, "Compaction failed: cannot write {}", snapshotPath);
+        fs::remove(tempPath, ec);
+        return false;
+    }
+    fs::remove(oldJournalPath, ec);
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    LOG_INFO(journalLog, "Compacted {} accounts into {} ({} bytes, {} ms)",
+             accounts.size(), snapshotPath, data.size(), elapsed.count());
+    return true;
+}
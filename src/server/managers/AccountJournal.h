@@ -0,0 +1,113 @@
+#pragma once
+#include "../../common/DataStructures.h"
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// ACCOUNT JOURNAL
+// Durable account storage for AuthManager. Every change (a new account, a
+// login time) is appended to a binary journal instead of rewriting all
+// accounts. A writer thread writes whatever has been recorded since its
+// last commit and syncs it with one fsync (group commit), so callers never
+// wait on the disk. Once the journal passes COMPACT_THRESHOLD, the writer
+// starts a new one and folds the old one into a fresh snapshot, written to
+// a temporary file and renamed into place. Startup reads the snapshot and
+// replays the journals written after it.
+//
+// Files in `directory` (little-endian, packed):
+//   accounts.snapshot      AccountFileHeader + one CREATE record per account
+//   accounts.journal.old   Journal being folded into the snapshot (left
+//                          behind only if the server stopped mid-compaction)
+//   accounts.journal       AccountFileHeader + records
+// Records are JournalRecordHeader + payload. A record cut short or failing
+// its checksum ends replay (a torn last write); the journal is truncated
+// there before anything new is appended. A batch that fails to write or
+// sync is cut off the same way and retried; it only counts as committed
+// once it is on disk.
+// ============================================================================
+
+#pragma pack(push, 1)
+struct AccountFileHeader {
+    char magic[8];              // "TDSACSN\0" snapshot, "TDSACJR\0" journal
+    uint32_t version;
+    uint32_t reserved;
+};
+
+struct JournalRecordHeader {
+    uint32_t payloadSize;
+    uint32_t checksum;          // FNV-1a of the payload
+};
+#pragma pack(pop)
+
+class AccountJournal {
+public:
+    static constexpr uint32_t VERSION = 1;
+
+    explicit AccountJournal(const std::string& directory);
+    ~AccountJournal();
+
+    AccountJournal(const AccountJournal&) = delete;
+    AccountJournal& operator=(const AccountJournal&) = delete;
+
+    // Read the snapshot and replay the journals into `accounts`. Call once,
+    // before start(). False if a file exists but cannot be read.
+    bool load(std::map<uint64_t, Account>& accounts, std::string& errorMsg);
+
+    // Open the journal for appending and start the writer thread. Refuses
+    // unless load() succeeded: a journal that was not read must not be
+    // truncated or appended to.
+    bool start(std::string& errorMsg);
+
+    // Commit everything recorded, then stop the writer thread
+    void stop();
+
+    // Queue a change; the writer thread has it on disk shortly after
+    void recordCreate(const Account& account);
+    void recordLogin(uint64_t accountId, uint64_t lastLogin);
+
+    // Block until everything recorded so far is on disk. False if the
+    // journal cannot be written right now; the records stay queued and the
+    // writer keeps retrying them.
+    bool flush();
+
+private:
+    // Journal size that triggers compaction
+    static constexpr uint64_t COMPACT_THRESHOLD = 16 * 1024 * 1024;
+
+    // Wait before retrying a batch that could not be written
+    static constexpr int RETRY_MILLIS = 1000;
+
+    std::string snapshotPath;
+    std::string journalPath;
+    std::string oldJournalPath;
+    uint64_t loadedJournalBytes = 0;    // Valid prefix found by load()
+    bool loaded = false;                // load() read every file
+
+    // Writer thread only, once started
+    std::FILE* journal = nullptr;
+    uint64_t journalBytes = 0;          // Committed bytes in the current journal
+    uint64_t compactAt = COMPACT_THRESHOLD;     // Journal size for the next rotation
+
+    std::mutex mutex;
+    std::condition_variable wakeCv;
+    std::condition_variable committedCv;
+    std::vector<uint8_t> pending;       // Framed records not yet taken by the writer
+    uint64_t recorded = 0;              // Records queued so far
+    uint64_t committed = 0;             // Records on disk
+    bool writeFailing = false;          // The last commit failed; `pending` is being retried
+    bool stopping = false;
+    std::thread writer;
+
+    void append(const uint8_t* payload, size_t size);
+    void writerMain();
+    bool commit(const std::vector<uint8_t>& batch);
+    bool openJournal();
+    void rotate();
+    bool compact();
+};
@@ -1,8 +1,17 @@
 #include "AuthManager.h"
-#include <iostream>
+#include "../../common/Logger.h"
+#include <chrono>
+#include <cstdio>
 #include <fstream>
 
-AuthManager::AuthManager() : nextAccountId(1) {
+namespace {
+    LogCategory authLog("AuthManager");
+
+    // Sessions with no packets for this long are dropped
+    constexpr uint64_t SESSION_IDLE_TIMEOUT = 3600;    // Seconds
+}
+
+AuthManager::AuthManager(TimerWheel* timers) : journal("Server"), timers(timers), nextAccountId(1) {
     loadAccounts();
 }
 
@@ -19,11 +28,9 @@ bool AuthManager::registerAccount(const std::string& username, const std::string
     }
 
     // Check if username already exists
-    for (const auto& pair : accounts) {
-        if (pair.second.username == username) {
-            errorMsg = "Username already taken";
-            return false;
-        }
+    if (accountsByUsername.find(username) != accountsByUsername.end()) {
+        errorMsg = "Username already taken";
+        return false;
     }
 
     // Create account
@@ -40,11 +47,9 @@ bool AuthManager::registerAccount(const std::string& username, const std::string
 
     outAccountId = account.accountId;
 
-    std::cout << "[AuthManager] Registered new account: " << username
-              << " (ID: " << account.accountId << ")" << std::endl;
+    LOG_INFO(authLog, "Registered new account: {} (ID: {})", username, account.accountId);
 
-    // Auto-save
-    saveAccounts();
+    journal.recordCreate(account);
 
     return true;
 }
@@ -69,66 +74,54 @@ bool AuthManager::login(const std::string& username, const std::string& password
     }
 
     // Check if already logged in
-    for (const auto& pair : sessions) {
-        if (pair.second.accountId == accountId && pair.second.valid) {
-            errorMsg = "Account already logged in";
-            return false;
-        }
+    if (sessions.findByAccount(accountId)) {
+        errorMsg = "Account already logged in";
+        return false;
     }
 
-    // Create session
-    Session session;
-    session.sessionToken = generateSessionToken();
-    session.accountId = accountId;
-    session.created = getCurrentTimestamp();
-    session.lastActivity = session.created;
-    session.valid = true;
+    // A connection holds one session; logging in again replaces it
+    SessionTable::Entry* previous = sessions.findByClient(clientId);
+    if (previous) {
+        endSession(previous->session.sessionToken);
+    }
 
-    sessions[session.sessionToken] = session;
-    sessionsByClient[clientId] = session.sessionToken;
-    clientsByAccount[accountId] = clientId;
+    // Create session
+    uint64_t now = getCurrentTimestamp();
+    uint64_t sessionToken;
+    if (!sessions.create(accountId, clientId, now, sessionToken)) {
+        errorMsg = "Account already logged in";
+        return false;
+    }
+    scheduleSessionExpiry(*sessions.find(sessionToken), SESSION_IDLE_TIMEOUT);
 
     // Update last login
-    account.lastLogin = session.created;
+    account.lastLogin = now;
+    journal.recordLogin(accountId, account.lastLogin);
 
     outAccountId = accountId;
-    outSessionToken = session.sessionToken;
+    outSessionToken = sessionToken;
 
-    std::cout << "[AuthManager] User logged in: " << username
-              << " (Session: " << session.sessionToken << ")" << std::endl;
+    LOG_INFO(authLog, "User logged in: {} (Session: {})", username, sessionToken);
 
     return true;
 }
 
 void AuthManager::logout(uint64_t sessionToken) {
-    auto it = sessions.find(sessionToken);
-    if (it != sessions.end()) {
-        it->second.valid = false;
-
-        // Remove client mapping
-        uint64_t accountId = it->second.accountId;
-        clientsByAccount.erase(accountId);
-
-        std::cout << "[AuthManager] Session logged out: " << sessionToken << std::endl;
+    if (sessions.find(sessionToken)) {
+        endSession(sessionToken);
+        LOG_INFO(authLog, "Session logged out: {}", sessionToken);
     }
 }
 
 bool AuthManager::validateSession(uint64_t sessionToken, uint64_t& outAccountId) {
-    auto it = sessions.find(sessionToken);
-    if (it == sessions.end() || !it->second.valid) {
+    SessionTable::Entry* entry = sessions.find(sessionToken);
+    if (!entry) {
         return false;
     }
 
-    // Check for timeout (1 hour)
-    uint64_t currentTime = getCurrentTimestamp();
-    if (it->second.isExpired(currentTime, 3600)) {
-        it->second.valid = false;
-        return false;
-    }
-
-    // Update last activity
-    it->second.lastActivity = currentTime;
-    outAccountId = it->second.accountId;
+    // Update last activity; the expiry timer reads it when it fires
+    entry->session.lastActivity = getCurrentTimestamp();
+    outAccountId = entry->session.accountId;
     return true;
 }
 
@@ -149,73 +142,132 @@ Account* AuthManager::getAccountByUsername(const std::string& username) {
 }
 
 bool AuthManager::getClientForAccount(uint64_t accountId, uint64_t& outClientId) {
-    auto it = clientsByAccount.find(accountId);
-    if (it != clientsByAccount.end()) {
-        outClientId = it->second;
+    SessionTable::Entry* entry = sessions.findByAccount(accountId);
+    if (entry) {
+        outClientId = entry->clientId;
         return true;
     }
     return false;
 }
 
 bool AuthManager::getSessionForClient(uint64_t clientId, uint64_t& outSessionToken) {
-    auto it = sessionsByClient.find(clientId);
-    if (it != sessionsByClient.end()) {
-        outSessionToken = it->second;
+    SessionTable::Entry* entry = sessions.findByClient(clientId);
+    if (entry) {
+        outSessionToken = entry->session.sessionToken;
         return true;
     }
     return false;
 }
 
 void AuthManager::handleClientDisconnect(uint64_t clientId) {
-    // Find and invalidate session
-    auto it = sessionsByClient.find(clientId);
-    if (it != sessionsByClient.end()) {
-        uint64_t sessionToken = it->second;
-        logout(sessionToken);
-        sessionsByClient.erase(it);
+    // Find and end session
+    SessionTable::Entry* entry = sessions.findByClient(clientId);
+    if (entry) {
+        logout(entry->session.sessionToken);
+    }
+}
+
+void AuthManager::scheduleSessionExpiry(SessionTable::Entry& entry, uint64_t delaySeconds) {
+    uint64_t sessionToken = entry.session.sessionToken;
+    entry.expiryTimer = timers->schedule(static_cast<double>(delaySeconds),
+                                         [this, sessionToken]() { expireSession(sessionToken); });
+}
+
+void AuthManager::expireSession(uint64_t sessionToken) {
+    SessionTable::Entry* entry = sessions.find(sessionToken);
+    if (!entry) return;
+    entry->expiryTimer = 0;
+
+    // Activity since the timer was set pushes the deadline back; checking
+    // here instead of rescheduling on every packet keeps packets cheap
+    uint64_t idle = getCurrentTimestamp() - entry->session.lastActivity;
+    if (idle < SESSION_IDLE_TIMEOUT) {
+        scheduleSessionExpiry(*entry, SESSION_IDLE_TIMEOUT - idle);
+        return;
+    }
+
+    LOG_INFO(authLog, "Session expired: {} (idle {} s)", sessionToken, idle);
+    endSession(sessionToken);
+}
+
+void AuthManager::endSession(uint64_t sessionToken) {
+    SessionTable::Entry* entry = sessions.find(sessionToken);
+    if (!entry) return;
+
+    if (entry->expiryTimer != 0) {
+        timers->cancel(entry->expiryTimer);
     }
+    if (onSessionEnd) {
+        onSessionEnd(entry->clientId);
+    }
+
+    // Frees the slot and drops the account and client index entries
+    sessions.erase(sessionToken);
 }
 
 void AuthManager::saveAccounts() {
-    std::ofstream file("Server/accounts.dat");
-    if (!file.is_open()) {
-        std::cout << "[AuthManager] Failed to save accounts" << std::endl;
+    if (!journal.flush()) {
+        LOG_ERROR(authLog, "Account changes are not on disk yet; the journal is retrying them");
+    }
+}
+
+void AuthManager::loadAccounts() {
+    auto start = std::chrono::steady_clock::now();
+
+    std::string errorMsg;
+    if (!journal.load(accounts, errorMsg)) {
+        // Serving without them would hand out their account ids again
+        LOG_ERROR(authLog, "Failed to load accounts: {}", errorMsg);
+        accounts.clear();
         return;
     }
 
-    file << "ACCOUNTS_V1\n";
-    file << nextAccountId << "\n";
-    file << accounts.size() << "\n";
+    bool imported = accounts.empty() && importLegacyAccounts();
 
     for (const auto& pair : accounts) {
-        const Account& acc = pair.second;
-        file << acc.accountId << "\n";
-        file << acc.username << "\n";
-        file << acc.passwordHash << "\n";
-        file << acc.email << "\n";
-        file << acc.created << "\n";
-        file << acc.lastLogin << "\n";
+        accountsByUsername.emplace(pair.second.username, pair.first);
+    }
+    if (!accounts.empty()) {
+        nextAccountId = accounts.rbegin()->first + 1;
     }
 
-    file.close();
-    std::cout << "[AuthManager] Saved " << accounts.size() << " accounts" << std::endl;
+    if (!journal.start(errorMsg)) {
+        LOG_ERROR(authLog, "Account changes will not be saved: {}", errorMsg);
+        return;
+    }
+    accountsLoaded = true;
+
+    if (imported) {
+        // Journal the imported accounts before retiring the old file
+        for (const auto& pair : accounts) {
+            journal.recordCreate(pair.second);
+        }
+        if (journal.flush()) {
+            std::rename("Server/accounts.dat", "Server/accounts.dat.imported");
+        } else {
+            LOG_ERROR(authLog, "Imported accounts are not journaled yet; keeping Server/accounts.dat");
+        }
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    LOG_INFO(authLog, "Loaded {} accounts in {} ms", accounts.size(), elapsed.count());
 }
 
-void AuthManager::loadAccounts() {
+bool AuthManager::importLegacyAccounts() {
     std::ifstream file("Server/accounts.dat");
     if (!file.is_open()) {
-        std::cout << "[AuthManager] No accounts file found, starting fresh" << std::endl;
-        return;
+        return false;
     }
 
     std::string line;
     std::getline(file, line);  // Version
     if (line != "ACCOUNTS_V1") {
-        std::cout << "[AuthManager] Invalid accounts file version" << std::endl;
-        return;
+        LOG_WARN(authLog, "Invalid accounts file version");
+        return false;
     }
 
-    file >> nextAccountId;
+    uint64_t savedNextAccountId;
+    file >> savedNextAccountId;
     int accountCount;
     file >> accountCount;
     file.ignore();
@@ -231,9 +283,9 @@ void AuthManager::loadAccounts() {
         file.ignore();
 
         accounts[acc.accountId] = acc;
-        accountsByUsername[acc.username] = acc.accountId;
     }
 
     file.close();
-    std::cout << "[AuthManager] Loaded " << accounts.size() << " accounts" << std::endl;
+    LOG_INFO(authLog, "Importing {} accounts from Server/accounts.dat", accounts.size());
+    return true;
 }
@@ -2,6 +2,9 @@
 #include "../../common/NetworkProtocol.h"
 #include "../../common/DataStructures.h"
 #include "../../common/Utils.h"
+#include "../TimerWheel.h"
+#include "AccountJournal.h"
+#include "SessionTable.h"
 #include <map>
 #include <vector>
 #include <string>
@@ -9,7 +12,11 @@
 // Authentication Manager - handles login, registration, and session management
 class AuthManager {
 public:
-    AuthManager();
+    // Called with the session's client whenever a session ends (logout,
+    // idle expiry, replacement by a new login, disconnect)
+    using SessionEndHandler = void (*)(uint64_t clientId);
+
+    explicit AuthManager(TimerWheel* timers);
     ~AuthManager();
 
     // Register new account
@@ -24,7 +31,8 @@ public:
     // Logout
     void logout(uint64_t sessionToken);
 
-    // Validate session
+    // Validate session and count it as activity. Idle sessions are expired
+    // and freed by a timer, not here.
     bool validateSession(uint64_t sessionToken, uint64_t& outAccountId);
 
     // Get account by ID
@@ -42,17 +50,32 @@ public:
     // Handle client disconnect
     void handleClientDisconnect(uint64_t clientId);
 
-    // Save accounts to file
+    void setSessionEndHandler(SessionEndHandler handler) { onSessionEnd = handler; }
+
+    // Wait until every account change so far is on disk (AccountJournal)
     void saveAccounts();
 
-    // Load accounts from file
+    // Load accounts from the journal and start journaling changes
     void loadAccounts();
 
+    // False if the accounts could not be loaded or journaled; the server
+    // must not run without them
+    bool isReady() const { return accountsLoaded; }
+
 private:
+    AccountJournal journal;
     std::map<uint64_t, Account> accounts;
     std::map<std::string, uint64_t> accountsByUsername;
-    std::map<uint64_t, Session> sessions;
-    std::map<uint64_t, uint64_t> sessionsByClient;   // clientId -> sessionToken
-    std::map<uint64_t, uint64_t> clientsByAccount;   // accountId -> clientId
+    SessionTable sessions;
+    TimerWheel* timers;
+    SessionEndHandler onSessionEnd = nullptr;
     uint64_t nextAccountId;
+    bool accountsLoaded = false;
+
+    // One-time import of the old text accounts file
+    bool importLegacyAccounts();
+
+    void scheduleSessionExpiry(SessionTable::Entry& entry, uint64_t delaySeconds);
+    void expireSession(uint64_t sessionToken);
+    void endSession(uint64_t sessionToken);
 };
@@ -1,8 +1,12 @@
 #include "FriendManager.h"
-#include <iostream>
+#include "../../common/Logger.h"
 #include <fstream>
 #include <algorithm>
 
+namespace {
+    LogCategory friendLog("FriendManager");
+}
+
 FriendManager::FriendManager(AuthManager* authMgr, LobbyManager* lobbyMgr)
     : authManager(authMgr), lobbyManager(lobbyMgr) {
     loadFriendships();
@@ -67,8 +71,7 @@ bool FriendManager::sendFriendRequest(uint64_t fromAccountId, const std::string&
     reverseFriend.created = friendReq.created;
     friendships[toAccountId].push_back(reverseFriend);
 
-    std::cout << "[FriendManager] Friend request sent from " << fromAccountId
-              << " to " << toUsername << std::endl;
+    LOG_INFO(friendLog, "Friend request sent from {} to {}", fromAccountId, toUsername);
 
     saveFriendships();
     return true;
@@ -95,8 +98,7 @@ bool FriendManager::acceptFriendRequest(uint64_t accountId, uint64_t friendAccou
         reverseFriend->status = FriendStatus::ACCEPTED;
     }
 
-    std::cout << "[FriendManager] Friend request accepted: " << accountId
-              << " <-> " << friendAccountId << std::endl;
+    LOG_INFO(friendLog, "Friend request accepted: {} <-> {}", accountId, friendAccountId);
 
     saveFriendships();
     return true;
@@ -107,8 +109,7 @@ bool FriendManager::declineFriendRequest(uint64_t accountId, uint64_t friendAcco
     removeFriendship(accountId, friendAccountId);
     removeFriendship(friendAccountId, accountId);
 
-    std::cout << "[FriendManager] Friend request declined: " << accountId
-              << " declined " << friendAccountId << std::endl;
+    LOG_INFO(friendLog, "Friend request declined: {} declined {}", accountId, friendAccountId);
 
     saveFriendships();
     return true;
@@ -119,8 +120,7 @@ bool FriendManager::removeFriend(uint64_t accountId, uint64_t friendAccountId, s
     removeFriendship(accountId, friendAccountId);
     removeFriendship(friendAccountId, accountId);
 
-    std::cout << "[FriendManager] Friendship removed: " << accountId
-              << " <-> " << friendAccountId << std::endl;
+    LOG_INFO(friendLog, "Friendship removed: {} <-> {}", accountId, friendAccountId);
 
     saveFriendships();
     return true;
@@ -187,8 +187,7 @@ bool FriendManager::inviteFriendToLobby(uint64_t accountId, uint64_t friendAccou
         return false;
     }
 
-    std::cout << "[FriendManager] Lobby invite sent from " << accountId
-              << " to " << friendAccountId << " (Lobby: " << lobby->lobbyId << ")" << std::endl;
+    LOG_INFO(friendLog, "Lobby invite sent from {} to {} (Lobby: {})", accountId, friendAccountId, lobby->lobbyId);
 
     return true;
 }
@@ -207,7 +206,7 @@ void FriendManager::setOnlineStatus(uint64_t accountId, bool online) {
 void FriendManager::saveFriendships() {
     std::ofstream file("Server/friendships.dat");
     if (!file.is_open()) {
-        std::cout << "[FriendManager] Failed to save friendships" << std::endl;
+        LOG_WARN(friendLog, "Failed to save friendships");
         return;
     }
 
@@ -227,20 +226,20 @@ void FriendManager::saveFriendships() {
     }
 
     file.close();
-    std::cout << "[FriendManager] Saved friendships" << std::endl;
+    LOG_INFO(friendLog, "Saved friendships");
 }
 
 void FriendManager::loadFriendships() {
     std::ifstream file("Server/friendships.dat");
     if (!file.is_open()) {
-        std::cout << "[FriendManager] No friendships file found, starting fresh" << std::endl;
+        LOG_INFO(friendLog, "No friendships file found, starting fresh");
         return;
     }
 
     std::string line;
     std::getline(file, line);  // Version
     if (line != "FRIENDSHIPS_V1") {
-        std::cout << "[FriendManager] Invalid friendships file version" << std::endl;
+        LOG_WARN(friendLog, "Invalid friendships file version");
         return;
     }
 
@@ -280,7 +279,7 @@ void FriendManager::loadFriendships() {
     }
 
     file.close();
-    std::cout << "[FriendManager] Loaded friendships" << std::endl;
+    LOG_INFO(friendLog, "Loaded friendships");
 }
 
 Friend* FriendManager::getFriendship(uint64_t accountId, uint64_t friendAccountId) {
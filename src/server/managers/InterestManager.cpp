@@ -0,0 +1,184 @@
+#include "InterestManager.h"
+#include <algorithm>
+
+namespace {
+    // Grid over the full quantized range: 65536 steps / 1024 = 64 cells of
+    // 32 m per axis
+    constexpr int CELL_SHIFT = 10;
+    constexpr int GRID_SIZE = 65536 >> CELL_SHIFT;
+    constexpr int GRID_CELLS = GRID_SIZE * GRID_SIZE;
+
+    struct InterestTier {
+        float radius;           // Metres
+        uint32_t interval;      // Send every Nth snapshot
+    };
+
+    constexpr InterestTier INTEREST_TIERS[] = {
+        { 40.0f, 1 },
+        { 100.0f, 2 },
+        { 200.0f, 4 }
+    };
+
+    constexpr float INTEREST_RADIUS = 200.0f;
+    constexpr uint32_t INTERACTION_TICKS = 5 * 60;     // 5 s at the simulation rate
+
+    int cellCoord(uint16_t quantized) {
+        return quantized >> CELL_SHIFT;
+    }
+
+    int cellIndex(uint16_t x, uint16_t z) {
+        return cellCoord(z) * GRID_SIZE + cellCoord(x);
+    }
+
+    template <typename Key>
+    std::pair<Key, Key> interactionKey(const Key& a, const Key& b) {
+        return a < b ? std::make_pair(a, b) : std::make_pair(b, a);
+    }
+
+    template <typename Entity>
+    const Entity* findById(const std::vector<Entity>& entities, uint64_t id) {
+        auto it = std::lower_bound(entities.begin(), entities.end(), id,
+                                   [](const Entity& e, uint64_t value) { return e.id < value; });
+        return (it != entities.end() && it->id == id) ? &*it : nullptr;
+    }
+}
+
+InterestManager::InterestManager() : cellStart(GRID_CELLS + 1, 0), currentTick(0) {
+}
+
+void InterestManager::rebuild(const WorldSnapshot& world) {
+    currentTick = world.tick;
+
+    // Counting sort by cell: sizes, prefix sums, then place
+    std::fill(cellStart.begin(), cellStart.end(), 0);
+    for (const auto& player : world.players) {
+        cellStart[cellIndex(player.fields[PLAYER_X], player.fields[PLAYER_Z]) + 1]++;
+    }
+    for (const auto& enemy : world.enemies) {
+        cellStart[cellIndex(enemy.fields[ENEMY_X], enemy.fields[ENEMY_Z]) + 1]++;
+    }
+    for (int i = 0; i < GRID_CELLS; i++) {
+        cellStart[i + 1] += cellStart[i];
+    }
+
+    cellEntries.resize(world.players.size() + world.enemies.size());
+    std::vector<uint32_t> cursor(cellStart.begin(), cellStart.end() - 1);
+    for (uint32_t i = 0; i < world.players.size(); i++) {
+        int cell = cellIndex(world.players[i].fields[PLAYER_X], world.players[i].fields[PLAYER_Z]);
+        cellEntries[cursor[cell]++] = { EntityKind::PLAYER, i };
+    }
+    for (uint32_t i = 0; i < world.enemies.size(); i++) {
+        int cell = cellIndex(world.enemies[i].fields[ENEMY_X], world.enemies[i].fields[ENEMY_Z]);
+        cellEntries[cursor[cell]++] = { EntityKind::ENEMY, i };
+    }
+
+    // Forget stale interactions
+    for (auto it = interactions.begin(); it != interactions.end();) {
+        if (currentTick - it->second > INTERACTION_TICKS) {
+            it = interactions.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void InterestManager::recordPlayerInteraction(uint64_t accountA, uint64_t accountB, uint32_t tick) {
+    recordInteraction({ EntityKind::PLAYER, accountA }, { EntityKind::PLAYER, accountB }, tick);
+}
+
+void InterestManager::recordEnemyInteraction(uint64_t enemyId, uint64_t accountId, uint32_t tick) {
+    recordInteraction({ EntityKind::ENEMY, enemyId }, { EntityKind::PLAYER, accountId }, tick);
+}
+
+void InterestManager::recordInteraction(EntityKey a, EntityKey b, uint32_t tick) {
+    if (a.second == 0 || b.second == 0 || a == b) return;
+    interactions[interactionKey(a, b)] = tick;
+}
+
+bool InterestManager::recentlyInteracted(EntityKey a, EntityKey b) const {
+    auto it = interactions.find(interactionKey(a, b));
+    return it != interactions.end() && currentTick - it->second <= INTERACTION_TICKS;
+}
+
+uint32_t InterestManager::updateInterval(uint16_t viewerX, uint16_t viewerZ, uint16_t x, uint16_t z) {
+    float dx = (static_cast<int>(x) - static_cast<int>(viewerX)) / SNAPSHOT_POSITION_SCALE;
+    float dz = (static_cast<int>(z) - static_cast<int>(viewerZ)) / SNAPSHOT_POSITION_SCALE;
+    float distanceSquared = dx * dx + dz * dz;
+
+    for (const auto& tier : INTEREST_TIERS) {
+        if (distanceSquared < tier.radius * tier.radius) return tier.interval;
+    }
+    return 0;
+}
+
+void InterestManager::buildView(uint64_t viewerId, const WorldSnapshot& world, const WorldSnapshot* previous,
+                                uint32_t sendIndex, WorldSnapshot& out) const {
+    out.tick = world.tick;
+    out.players.clear();
+    out.enemies.clear();
+    out.collectedLoot = world.collectedLoot;    // Already sent only as it changes
+
+    const SnapshotPlayer* viewer = findById(world.players, viewerId);
+    if (!viewer) {
+        out.players = world.players;
+        out.enemies = world.enemies;
+        return;
+    }
+    const EntityKey viewerKey(EntityKind::PLAYER, viewerId);
+    const uint16_t viewerX = viewer->fields[PLAYER_X];
+    const uint16_t viewerZ = viewer->fields[PLAYER_Z];
+
+    // Current values when due (or new to the viewer), otherwise the values
+    // they were last sent
+    auto include = [&](uint64_t id, uint32_t interval, const auto& entity, const auto* last, auto& list) {
+        bool due = interval <= 1 || (sendIndex + static_cast<uint32_t>(id)) % interval == 0;
+        list.push_back(due || !last ? entity : *last);
+    };
+
+    // Cells overlapping the interest radius around the viewer
+    const int reach = static_cast<int>(INTEREST_RADIUS * SNAPSHOT_POSITION_SCALE) >> CELL_SHIFT;
+    const int centerX = cellCoord(viewerX);
+    const int centerZ = cellCoord(viewerZ);
+    for (int cz = std::max(centerZ - reach - 1, 0); cz <= std::min(centerZ + reach + 1, GRID_SIZE - 1); cz++) {
+        for (int cx = std::max(centerX - reach - 1, 0); cx <= std::min(centerX + reach + 1, GRID_SIZE - 1); cx++) {
+            int cell = cz * GRID_SIZE + cx;
+            for (uint32_t i = cellStart[cell]; i < cellStart[cell + 1]; i++) {
+                // Interacting entities are added below, whatever their distance
+                const CellEntry& entry = cellEntries[i];
+                if (entry.kind == EntityKind::PLAYER) {
+                    const SnapshotPlayer& player = world.players[entry.index];
+                    if (player.id == viewerId) continue;
+                    uint32_t interval = updateInterval(viewerX, viewerZ, player.fields[PLAYER_X], player.fields[PLAYER_Z]);
+                    if (interval == 0 || recentlyInteracted(viewerKey, { EntityKind::PLAYER, player.id })) continue;
+                    include(player.id, interval, player, previous ? findById(previous->players, player.id) : nullptr, out.players);
+                } else {
+                    const SnapshotEnemy& enemy = world.enemies[entry.index];
+                    uint32_t interval = updateInterval(viewerX, viewerZ, enemy.fields[ENEMY_X], enemy.fields[ENEMY_Z]);
+                    if (interval == 0 || recentlyInteracted(viewerKey, { EntityKind::ENEMY, enemy.id })) continue;
+                    include(enemy.id, interval, enemy, previous ? findById(previous->enemies, enemy.id) : nullptr, out.enemies);
+                }
+            }
+        }
+    }
+
+    // Always at full rate: the viewer and whatever they are fighting
+    out.players.push_back(*viewer);
+    for (const auto& interaction : interactions) {
+        if (currentTick - interaction.second > INTERACTION_TICKS) continue;
+        EntityKey other;
+        if (interaction.first.first == viewerKey) other = interaction.first.second;
+        else if (interaction.first.second == viewerKey) other = interaction.first.first;
+        else continue;
+
+        if (other.first == EntityKind::PLAYER) {
+            if (const SnapshotPlayer* player = findById(world.players, other.second)) out.players.push_back(*player);
+        } else {
+            if (const SnapshotEnemy* enemy = findById(world.enemies, other.second)) out.enemies.push_back(*enemy);
+        }
+    }
+
+    // The encoder expects id order
+    auto byId = [](const auto& a, const auto& b) { return a.id < b.id; };
+    std::sort(out.players.begin(), out.players.end(), byId);
+    std::sort(out.enemies.begin(), out.enemies.end(), byId);
+}
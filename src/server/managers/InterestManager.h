@@ -0,0 +1,63 @@
+#pragma once
+#include "../../common/WorldSnapshot.h"
+#include <map>
+#include <utility>
+#include <vector>
+
+// Interest Manager - decides, per recipient and per snapshot, which of a
+// match's entities are replicated and how often. One instance per match.
+//
+// Entities are bucketed into a coarse grid (32 m cells over the quantized
+// map) so a viewer only looks at cells within range. Relevance then comes
+// from horizontal distance:
+//   - near (< 40 m): every snapshot
+//   - mid (< 100 m): every 2nd snapshot
+//   - far (< 200 m): every 4th snapshot
+//   - beyond: not replicated (the client drops it)
+// Entities the viewer recently interacted with (damage, an enemy targeting
+// them) are sent every snapshot at any distance. Between updates an entity
+// repeats the values the viewer was last sent, so the delta encoder skips it.
+class InterestManager {
+public:
+    InterestManager();
+
+    // Bucket a freshly captured match snapshot into the grid
+    void rebuild(const WorldSnapshot& world);
+
+    // Two players interacted on `tick`
+    void recordPlayerInteraction(uint64_t accountA, uint64_t accountB, uint32_t tick);
+
+    // An enemy and a player interacted on `tick`. Enemy ids and account ids
+    // are separate ranges that may overlap, so they are never mixed.
+    void recordEnemyInteraction(uint64_t enemyId, uint64_t accountId, uint32_t tick);
+
+    // Build `viewerId`'s view of `world` (the snapshot passed to rebuild).
+    // `previous` is the last snapshot sent to the viewer, or nullptr;
+    // `sendIndex` counts snapshots sent to them and staggers reduced rates.
+    void buildView(uint64_t viewerId, const WorldSnapshot& world, const WorldSnapshot* previous,
+                   uint32_t sendIndex, WorldSnapshot& out) const;
+
+private:
+    enum class EntityKind : uint8_t { PLAYER, ENEMY };
+
+    struct CellEntry {
+        EntityKind kind;
+        uint32_t index;     // Into world.players / world.enemies
+    };
+
+    // Cell index -> entries, as a counting-sorted flat array
+    std::vector<uint32_t> cellStart;    // GRID_CELLS + 1 offsets into cellEntries
+    std::vector<CellEntry> cellEntries;
+
+    using EntityKey = std::pair<EntityKind, uint64_t>;
+
+    // Ordered entity pair -> tick of the last interaction
+    std::map<std::pair<EntityKey, EntityKey>, uint32_t> interactions;
+    uint32_t currentTick;
+
+    void recordInteraction(EntityKey a, EntityKey b, uint32_t tick);
+    bool recentlyInteracted(EntityKey a, EntityKey b) const;
+
+    // Snapshots between updates at this distance (0 = not relevant)
+    static uint32_t updateInterval(uint16_t viewerX, uint16_t viewerZ, uint16_t x, uint16_t z);
+};
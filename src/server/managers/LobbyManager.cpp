@@ -1,8 +1,16 @@
 #include "LobbyManager.h"
-#include <iostream>
+#include "../../common/Logger.h"
 #include <algorithm>
 
-LobbyManager::LobbyManager() : nextLobbyId(1) {}
+namespace {
+    LogCategory lobbyLog("LobbyManager");
+
+    constexpr double QUEUE_TIMEOUT = 600.0;             // Seconds
+    constexpr double LOBBY_CLEANUP_INTERVAL = 300.0;    // Seconds
+}
+
+LobbyManager::LobbyManager(TimerWheel* timers, AuthManager* authMgr)
+    : timers(timers), authManager(authMgr), nextLobbyId(1) {}
 
 bool LobbyManager::createLobby(uint64_t ownerAccountId, const std::string& lobbyName,
                                int maxPlayers, bool isPrivate, uint64_t& outLobbyId,
@@ -38,11 +46,11 @@ bool LobbyManager::createLobby(uint64_t ownerAccountId, const std::string& lobby
 
     lobbies[lobby.lobbyId] = lobby;
     playerLobbies[ownerAccountId] = lobby.lobbyId;
+    scheduleCleanup(lobby.lobbyId);
 
     outLobbyId = lobby.lobbyId;
 
-    std::cout << "[LobbyManager] Lobby created: " << lobby.lobbyName
-              << " (ID: " << lobby.lobbyId << ")" << std::endl;
+    LOG_INFO(lobbyLog, "Lobby created: {} (ID: {})", lobby.lobbyName, lobby.lobbyId);
 
     return true;
 }
@@ -84,7 +92,7 @@ bool LobbyManager::joinLobby(uint64_t accountId, uint64_t lobbyId, std::string&
 
     playerLobbies[accountId] = lobbyId;
 
-    std::cout << "[LobbyManager] Player " << accountId << " joined lobby " << lobbyId << std::endl;
+    LOG_INFO(lobbyLog, "Player {} joined lobby {}", accountId, lobbyId);
 
     return true;
 }
@@ -113,18 +121,17 @@ bool LobbyManager::leaveLobby(uint64_t accountId, std::string& errorMsg) {
             if (!lobby.members.empty()) {
                 lobby.members[0].isOwner = true;
                 lobby.ownerId = lobby.members[0].accountId;
-                std::cout << "[LobbyManager] Ownership transferred in lobby " << lobbyId << std::endl;
+                LOG_INFO(lobbyLog, "Ownership transferred in lobby {}", lobbyId);
             } else {
                 // Delete empty lobby
-                lobbies.erase(lobbyId);
-                std::cout << "[LobbyManager] Lobby " << lobbyId << " deleted (empty)" << std::endl;
+                removeLobby(lobbyId);
             }
         }
     }
 
     playerLobbies.erase(accountId);
 
-    std::cout << "[LobbyManager] Player " << accountId << " left lobby " << lobbyId << std::endl;
+    LOG_INFO(lobbyLog, "Player {} left lobby {}", accountId, lobbyId);
 
     return true;
 }
@@ -160,7 +167,7 @@ bool LobbyManager::kickPlayer(uint64_t ownerAccountId, uint64_t targetAccountId,
         lobby.members.erase(memberIt);
         playerLobbies.erase(targetAccountId);
 
-        std::cout << "[LobbyManager] Player " << targetAccountId << " kicked from lobby " << lobbyId << std::endl;
+        LOG_INFO(lobbyLog, "Player {} kicked from lobby {}", targetAccountId, lobbyId);
         return true;
     }
 
@@ -187,7 +194,7 @@ bool LobbyManager::setReady(uint64_t accountId, bool ready, std::string& errorMs
         // Check if all ready
         if (lobby.allReady() && lobby.state == LobbyState::WAITING) {
             lobby.state = LobbyState::READY;
-            std::cout << "[LobbyManager] Lobby " << lobbyId << " is ready!" << std::endl;
+            LOG_INFO(lobbyLog, "Lobby {} is ready!", lobbyId);
         } else if (!lobby.allReady() && lobby.state == LobbyState::READY) {
             lobby.state = LobbyState::WAITING;
         }
@@ -225,8 +232,9 @@ bool LobbyManager::startQueue(uint64_t accountId, std::string& errorMsg) {
     // Start queue
     lobby.state = LobbyState::IN_QUEUE;
     queuedLobbies.push_back(lobbyId);
+    queueTimers[lobbyId] = timers->schedule(QUEUE_TIMEOUT, [this, lobbyId]() { expireQueue(lobbyId); });
 
-    std::cout << "[LobbyManager] Lobby " << lobbyId << " entered queue" << std::endl;
+    LOG_INFO(lobbyLog, "Lobby {} entered queue", lobbyId);
 
     return true;
 }
@@ -248,15 +256,10 @@ bool LobbyManager::stopQueue(uint64_t accountId, std::string& errorMsg) {
         return false;
     }
 
-    // Remove from queue
-    auto queueIt = std::find(queuedLobbies.begin(), queuedLobbies.end(), lobbyId);
-    if (queueIt != queuedLobbies.end()) {
-        queuedLobbies.erase(queueIt);
-    }
-
+    removeFromQueue(lobbyId);
     lobby.state = LobbyState::READY;
 
-    std::cout << "[LobbyManager] Lobby " << lobbyId << " left queue" << std::endl;
+    LOG_INFO(lobbyLog, "Lobby {} left queue", lobbyId);
 
     return true;
 }
@@ -285,11 +288,21 @@ const std::vector<uint64_t>& LobbyManager::getQueuedLobbies() const {
     return queuedLobbies;
 }
 
+void LobbyManager::takeExpiredQueues(std::vector<uint64_t>& out) {
+    out.clear();
+    out.swap(expiredQueues);
+}
+
 void LobbyManager::setLobbyState(uint64_t lobbyId, LobbyState state) {
     auto it = lobbies.find(lobbyId);
     if (it != lobbies.end()) {
         it->second.state = state;
     }
+
+    // A lobby that left IN_QUEUE must not be matched again
+    if (state != LobbyState::IN_QUEUE) {
+        removeFromQueue(lobbyId);
+    }
 }
 
 void LobbyManager::removeLobby(uint64_t lobbyId) {
@@ -301,16 +314,69 @@ void LobbyManager::removeLobby(uint64_t lobbyId) {
         }
 
         // Remove from queue if present
-        auto queueIt = std::find(queuedLobbies.begin(), queuedLobbies.end(), lobbyId);
-        if (queueIt != queuedLobbies.end()) {
-            queuedLobbies.erase(queueIt);
+        removeFromQueue(lobbyId);
+
+        auto cleanup = cleanupTimers.find(lobbyId);
+        if (cleanup != cleanupTimers.end()) {
+            timers->cancel(cleanup->second);
+            cleanupTimers.erase(cleanup);
         }
 
         lobbies.erase(it);
-        std::cout << "[LobbyManager] Lobby " << lobbyId << " removed" << std::endl;
+        LOG_INFO(lobbyLog, "Lobby {} removed", lobbyId);
     }
 }
 
 const std::map<uint64_t, Lobby>& LobbyManager::getAllLobbies() const {
     return lobbies;
 }
+
+void LobbyManager::removeFromQueue(uint64_t lobbyId) {
+    auto queueIt = std::find(queuedLobbies.begin(), queuedLobbies.end(), lobbyId);
+    if (queueIt != queuedLobbies.end()) {
+        queuedLobbies.erase(queueIt);
+    }
+
+    auto timer = queueTimers.find(lobbyId);
+    if (timer != queueTimers.end()) {
+        timers->cancel(timer->second);
+        queueTimers.erase(timer);
+    }
+}
+
+void LobbyManager::expireQueue(uint64_t lobbyId) {
+    queueTimers.erase(lobbyId);
+
+    auto it = lobbies.find(lobbyId);
+    if (it == lobbies.end() || it->second.state != LobbyState::IN_QUEUE) return;
+
+    removeFromQueue(lobbyId);
+    it->second.state = LobbyState::READY;
+    expiredQueues.push_back(lobbyId);
+
+    LOG_INFO(lobbyLog, "Lobby {} queue timed out", lobbyId);
+}
+
+void LobbyManager::scheduleCleanup(uint64_t lobbyId) {
+    cleanupTimers[lobbyId] = timers->schedule(LOBBY_CLEANUP_INTERVAL, [this, lobbyId]() { checkCleanup(lobbyId); });
+}
+
+void LobbyManager::checkCleanup(uint64_t lobbyId) {
+    cleanupTimers.erase(lobbyId);
+
+    auto it = lobbies.find(lobbyId);
+    if (it == lobbies.end()) return;
+
+    // Members log out or drop without leaving; once none is online the
+    // lobby can never start again
+    uint64_t clientId;
+    for (const auto& member : it->second.members) {
+        if (authManager->getClientForAccount(member.accountId, clientId)) {
+            scheduleCleanup(lobbyId);
+            return;
+        }
+    }
+
+    LOG_INFO(lobbyLog, "Lobby {} closed: no members online", lobbyId);
+    removeLobby(lobbyId);
+}
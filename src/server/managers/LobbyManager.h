@@ -1,14 +1,18 @@
 #pragma once
 #include "../../common/NetworkProtocol.h"
 #include "../../common/DataStructures.h"
+#include "../TimerWheel.h"
+#include "AuthManager.h"
 #include <map>
 #include <vector>
 #include <string>
 
-// Lobby Manager - handles lobby creation, joining, and party management
+// Lobby Manager - handles lobby creation, joining, and party management.
+// Queued lobbies drop out of the queue after QUEUE_TIMEOUT; lobbies with no
+// member online are closed by a periodic per-lobby check.
 class LobbyManager {
 public:
-    LobbyManager();
+    LobbyManager(TimerWheel* timers, AuthManager* authMgr);
 
     // Create new lobby
     bool createLobby(uint64_t ownerAccountId, const std::string& lobbyName,
@@ -45,6 +49,9 @@ public:
     // Get queued lobbies
     const std::vector<uint64_t>& getQueuedLobbies() const;
 
+    // Lobbies whose queue timed out since the last call (now READY again)
+    void takeExpiredQueues(std::vector<uint64_t>& out);
+
     // Set lobby state
     void setLobbyState(uint64_t lobbyId, LobbyState state);
 
@@ -58,5 +65,15 @@ private:
     std::map<uint64_t, Lobby> lobbies;
     std::map<uint64_t, uint64_t> playerLobbies;  // accountId -> lobbyId
     std::vector<uint64_t> queuedLobbies;
+    std::vector<uint64_t> expiredQueues;
+    std::map<uint64_t, TimerWheel::TimerId> queueTimers;     // lobbyId -> queue timeout
+    std::map<uint64_t, TimerWheel::TimerId> cleanupTimers;   // lobbyId -> next cleanup check
+    TimerWheel* timers;
+    AuthManager* authManager;
     uint64_t nextLobbyId;
+
+    void removeFromQueue(uint64_t lobbyId);
+    void expireQueue(uint64_t lobbyId);
+    void scheduleCleanup(uint64_t lobbyId);
+    void checkCleanup(uint64_t lobbyId);
 };
@@ -1,9 +1,41 @@
 #include "MatchManager.h"
-#include <iostream>
+#include "../../common/Logger.h"
+#include "../../common/PlayerMovement.h"
+#include <algorithm>
+#include <cmath>
 #include <random>
 #include <cstring>
 
-MatchManager::MatchManager() : nextMatchId(1) {
+namespace {
+    LogCategory matchLog("MatchManager", 100);
+
+    // Commands held for a player beyond this are dropped unapplied; the
+    // client sends them again until they are acknowledged
+    constexpr size_t MAX_QUEUED_INPUTS = MAX_INPUT_COMMANDS;
+
+    // Ticks of unused input allowance a player can bank, so commands that
+    // arrive bunched up by jitter still all apply promptly
+    constexpr int MAX_INPUT_BUDGET = 4;
+
+    // How far a shot's origin may be from the server's position for the
+    // shooter: prediction runs up to a few commands ahead of the server
+    constexpr float MAX_SHOT_ORIGIN_ERROR = 2.0f;
+    constexpr float MAX_SHOT_RANGE = 300.0f;
+
+    // Weapons aren't mapped to PlayerShoot::weaponId yet; every shot does
+    // the AK-74's damage
+    constexpr const char* DEFAULT_WEAPON = "ak74";
+
+    // Shot times are measured on the match clock, which advances a whole
+    // tick at a time; allow that much early
+    constexpr float SHOT_TIME_TOLERANCE = 1.0f / MOVEMENT_TICK_RATE;
+
+    // Finished matches stay readable this long, for handlers still holding
+    // them when they end, before their memory is freed
+    constexpr double FINISHED_MATCH_RETENTION = 60.0;   // Seconds
+}
+
+MatchManager::MatchManager(TimerWheel* timers) : timers(timers), nextMatchId(1) {
     initializeExtractionZones();
 }
 
@@ -33,6 +65,10 @@ bool MatchManager::createMatch(const std::vector<LobbyMember>& lobbyMembers, con
 
         // Map player to match
         playerMatches[member.accountId] = match.matchId;
+
+        // The raid's GameClient numbers its inputs from 1
+        playerInputs.erase(member.accountId);
+        nextShotTimes.erase(member.accountId);
     }
 
     // Generate spawn positions (party spawns together)
@@ -45,13 +81,21 @@ bool MatchManager::createMatch(const std::vector<LobbyMember>& lobbyMembers, con
     spawnAIEnemies(match);
 
     matches[match.matchId] = match;
+    matchHistory.erase(match.matchId);
+    matchHistory.emplace(match.matchId, PoseHistory(match));
     outMatchId = match.matchId;
 
     // Set state to active
     matches[match.matchId].state = MatchState::ACTIVE;
 
-    std::cout << "[MatchManager] Match created: " << match.matchId
-              << " (Map: " << mapName << ", Players: " << lobbyMembers.size() << ")" << std::endl;
+    uint64_t matchId = match.matchId;
+    raidTimers[matchId] = timers->schedule(match.raidDuration, [this, matchId]() {
+        raidTimers.erase(matchId);
+        LOG_INFO(matchLog, "Match {} timed out", matchId);
+        endMatch(matchId);
+    });
+
+    LOG_INFO(matchLog, "Match created: {} (Map: {}, Players: {})", match.matchId, mapName, lobbyMembers.size());
 
     return true;
 }
@@ -72,28 +116,125 @@ Match* MatchManager::getPlayerMatch(uint64_t accountId) {
     return nullptr;
 }
 
-bool MatchManager::updatePlayerPosition(uint64_t accountId, float x, float y, float z, float yaw, float pitch) {
+void MatchManager::queuePlayerInput(uint64_t accountId, const PlayerInput& input) {
+    Match* match = getPlayerMatch(accountId);
+    if (!match) return;
+
+    MatchPlayer* player = match->findPlayer(accountId);
+    if (!player || !player->alive) return;
+
+    // Each packet repeats commands already queued; take only the new ones.
+    // A gap (commands lost beyond the resend window) is skipped.
+    InputState& state = playerInputs[accountId];
+    for (uint8_t i = 0; i < input.commandCount; i++) {
+        uint32_t sequence = input.firstSequence + i;
+        if (state.lastSequence != 0 && !isNewerSequence(sequence, state.lastSequence)) continue;
+        if (state.queued.size() >= MAX_QUEUED_INPUTS) break;
+
+        state.queued.emplace_back(sequence, input.commands[i]);
+        state.lastSequence = sequence;
+    }
+}
+
+bool MatchManager::getPlayerState(uint64_t accountId, PlayerState& out) {
     Match* match = getPlayerMatch(accountId);
     if (!match) return false;
 
     MatchPlayer* player = match->findPlayer(accountId);
-    if (!player || !player->alive) return false;
+    if (!player) return false;
 
-    // Server-side validation: check for teleportation
-    float distance = calculateDistance3D(player->x, player->y, player->z, x, y, z);
-    if (distance > 50.0f) {
-        std::cout << "[MatchManager] WARNING: Possible teleport detected for player " << accountId
-                  << " (distance: " << distance << ")" << std::endl;
-        // In production, this would trigger anti-cheat
+    auto it = playerInputs.find(accountId);
+    out.inputSequence = it != playerInputs.end() ? it->second.appliedSequence : 0;
+    out.x = player->x;
+    out.z = player->z;
+    return true;
+}
+
+void MatchManager::simulatePlayers(Match& match) {
+    for (auto& player : match.players) {
+        auto it = playerInputs.find(player.accountId);
+        if (it == playerInputs.end()) continue;
+        InputState& state = it->second;
+
+        if (!player.alive || player.extracted) {
+            state.queued.clear();
+            continue;
+        }
+
+        // One command per tick is real time; the budget absorbs jitter
+        state.budget = std::min(state.budget + 1, MAX_INPUT_BUDGET);
+        while (state.budget > 0 && !state.queued.empty()) {
+            const MoveCommand& command = state.queued.front().second;
+
+            MoveState position;
+            position.x = player.x;
+            position.z = player.z;
+            applyMoveCommand(position, command);
+            player.x = position.x;
+            player.z = position.z;
+            player.yaw = dequantizeAngle(command.yaw);
+            player.pitch = dequantizeAngle(command.pitch);
+
+            state.appliedSequence = state.queued.front().first;
+            state.queued.pop_front();
+            state.budget--;
+        }
+    }
+}
+
+bool MatchManager::playerShoot(uint64_t accountId, const PlayerShoot& shot, float viewDelay, ShotResult& out) {
+    out = ShotResult();
+
+    Match* match = getPlayerMatch(accountId);
+    if (!match) return false;
+
+    MatchPlayer* shooter = match->findPlayer(accountId);
+    if (!shooter || !shooter->alive || shooter->extracted) return false;
+
+    float originError = calculateDistance2D(shooter->x, shooter->z, shot.originX, shot.originZ);
+    if (originError > MAX_SHOT_ORIGIN_ERROR) {
+        LOG_WARN(matchLog, "Shot from player {} rejected: origin {} m from server position", accountId, originError);
+        return false;
+    }
+
+    auto history = matchHistory.find(match->matchId);
+    if (history == matchHistory.end()) return false;
+
+    Item* weapon = ItemDatabase::getInstance().getItemTemplate(DEFAULT_WEAPON);
+    if (!weapon || weapon->fireRate <= 0.0f) return false;
+
+    // Each accepted shot moves the ready time on by one interval, so no
+    // client fires faster than the weapon, whatever it sends
+    float now = history->second.getTime();
+    auto nextShot = nextShotTimes.find(accountId);
+    if (nextShot != nextShotTimes.end() && now < nextShot->second - SHOT_TIME_TOLERANCE) {
+        LOG_WARN(matchLog, "Shot from player {} rejected: faster than {} rounds/min", accountId, weapon->fireRate);
         return false;
     }
+    float readyFrom = nextShot != nextShotTimes.end() ? std::max(now, nextShot->second) : now;
+    nextShotTimes[accountId] = readyFrom + 60.0f / weapon->fireRate;
+
+    // Rewinds beyond the history hit against its oldest frame
+    float rewind = std::min(viewDelay, history->second.getDuration());
 
-    player->x = x;
-    player->y = y;
-    player->z = z;
-    player->yaw = yaw;
-    player->pitch = pitch;
+    PoseHistory::RayHit hit;
+    if (!history->second.raycast(rewind, shot.originX, shot.originZ, shot.dirX, shot.dirZ,
+                                 MAX_SHOT_RANGE, accountId, hit)) {
+        return true;
+    }
 
+    float damage = static_cast<float>(weapon->damage);
+    if (damage <= 0.0f) return true;
+
+    if (!playerTakeDamage(hit.accountId, damage, accountId)) return true;
+    MatchPlayer* target = match->findPlayer(hit.accountId);
+
+    out.hit = true;
+    out.targetAccountId = hit.accountId;
+    out.damage = damage;
+    out.killed = target && !target->alive;
+
+    LOG_DEBUG(matchLog, "Player {} hit {} at {} m (rewound {} s)", accountId, hit.accountId, hit.distance, rewind);
     return true;
 }
 
@@ -107,15 +248,21 @@ bool MatchManager::playerTakeDamage(uint64_t accountId, float damage, uint64_t a
     // Apply damage
     player->health -= damage;
 
-    std::cout << "[MatchManager] Player " << accountId << " took " << damage
-              << " damage (HP: " << player->health << ")" << std::endl;
+    // Attacker and victim stay relevant to each other at any range
+    auto interestIt = matchInterest.find(match->matchId);
+    auto snapshotIt = matchSnapshots.find(match->matchId);
+    if (interestIt != matchInterest.end() && snapshotIt != matchSnapshots.end()) {
+        interestIt->second.recordPlayerInteraction(accountId, attackerId, snapshotIt->second.tick);
+    }
+
+    LOG_DEBUG(matchLog, "Player {} took {} damage (HP: {})", accountId, damage, player->health);
 
     // Check for death
     if (player->health <= 0) {
         player->alive = false;
         player->health = 0;
 
-        std::cout << "[MatchManager] Player " << accountId << " died in match " << match->matchId << std::endl;
+        LOG_INFO(matchLog, "Player {} died in match {}", accountId, match->matchId);
 
         // Check if match should end
         if (match->allExtractedOrDead()) {
@@ -139,8 +286,7 @@ bool MatchManager::playerLootItem(uint64_t accountId, uint64_t lootEntityId, Ite
             // Validate proximity (must be within 5 meters)
             float distance = calculateDistance3D(player->x, player->y, player->z, loot.x, loot.y, loot.z);
             if (distance > 5.0f) {
-                std::cout << "[MatchManager] WARNING: Loot too far for player " << accountId
-                          << " (distance: " << distance << ")" << std::endl;
+                LOG_WARN(matchLog, "Loot too far for player {} (distance: {})", accountId, distance);
                 return false;
             }
 
@@ -152,7 +298,7 @@ bool MatchManager::playerLootItem(uint64_t accountId, uint64_t lootEntityId, Ite
             outItem.foundInRaid = true;
             player->lootCollected.push_back(outItem);
 
-            std::cout << "[MatchManager] Player " << accountId << " looted " << loot.item.name << std::endl;
+            LOG_INFO(matchLog, "Player {} looted {}", accountId, loot.item.name);
 
             return true;
         }
@@ -174,15 +320,18 @@ bool MatchManager::playerExtract(uint64_t accountId, const std::string& extracti
             // Validate player is in zone
             float distance = calculateDistance2D(player->x, player->z, zone.x, zone.z);
             if (distance > zone.radius) {
-                std::cout << "[MatchManager] Player " << accountId << " not in extraction zone" << std::endl;
+                LOG_INFO(matchLog, "Player {} not in extraction zone", accountId);
                 return false;
             }
 
             // Extract player
             player->extracted = true;
             playerMatches.erase(accountId);
+            replication.erase(accountId);
+            playerInputs.erase(accountId);
+            nextShotTimes.erase(accountId);
 
-            std::cout << "[MatchManager] Player " << accountId << " extracted from match " << match->matchId << std::endl;
+            LOG_INFO(matchLog, "Player {} extracted from match {}", accountId, match->matchId);
 
             // Check if match should end
             if (match->allExtractedOrDead()) {
@@ -196,20 +345,19 @@ bool MatchManager::playerExtract(uint64_t accountId, const std::string& extracti
     return false;
 }
 
-void MatchManager::update() {
-    uint64_t currentTime = getCurrentTimestamp();
-
+void MatchManager::update(float deltaTime) {
     std::vector<uint64_t> toEnd;
 
     for (auto& pair : matches) {
         Match& match = pair.second;
 
         if (match.state == MatchState::ACTIVE) {
-            // Check for timeout
-            float elapsed = static_cast<float>(currentTime) - match.startTime;
-            if (elapsed >= match.raidDuration) {
-                std::cout << "[MatchManager] Match " << match.matchId << " timed out" << std::endl;
-                toEnd.push_back(match.matchId);
+            simulatePlayers(match);
+            updateEnemies(match, deltaTime);
+
+            auto history = matchHistory.find(match.matchId);
+            if (history != matchHistory.end()) {
+                history->second.record(match, deltaTime);
             }
 
             // Check if all players extracted or died
@@ -219,7 +367,7 @@ void MatchManager::update() {
         }
     }
 
-    // End timed-out matches
+    // End finished matches
     for (uint64_t matchId : toEnd) {
         endMatch(matchId);
     }
@@ -237,6 +385,133 @@ const std::vector<ExtractionZone>& MatchManager::getExtractionZones() const {
     return extractionZones;
 }
 
+void MatchManager::captureSnapshots(uint32_t tick) {
+    for (const auto& pair : matches) {
+        const Match& match = pair.second;
+        if (match.state != MatchState::ACTIVE) continue;
+
+        WorldSnapshot& snapshot = matchSnapshots[match.matchId];
+        snapshot.tick = tick;
+
+        snapshot.players.clear();
+        for (const auto& player : match.players) {
+            if (player.extracted) continue;
+
+            SnapshotPlayer entity;
+            entity.id = player.accountId;
+            entity.fields[PLAYER_X] = quantizePosition(player.x);
+            entity.fields[PLAYER_Y] = quantizePosition(player.y);
+            entity.fields[PLAYER_Z] = quantizePosition(player.z);
+            entity.fields[PLAYER_YAW] = quantizeAngle(player.yaw);
+            entity.fields[PLAYER_PITCH] = quantizeAngle(player.pitch);
+            entity.fields[PLAYER_HEALTH] = quantizeHealth(player.health);
+            entity.fields[PLAYER_FLAGS] = player.alive ? SNAPSHOT_FLAG_ALIVE : 0;
+            snapshot.players.push_back(entity);
+        }
+
+        snapshot.enemies.clear();
+        for (const auto& enemy : matchEnemies[match.matchId]) {
+            SnapshotEnemy entity;
+            entity.id = enemy.entityId;
+            entity.fields[ENEMY_X] = quantizePosition(enemy.x);
+            entity.fields[ENEMY_Y] = quantizePosition(enemy.y);
+            entity.fields[ENEMY_Z] = quantizePosition(enemy.z);
+            entity.fields[ENEMY_YAW] = quantizeAngle(enemy.yaw);
+            entity.fields[ENEMY_HEALTH] = quantizeHealth(enemy.health);
+            entity.fields[ENEMY_FLAGS] = static_cast<uint16_t>((enemy.alive ? SNAPSHOT_FLAG_ALIVE : 0) |
+                                                               (enemy.aggroed ? SNAPSHOT_FLAG_AGGROED : 0) |
+                                                               (static_cast<uint16_t>(enemy.type) << 4));
+            snapshot.enemies.push_back(entity);
+        }
+
+        snapshot.collectedLoot.clear();
+        const auto& loot = matchLoot[match.matchId];
+        for (size_t i = 0; i < loot.size(); i++) {
+            if (loot[i].collected) snapshot.collectedLoot.push_back(static_cast<uint32_t>(i));
+        }
+
+        // Encoder and decoder both rely on id order
+        auto byId = [](const auto& a, const auto& b) { return a.id < b.id; };
+        std::sort(snapshot.players.begin(), snapshot.players.end(), byId);
+        std::sort(snapshot.enemies.begin(), snapshot.enemies.end(), byId);
+
+        InterestManager& interest = matchInterest[match.matchId];
+        for (const auto& enemy : matchEnemies[match.matchId]) {
+            if (enemy.alive && enemy.aggroed) {
+                interest.recordEnemyInteraction(enemy.entityId, enemy.targetPlayerId, tick);
+            }
+        }
+        interest.rebuild(snapshot);
+    }
+}
+
+std::vector<uint64_t> MatchManager::getRaidPlayers() const {
+    std::vector<uint64_t> accounts;
+    accounts.reserve(playerMatches.size());
+    for (const auto& pair : playerMatches) {
+        accounts.push_back(pair.first);
+    }
+    return accounts;
+}
+
+size_t MatchManager::encodeSnapshot(uint64_t accountId, uint8_t* buffer, size_t capacity) {
+    auto matchIt = playerMatches.find(accountId);
+    if (matchIt == playerMatches.end()) return 0;
+
+    auto snapshotIt = matchSnapshots.find(matchIt->second);
+    if (snapshotIt == matchSnapshots.end()) return 0;
+
+    ReplicationState& state = replication[accountId];
+
+    const WorldSnapshot* previous = !state.pending.empty() ? &state.pending.back()
+                                  : state.acked.sequence != 0 ? &state.acked : nullptr;
+    WorldSnapshot snapshot;
+    matchInterest[matchIt->second].buildView(accountId, snapshotIt->second, previous, state.nextSequence, snapshot);
+    snapshot.sequence = state.nextSequence;
+    const WorldSnapshot* baseline = state.acked.sequence != 0 ? &state.acked : nullptr;
+
+    size_t size = ::encodeSnapshot(snapshot, baseline, buffer, capacity);
+    if (size == 0) {
+        LOG_WARN(matchLog, "Snapshot for player {} does not fit in {} bytes", accountId, capacity);
+        return 0;
+    }
+
+    // Sequence 0 is reserved for "no baseline"
+    state.nextSequence = state.nextSequence == UINT32_MAX ? 1 : state.nextSequence + 1;
+    state.pending.push_back(std::move(snapshot));
+    if (state.pending.size() > SNAPSHOT_HISTORY) {
+        state.pending.pop_front();
+    }
+    return size;
+}
+
+void MatchManager::acknowledgeSnapshot(uint64_t accountId, uint32_t sequence) {
+    auto it = replication.find(accountId);
+    if (it == replication.end()) return;
+    ReplicationState& state = it->second;
+
+    // Client lost its baseline; start over from a full snapshot
+    if (sequence == 0) {
+        state.acked = WorldSnapshot();
+        state.pending.clear();
+        return;
+    }
+
+    // Acks travel unreliably and can arrive out of order: only move forward
+    if (state.acked.sequence != 0 && !isNewerSequence(sequence, state.acked.sequence)) return;
+
+    while (!state.pending.empty()) {
+        WorldSnapshot& oldest = state.pending.front();
+        if (oldest.sequence == sequence) {
+            state.acked = std::move(oldest);
+            state.pending.pop_front();
+            return;
+        }
+        if (isNewerSequence(oldest.sequence, sequence)) return;  // Already dropped from history
+        state.pending.pop_front();
+    }
+}
+
 void MatchManager::generateSpawnPositions(Match& match) {
     static std::random_device rd;
     static std::mt19937 gen(rd());
@@ -256,9 +531,8 @@ void MatchManager::generateSpawnPositions(Match& match) {
         match.players[i].yaw = dis(gen);
         match.players[i].pitch = 0.0f;
 
-        std::cout << "[MatchManager] Player " << match.players[i].username
-                  << " spawned at (" << match.players[i].x << ", "
-                  << match.players[i].y << ", " << match.players[i].z << ")" << std::endl;
+        LOG_INFO(matchLog, "Player {} spawned at ({}, {}, {})",
+                 match.players[i].username, match.players[i].x, match.players[i].y, match.players[i].z);
     }
 }
 
@@ -294,7 +568,7 @@ void MatchManager::generateLoot(Match& match) {
     }
 
     matchLoot[match.matchId] = loot;
-    std::cout << "[MatchManager] Generated " << lootCount << " loot spawns for match " << match.matchId << std::endl;
+    LOG_INFO(matchLog, "Generated {} loot spawns for match {}", lootCount, match.matchId);
 }
 
 void MatchManager::spawnAIEnemies(Match& match) {
@@ -324,7 +598,48 @@ void MatchManager::spawnAIEnemies(Match& match) {
     }
 
     matchEnemies[match.matchId] = enemies;
-    std::cout << "[MatchManager] Spawned " << enemyCount << " AI enemies for match " << match.matchId << std::endl;
+    LOG_INFO(matchLog, "Spawned {} AI enemies for match {}", enemyCount, match.matchId);
+}
+
+void MatchManager::updateEnemies(Match& match, float deltaTime) {
+    const float AGGRO_RANGE = 30.0f;
+    const float PATROL_SPEED = 1.5f;    // m/s
+    const float PATROL_TURN = 20.0f;    // deg/s
+    const float CHASE_SPEED = 3.0f;
+    const float CHASE_STOP = 10.0f;     // Hold position this close to the target
+
+    for (auto& enemy : matchEnemies[match.matchId]) {
+        if (!enemy.alive) continue;
+
+        // Nearest living player in aggro range
+        MatchPlayer* target = nullptr;
+        float targetDistance = AGGRO_RANGE;
+        for (auto& player : match.players) {
+            if (!player.alive || player.extracted) continue;
+            float distance = calculateDistance2D(enemy.x, enemy.z, player.x, player.z);
+            if (distance < targetDistance) {
+                target = &player;
+                targetDistance = distance;
+            }
+        }
+
+        enemy.aggroed = target != nullptr;
+        enemy.targetPlayerId = target ? target->accountId : 0;
+
+        float speed = PATROL_SPEED;
+        if (target) {
+            // Face the player and close in
+            enemy.yaw = std::atan2(target->x - enemy.x, target->z - enemy.z) * 180.0f / 3.14159265f;
+            speed = targetDistance > CHASE_STOP ? CHASE_SPEED : 0.0f;
+        } else {
+            // Wander in a slow circle
+            enemy.yaw = std::fmod(enemy.yaw + PATROL_TURN * deltaTime, 360.0f);
+        }
+
+        float radians = enemy.yaw * 3.14159265f / 180.0f;
+        enemy.x += std::sin(radians) * speed * deltaTime;
+        enemy.z += std::cos(radians) * speed * deltaTime;
+    }
 }
 
 void MatchManager::initializeExtractionZones() {
@@ -365,23 +680,37 @@ void MatchManager::initializeExtractionZones() {
 
 void MatchManager::endMatch(uint64_t matchId) {
     auto it = matches.find(matchId);
-    if (it == matches.end()) return;
+    if (it == matches.end() || it->second.state == MatchState::FINISHED) return;
 
     Match& match = it->second;
     match.state = MatchState::ENDING;
     match.active = false;
 
-    std::cout << "[MatchManager] Match " << matchId << " ended" << std::endl;
+    LOG_INFO(matchLog, "Match {} ended", matchId);
 
     // Remove player mappings
     for (const auto& player : match.players) {
         playerMatches.erase(player.accountId);
+        replication.erase(player.accountId);
+        playerInputs.erase(player.accountId);
+        nextShotTimes.erase(player.accountId);
     }
 
-    // Clean up loot and enemies
+    // Clean up loot, enemies and replication
     matchLoot.erase(matchId);
     matchEnemies.erase(matchId);
+    matchSnapshots.erase(matchId);
+    matchInterest.erase(matchId);
+    matchHistory.erase(matchId);
+
+    auto raidTimer = raidTimers.find(matchId);
+    if (raidTimer != raidTimers.end()) {
+        timers->cancel(raidTimer->second);
+        raidTimers.erase(raidTimer);
+    }
 
     // Mark as finished
     match.state = MatchState::FINISHED;
+
+    timers->schedule(FINISHED_MATCH_RETENTION, [this, matchId]() { matches.erase(matchId); });
 }
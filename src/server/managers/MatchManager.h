@@ -2,14 +2,27 @@
 #include "../../common/NetworkProtocol.h"
 #include "../../common/DataStructures.h"
 #include "../../common/ItemDatabase.h"
+#include "../../common/WorldSnapshot.h"
+#include "InterestManager.h"
+#include "PoseHistory.h"
+#include "../TimerWheel.h"
+#include <deque>
 #include <map>
 #include <vector>
 #include <string>
 
+// Outcome of a shot that passed validation
+struct ShotResult {
+    bool hit = false;
+    uint64_t targetAccountId = 0;
+    float damage = 0.0f;
+    bool killed = false;
+};
+
 // Match Manager - handles match creation, spawning, and raid management
 class MatchManager {
 public:
-    MatchManager();
+    explicit MatchManager(TimerWheel* timers);
 
     // Create match from lobby
     bool createMatch(const std::vector<LobbyMember>& lobbyMembers, const std::string& mapName, uint64_t& outMatchId);
@@ -20,8 +33,20 @@ public:
     // Get player's match
     Match* getPlayerMatch(uint64_t accountId);
 
-    // Update player position
-    bool updatePlayerPosition(uint64_t accountId, float x, float y, float z, float yaw, float pitch);
+    // Queue movement commands from the player's client (PlayerMovement.h).
+    // They are applied by update(), at most one per tick on average, so a
+    // client cannot move faster by sending more of them.
+    void queuePlayerInput(uint64_t accountId, const PlayerInput& input);
+
+    // Position after the last command applied, for PLAYER_STATE
+    bool getPlayerState(uint64_t accountId, PlayerState& out);
+
+    // Validate a shot and apply its damage. Targets are rewound to where
+    // they were `viewDelay` seconds ago, when the shooter saw them (see
+    // PoseHistory). Returns false if the shot is rejected: fired from too
+    // far from the server's position, or sooner than the weapon's fire
+    // rate allows.
+    bool playerShoot(uint64_t accountId, const PlayerShoot& shot, float viewDelay, ShotResult& out);
 
     // Player takes damage
     bool playerTakeDamage(uint64_t accountId, float damage, uint64_t attackerId);
@@ -32,8 +57,9 @@ public:
     // Player extracts
     bool playerExtract(uint64_t accountId, const std::string& extractionName);
 
-    // Update match (check for timeout)
-    void update();
+    // Update active matches: player movement, enemy AI and end checks.
+    // Raid timeouts run on timers.
+    void update(float deltaTime);
 
     // Get loot spawns for match
     const std::vector<LootSpawn>& getMatchLoot(uint64_t matchId);
@@ -44,17 +70,57 @@ public:
     // Get extraction zones
     const std::vector<ExtractionZone>& getExtractionZones() const;
 
+    // Capture every active match's world state; call once per network tick
+    void captureSnapshots(uint32_t tick);
+
+    // Accounts currently in a raid (snapshot recipients)
+    std::vector<uint64_t> getRaidPlayers() const;
+
+    // Encode the player's view of the latest snapshot of their match (see
+    // InterestManager) as a delta against the newest one they acknowledged.
+    // Returns the payload size, 0 if there is nothing to send or it does not fit.
+    size_t encodeSnapshot(uint64_t accountId, uint8_t* buffer, size_t capacity);
+
+    // Client decoded snapshot `sequence`; 0 asks for a full snapshot
+    void acknowledgeSnapshot(uint64_t accountId, uint32_t sequence);
+
 private:
+    // Per-recipient delta state. Sent snapshots wait in `pending` until
+    // acknowledged; the newest acknowledged one becomes the baseline.
+    struct ReplicationState {
+        uint32_t nextSequence = 1;
+        WorldSnapshot acked;                // sequence 0 = none, send full
+        std::deque<WorldSnapshot> pending;  // Sent, not yet acknowledged (oldest first)
+    };
+
+    // Per-player movement commands waiting for simulation ticks
+    struct InputState {
+        uint32_t lastSequence = 0;          // Newest command queued, 0 = none yet
+        uint32_t appliedSequence = 0;       // Newest command applied
+        std::deque<std::pair<uint32_t, MoveCommand>> queued;    // Sequence, command
+        int budget = 0;                     // Commands the player may still apply
+    };
+
     std::map<uint64_t, Match> matches;
     std::map<uint64_t, uint64_t> playerMatches;  // accountId -> matchId
     std::map<uint64_t, std::vector<LootSpawn>> matchLoot;
     std::map<uint64_t, std::vector<AIEnemy>> matchEnemies;
+    std::map<uint64_t, WorldSnapshot> matchSnapshots;       // matchId -> latest capture
+    std::map<uint64_t, InterestManager> matchInterest;      // matchId -> relevance grid
+    std::map<uint64_t, ReplicationState> replication;       // accountId -> delta state
+    std::map<uint64_t, InputState> playerInputs;            // accountId -> queued movement
+    std::map<uint64_t, PoseHistory> matchHistory;           // matchId -> recent player poses
+    std::map<uint64_t, float> nextShotTimes;                // accountId -> match time the weapon is ready
+    std::map<uint64_t, TimerWheel::TimerId> raidTimers;     // matchId -> raid end
     std::vector<ExtractionZone> extractionZones;
+    TimerWheel* timers;
     uint64_t nextMatchId;
 
     void generateSpawnPositions(Match& match);
     void generateLoot(Match& match);
     void spawnAIEnemies(Match& match);
+    void simulatePlayers(Match& match);
+    void updateEnemies(Match& match, float deltaTime);
     void initializeExtractionZones();
     void endMatch(uint64_t matchId);
 };
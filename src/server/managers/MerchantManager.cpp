@@ -1,5 +1,10 @@
 #include "MerchantManager.h"
-#include <iostream>
+#include "../../common/Logger.h"
+#include <algorithm>
+
+namespace {
+    LogCategory merchantLog("MerchantManager");
+}
 
 MerchantManager::MerchantManager(PersistenceManager* persistMgr) : persistenceManager(persistMgr) {
     initializeMerchants();
@@ -86,8 +91,8 @@ bool MerchantManager::buyItem(uint64_t accountId, MerchantType merchantType, con
     // Save player data
     persistenceManager->savePlayerData(accountId);
 
-    std::cout << "[MerchantManager] Player " << accountId << " bought " << quantity << "x "
-              << itemId << " from " << merchant.name << " for " << totalCost << " roubles" << std::endl;
+    LOG_INFO(merchantLog, "Player {} bought {}x {} from {} for {} roubles",
+             accountId, quantity, itemId, merchant.name, totalCost);
 
     return true;
 }
@@ -138,8 +143,7 @@ bool MerchantManager::sellItem(uint64_t accountId, MerchantType merchantType, ui
     // Save player data
     persistenceManager->savePlayerData(accountId);
 
-    std::cout << "[MerchantManager] Player " << accountId << " sold "
-              << item.name << " to " << merchant.name << " for " << sellPrice << " roubles" << std::endl;
+    LOG_INFO(merchantLog, "Player {} sold {} to {} for {} roubles", accountId, item.name, merchant.name, sellPrice);
 
     return true;
 }
@@ -249,7 +253,7 @@ void MerchantManager::initializeMerchants() {
         merchants[MerchantType::RAGMAN] = ragman;
     }
 
-    std::cout << "[MerchantManager] Initialized " << merchants.size() << " merchants" << std::endl;
+    LOG_INFO(merchantLog, "Initialized {} merchants", merchants.size());
 }
 
 void MerchantManager::addOffer(Merchant& merchant, const std::string& itemId, int stock, float markup) {
@@ -1,8 +1,12 @@
 #include "PersistenceManager.h"
-#include <iostream>
+#include "../../common/Logger.h"
 #include <fstream>
 #include <sstream>
 
+namespace {
+    LogCategory persistenceLog("PersistenceManager");
+}
+
 PersistenceManager::PersistenceManager() {
     loadAllPlayerData();
 }
@@ -14,7 +18,7 @@ PersistenceManager::~PersistenceManager() {
 bool PersistenceManager::createPlayerData(uint64_t accountId, const std::string& username) {
     // Check if already exists
     if (playerDataMap.find(accountId) != playerDataMap.end()) {
-        std::cout << "[PersistenceManager] Player data already exists for account " << accountId << std::endl;
+        LOG_INFO(persistenceLog, "Player data already exists for account {}", accountId);
         return false;
     }
 
@@ -28,7 +32,7 @@ bool PersistenceManager::createPlayerData(uint64_t accountId, const std::string&
 
     playerDataMap[accountId] = playerData;
 
-    std::cout << "[PersistenceManager] Created player data for " << username << std::endl;
+    LOG_INFO(persistenceLog, "Created player data for {}", username);
 
     // Auto-save
     savePlayerData(accountId);
@@ -47,7 +51,7 @@ PlayerData* PersistenceManager::getPlayerData(uint64_t accountId) {
 bool PersistenceManager::savePlayerData(uint64_t accountId) {
     auto it = playerDataMap.find(accountId);
     if (it == playerDataMap.end()) {
-        std::cout << "[PersistenceManager] Cannot save - player data not found for account " << accountId << std::endl;
+        LOG_WARN(persistenceLog, "Cannot save - player data not found for account {}", accountId);
         return false;
     }
 
@@ -56,7 +60,7 @@ bool PersistenceManager::savePlayerData(uint64_t accountId) {
     std::string filename = "Server/playerdata_" + std::to_string(accountId) + ".dat";
     std::ofstream file(filename);
     if (!file.is_open()) {
-        std::cout << "[PersistenceManager] Failed to open file for writing: " << filename << std::endl;
+        LOG_WARN(persistenceLog, "Failed to open file for writing: {}", filename);
         return false;
     }
 
@@ -101,7 +105,7 @@ bool PersistenceManager::loadPlayerData(uint64_t accountId) {
     std::string filename = "Server/playerdata_" + std::to_string(accountId) + ".dat";
     std::ifstream file(filename);
     if (!file.is_open()) {
-        std::cout << "[PersistenceManager] No save file found for account " << accountId << std::endl;
+        LOG_INFO(persistenceLog, "No save file found for account {}", accountId);
         return false;
     }
 
@@ -110,7 +114,7 @@ bool PersistenceManager::loadPlayerData(uint64_t accountId) {
     std::string line;
     std::getline(file, line);  // Version header
     if (line != "PLAYERDATA_V1") {
-        std::cout << "[PersistenceManager] Invalid save file version" << std::endl;
+        LOG_WARN(persistenceLog, "Invalid save file version");
         return false;
     }
 
@@ -172,7 +176,7 @@ bool PersistenceManager::loadPlayerData(uint64_t accountId) {
     file.close();
 
     playerDataMap[accountId] = data;
-    std::cout << "[PersistenceManager] Loaded player data for " << data.username << std::endl;
+    LOG_INFO(persistenceLog, "Loaded player data for {}", data.username);
 
     return true;
 }
@@ -180,7 +184,7 @@ bool PersistenceManager::loadPlayerData(uint64_t accountId) {
 void PersistenceManager::loadAllPlayerData() {
     // In a real implementation, you would scan the directory for all playerdata_*.dat files
     // For now, player data is loaded on-demand
-    std::cout << "[PersistenceManager] Persistence manager initialized" << std::endl;
+    LOG_INFO(persistenceLog, "Persistence manager initialized");
 }
 
 void PersistenceManager::saveAllPlayerData() {
@@ -190,7 +194,7 @@ void PersistenceManager::saveAllPlayerData() {
             count++;
         }
     }
-    std::cout << "[PersistenceManager] Saved " << count << " player profiles" << std::endl;
+    LOG_INFO(persistenceLog, "Saved {} player profiles", count);
 }
 
 void PersistenceManager::handleExtraction(uint64_t accountId, const std::vector<Item>& lootCollected) {
@@ -212,7 +216,7 @@ void PersistenceManager::handleExtraction(uint64_t accountId, const std::vector<
 
     // Keep loadout intact
 
-    std::cout << "[PersistenceManager] Player " << accountId << " extracted with " << lootCollected.size() << " items" << std::endl;
+    LOG_INFO(persistenceLog, "Player {} extracted with {} items", accountId, lootCollected.size());
 
     savePlayerData(accountId);
 }
@@ -233,7 +237,7 @@ void PersistenceManager::handleDeath(uint64_t accountId) {
     // Lose all loadout (no insurance system yet)
     data->loadout.clear();
 
-    std::cout << "[PersistenceManager] Player " << accountId << " died and lost all gear" << std::endl;
+    LOG_INFO(persistenceLog, "Player {} died and lost all gear", accountId);
 
     savePlayerData(accountId);
 }
@@ -271,7 +275,7 @@ bool PersistenceManager::loadItem(std::ifstream& file, Item& item) {
     // Create item from template
     item = itemDb.createItem(itemId, instanceId);
     if (item.id.empty()) {
-        std::cout << "[PersistenceManager] WARNING: Unknown item ID: " << itemId << std::endl;
+        LOG_WARN(persistenceLog, "Unknown item ID: {}", itemId);
         return false;
     }
 
@@ -313,5 +317,5 @@ void PersistenceManager::initializeStartingGear(PlayerData& data) {
     data.stash.push_back(itemDb.createItem("water", 12));
     data.stash.push_back(itemDb.createItem("tushonka", 13));
 
-    std::cout << "[PersistenceManager] Initialized starting gear for " << data.username << std::endl;
+    LOG_INFO(persistenceLog, "Initialized starting gear for {}", data.username);
 }
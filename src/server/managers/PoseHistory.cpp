@@ -0,0 +1,94 @@
+#include "PoseHistory.h"
+#include <algorithm>
+#include <cmath>
+
+PoseHistory::PoseHistory(const Match& match)
+    : playerCount(match.players.size()), frameCount(0),
+      newestFrame(HISTORY_FRAMES - 1), currentTime(0.0f),
+      frameTimes(HISTORY_FRAMES, 0.0f),
+      positionX(HISTORY_FRAMES * match.players.size(), 0.0f),
+      positionZ(HISTORY_FRAMES * match.players.size(), 0.0f),
+      alive(HISTORY_FRAMES * match.players.size(), 0) {
+    accountIds.reserve(playerCount);
+    for (const auto& player : match.players) {
+        accountIds.push_back(player.accountId);
+    }
+}
+
+void PoseHistory::record(const Match& match, float deltaTime) {
+    currentTime += deltaTime;
+    newestFrame = (newestFrame + 1) % HISTORY_FRAMES;
+    frameCount = std::min(frameCount + 1, HISTORY_FRAMES);
+    frameTimes[newestFrame] = currentTime;
+
+    size_t base = newestFrame * playerCount;
+    size_t slots = std::min(playerCount, match.players.size());
+    for (size_t slot = 0; slot < slots; slot++) {
+        const auto& player = match.players[slot];
+        positionX[base + slot] = player.x;
+        positionZ[base + slot] = player.z;
+        alive[base + slot] = player.alive && !player.extracted;
+    }
+}
+
+bool PoseHistory::raycast(float secondsAgo, float originX, float originZ, float dirX, float dirZ,
+                          float maxDistance, uint64_t ignoreAccountId, RayHit& out) const {
+    if (frameCount == 0) return false;
+
+    float length = std::sqrt(dirX * dirX + dirZ * dirZ);
+    if (length < 1e-4f) return false;   // Straight up or down
+    dirX /= length;
+    dirZ /= length;
+
+    // Walk back from the newest frame to the pair bracketing the view time;
+    // `older` stops at the oldest frame when the time is further back
+    float time = currentTime - std::max(secondsAgo, 0.0f);
+    size_t newer = newestFrame;
+    size_t older = newestFrame;
+    for (size_t i = 1; i < frameCount && frameTimes[older] > time; i++) {
+        newer = older;
+        older = (newestFrame + HISTORY_FRAMES - i) % HISTORY_FRAMES;
+    }
+    float span = frameTimes[newer] - frameTimes[older];
+    float blend = 0.0f;
+    if (span > 0.0f && time > frameTimes[older]) {
+        blend = std::min((time - frameTimes[older]) / span, 1.0f);
+    }
+
+    size_t olderBase = older * playerCount;
+    size_t newerBase = newer * playerCount;
+    bool found = false;
+    for (size_t slot = 0; slot < playerCount; slot++) {
+        if (accountIds[slot] == ignoreAccountId) continue;
+        if (!alive[olderBase + slot] || !alive[newerBase + slot]) continue;
+
+        float x = positionX[olderBase + slot] + (positionX[newerBase + slot] - positionX[olderBase + slot]) * blend;
+        float z = positionZ[olderBase + slot] + (positionZ[newerBase + slot] - positionZ[olderBase + slot]) * blend;
+
+        // Ray against the hitbox circle: closest approach, then step back to
+        // where the ray enters it
+        float toX = x - originX;
+        float toZ = z - originZ;
+        float along = toX * dirX + toZ * dirZ;
+        float missSq = toX * toX + toZ * toZ - along * along;
+        float radiusSq = HITBOX_RADIUS * HITBOX_RADIUS;
+        if (missSq > radiusSq) continue;
+
+        if (along < 0.0f && toX * toX + toZ * toZ > radiusSq) continue;    // Behind the shooter
+
+        float distance = std::max(along - std::sqrt(radiusSq - missSq), 0.0f);
+        if (distance > maxDistance) continue;
+        if (found && distance >= out.distance) continue;
+
+        out.accountId = accountIds[slot];
+        out.distance = distance;
+        found = true;
+    }
+    return found;
+}
+
+float PoseHistory::getDuration() const {
+    if (frameCount == 0) return 0.0f;
+    size_t oldest = (newestFrame + HISTORY_FRAMES - (frameCount - 1)) % HISTORY_FRAMES;
+    return currentTime - frameTimes[oldest];
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include "../../common/DataStructures.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Pose History - the last second of a match's player poses, so a shot can be
+// checked against the targets as the shooter saw them instead of where they
+// are by the time the shot reaches the server (lag compensation). One
+// instance per match.
+//
+// A ring of HISTORY_FRAMES frames, one recorded per simulation tick. Each
+// field is a flat array indexed by frame * playerCount + slot, sized when
+// the match starts, so recording and rewinding never allocate. Slots follow
+// Match::players, which does not change during a match.
+//
+// Hitboxes are vertical cylinders: the server doesn't simulate height (the
+// terrain only exists on clients), so only a shot's horizontal path is tested.
+class PoseHistory {
+public:
+    static constexpr size_t HISTORY_FRAMES = 64;    // ~1 s at 60 Hz
+    static constexpr float HITBOX_RADIUS = 0.4f;    // Metres
+
+    struct RayHit {
+        uint64_t accountId = 0;
+        float distance = 0.0f;      // Horizontal, from the ray origin
+    };
+
+    explicit PoseHistory(const Match& match);
+
+    // Append the players' current poses, `deltaTime` after the last frame
+    void record(const Match& match, float deltaTime);
+
+    // Nearest player other than `ignoreAccountId` whose hitbox the ray
+    // crosses within `maxDistance`, with poses as they were `secondsAgo`
+    // (interpolated between frames, clamped to the oldest one)
+    bool raycast(float secondsAgo, float originX, float originZ, float dirX, float dirZ,
+                 float maxDistance, uint64_t ignoreAccountId, RayHit& out) const;
+
+    // How far back the history reaches
+    float getDuration() const;
+
+    // Match time of the newest frame
+    float getTime() const { return currentTime; }
+
+private:
+    size_t playerCount;
+    size_t frameCount;          // Recorded so far, up to HISTORY_FRAMES
+    size_t newestFrame;
+    float currentTime;          // Match time of the newest frame
+
+    std::vector<uint64_t> accountIds;   // Per slot
+    std::vector<float> frameTimes;      // Per frame
+    std::vector<float> positionX;       // Per frame and slot
+    std::vector<float> positionZ;
+    std::vector<uint8_t> alive;
+};
@@ -0,0 +1,72 @@
+#include "SessionTable.h"
+#include "../../common/Utils.h"
+
+bool SessionTable::create(uint64_t accountId, uint64_t clientId, uint64_t now, uint64_t& outToken) {
+    if (byAccount.find(accountId) != byAccount.end()) return false;
+
+    // 0 means "no session" on the wire
+    uint64_t token;
+    do {
+        token = generateSessionToken();
+    } while (token == 0 || byToken.find(token) != byToken.end());
+
+    uint32_t index;
+    if (freeHead != NONE) {
+        index = freeHead;
+        freeHead = slots[index].nextFree;
+    } else {
+        index = static_cast<uint32_t>(slots.size());
+        slots.emplace_back();
+    }
+
+    Slot& slot = slots[index];
+    slot.nextFree = NONE;
+    slot.entry = Entry();
+    slot.entry.clientId = clientId;
+    slot.entry.session.sessionToken = token;
+    slot.entry.session.accountId = accountId;
+    slot.entry.session.created = now;
+    slot.entry.session.lastActivity = now;
+    slot.entry.session.valid = true;
+
+    byToken[token] = index;
+    byAccount[accountId] = index;
+    byClient[clientId] = index;
+    outToken = token;
+    return true;
+}
+
+SessionTable::Entry* SessionTable::find(uint64_t sessionToken) {
+    auto it = byToken.find(sessionToken);
+    return it != byToken.end() ? &slots[it->second].entry : nullptr;
+}
+
+SessionTable::Entry* SessionTable::findByAccount(uint64_t accountId) {
+    auto it = byAccount.find(accountId);
+    return it != byAccount.end() ? &slots[it->second].entry : nullptr;
+}
+
+SessionTable::Entry* SessionTable::findByClient(uint64_t clientId) {
+    auto it = byClient.find(clientId);
+    return it != byClient.end() ? &slots[it->second].entry : nullptr;
+}
+
+bool SessionTable::erase(uint64_t sessionToken) {
+    auto it = byToken.find(sessionToken);
+    if (it == byToken.end()) return false;
+
+    uint32_t index = it->second;
+    byToken.erase(it);
+
+    Slot& slot = slots[index];
+    byAccount.erase(slot.entry.session.accountId);
+    auto client = byClient.find(slot.entry.clientId);
+    if (client != byClient.end() && client->second == index) {
+        byClient.erase(client);
+    }
+
+    slot.entry = Entry();
+    slot.nextFree = freeHead;
+    freeHead = index;
+    return true;
+}
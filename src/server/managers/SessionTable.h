@@ -0,0 +1,48 @@
+#pragma once
+#include "../../common/DataStructures.h"
+#include "../TimerWheel.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Session Table - live sessions in a slot array, indexed by token, account
+// and client. Tokens are 64 random bits: they are the only credential on
+// gameplay datagrams, so none of their bits may be guessable, and a hash
+// index maps each one to its slot. Ended sessions give their slot back
+// through a free list, so the table never grows past the peak number of
+// sessions. One session per account and per client.
+class SessionTable {
+public:
+    struct Entry {
+        Session session;
+        uint64_t clientId = 0;
+        TimerWheel::TimerId expiryTimer = 0;
+    };
+
+    // Start a session. False if the account already has one.
+    bool create(uint64_t accountId, uint64_t clientId, uint64_t now, uint64_t& outToken);
+
+    // nullptr if the token is not a live session
+    Entry* find(uint64_t sessionToken);
+    Entry* findByAccount(uint64_t accountId);
+    Entry* findByClient(uint64_t clientId);
+
+    // End a session and free its slot. False if it was not live.
+    bool erase(uint64_t sessionToken);
+
+    size_t size() const { return byAccount.size(); }
+
+private:
+    static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+    struct Slot {
+        Entry entry;
+        uint32_t nextFree = NONE;
+    };
+
+    std::vector<Slot> slots;
+    uint32_t freeHead = NONE;
+    std::unordered_map<uint64_t, uint32_t> byToken;     // sessionToken -> slot
+    std::unordered_map<uint64_t, uint32_t> byAccount;   // accountId -> slot
+    std::unordered_map<uint64_t, uint32_t> byClient;    // clientId -> slot
+};
@@ -0,0 +1,163 @@
+#pragma once
+#include "../../common/NetworkProtocol.h"
+#include "../../common/LatencyHistogram.h"
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+
+// ============================================================================
+// CONNECTION STATS
+// Per-connection traffic numbers. A reactor is the only writer of its
+// connections' ConnectionStats; the game thread reads them at any time.
+// Counters are relaxed atomics (torn sums across fields are fine for
+// monitoring). RTT comes from heartbeat probes the reactor sends and the
+// client echoes, one sample per second, so its histogram sits behind a
+// mutex instead.
+// ============================================================================
+
+// Per-type counters use a dense slot per type: ten categories of at most 16
+// types (see PacketType), plus one slot for anything else
+constexpr size_t PACKET_TYPES_PER_CATEGORY = 16;
+constexpr size_t PACKET_TYPE_SLOTS = 10 * PACKET_TYPES_PER_CATEGORY + 1;
+constexpr size_t OTHER_PACKET_TYPE_SLOT = PACKET_TYPE_SLOTS - 1;
+
+inline size_t packetTypeSlot(PacketType type) {
+    uint16_t value = static_cast<uint16_t>(type);
+    size_t category = value / 100;
+    size_t offset = value % 100;
+    if (category >= 10 || offset >= PACKET_TYPES_PER_CATEGORY) return OTHER_PACKET_TYPE_SLOT;
+    return category * PACKET_TYPES_PER_CATEGORY + offset;
+}
+
+inline PacketType slotPacketType(size_t slot) {
+    if (slot >= OTHER_PACKET_TYPE_SLOT) return PacketType::INVALID_PACKET;
+    return static_cast<PacketType>(slot / PACKET_TYPES_PER_CATEGORY * 100 + slot % PACKET_TYPES_PER_CATEGORY);
+}
+
+// Packets and bytes (headers included) in one direction, as read by the
+// game thread
+struct TrafficCounters {
+    uint64_t packets = 0;
+    uint64_t bytes = 0;
+    uint64_t packetsByType[PACKET_TYPE_SLOTS] = {};
+
+    void add(PacketType type, size_t size) {
+        packets++;
+        bytes += size;
+        packetsByType[packetTypeSlot(type)]++;
+    }
+
+    void merge(const TrafficCounters& other) {
+        packets += other.packets;
+        bytes += other.bytes;
+        for (size_t i = 0; i < PACKET_TYPE_SLOTS; i++) {
+            packetsByType[i] += other.packetsByType[i];
+        }
+    }
+};
+
+// The same, written by a single reactor thread
+struct AtomicTrafficCounters {
+    std::atomic<uint64_t> packets{ 0 };
+    std::atomic<uint64_t> bytes{ 0 };
+    std::atomic<uint32_t> packetsByType[PACKET_TYPE_SLOTS] = {};
+
+    // Single writer: plain load + store, no locked read-modify-write
+    void add(PacketType type, size_t size) {
+        packets.store(packets.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        bytes.store(bytes.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+        std::atomic<uint32_t>& slot = packetsByType[packetTypeSlot(type)];
+        slot.store(slot.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void addTo(TrafficCounters& out) const {
+        out.packets += packets.load(std::memory_order_relaxed);
+        out.bytes += bytes.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < PACKET_TYPE_SLOTS; i++) {
+            out.packetsByType[i] += packetsByType[i].load(std::memory_order_relaxed);
+        }
+    }
+};
+
+// Live per-connection numbers, written by the owning reactor and readable
+// from the game thread. Outbound packets count when queued.
+struct ConnectionStats {
+    std::atomic<size_t> queuedBytes{ 0 };
+    std::atomic<size_t> peakQueuedBytes{ 0 };
+    AtomicTrafficCounters in;
+    AtomicTrafficCounters out;
+
+    // Heartbeat RTT, microseconds
+    std::atomic<uint32_t> probesSent{ 0 };
+    std::atomic<uint32_t> probesAnswered{ 0 };
+    std::atomic<uint32_t> lastRttMicros{ 0 };
+    std::atomic<uint32_t> smoothedRttMicros{ 0 };  // 1/8 gain, as TCP's SRTT
+    mutable std::mutex rttMutex;
+    LatencyHistogram rttMicros;
+
+    void setQueuedBytes(size_t bytes) {
+        queuedBytes.store(bytes, std::memory_order_relaxed);
+        if (bytes > peakQueuedBytes.load(std::memory_order_relaxed)) {
+            peakQueuedBytes.store(bytes, std::memory_order_relaxed);
+        }
+    }
+
+    void recordRtt(uint64_t micros) {
+        uint32_t sample = micros > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(micros);
+        uint32_t smoothed = smoothedRttMicros.load(std::memory_order_relaxed);
+        smoothed = smoothed == 0 ? sample : static_cast<uint32_t>((7ull * smoothed + sample) / 8);
+
+        lastRttMicros.store(sample, std::memory_order_relaxed);
+        smoothedRttMicros.store(smoothed, std::memory_order_relaxed);
+        probesAnswered.store(probesAnswered.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(rttMutex);
+        rttMicros.record(sample);
+    }
+};
+
+// Snapshot of one connection (NetworkServer::getConnectionStats) or of the
+// whole server (NetworkServer::getNetworkStats)
+struct NetworkTrafficStats {
+    uint32_t connections = 0;
+    TrafficCounters in;                 // TCP
+    TrafficCounters out;
+    TrafficCounters datagramsIn;        // Accepted UDP datagrams
+    TrafficCounters datagramsOut;
+    size_t queuedBytes = 0;             // Waiting for the socket now
+    size_t peakQueuedBytes = 0;         // Highest seen on one connection
+    uint64_t probesSent = 0;
+    uint64_t probesAnswered = 0;
+    uint32_t lastRttMicros = 0;         // One connection only
+    uint32_t smoothedRttMicros = 0;     // One connection only
+    LatencyHistogram rttMicros;
+
+    void addConnection(const ConnectionStats& stats) {
+        connections++;
+        stats.in.addTo(in);
+        stats.out.addTo(out);
+        queuedBytes += stats.queuedBytes.load(std::memory_order_relaxed);
+        size_t peak = stats.peakQueuedBytes.load(std::memory_order_relaxed);
+        if (peak > peakQueuedBytes) peakQueuedBytes = peak;
+        probesSent += stats.probesSent.load(std::memory_order_relaxed);
+        probesAnswered += stats.probesAnswered.load(std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(stats.rttMutex);
+        rttMicros.merge(stats.rttMicros);
+    }
+
+    // Totals only: lastRttMicros/smoothedRttMicros are left as they were
+    void merge(const NetworkTrafficStats& other) {
+        connections += other.connections;
+        in.merge(other.in);
+        out.merge(other.out);
+        datagramsIn.merge(other.datagramsIn);
+        datagramsOut.merge(other.datagramsOut);
+        queuedBytes += other.queuedBytes;
+        if (other.peakQueuedBytes > peakQueuedBytes) peakQueuedBytes = other.peakQueuedBytes;
+        probesSent += other.probesSent;
+        probesAnswered += other.probesAnswered;
+        rttMicros.merge(other.rttMicros);
+    }
+};
@@ -0,0 +1,771 @@
+#include "NetworkReactor.h"
+#include "../../common/Logger.h"
+#include <cstring>
+#include <chrono>
+
+#ifdef PLATFORM_LINUX
+#include <sys/eventfd.h>
+#endif
+
+namespace {
+    LogCategory reactorLog("NetworkReactor", 200);
+
+    // Socket error helpers shared by the Winsock and POSIX backends
+    int lastSocketError() {
+#ifdef PLATFORM_WINDOWS
+        return WSAGetLastError();
+#else
+        return errno;
+#endif
+    }
+
+    bool isWouldBlock(int error) {
+#ifdef PLATFORM_WINDOWS
+        return error == WSAEWOULDBLOCK;
+#else
+        return error == EAGAIN || error == EWOULDBLOCK;
+#endif
+    }
+
+    bool setNonBlocking(SOCKET s) {
+#ifdef PLATFORM_WINDOWS
+        u_long mode = 1;
+        return ioctlsocket(s, FIONBIO, &mode) == 0;
+#else
+        int flags = fcntl(s, F_GETFL, 0);
+        return flags != -1 && fcntl(s, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+    }
+}
+
+// ============================================================================
+// ActivitySignal
+// ============================================================================
+
+void ActivitySignal::notify() {
+    if (!pending.exchange(true, std::memory_order_acq_rel)) {
+        std::lock_guard<std::mutex> lock(mutex);
+        cv.notify_one();
+    }
+}
+
+bool ActivitySignal::wait(int timeoutMs) {
+    std::unique_lock<std::mutex> lock(mutex);
+    return cv.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+                       [this] { return pending.load(std::memory_order_acquire); });
+}
+
+// ============================================================================
+// NetworkReactor
+// ============================================================================
+
+NetworkReactor::NetworkReactor(uint32_t index, ActivitySignal* signal)
+    : index(index), signal(signal), listenSocket(INVALID_SOCKET), datagramSocket(INVALID_SOCKET),
+      inbound(INBOUND_QUEUE_SIZE), commands(COMMAND_QUEUE_SIZE) {
+#ifdef PLATFORM_LINUX
+    epollFd = -1;
+    wakeFd = -1;
+    readyEventCount = 0;
+#endif
+}
+
+NetworkReactor::~NetworkReactor() {
+    stopThread();
+    close();
+}
+
+bool NetworkReactor::open(int port, bool reusePort) {
+    // Create listen socket
+    listenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listenSocket == INVALID_SOCKET) {
+        LOG_ERROR(reactorLog, "#{} Failed to create socket: {}", index, lastSocketError());
+        return false;
+    }
+
+    // Set socket to non-blocking
+    setNonBlocking(listenSocket);
+
+#ifndef PLATFORM_WINDOWS
+    // Allow fast restarts while old connections sit in TIME_WAIT
+    int enable = 1;
+    setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+#endif
+#ifdef SO_REUSEPORT
+    // Every reactor binds the same port; the kernel balances accepts
+    if (reusePort) {
+        setsockopt(listenSocket, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable));
+    }
+#else
+    (void)reusePort;
+#endif
+
+    // Bind socket
+    sockaddr_in serverAddr;
+    memset(&serverAddr, 0, sizeof(serverAddr));
+    serverAddr.sin_family = AF_INET;
+    serverAddr.sin_addr.s_addr = INADDR_ANY;
+    serverAddr.sin_port = htons(port);
+
+    if (bind(listenSocket, (sockaddr*)&serverAddr, sizeof(serverAddr)) == SOCKET_ERROR) {
+        LOG_ERROR(reactorLog, "#{} Bind failed: {}", index, lastSocketError());
+        close();
+        return false;
+    }
+
+    // Listen
+    if (listen(listenSocket, SOMAXCONN) == SOCKET_ERROR) {
+        LOG_ERROR(reactorLog, "#{} Listen failed: {}", index, lastSocketError());
+        close();
+        return false;
+    }
+
+#ifdef PLATFORM_LINUX
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd == -1 || wakeFd == -1) {
+        LOG_ERROR(reactorLog, "#{} epoll/eventfd setup failed: {}", index, errno);
+        close();
+        return false;
+    }
+
+    epoll_event ev;
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.u64 = LISTEN_EVENT_ID;
+    bool ok = epoll_ctl(epollFd, EPOLL_CTL_ADD, listenSocket, &ev) == 0;
+
+    ev.events = EPOLLIN;
+    ev.data.u64 = WAKE_EVENT_ID;
+    ok = ok && epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev) == 0;
+
+    if (!ok) {
+        LOG_ERROR(reactorLog, "#{} epoll_ctl failed: {}", index, errno);
+        close();
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+bool NetworkReactor::openDatagram(int port) {
+    datagramSocket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (datagramSocket == INVALID_SOCKET) {
+        LOG_ERROR(reactorLog, "#{} Failed to create datagram socket: {}", index, lastSocketError());
+        return false;
+    }
+
+    setNonBlocking(datagramSocket);
+
+    sockaddr_in serverAddr;
+    memset(&serverAddr, 0, sizeof(serverAddr));
+    serverAddr.sin_family = AF_INET;
+    serverAddr.sin_addr.s_addr = INADDR_ANY;
+    serverAddr.sin_port = htons(port);
+
+    if (bind(datagramSocket, (sockaddr*)&serverAddr, sizeof(serverAddr)) == SOCKET_ERROR) {
+        LOG_ERROR(reactorLog, "#{} Datagram bind failed: {}", index, lastSocketError());
+        closesocket(datagramSocket);
+        datagramSocket = INVALID_SOCKET;
+        return false;
+    }
+
+#ifdef PLATFORM_LINUX
+    epoll_event ev;
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.u64 = DATAGRAM_EVENT_ID;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, datagramSocket, &ev) == -1) {
+        LOG_ERROR(reactorLog, "#{} epoll_ctl(datagram) failed: {}", index, errno);
+        closesocket(datagramSocket);
+        datagramSocket = INVALID_SOCKET;
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+void NetworkReactor::startThread() {
+#ifdef PLATFORM_LINUX
+    if (threaded) return;
+    threaded = true;
+    running.store(true, std::memory_order_release);
+    thread = std::thread(&NetworkReactor::threadMain, this);
+#endif
+}
+
+void NetworkReactor::stopThread() {
+    if (!threaded) return;
+    running.store(false, std::memory_order_release);
+    wake();
+    if (thread.joinable()) {
+        thread.join();
+    }
+    threaded = false;
+}
+
+void NetworkReactor::close() {
+    // Close all client connections
+    for (auto& pair : clients) {
+        closesocket(pair.second.socket);
+    }
+    clients.clear();
+    pendingRemoval.clear();
+    pendingFlush.clear();
+    totalQueuedBytes.store(0, std::memory_order_relaxed);
+
+    // Close listen socket
+    if (listenSocket != INVALID_SOCKET) {
+        closesocket(listenSocket);
+        listenSocket = INVALID_SOCKET;
+    }
+    if (datagramSocket != INVALID_SOCKET) {
+        closesocket(datagramSocket);
+        datagramSocket = INVALID_SOCKET;
+    }
+
+#ifdef PLATFORM_LINUX
+    if (epollFd != -1) {
+        ::close(epollFd);
+        epollFd = -1;
+    }
+    if (wakeFd != -1) {
+        ::close(wakeFd);
+        wakeFd = -1;
+    }
+    readyEventCount = 0;
+#endif
+}
+
+void NetworkReactor::wake() {
+#ifdef PLATFORM_LINUX
+    if (wakeFd != -1) {
+        uint64_t one = 1;
+        ssize_t ignored = write(wakeFd, &one, sizeof(one));
+        (void)ignored;
+    }
+#endif
+}
+
+void NetworkReactor::poll(int timeoutMs) {
+#ifdef PLATFORM_LINUX
+    pollEvents(timeoutMs);
+    processReadyEvents();
+#else
+    (void)timeoutMs;
+
+    // Accept new connections
+    acceptNewConnections();
+
+    // Receive data from all clients
+    receiveFromAllClients();
+
+    if (datagramSocket != INVALID_SOCKET) {
+        receiveDatagrams();
+    }
+#endif
+
+    // Remove disconnected clients
+    removeDisconnectedClients();
+    drainOverflow();
+}
+
+void NetworkReactor::flush() {
+    processCommands();
+    sendHeartbeats();
+    flushPending();
+    removeDisconnectedClients();
+    drainOverflow();
+}
+
+void NetworkReactor::threadMain() {
+#ifdef PLATFORM_LINUX
+    while (running.load(std::memory_order_acquire)) {
+        // Sleep until a socket is ready, the game thread posts commands or
+        // the next heartbeat round is due. With events backed up in
+        // overflow, retry the handoff shortly.
+        pollEvents(overflow.empty() ? millisUntilHeartbeat() : 1);
+        processReadyEvents();
+        runCycle();
+    }
+#endif
+}
+
+void NetworkReactor::runCycle() {
+    processCommands();
+    sendHeartbeats();
+    flushPending();
+    removeDisconnectedClients();
+    drainOverflow();
+
+    if (publishedInbound) {
+        publishedInbound = false;
+        signal->notify();
+    }
+}
+
+void NetworkReactor::publish(InboundEvent&& event) {
+    event.timestampNanos = networkClockNanos();
+
+    // Once anything is waiting in overflow, keep appending there so the game
+    // thread still sees events in arrival order
+    if (overflow.empty() && inbound.push(std::move(event))) {
+        publishedInbound = true;
+        return;
+    }
+    overflow.push_back(std::move(event));
+}
+
+void NetworkReactor::drainOverflow() {
+    size_t moved = 0;
+    while (moved < overflow.size() && inbound.push(std::move(overflow[moved]))) {
+        moved++;
+    }
+    if (moved > 0) {
+        overflow.erase(overflow.begin(), overflow.begin() + moved);
+        publishedInbound = true;
+    }
+}
+
+#ifdef PLATFORM_LINUX
+void NetworkReactor::pollEvents(int timeoutMs) {
+    int count = epoll_wait(epollFd, readyEvents, MAX_EPOLL_EVENTS, timeoutMs);
+    if (count < 0) {
+        if (errno != EINTR) {
+            LOG_WARN(reactorLog, "#{} epoll_wait failed: {}", index, errno);
+        }
+        count = 0;
+    }
+    readyEventCount = count;
+}
+
+void NetworkReactor::processReadyEvents() {
+    for (int i = 0; i < readyEventCount; i++) {
+        const epoll_event& ev = readyEvents[i];
+
+        if (ev.data.u64 == LISTEN_EVENT_ID) {
+            acceptNewConnections();
+            continue;
+        }
+
+        if (ev.data.u64 == DATAGRAM_EVENT_ID) {
+            receiveDatagrams();
+            continue;
+        }
+
+        if (ev.data.u64 == WAKE_EVENT_ID) {
+            // Game thread posted commands; runCycle() picks them up
+            uint64_t value;
+            ssize_t ignored = read(wakeFd, &value, sizeof(value));
+            (void)ignored;
+            continue;
+        }
+
+        auto it = clients.find(ev.data.u64);
+        if (it == clients.end()) continue;   // Removed earlier this round
+
+        ClientConnection& client = it->second;
+
+        // Drain readable data first so a final packet before FIN isn't lost
+        if (ev.events & EPOLLIN) {
+            receiveFromClient(client);
+        }
+
+        // EPOLLOUT needs nothing here: the wakeup alone lets runCycle()'s
+        // flushPending() retry the client
+
+        if (client.connected && (ev.events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP))) {
+            LOG_INFO(reactorLog, "#{} Client {} closed connection", index, client.clientId);
+            markDisconnected(client);
+        }
+    }
+    readyEventCount = 0;
+}
+#endif
+
+void NetworkReactor::acceptNewConnections() {
+    // Drain the whole backlog: edge-triggered epoll won't report it again
+    while (true) {
+        sockaddr_in clientAddr;
+        socklen_t addrLen = sizeof(clientAddr);
+
+#ifdef PLATFORM_LINUX
+        SOCKET clientSocket = accept4(listenSocket, (sockaddr*)&clientAddr, &addrLen, SOCK_NONBLOCK | SOCK_CLOEXEC);
+#else
+        SOCKET clientSocket = accept(listenSocket, (sockaddr*)&clientAddr, &addrLen);
+#endif
+        if (clientSocket == INVALID_SOCKET) {
+            int error = lastSocketError();
+#ifndef PLATFORM_WINDOWS
+            if (error == EINTR || error == ECONNABORTED) continue;
+#endif
+            if (!isWouldBlock(error)) {
+                LOG_WARN(reactorLog, "#{} Accept failed: {}", index, error);
+            }
+            return;
+        }
+
+#ifndef PLATFORM_LINUX
+        // Set client socket to non-blocking
+        setNonBlocking(clientSocket);
+#endif
+
+        // Create client connection
+        ClientConnection client;
+        client.socket = clientSocket;
+        client.clientId = (nextClientSerial++ << INDEX_BITS) | index;
+        client.stats = std::make_shared<ConnectionStats>();
+
+#ifdef PLATFORM_LINUX
+        // Edge-triggered EPOLLOUT fires when a socket whose send buffer
+        // filled up (FlushResult::PENDING) has room again, so the rest of
+        // the queue goes out then instead of at the next unrelated wakeup
+        epoll_event ev;
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.u64 = client.clientId;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, clientSocket, &ev) == -1) {
+            LOG_WARN(reactorLog, "#{} epoll_ctl(client) failed: {}", index, errno);
+            closesocket(clientSocket);
+            continue;
+        }
+#endif
+
+        // Tell the game thread before any of this client's packets
+        InboundEvent event;
+        event.kind = InboundEvent::Kind::CONNECTED;
+        event.packet.clientId = client.clientId;
+        event.stats = client.stats;
+        inet_ntop(AF_INET, &clientAddr.sin_addr, event.ipAddress, INET_ADDRSTRLEN);
+        LOG_INFO(reactorLog, "#{} New client connected: {} ({})", index, client.clientId, event.ipAddress);
+        publish(std::move(event));
+
+        uint64_t clientId = client.clientId;
+        clients.emplace(clientId, std::move(client));
+    }
+}
+
+void NetworkReactor::receiveFromAllClients() {
+    for (auto& pair : clients) {
+        receiveFromClient(pair.second);
+    }
+}
+
+void NetworkReactor::receiveFromClient(ClientConnection& client) {
+    if (!client.connected) return;
+
+    // recv() straight into the ring's free region until the socket would
+    // block (required for edge-triggered epoll)
+    while (client.connected) {
+        size_t freeLength;
+        uint8_t* region = client.receiveBuffer.writeRegion(freeLength);
+        if (freeLength == 0) {
+            // Ring is full: frame what we have to make room, then keep reading
+            size_t before = client.receiveBuffer.size();
+            parseClientPackets(client);
+            if (client.receiveBuffer.size() == before) break;
+            continue;
+        }
+
+        int result = recv(client.socket, (char*)region, static_cast<int>(freeLength), 0);
+
+        if (result > 0) {
+            client.receiveBuffer.commitWrite(static_cast<size_t>(result));
+            continue;
+        }
+
+        if (result == 0) {
+            // Connection closed
+            LOG_INFO(reactorLog, "#{} Client {} closed connection", index, client.clientId);
+            markDisconnected(client);
+        }
+        else {
+            int error = lastSocketError();
+#ifndef PLATFORM_WINDOWS
+            if (error == EINTR) continue;
+#endif
+            if (!isWouldBlock(error)) {
+                LOG_WARN(reactorLog, "#{} Receive failed from client {}: {}", index, client.clientId, error);
+                markDisconnected(client);
+            }
+        }
+        break;
+    }
+
+    // Try to parse packets
+    parseClientPackets(client);
+}
+
+void NetworkReactor::parseClientPackets(ClientConnection& client) {
+    RingBuffer& ring = client.receiveBuffer;
+
+    while (ring.size() >= sizeof(PacketHeader)) {
+        // Read header (may straddle the wrap point)
+        PacketHeader header;
+        ring.peek(0, &header, sizeof(PacketHeader));
+
+        // A packet larger than the ring could never complete
+        if (header.payloadSize > MAX_PACKET_SIZE) {
+            LOG_WARN(reactorLog, "#{} Oversized packet ({} bytes) from client {}",
+                     index, header.payloadSize, client.clientId);
+            markDisconnected(client);
+            ring.clear();
+            return;
+        }
+
+        // Check if we have the full packet
+        size_t totalSize = sizeof(PacketHeader) + header.payloadSize;
+        if (ring.size() < totalSize) {
+            break;  // Wait for more data
+        }
+
+        client.stats->in.add(static_cast<PacketType>(header.type), totalSize);
+
+        // Echoes of our own probes end here; empty keep-alives go on
+        if (header.type == static_cast<uint16_t>(PacketType::HEARTBEAT) && header.payloadSize > 0) {
+            handleHeartbeatEcho(client, header.payloadSize);
+            ring.consume(totalSize);
+            client.sequenceIn++;
+            continue;
+        }
+
+        // Hand a view over a pooled copy of the payload to the game thread
+        InboundEvent event;
+        event.kind = InboundEvent::Kind::PACKET;
+        event.packet.clientId = client.clientId;
+        event.packet.type = static_cast<PacketType>(header.type);
+        event.packet.sessionToken = header.sessionToken;
+        if (header.payloadSize > 0) {
+            event.packet.payload = payloadPool.acquire(header.payloadSize);
+            ring.peek(sizeof(PacketHeader), event.packet.payload.data(), header.payloadSize);
+        }
+
+        // Release the frame; nothing behind it moves
+        ring.consume(totalSize);
+        client.sequenceIn++;
+
+        LOG_TRACE(reactorLog, "#{} Received {} from client {}",
+                  index, packetTypeToString(event.packet.type), client.clientId);
+
+        publish(std::move(event));
+    }
+}
+
+void NetworkReactor::handleHeartbeatEcho(ClientConnection& client, uint32_t payloadSize) {
+    uint8_t payload[16];
+    if (payloadSize > sizeof(payload)) return;
+    client.receiveBuffer.peek(sizeof(PacketHeader), payload, payloadSize);
+
+    // Only the outstanding probe counts; late echoes of replaced ones don't
+    HeartbeatProbe probe;
+    if (!decodePacket(payload, payloadSize, probe) || client.probeSentNanos == 0 ||
+        probe.sentNanos != client.probeSentNanos) {
+        return;
+    }
+    client.stats->recordRtt((networkClockNanos() - probe.sentNanos) / 1000);
+    client.probeSentNanos = 0;
+}
+
+void NetworkReactor::sendHeartbeats() {
+    uint64_t now = networkClockNanos();
+    if (now < nextHeartbeatNanos) return;
+    nextHeartbeatNanos = now + HEARTBEAT_INTERVAL_NANOS;
+    if (clients.empty()) return;
+
+    // Every probe of this round shares one payload
+    HeartbeatProbe probe;
+    probe.sentNanos = now;
+    uint8_t buffer[16];
+    size_t size = encodePacket(probe, buffer, sizeof(buffer));
+
+    OutboundCommand command;
+    command.type = PacketType::HEARTBEAT;
+    command.payload = payloadPool.acquire(static_cast<uint32_t>(size));
+    memcpy(command.payload.data(), buffer, size);
+
+    for (auto& pair : clients) {
+        ClientConnection& client = pair.second;
+        if (!client.connected) continue;
+
+        // One probe in flight per connection, until it is presumed lost
+        if (client.probeSentNanos != 0 && now - client.probeSentNanos < HEARTBEAT_TIMEOUT_NANOS) continue;
+
+        client.probeSentNanos = now;
+        client.stats->probesSent.store(client.stats->probesSent.load(std::memory_order_relaxed) + 1,
+                                       std::memory_order_relaxed);
+        command.clientId = client.clientId;
+        queuePacket(client, command);
+    }
+}
+
+int NetworkReactor::millisUntilHeartbeat() const {
+    if (clients.empty()) return -1;
+
+    uint64_t now = networkClockNanos();
+    if (now >= nextHeartbeatNanos) return 0;
+    return static_cast<int>((nextHeartbeatNanos - now + 999999) / 1000000);
+}
+
+void NetworkReactor::receiveDatagrams() {
+    // Drain until the socket would block (required for edge-triggered epoll)
+    while (true) {
+        sockaddr_in from;
+        socklen_t fromLength = sizeof(from);
+        int received = static_cast<int>(recvfrom(datagramSocket, (char*)datagramBuffer, static_cast<int>(sizeof(datagramBuffer)), 0,
+                                                 (sockaddr*)&from, &fromLength));
+        if (received < 0) {
+            int error = lastSocketError();
+#ifdef PLATFORM_WINDOWS
+            // ICMP unreachable from a departed client, or an oversized datagram
+            if (error == WSAECONNRESET || error == WSAEMSGSIZE) continue;
+#else
+            if (error == EINTR) continue;
+#endif
+            if (!isWouldBlock(error)) {
+                LOG_WARN(reactorLog, "#{} Datagram receive failed: {}", index, error);
+            }
+            return;
+        }
+
+        // Runts and oversized datagrams are dropped like lost ones
+        size_t length = static_cast<size_t>(received);
+        if (length < sizeof(DatagramHeader) || length > MAX_DATAGRAM_SIZE) continue;
+
+        DatagramHeader header;
+        memcpy(&header, datagramBuffer, sizeof(header));
+
+        InboundEvent event;
+        event.kind = InboundEvent::Kind::DATAGRAM;
+        event.packet.type = static_cast<PacketType>(header.type);
+        event.packet.sessionToken = header.sessionToken;
+        event.address = from;
+        event.sequence = header.sequence;
+
+        uint32_t payloadSize = static_cast<uint32_t>(length - sizeof(header));
+        if (payloadSize > 0) {
+            event.packet.payload = payloadPool.acquire(payloadSize);
+            memcpy(event.packet.payload.data(), datagramBuffer + sizeof(header), payloadSize);
+        }
+
+        publish(std::move(event));
+    }
+}
+
+void NetworkReactor::sendDatagram(const OutboundCommand& command) {
+    // Best effort: a full socket buffer drops the datagram, as the network might
+    int sent = static_cast<int>(sendto(datagramSocket, (const char*)command.payload.data(), static_cast<int>(command.payload.size()), 0,
+                                       (const sockaddr*)&command.address, sizeof(command.address)));
+    if (sent < 0) {
+        int error = lastSocketError();
+        if (!isWouldBlock(error)) {
+            LOG_WARN(reactorLog, "#{} Datagram send to client {} failed: {}", index, command.clientId, error);
+        }
+    }
+}
+
+void NetworkReactor::processCommands() {
+    OutboundCommand command;
+    while (commands.pop(command)) {
+        if (command.kind == OutboundCommand::Kind::DATAGRAM) {
+            // Sent from this reactor's socket whichever reactor owns the client
+            if (datagramSocket != INVALID_SOCKET) {
+                sendDatagram(command);
+            }
+            continue;
+        }
+
+        auto it = clients.find(command.clientId);
+        if (it == clients.end() || !it->second.connected) continue;
+
+        if (command.kind == OutboundCommand::Kind::DISCONNECT) {
+            LOG_INFO(reactorLog, "#{} Client {} disconnected", index, command.clientId);
+            markDisconnected(it->second);
+        } else {
+            queuePacket(it->second, command);
+        }
+    }
+}
+
+void NetworkReactor::queuePacket(ClientConnection& client, const OutboundCommand& command) {
+    // Per-connection header in front of a payload that may be shared
+    PacketHeader header;
+    header.type = static_cast<uint16_t>(command.type) | (command.compressed ? PACKET_FLAG_COMPRESSED : 0);
+    header.payloadSize = command.payload.size();
+    header.sessionToken = command.sessionToken;
+    header.sequence = client.sequenceOut++;
+
+    client.sendQueue.push(header, command.payload);
+    totalQueuedBytes.fetch_add(sizeof(PacketHeader) + command.payload.size(), std::memory_order_relaxed);
+    client.stats->out.add(command.type, sizeof(PacketHeader) + command.payload.size());
+    client.stats->setQueuedBytes(client.sendQueue.getQueuedBytes());
+
+    if (!client.flushScheduled) {
+        client.flushScheduled = true;
+        pendingFlush.push_back(client.clientId);
+    }
+
+    if (client.sendQueue.getQueuedBytes() > MAX_QUEUED_BYTES) {
+        LOG_WARN(reactorLog, "#{} Client {} send queue overflow ({} bytes), disconnecting",
+                 index, client.clientId, client.sendQueue.getQueuedBytes());
+        markDisconnected(client);
+    }
+}
+
+void NetworkReactor::flushPending() {
+    // Only clients that queued something since their last full drain are visited
+    size_t keep = 0;
+    for (size_t i = 0; i < pendingFlush.size(); i++) {
+        auto it = clients.find(pendingFlush[i]);
+        if (it == clients.end()) continue;
+
+        ClientConnection& client = it->second;
+        if (!client.connected) {
+            client.flushScheduled = false;
+            continue;
+        }
+
+        size_t before = client.sendQueue.getQueuedBytes();
+        int error = 0;
+        OutboundQueue::FlushResult result = client.sendQueue.flush(client.socket, error);
+        totalQueuedBytes.fetch_sub(before - client.sendQueue.getQueuedBytes(), std::memory_order_relaxed);
+        client.stats->queuedBytes.store(client.sendQueue.getQueuedBytes(), std::memory_order_relaxed);
+
+        if (result == OutboundQueue::FlushResult::FAILED) {
+            LOG_WARN(reactorLog, "#{} Failed to send to client {}: {}", index, client.clientId, error);
+            client.flushScheduled = false;
+            markDisconnected(client);
+        }
+        else if (result == OutboundQueue::FlushResult::PENDING) {
+            // Socket buffer full: retry on the next flush from the same byte
+            pendingFlush[keep++] = client.clientId;
+        }
+        else {
+            client.flushScheduled = false;
+        }
+    }
+    pendingFlush.resize(keep);
+}
+
+void NetworkReactor::markDisconnected(ClientConnection& client) {
+    if (!client.connected) return;
+    client.connected = false;
+    pendingRemoval.push_back(client.clientId);
+}
+
+void NetworkReactor::removeDisconnectedClients() {
+    // Only clients flagged this round are visited, not the whole client map
+    for (uint64_t clientId : pendingRemoval) {
+        auto it = clients.find(clientId);
+        if (it == clients.end()) continue;
+
+        // Closing the fd also removes it from the epoll set
+        closesocket(it->second.socket);
+        totalQueuedBytes.fetch_sub(it->second.sendQueue.getQueuedBytes(), std::memory_order_relaxed);
+        it->second.stats->queuedBytes.store(0, std::memory_order_relaxed);
+        clients.erase(it);
+
+        InboundEvent event;
+        event.kind = InboundEvent::Kind::DISCONNECTED;
+        event.packet.clientId = clientId;
+        publish(std::move(event));
+    }
+    pendingRemoval.clear();
+}
@@ -0,0 +1,224 @@
+#pragma once
+#include "../../engine/core/Platform.h"
+#include "../../common/NetworkProtocol.h"
+#include "../../common/RingBuffer.h"
+#include "PacketView.h"
+#include "OutboundQueue.h"
+#include "ConcurrentQueue.h"
+#include "ConnectionStats.h"
+#include <map>
+#include <vector>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+#ifdef PLATFORM_LINUX
+#include <sys/epoll.h>
+#endif
+
+// Steady-clock time used to stamp inbound events
+inline uint64_t networkClockNanos() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Connection lifecycle or packet, handed from a reactor to the game thread.
+// DATAGRAM packets arrive without a clientId; the game thread resolves their
+// session token to a connection.
+struct InboundEvent {
+    enum class Kind : uint8_t {
+        PACKET,
+        CONNECTED,
+        DISCONNECTED,
+        DATAGRAM
+    };
+
+    Kind kind = Kind::PACKET;
+    uint64_t timestampNanos = 0;                // networkClockNanos() when the reactor published it
+    PacketView packet;                          // clientId set except for DATAGRAM; payload for PACKET/DATAGRAM
+    std::shared_ptr<ConnectionStats> stats;     // CONNECTED only
+    char ipAddress[INET_ADDRSTRLEN] = {};       // CONNECTED only
+    sockaddr_in address = {};                   // DATAGRAM only: sender
+    uint32_t sequence = 0;                      // DATAGRAM only
+};
+
+// Send or disconnect request, handed from the game thread to a reactor.
+// A DATAGRAM payload is the complete datagram, header included.
+struct OutboundCommand {
+    enum class Kind : uint8_t {
+        SEND,
+        DISCONNECT,
+        DATAGRAM
+    };
+
+    Kind kind = Kind::SEND;
+    uint64_t clientId = 0;
+    PacketType type = PacketType::INVALID_PACKET;
+    uint64_t sessionToken = 0;
+    PayloadRef payload;
+    bool compressed = false;    // SEND only: payload is a Compression.h frame
+    sockaddr_in address = {};   // DATAGRAM only: destination
+};
+
+// Wakes the game thread when any reactor has published inbound events
+class ActivitySignal {
+public:
+    void notify();
+    bool wait(int timeoutMs);   // true if woken by activity
+    void reset() { pending.store(false, std::memory_order_relaxed); }
+
+private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::atomic<bool> pending{ false };
+};
+
+// One shard of the server's connections. A reactor owns its listen socket
+// (SO_REUSEPORT lets the kernel spread accepts across reactors), its client
+// sockets, receive rings and send queues. It runs either on its own thread or
+// inline on the game thread; in both cases the game thread only talks to it
+// through the inbound/outbound queues. Reactor 0 also owns the server's UDP
+// socket (openDatagram), which is not sharded.
+//
+// Each connection's traffic is counted into its ConnectionStats. The reactor
+// also probes every connection with a HEARTBEAT once a second and takes the
+// echoes itself, so the RTT it records excludes the game thread's tick.
+class NetworkReactor {
+public:
+    // Client IDs carry the owning reactor in their low bits
+    static constexpr int INDEX_BITS = 8;
+    static constexpr uint32_t MAX_REACTORS = 1u << INDEX_BITS;
+
+    static uint32_t reactorIndexOf(uint64_t clientId) {
+        return static_cast<uint32_t>(clientId & (MAX_REACTORS - 1));
+    }
+
+    NetworkReactor(uint32_t index, ActivitySignal* signal);
+    ~NetworkReactor();
+
+    NetworkReactor(const NetworkReactor&) = delete;
+    NetworkReactor& operator=(const NetworkReactor&) = delete;
+
+    // Create the listen socket (and epoll set)
+    bool open(int port, bool reusePort);
+
+    // Also serve the UDP gameplay channel on `port` (one reactor only)
+    bool openDatagram(int port);
+
+    // Start/stop the dedicated I/O thread
+    void startThread();
+    void stopThread();
+    bool isThreaded() const { return threaded; }
+
+    // Close every socket
+    void close();
+
+    // Inline mode: accept/receive (waiting up to timeoutMs for readiness)
+    void poll(int timeoutMs);
+
+    // Inline mode: apply queued commands and write send queues
+    void flush();
+
+    // Game thread side
+    bool popInbound(InboundEvent& out) { return inbound.pop(out); }
+    bool postCommand(OutboundCommand&& command) { return commands.push(std::move(command)); }
+    void wake();
+
+    size_t getTotalQueuedBytes() const { return totalQueuedBytes.load(std::memory_order_relaxed); }
+
+private:
+    // Per-connection receive ring; must hold the largest legal packet
+    static constexpr size_t RECEIVE_BUFFER_SIZE = 32768;
+    static_assert(RECEIVE_BUFFER_SIZE >= sizeof(PacketHeader) + MAX_PACKET_SIZE,
+                  "receive ring must fit a full packet");
+
+    // Clients that stop reading are dropped once this much is queued for them
+    static constexpr size_t MAX_QUEUED_BYTES = 1024 * 1024;
+
+    // Heartbeat probes; one left unanswered this long is replaced
+    static constexpr uint64_t HEARTBEAT_INTERVAL_NANOS = 1000000000ull;
+    static constexpr uint64_t HEARTBEAT_TIMEOUT_NANOS = 10 * HEARTBEAT_INTERVAL_NANOS;
+
+    static constexpr size_t INBOUND_QUEUE_SIZE = 65536;
+    static constexpr size_t COMMAND_QUEUE_SIZE = 65536;
+
+    struct ClientConnection {
+        SOCKET socket;
+        uint64_t clientId;
+        bool connected;
+        bool flushScheduled;    // Already listed in pendingFlush
+        uint32_t sequenceIn;
+        uint32_t sequenceOut;
+        uint64_t probeSentNanos;    // Outstanding heartbeat probe, 0 if none
+        RingBuffer receiveBuffer;
+        OutboundQueue sendQueue;
+        std::shared_ptr<ConnectionStats> stats;
+
+        ClientConnection() : socket(INVALID_SOCKET), clientId(0), connected(true),
+                            flushScheduled(false),
+                            sequenceIn(0), sequenceOut(0), probeSentNanos(0), receiveBuffer(RECEIVE_BUFFER_SIZE) {}
+    };
+
+    uint32_t index;
+    ActivitySignal* signal;
+    SOCKET listenSocket;
+    SOCKET datagramSocket;
+    uint8_t datagramBuffer[MAX_DATAGRAM_SIZE + 1];  // One spare byte detects oversized datagrams
+    std::map<uint64_t, ClientConnection> clients;
+    uint64_t nextClientSerial = 1;
+
+    PayloadPool payloadPool;    // Declared before the queues: outlives their payloads
+    ConcurrentQueue<InboundEvent> inbound;
+    ConcurrentQueue<OutboundCommand> commands;
+    std::vector<InboundEvent> overflow;     // Kept in order while the inbound queue is full
+    bool publishedInbound = false;
+
+    std::vector<uint64_t> pendingRemoval;   // Clients marked disconnected this round
+    std::vector<uint64_t> pendingFlush;     // Clients with queued outbound data
+    std::atomic<size_t> totalQueuedBytes{ 0 };
+    uint64_t nextHeartbeatNanos = 0;
+
+    bool threaded = false;
+    std::atomic<bool> running{ false };
+    std::thread thread;
+
+#ifdef PLATFORM_LINUX
+    // Edge-triggered epoll backend: only ready sockets are touched
+    static constexpr uint64_t LISTEN_EVENT_ID = 0;            // Client IDs are never 0
+    static constexpr uint64_t WAKE_EVENT_ID = ~0ull;
+    static constexpr uint64_t DATAGRAM_EVENT_ID = ~0ull - 1;
+    static constexpr int MAX_EPOLL_EVENTS = 256;
+
+    int epollFd;
+    int wakeFd;                 // eventfd the game thread writes to
+    epoll_event readyEvents[MAX_EPOLL_EVENTS];
+    int readyEventCount;
+
+    void pollEvents(int timeoutMs);
+    void processReadyEvents();
+#endif
+
+    void threadMain();
+    void runCycle();
+    void publish(InboundEvent&& event);
+    void drainOverflow();
+
+    void acceptNewConnections();
+    void receiveFromAllClients();
+    void receiveFromClient(ClientConnection& client);
+    void parseClientPackets(ClientConnection& client);
+    void handleHeartbeatEcho(ClientConnection& client, uint32_t payloadSize);
+    void sendHeartbeats();
+    int millisUntilHeartbeat() const;
+    void receiveDatagrams();
+    void sendDatagram(const OutboundCommand& command);
+    void processCommands();
+    void flushPending();
+    void queuePacket(ClientConnection& client, const OutboundCommand& command);
+    void markDisconnected(ClientConnection& client);
+    void removeDisconnectedClients();
+};
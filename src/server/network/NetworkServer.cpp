@@ -1,65 +1,172 @@
 #include "NetworkServer.h"
-#include <iostream>
+#include "../../common/Logger.h"
+#include <algorithm>
+#include <cstdio>
 #include <cstring>
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <chrono>
 
-NetworkServer::NetworkServer() : listenSocket(INVALID_SOCKET), initialized(false), running(false) {
+namespace {
+    LogCategory networkLog("NetworkServer");
+
+    // Records fed per update() when replaying as fast as possible, so ticks
+    // still interleave with packet handling
+    constexpr size_t REPLAY_BATCH = 1024;
+
+    // Connections listed by logNetworkStats(), worst p99 RTT first
+    constexpr size_t SLOWEST_CLIENTS_LOGGED = 5;
+}
+
+NetworkServer::NetworkServer() : encodeBuffer(MAX_PACKET_SIZE), initialized(false), running(false) {
+#ifdef PLATFORM_WINDOWS
     // Initialize Winsock
     WSADATA wsaData;
     int result = WSAStartup(MAKEWORD(2, 2), &wsaData);
     if (result != 0) {
-        std::cout << "[NetworkServer] WSAStartup failed: " << result << std::endl;
+        LOG_ERROR(networkLog, "WSAStartup failed: {}", result);
         return;
     }
+    LOG_INFO(networkLog, "Winsock initialized");
+#endif
     initialized = true;
-    std::cout << "[NetworkServer] Winsock initialized" << std::endl;
 }
 
 NetworkServer::~NetworkServer() {
     shutdown();
+#ifdef PLATFORM_WINDOWS
     if (initialized) {
         WSACleanup();
     }
+#endif
 }
 
-bool NetworkServer::start(int port) {
+bool NetworkServer::start(int port, int ioThreads) {
     if (!initialized) {
-        std::cout << "[NetworkServer] Cannot start - not initialized" << std::endl;
+        LOG_WARN(networkLog, "Cannot start - not initialized");
         return false;
     }
 
-    // Create listen socket
-    listenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-    if (listenSocket == INVALID_SOCKET) {
-        std::cout << "[NetworkServer] Failed to create socket: " << WSAGetLastError() << std::endl;
+#ifndef PLATFORM_LINUX
+    // Winsock has no SO_REUSEPORT sharding; keep one inline reactor
+    ioThreads = 0;
+#endif
+    if (ioThreads > static_cast<int>(NetworkReactor::MAX_REACTORS)) {
+        ioThreads = static_cast<int>(NetworkReactor::MAX_REACTORS);
+    }
+
+    threaded = ioThreads > 0;
+    int reactorCount = threaded ? ioThreads : 1;
+
+    for (int i = 0; i < reactorCount; i++) {
+        auto reactor = std::make_unique<NetworkReactor>(static_cast<uint32_t>(i), &activity);
+        if (!reactor->open(port, reactorCount > 1)) {
+            reactors.clear();
+            return false;
+        }
+        reactors.push_back(std::move(reactor));
+    }
+    reactorHasCommands.assign(reactors.size(), false);
+
+    // The first reactor also serves the UDP gameplay channel
+    if (!reactors[0]->openDatagram(port)) {
+        reactors.clear();
         return false;
     }
 
-    // Set socket to non-blocking
-    u_long mode = 1;
-    ioctlsocket(listenSocket, FIONBIO, &mode);
+    if (threaded) {
+        for (auto& reactor : reactors) {
+            reactor->startThread();
+        }
+    }
 
-    // Bind socket
-    sockaddr_in serverAddr;
-    serverAddr.sin_family = AF_INET;
-    serverAddr.sin_addr.s_addr = INADDR_ANY;
-    serverAddr.sin_port = htons(port);
+    running = true;
+    serverPort = port;
+    lastLoggedNanos = networkClockNanos();
+    LOG_INFO(networkLog, "Server started on port {} ({})",
+             port, (threaded ? std::to_string(reactorCount) + " I/O threads" : std::string("inline I/O")));
+    return true;
+}
 
-    if (bind(listenSocket, (sockaddr*)&serverAddr, sizeof(serverAddr)) == SOCKET_ERROR) {
-        std::cout << "[NetworkServer] Bind failed: " << WSAGetLastError() << std::endl;
-        closesocket(listenSocket);
+bool NetworkServer::startReplay(const std::string& path, bool realtime, std::string& errorMsg) {
+    if (running) {
+        errorMsg = "Server is already running";
         return false;
     }
 
-    // Listen
-    if (listen(listenSocket, SOMAXCONN) == SOCKET_ERROR) {
-        std::cout << "[NetworkServer] Listen failed: " << WSAGetLastError() << std::endl;
-        closesocket(listenSocket);
+    auto reader = std::make_unique<PacketCaptureReader>(payloadPool);
+    if (!reader->open(path, errorMsg)) {
         return false;
     }
 
+    replay = std::move(reader);
+    replayRealtime = realtime;
+    replayFinished = false;
+    replayTokens.clear();
+    replayLogins.clear();
+    replayStats = ReplayStats();
+    replayStats.startNanos = networkClockNanos();
+    if (!replay->peekTimestamp(replayFirstTimestamp)) {
+        replayFirstTimestamp = 0;
+    }
+
     running = true;
-    serverPort = port;
-    std::cout << "[NetworkServer] Server started on port " << port << std::endl;
+    lastLoggedNanos = replayStats.startNanos;
+    LOG_INFO(networkLog, "Replaying {} ({})", path, (realtime ? "recorded speed" : "as fast as possible"));
+    return true;
+}
+
+void NetworkServer::logReplayStats() const {
+    uint64_t end = replayStats.endNanos != 0 ? replayStats.endNanos : networkClockNanos();
+    double seconds = (end - replayStats.startNanos) / 1e9;
+    double rate = seconds > 0.0 ? replayStats.packets / seconds : 0.0;
+
+    LOG_INFO(networkLog, "Replay: {} records, {} packets in {} s ({} packets/s); {} responses ({} bytes) built and dropped",
+             replayStats.records, replayStats.packets, seconds, static_cast<uint64_t>(rate),
+             replayStats.sentPackets, replayStats.sentBytes);
+}
+
+bool NetworkServer::startCapture(const std::string& path, std::string& errorMsg) {
+    auto writer = std::make_unique<PacketCaptureWriter>();
+    uint64_t now = networkClockNanos();
+    if (!writer->open(path, now, errorMsg)) {
+        return false;
+    }
+
+    // Clients connected before the capture started, so their packets replay
+    for (const auto& pair : clients) {
+        writer->writeConnected(now, pair.first, pair.second.ipAddress.c_str());
+    }
+
+    capture = std::move(writer);
+    LOG_INFO(networkLog, "Capturing traffic to {}", path);
+    return true;
+}
+
+void NetworkServer::stopCapture() {
+    if (!capture) return;
+
+    capture->close();
+    LOG_INFO(networkLog, "Capture closed: {} records, {} bytes", capture->getRecordCount(), capture->getByteCount());
+    capture.reset();
+}
+
+bool NetworkServer::loadCompressionDictionary(const std::string& path, std::string& errorMsg) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        errorMsg = "Cannot open compression dictionary " + path;
+        return false;
+    }
+
+    std::vector<uint8_t> content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (content.empty() || content.size() > MAX_DICTIONARY_SIZE) {
+        errorMsg = path + " is not a compression dictionary (" + std::to_string(content.size()) + " bytes)";
+        return false;
+    }
+
+    compressionDictionary = CompressionDictionary(content.data(), content.size());
+    LOG_INFO(networkLog, "Compression dictionary {} loaded ({} bytes)", compressionDictionary.id(), content.size());
     return true;
 }
 
@@ -67,214 +174,661 @@ void NetworkServer::shutdown() {
     if (!running) return;
 
     running = false;
+    stopCapture();
+    replay.reset();
 
-    // Close all client connections
-    for (auto& pair : clients) {
-        closesocket(pair.second.socket);
+    if (datagramStats.accepted + datagramStats.stale + datagramStats.unknownSession + datagramStats.disallowedType > 0) {
+        LOG_INFO(networkLog, "Datagrams: {} accepted, {} stale, {} unknown session, {} disallowed type",
+                 datagramStats.accepted, datagramStats.stale, datagramStats.unknownSession, datagramStats.disallowedType);
+    }
+    if (compressionStats.packets > 0) {
+        LOG_INFO(networkLog, "Compression: {} packets, {} -> {} bytes",
+                 compressionStats.packets, compressionStats.rawBytes, compressionStats.compressedBytes);
     }
-    clients.clear();
 
-    // Close listen socket
-    if (listenSocket != INVALID_SOCKET) {
-        closesocket(listenSocket);
-        listenSocket = INVALID_SOCKET;
+    // Join I/O threads before their sockets go away
+    for (auto& reactor : reactors) {
+        reactor->stopThread();
     }
+    reactors.clear();
+    reactorHasCommands.clear();
+    clients.clear();
+    datagramSessions.clear();
+    datagramStats = DatagramStats();
+    closedConnectionStats = NetworkTrafficStats();
+    lastLoggedStats = NetworkTrafficStats();
+    compressionStats = CompressionStats();
+    receivedPackets.clear();
+    activity.reset();
 
-    std::cout << "[NetworkServer] Server shutdown" << std::endl;
+    LOG_INFO(networkLog, "Server shutdown");
 }
 
 void NetworkServer::update() {
     if (!running) return;
 
-    // Accept new connections
-    acceptNewConnections();
-
-    // Receive data from all clients
-    receiveFromAllClients();
+    if (replay) {
+        pumpReplay();
+        return;
+    }
 
-    // Remove disconnected clients
-    removeDisconnectedClients();
+    if (!threaded) {
+        // Inline reactor: only sockets that became ready are touched
+        reactors[0]->poll(0);
+    }
+    activity.reset();
+
+    // Collect what every reactor published since the last update
+    InboundEvent event;
+    for (auto& reactor : reactors) {
+        while (reactor->popInbound(event)) {
+            if (capture) {
+                captureEvent(event);
+            }
+
+            uint64_t clientId = event.packet.clientId;
+            switch (event.kind) {
+            case InboundEvent::Kind::PACKET:
+                // Drop stragglers from clients disconnected on this side
+                if (clients.find(clientId) != clients.end()) {
+                    receivedPackets.push_back(std::move(event.packet));
+                }
+                break;
+
+            case InboundEvent::Kind::CONNECTED: {
+                ClientInfo& info = clients[clientId];
+                info.ipAddress = event.ipAddress;
+                info.stats = std::move(event.stats);
+                sendCompressionDictionary(clientId);
+                break;
+            }
+
+            case InboundEvent::Kind::DISCONNECTED:
+                removeClient(clientId);
+                break;
+
+            case InboundEvent::Kind::DATAGRAM:
+                if (acceptDatagram(event)) {
+                    if (capture) {
+                        capture->writePacket(event.timestampNanos, event.packet);
+                    }
+                    receivedPackets.push_back(std::move(event.packet));
+                }
+                break;
+            }
+        }
+    }
 }
 
-bool NetworkServer::sendPacket(uint64_t clientId, PacketType type, const void* payload, uint32_t payloadSize, uint64_t sessionToken) {
-    auto it = clients.find(clientId);
-    if (it == clients.end()) {
+bool NetworkServer::acceptDatagram(InboundEvent& event) {
+    if (!isDatagramPacketType(event.packet.type)) {
+        datagramStats.disallowedType++;
         return false;
     }
 
-    // Build packet
-    PacketHeader header;
-    header.type = static_cast<uint16_t>(type);
-    header.payloadSize = payloadSize;
-    header.sessionToken = sessionToken;
-    header.sequence = it->second.sequenceOut++;
-
-    // Send header
-    int result = send(it->second.socket, (char*)&header, sizeof(header), 0);
-    if (result == SOCKET_ERROR) {
-        std::cout << "[NetworkServer] Failed to send header to client " << clientId << ": " << WSAGetLastError() << std::endl;
-        it->second.connected = false;
+    auto session = datagramSessions.find(event.packet.sessionToken);
+    if (session == datagramSessions.end()) {
+        datagramStats.unknownSession++;
         return false;
     }
 
-    // Send payload (if any)
-    if (payloadSize > 0 && payload != nullptr) {
-        result = send(it->second.socket, (char*)payload, payloadSize, 0);
-        if (result == SOCKET_ERROR) {
-            std::cout << "[NetworkServer] Failed to send payload to client " << clientId << ": " << WSAGetLastError() << std::endl;
-            it->second.connected = false;
-            return false;
-        }
+    ClientInfo& info = clients[session->second];
+
+    // Anything older than the newest datagram is superseded state
+    if (info.hasDatagramAddress && !isNewerSequence(event.sequence, info.datagramSequenceIn)) {
+        datagramStats.stale++;
+        return false;
     }
 
+    info.hasDatagramAddress = true;
+    info.datagramAddress = event.address;
+    info.datagramSequenceIn = event.sequence;
+    info.datagramsIn.add(event.packet.type, sizeof(DatagramHeader) + event.packet.size());
+    event.packet.clientId = session->second;
+    datagramStats.accepted++;
     return true;
 }
 
-void NetworkServer::broadcastPacket(PacketType type, const void* payload, uint32_t payloadSize, uint64_t sessionToken) {
-    for (auto& pair : clients) {
-        sendPacket(pair.first, type, payload, payloadSize, sessionToken);
+void NetworkServer::removeClient(uint64_t clientId) {
+    auto it = clients.find(clientId);
+    if (it == clients.end()) return;
+
+    if (it->second.datagramToken != 0) {
+        datagramSessions.erase(it->second.datagramToken);
     }
+    addClientStats(it->second, closedConnectionStats);
+    clients.erase(it);
+
+    PacketView notice;
+    notice.type = PacketType::DISCONNECT;
+    notice.clientId = clientId;
+    receivedPackets.push_back(std::move(notice));
 }
 
-void NetworkServer::broadcastToClients(const std::vector<uint64_t>& clientIds, PacketType type, const void* payload, uint32_t payloadSize, uint64_t sessionToken) {
-    for (uint64_t clientId : clientIds) {
-        sendPacket(clientId, type, payload, payloadSize, sessionToken);
+void NetworkServer::captureEvent(const InboundEvent& event) {
+    switch (event.kind) {
+    case InboundEvent::Kind::PACKET:
+        capture->writePacket(event.timestampNanos, event.packet);
+        break;
+    case InboundEvent::Kind::CONNECTED:
+        capture->writeConnected(event.timestampNanos, event.packet.clientId, event.ipAddress);
+        break;
+    case InboundEvent::Kind::DISCONNECTED:
+        capture->writeDisconnected(event.timestampNanos, event.packet.clientId);
+        break;
+    case InboundEvent::Kind::DATAGRAM:
+        // Recorded as a packet once acceptDatagram() resolves its client
+        break;
     }
 }
 
-bool NetworkServer::isClientConnected(uint64_t clientId) const {
-    auto it = clients.find(clientId);
-    return it != clients.end() && it->second.connected;
+void NetworkServer::captureSent(uint64_t clientId, PacketType type, uint64_t sessionToken, const void* payload, uint32_t payloadSize) {
+    capture->writeSent(networkClockNanos(), clientId, type, sessionToken, payload, payloadSize);
 }
 
-int NetworkServer::getClientCount() const {
-    return static_cast<int>(clients.size());
+void NetworkServer::sendCompressionDictionary(uint64_t clientId) {
+    // Ahead of anything compressed against it on the same connection
+    if (compressionEnabled && !compressionDictionary.empty()) {
+        sendPacket(clientId, PacketType::COMPRESSION_DICTIONARY, compressionDictionary.data(),
+                   static_cast<uint32_t>(compressionDictionary.size()));
+    }
 }
 
-void NetworkServer::disconnectClient(uint64_t clientId) {
-    auto it = clients.find(clientId);
-    if (it != clients.end()) {
-        closesocket(it->second.socket);
-        clients.erase(it);
-        std::cout << "[NetworkServer] Client " << clientId << " disconnected" << std::endl;
+void NetworkServer::pumpReplay() {
+    if (replayFinished) return;
+
+    uint64_t elapsed = networkClockNanos() - replayStats.startNanos;
+    size_t limit = replayRealtime ? SIZE_MAX : REPLAY_BATCH;
+    size_t fed = 0;
+
+    CaptureRecord record;
+    uint64_t timestamp;
+    while (fed < limit && replay->peekTimestamp(timestamp)) {
+        // Reactors are drained one after another, so timestamps are only
+        // roughly ordered; anything at or before its slot is due
+        if (replayRealtime && timestamp > replayFirstTimestamp + elapsed) {
+            break;  // Not due yet
+        }
+        if (!replay->next(record)) {
+            break;
+        }
+        fed++;
+        replayStats.records++;
+
+        uint64_t clientId = record.packet.clientId;
+        switch (record.kind) {
+        case CaptureRecord::Kind::PACKET: {
+            if (clients.find(clientId) == clients.end()) break;
+
+            // Swap the captured session token for the one this run issued.
+            // A token is bound to the first login response sent to its
+            // client after the token was first seen.
+            uint64_t& token = record.packet.sessionToken;
+            if (token != 0) {
+                auto mapped = replayTokens.find(token);
+                if (mapped != replayTokens.end()) {
+                    token = mapped->second;
+                } else {
+                    auto login = replayLogins.find(clientId);
+                    if (login != replayLogins.end()) {
+                        replayTokens[token] = login->second;
+                        token = login->second;
+                        replayLogins.erase(login);
+                    }
+                }
+            }
+
+            replayStats.packets++;
+            bool isLogin = record.packet.type == PacketType::LOGIN_REQUEST;
+            receivedPackets.push_back(std::move(record.packet));
+
+            // Let the login be handled before reading on, so its token is
+            // known when the client's next packet is mapped
+            if (isLogin) limit = fed;
+            break;
+        }
+
+        case CaptureRecord::Kind::CONNECTED: {
+            ClientInfo& info = clients[clientId];
+            info.ipAddress = record.ipAddress;
+            info.stats = std::make_shared<ConnectionStats>();
+            sendCompressionDictionary(clientId);
+            break;
+        }
+
+        case CaptureRecord::Kind::SENT:
+            // What the server answered then; this run builds its own
+            break;
+
+        case CaptureRecord::Kind::DISCONNECTED:
+            removeClient(clientId);
+            replayLogins.erase(clientId);
+            break;
+        }
+    }
+
+    if (!replay->peekTimestamp(timestamp)) {
+        replayFinished = true;
+        replayStats.endNanos = networkClockNanos();
+        LOG_INFO(networkLog, "Replay finished");
     }
 }
 
-std::vector<NetworkServer::ReceivedPacket> NetworkServer::getReceivedPackets() {
-    std::vector<ReceivedPacket> packets = receivedPackets;
-    receivedPackets.clear();
-    return packets;
+void NetworkServer::waitForActivity(int timeoutMs) {
+    if (timeoutMs <= 0) return;
+
+    if (replay) {
+        // As fast as possible: never idle while records are left
+        if (!replayRealtime || replayFinished) return;
+
+        uint64_t timestamp;
+        if (replay->peekTimestamp(timestamp)) {
+            uint64_t offset = timestamp > replayFirstTimestamp ? timestamp - replayFirstTimestamp : 0;
+            uint64_t dueNanos = replayStats.startNanos + offset;
+            uint64_t now = networkClockNanos();
+            uint64_t waitNanos = dueNanos > now ? dueNanos - now : 0;
+            uint64_t maxNanos = static_cast<uint64_t>(timeoutMs) * 1000000ull;
+            std::this_thread::sleep_for(std::chrono::nanoseconds(waitNanos < maxNanos ? waitNanos : maxNanos));
+        }
+        return;
+    }
+
+    if (running && threaded) {
+        activity.wait(timeoutMs);
+        return;
+    }
+
+#ifdef PLATFORM_LINUX
+    if (running) {
+        // Ready sockets are processed now; update() hands over the results
+        reactors[0]->poll(timeoutMs);
+        return;
+    }
+#endif
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs));
 }
 
-void NetworkServer::acceptNewConnections() {
-    SOCKET clientSocket = accept(listenSocket, NULL, NULL);
-    if (clientSocket == INVALID_SOCKET) {
-        int error = WSAGetLastError();
-        if (error != WSAEWOULDBLOCK) {
-            std::cout << "[NetworkServer] Accept failed: " << error << std::endl;
+void NetworkServer::flushOutbound() {
+    if (!running || replay) return;
+
+    if (!threaded) {
+        reactors[0]->flush();
+        return;
+    }
+
+    // I/O threads write on their own; only wake the ones that have work
+    for (size_t i = 0; i < reactors.size(); i++) {
+        if (reactorHasCommands[i]) {
+            reactorHasCommands[i] = false;
+            reactors[i]->wake();
+        }
+    }
+}
+
+void NetworkServer::postCommand(OutboundCommand&& command) {
+    if (replay) {
+        // No sockets: count what would have been written
+        if (command.kind == OutboundCommand::Kind::SEND) {
+            replayStats.sentPackets++;
+            replayStats.sentBytes += sizeof(PacketHeader) + command.payload.size();
         }
         return;
     }
 
-    // Set client socket to non-blocking
-    u_long mode = 1;
-    ioctlsocket(clientSocket, FIONBIO, &mode);
+    // Datagrams all leave through the first reactor's UDP socket
+    uint32_t index = command.kind == OutboundCommand::Kind::DATAGRAM ? 0 : NetworkReactor::reactorIndexOf(command.clientId);
+    if (index >= reactors.size()) return;
+
+    NetworkReactor& reactor = *reactors[index];
+    while (!reactor.postCommand(std::move(command))) {
+        // Command queue full: let the reactor drain it and retry
+        if (threaded) {
+            reactor.wake();
+            std::this_thread::yield();
+        } else {
+            reactor.flush();
+        }
+    }
+    reactorHasCommands[index] = true;
+}
 
-    // Create client connection
-    ClientConnection client;
-    client.socket = clientSocket;
-    client.clientId = nextClientId++;
+bool NetworkServer::sendPacket(uint64_t clientId, PacketType type, const void* payload, uint32_t payloadSize, uint64_t sessionToken) {
+    if (clients.find(clientId) == clients.end()) {
+        return false;
+    }
+
+    // Learn the session token this replay issued to the client
+    if (replay && type == PacketType::LOGIN_RESPONSE) {
+        LoginResponse response;
+        if (decodePacket(static_cast<const uint8_t*>(payload), payloadSize, response) && response.success) {
+            replayLogins[clientId] = response.sessionToken;
+        }
+    }
+
+    if (capture) {
+        captureSent(clientId, type, sessionToken, payload, payloadSize);
+    }
 
-    // Get client IP
-    sockaddr_in clientAddr;
-    int addrLen = sizeof(clientAddr);
-    getpeername(clientSocket, (sockaddr*)&clientAddr, &addrLen);
-    char ipStr[INET_ADDRSTRLEN];
-    inet_ntop(AF_INET, &clientAddr.sin_addr, ipStr, INET_ADDRSTRLEN);
-    client.ipAddress = ipStr;
+    // Copy payload into a pooled slab; it stays queued until written
+    bool compressed;
+    PayloadRef slab = makePayload(type, payload, payloadSize, compressed);
+    if (payloadSize > 0 && slab.size() == 0) {
+        return false;
+    }
+
+    OutboundCommand command;
+    command.clientId = clientId;
+    command.type = type;
+    command.sessionToken = sessionToken;
+    command.payload = std::move(slab);
+    command.compressed = compressed;
+    postCommand(std::move(command));
+    return true;
+}
 
-    clients[client.clientId] = client;
-    std::cout << "[NetworkServer] New client connected: " << client.clientId << " (" << ipStr << ")" << std::endl;
+void NetworkServer::logEncodeFailure(PacketType type) {
+    LOG_WARN(networkLog, "{} does not fit in {} bytes once encoded", packetTypeToString(type), MAX_PACKET_SIZE);
 }
 
-void NetworkServer::receiveFromAllClients() {
+PayloadRef NetworkServer::makePayload(PacketType type, const void* payload, uint32_t payloadSize, bool& outCompressed) {
+    outCompressed = false;
+    if (payloadSize == 0 || payload == nullptr) {
+        return PayloadRef();
+    }
+
+    if (payloadSize > MAX_PACKET_SIZE) {
+        LOG_WARN(networkLog, "Refusing oversized {} ({} bytes)", packetTypeToString(type), payloadSize);
+        return PayloadRef();
+    }
+
+    // Payloads go out as a compressed frame when it is smaller (compressPayload
+    // skips small ones); the dictionary itself has to be readable without one
+    if (compressionEnabled && type != PacketType::COMPRESSION_DICTIONARY) {
+        const CompressionDictionary* dictionary = compressionDictionary.empty() ? nullptr : &compressionDictionary;
+        if (compressPayload(static_cast<const uint8_t*>(payload), payloadSize, compressBuffer, dictionary)) {
+            compressionStats.packets++;
+            compressionStats.rawBytes += payloadSize;
+            compressionStats.compressedBytes += compressBuffer.size();
+
+            PayloadRef slab = payloadPool.acquire(static_cast<uint32_t>(compressBuffer.size()));
+            memcpy(slab.data(), compressBuffer.data(), compressBuffer.size());
+            outCompressed = true;
+            return slab;
+        }
+    }
+
+    PayloadRef slab = payloadPool.acquire(payloadSize);
+    memcpy(slab.data(), payload, payloadSize);
+    return slab;
+}
+
+void NetworkServer::broadcastPacket(PacketType type, const void* payload, uint32_t payloadSize, uint64_t sessionToken) {
+    if (capture) {
+        captureSent(0, type, sessionToken, payload, payloadSize);
+    }
+
+    bool compressed;
+    PayloadRef slab = makePayload(type, payload, payloadSize, compressed);
+    if (payloadSize > 0 && slab.size() == 0) return;
+
     for (auto& pair : clients) {
-        receiveFromClient(pair.second);
+        OutboundCommand command;
+        command.clientId = pair.first;
+        command.type = type;
+        command.sessionToken = sessionToken;
+        command.payload = slab;
+        command.compressed = compressed;
+        postCommand(std::move(command));
     }
 }
 
-void NetworkServer::receiveFromClient(ClientConnection& client) {
-    if (!client.connected) return;
+void NetworkServer::broadcastToClients(const std::vector<uint64_t>& clientIds, PacketType type, const void* payload, uint32_t payloadSize, uint64_t sessionToken) {
+    if (capture) {
+        captureSent(0, type, sessionToken, payload, payloadSize);
+    }
+
+    bool compressed;
+    PayloadRef slab = makePayload(type, payload, payloadSize, compressed);
+    if (payloadSize > 0 && slab.size() == 0) return;
 
-    char buffer[4096];
-    int result = recv(client.socket, buffer, sizeof(buffer), 0);
+    for (uint64_t clientId : clientIds) {
+        if (clients.find(clientId) == clients.end()) continue;
+
+        OutboundCommand command;
+        command.clientId = clientId;
+        command.type = type;
+        command.sessionToken = sessionToken;
+        command.payload = slab;
+        command.compressed = compressed;
+        postCommand(std::move(command));
+    }
+}
 
-    if (result > 0) {
-        // Append to receive buffer
-        client.receiveBuffer.insert(client.receiveBuffer.end(), buffer, buffer + result);
+void NetworkServer::bindDatagramSession(uint64_t clientId, uint64_t sessionToken) {
+    auto it = clients.find(clientId);
+    if (it == clients.end()) return;
 
-        // Try to parse packets
-        parseClientPackets(client);
+    ClientInfo& info = it->second;
+    if (info.datagramToken != 0) {
+        datagramSessions.erase(info.datagramToken);
     }
-    else if (result == 0) {
-        // Connection closed
-        client.connected = false;
-        std::cout << "[NetworkServer] Client " << client.clientId << " closed connection" << std::endl;
+    info.datagramToken = sessionToken;
+    info.hasDatagramAddress = false;
+    datagramSessions[sessionToken] = clientId;
+}
+
+void NetworkServer::unbindDatagramSession(uint64_t clientId) {
+    auto it = clients.find(clientId);
+    if (it == clients.end() || it->second.datagramToken == 0) return;
+
+    ClientInfo& info = it->second;
+    datagramSessions.erase(info.datagramToken);
+    info.datagramToken = 0;
+    info.hasDatagramAddress = false;
+}
+
+bool NetworkServer::hasDatagramAddress(uint64_t clientId) const {
+    auto it = clients.find(clientId);
+    return it != clients.end() && it->second.hasDatagramAddress;
+}
+
+bool NetworkServer::sendDatagram(uint64_t clientId, PacketType type, const void* payload, uint32_t payloadSize) {
+    auto it = clients.find(clientId);
+    if (it == clients.end() || !it->second.hasDatagramAddress) {
+        return false;
     }
-    else {
-        int error = WSAGetLastError();
-        if (error != WSAEWOULDBLOCK) {
-            client.connected = false;
-            std::cout << "[NetworkServer] Receive failed from client " << client.clientId << ": " << error << std::endl;
-        }
+
+    if (sizeof(DatagramHeader) + payloadSize > MAX_DATAGRAM_SIZE) {
+        LOG_WARN(networkLog, "Refusing oversized {} datagram ({} bytes)", packetTypeToString(type), payloadSize);
+        return false;
+    }
+
+    ClientInfo& info = it->second;
+    DatagramHeader header;
+    header.sessionToken = 0;
+    header.type = static_cast<uint16_t>(type);
+    header.sequence = info.datagramSequenceOut++;
+    info.datagramsOut.add(type, sizeof(header) + payloadSize);
+
+    // Whole datagram in one slab; the reactor hands it to sendto() as is
+    PayloadRef datagram = payloadPool.acquire(static_cast<uint32_t>(sizeof(header) + payloadSize));
+    memcpy(datagram.data(), &header, sizeof(header));
+    if (payloadSize > 0) {
+        memcpy(datagram.data() + sizeof(header), payload, payloadSize);
     }
+
+    OutboundCommand command;
+    command.kind = OutboundCommand::Kind::DATAGRAM;
+    command.clientId = clientId;
+    command.type = type;
+    command.payload = std::move(datagram);
+    command.address = info.datagramAddress;
+    postCommand(std::move(command));
+    return true;
 }
 
-void NetworkServer::parseClientPackets(ClientConnection& client) {
-    while (client.receiveBuffer.size() >= sizeof(PacketHeader)) {
-        // Read header
-        PacketHeader header;
-        memcpy(&header, client.receiveBuffer.data(), sizeof(PacketHeader));
+bool NetworkServer::isClientConnected(uint64_t clientId) const {
+    return clients.find(clientId) != clients.end();
+}
 
-        // Check if we have the full packet
-        size_t totalSize = sizeof(PacketHeader) + header.payloadSize;
-        if (client.receiveBuffer.size() < totalSize) {
-            break;  // Wait for more data
-        }
+size_t NetworkServer::getQueuedBytes(uint64_t clientId) const {
+    auto it = clients.find(clientId);
+    return it != clients.end() ? it->second.stats->queuedBytes.load(std::memory_order_relaxed) : 0;
+}
 
-        // Extract payload
-        std::vector<uint8_t> payload;
-        if (header.payloadSize > 0) {
-            payload.resize(header.payloadSize);
-            memcpy(payload.data(), client.receiveBuffer.data() + sizeof(PacketHeader), header.payloadSize);
-        }
+uint32_t NetworkServer::getRttMicros(uint64_t clientId) const {
+    auto it = clients.find(clientId);
+    return it != clients.end() ? it->second.stats->smoothedRttMicros.load(std::memory_order_relaxed) : 0;
+}
+
+size_t NetworkServer::getTotalQueuedBytes() const {
+    size_t total = 0;
+    for (const auto& reactor : reactors) {
+        total += reactor->getTotalQueuedBytes();
+    }
+    return total;
+}
 
-        // Create received packet
-        ReceivedPacket packet;
-        packet.clientId = client.clientId;
-        packet.type = static_cast<PacketType>(header.type);
-        packet.payload = payload;
-        packet.sessionToken = header.sessionToken;
-        receivedPackets.push_back(packet);
+void NetworkServer::addClientStats(const ClientInfo& info, NetworkTrafficStats& out) const {
+    if (info.stats) {
+        out.addConnection(*info.stats);
+    } else {
+        out.connections++;
+    }
+    out.datagramsIn.merge(info.datagramsIn);
+    out.datagramsOut.merge(info.datagramsOut);
+}
 
-        // Remove processed packet from buffer
-        client.receiveBuffer.erase(client.receiveBuffer.begin(), client.receiveBuffer.begin() + totalSize);
+bool NetworkServer::getConnectionStats(uint64_t clientId, NetworkTrafficStats& out) const {
+    auto it = clients.find(clientId);
+    if (it == clients.end()) return false;
 
-        std::cout << "[NetworkServer] Received " << packetTypeToString(packet.type)
-                  << " from client " << client.clientId << std::endl;
+    out = NetworkTrafficStats();
+    addClientStats(it->second, out);
+    if (it->second.stats) {
+        out.lastRttMicros = it->second.stats->lastRttMicros.load(std::memory_order_relaxed);
+        out.smoothedRttMicros = it->second.stats->smoothedRttMicros.load(std::memory_order_relaxed);
     }
+    return true;
 }
 
-void NetworkServer::removeDisconnectedClients() {
-    std::vector<uint64_t> toRemove;
-    for (auto& pair : clients) {
-        if (!pair.second.connected) {
-            toRemove.push_back(pair.first);
+void NetworkServer::getNetworkStats(NetworkTrafficStats& out) const {
+    out = closedConnectionStats;
+    for (const auto& pair : clients) {
+        addClientStats(pair.second, out);
+    }
+}
+
+void NetworkServer::logNetworkStats() {
+    NetworkTrafficStats total;
+    getNetworkStats(total);
+
+    uint64_t now = networkClockNanos();
+    double seconds = (now - lastLoggedNanos) / 1e9;
+    if (seconds <= 0.0) seconds = 1.0;
+
+    auto rate = [seconds](uint64_t current, uint64_t previous) {
+        return (current - previous) / seconds;
+    };
+
+    char line[160];
+    LOG_INFO(networkLog, "Network stats over {} s, {} clients (packets/s, KB/s):", static_cast<uint64_t>(seconds + 0.5), clients.size());
+    const struct {
+        const char* label;
+        const TrafficCounters& current;
+        const TrafficCounters& previous;
+    } directions[] = {
+        { "TCP in", total.in, lastLoggedStats.in },
+        { "TCP out", total.out, lastLoggedStats.out },
+        { "UDP in", total.datagramsIn, lastLoggedStats.datagramsIn },
+        { "UDP out", total.datagramsOut, lastLoggedStats.datagramsOut }
+    };
+    for (const auto& direction : directions) {
+        snprintf(line, sizeof(line), "  %-8s %10.1f %10.1f", direction.label,
+                 rate(direction.current.packets, direction.previous.packets),
+                 rate(direction.current.bytes, direction.previous.bytes) / 1024.0);
+        LOG_INFO(networkLog, "{}", line);
+    }
+    snprintf(line, sizeof(line), "  queued %.1f KB now, peak %.1f KB on one connection",
+             total.queuedBytes / 1024.0, total.peakQueuedBytes / 1024.0);
+    LOG_INFO(networkLog, "{}", line);
+
+    // Busiest packet types in either direction, both channels together
+    LOG_INFO(networkLog, "Packets by type (in/s, out/s):");
+    for (size_t slot = 0; slot < PACKET_TYPE_SLOTS; slot++) {
+        uint64_t in = total.in.packetsByType[slot] + total.datagramsIn.packetsByType[slot] -
+                      lastLoggedStats.in.packetsByType[slot] - lastLoggedStats.datagramsIn.packetsByType[slot];
+        uint64_t out = total.out.packetsByType[slot] + total.datagramsOut.packetsByType[slot] -
+                       lastLoggedStats.out.packetsByType[slot] - lastLoggedStats.datagramsOut.packetsByType[slot];
+        if (in == 0 && out == 0) continue;
+
+        char name[32];
+        PacketType type = slotPacketType(slot);
+        if (slot == OTHER_PACKET_TYPE_SLOT) {
+            snprintf(name, sizeof(name), "(other)");
+        } else if (strcmp(packetTypeToString(type), "UNKNOWN") == 0) {
+            snprintf(name, sizeof(name), "type %u", static_cast<unsigned>(type));
+        } else {
+            snprintf(name, sizeof(name), "%s", packetTypeToString(type));
+        }
+        snprintf(line, sizeof(line), "  %-28s %10.1f %10.1f", name, in / seconds, out / seconds);
+        LOG_INFO(networkLog, "{}", line);
+    }
+
+    // RTT as the connected players see it now, and who is worst off
+    NetworkTrafficStats live;
+    std::vector<std::pair<uint64_t, uint64_t>> slowest;    // p99 us, clientId
+    for (const auto& pair : clients) {
+        if (!pair.second.stats) continue;
+        NetworkTrafficStats client;
+        client.addConnection(*pair.second.stats);
+        if (client.rttMicros.getCount() > 0) {
+            slowest.emplace_back(client.rttMicros.getPercentile(99.0), pair.first);
         }
+        live.merge(client);
+    }
+
+    const LatencyHistogram& rtt = live.rttMicros;
+    snprintf(line, sizeof(line), "Heartbeat RTT over %u live connections (ms): p50 %.2f  p90 %.2f  p99 %.2f  max %.2f, %llu probes unanswered",
+             live.connections, rtt.getPercentile(50.0) / 1000.0, rtt.getPercentile(90.0) / 1000.0,
+             rtt.getPercentile(99.0) / 1000.0, rtt.getMax() / 1000.0,
+             static_cast<unsigned long long>(live.probesSent - live.probesAnswered));
+    LOG_INFO(networkLog, "{}", line);
+
+    size_t shown = std::min(slowest.size(), SLOWEST_CLIENTS_LOGGED);
+    std::partial_sort(slowest.begin(), slowest.begin() + static_cast<std::ptrdiff_t>(shown), slowest.end(),
+                      [](const auto& a, const auto& b) { return a.first > b.first; });
+    for (size_t i = 0; i < shown; i++) {
+        const ClientInfo& info = clients.at(slowest[i].second);
+        snprintf(line, sizeof(line), "  client %-10llu %-15s p99 %8.2f ms  srtt %8.2f ms  queued %8.1f KB",
+                 static_cast<unsigned long long>(slowest[i].second), info.ipAddress.c_str(), slowest[i].first / 1000.0,
+                 info.stats->smoothedRttMicros.load(std::memory_order_relaxed) / 1000.0,
+                 info.stats->queuedBytes.load(std::memory_order_relaxed) / 1024.0);
+        LOG_INFO(networkLog, "{}", line);
     }
 
-    for (uint64_t clientId : toRemove) {
-        closesocket(clients[clientId].socket);
-        clients.erase(clientId);
+    lastLoggedStats = total;
+    lastLoggedNanos = now;
+}
+
+int NetworkServer::getClientCount() const {
+    return static_cast<int>(clients.size());
+}
+
+void NetworkServer::disconnectClient(uint64_t clientId) {
+    if (clients.find(clientId) != clients.end()) {
+        // The owning reactor closes the socket on its next cycle
+        removeClient(clientId);
+
+        OutboundCommand command;
+        command.kind = OutboundCommand::Kind::DISCONNECT;
+        command.clientId = clientId;
+        postCommand(std::move(command));
     }
 }
+
+void NetworkServer::getReceivedPackets(std::vector<PacketView>& outPackets) {
+    outPackets.clear();
+    outPackets.swap(receivedPackets);
+}
@@ -2,34 +2,115 @@
 #include "../../engine/core/Platform.h"
 #include "../../common/NetworkProtocol.h"
 #include "../../common/DataStructures.h"
+#include "../../common/Compression.h"
+#include "PacketView.h"
+#include "ConnectionStats.h"
+#include "NetworkReactor.h"
+#include "PacketCapture.h"
 #include <vector>
 #include <map>
+#include <string>
 #include <memory>
 
-// Server-side network manager
+// Server-side network manager. Connections are sharded over one or more
+// NetworkReactors; with ioThreads > 0 each reactor runs on its own thread and
+// the game thread only exchanges packets and send commands with them through
+// lock-free queues. Packet handlers always run on the game thread.
+//
+// Besides the TCP connections, the server takes unreliable UDP datagrams on
+// the same port for high-rate gameplay state (see sendDatagram()).
+//
+// TCP payloads of COMPRESSION_THRESHOLD bytes or more are compressed when
+// that makes them smaller, optionally against a shared dictionary.
+//
+// Every connection keeps traffic counts, queue depth and a heartbeat RTT
+// histogram (see ConnectionStats.h), readable per client or summed over the
+// server while it runs.
+//
+// Traffic can be recorded to a capture file while serving, and a capture
+// can be replayed in place of the sockets (see startReplay()).
 class NetworkServer {
 public:
     NetworkServer();
     ~NetworkServer();
 
-    // Start listening on specified port
-    bool start(int port = 7777);
+    // Start listening on specified port. ioThreads = 0 keeps all socket work
+    // on the calling thread (the only mode on Windows).
+    bool start(int port = 7777, int ioThreads = 0);
+
+    // Serve from a capture file instead of sockets: recorded connects,
+    // disconnects and packets come out of update() as if received, and
+    // outbound packets are built as usual and then dropped. realtime keeps
+    // the recorded spacing; otherwise records are fed as fast as the game
+    // loop takes them. Session tokens in the capture are mapped to the ones
+    // issued during the replay.
+    bool startReplay(const std::string& path, bool realtime, std::string& errorMsg);
+    bool isReplaying() const { return replay != nullptr; }
+    bool isReplayFinished() const { return replay != nullptr && replayFinished; }
+    void logReplayStats() const;
+
+    // Record every inbound event, and the packets sent in reply, to a
+    // capture file (while serving)
+    bool startCapture(const std::string& path, std::string& errorMsg);
+    void stopCapture();
+
+    // Compress against a dictionary (see CompressionDictionary::train()).
+    // Call before start(): every client is sent it as it connects.
+    bool loadCompressionDictionary(const std::string& path, std::string& errorMsg);
+    void setCompressionEnabled(bool enabled) { compressionEnabled = enabled; }
 
     // Shutdown server
     void shutdown();
 
-    // Update server (accept new connections, receive data)
+    // Update server (collect connections, disconnects and received packets)
     void update();
 
-    // Send packet to specific client
+    // Block until network activity arrives or timeoutMs elapses.
+    // Ready events are handled by the next update().
+    void waitForActivity(int timeoutMs);
+
+    // Write queued outbound packets (call once per tick, after handlers run)
+    void flushOutbound();
+
+    // Queue packet for specific client (written by the next flushOutbound)
     bool sendPacket(uint64_t clientId, PacketType type, const void* payload, uint32_t payloadSize, uint64_t sessionToken = 0);
 
-    // Broadcast packet to all clients
+    // Broadcast packet to all clients. The payload is copied once and every
+    // recipient's queue shares it; only the small header is per-connection.
     void broadcastPacket(PacketType type, const void* payload, uint32_t payloadSize, uint64_t sessionToken = 0);
 
-    // Broadcast packet to specific clients
+    // Broadcast packet to specific clients (payload shared as above)
     void broadcastToClients(const std::vector<uint64_t>& clientIds, PacketType type, const void* payload, uint32_t payloadSize, uint64_t sessionToken = 0);
 
+    // Typed variants of the above: the protocol struct is encoded through its
+    // PacketSchema into a reused buffer before being queued
+    template <typename T>
+    bool sendMessage(uint64_t clientId, PacketType type, const T& message, uint64_t sessionToken = 0);
+
+    template <typename T>
+    void broadcastMessage(PacketType type, const T& message, uint64_t sessionToken = 0);
+
+    template <typename T>
+    void broadcastMessageToClients(const std::vector<uint64_t>& clientIds, PacketType type, const T& message, uint64_t sessionToken = 0);
+
+    // Accept datagrams carrying this session token as coming from clientId
+    // (call once the client has logged in). The client's UDP address is
+    // learned from its datagrams and follows it if it changes.
+    void bindDatagramSession(uint64_t clientId, uint64_t sessionToken);
+
+    // Stop accepting the client's datagrams (its session ended). They are
+    // dropped as unknown sessions instead of reaching the dispatcher.
+    void unbindDatagramSession(uint64_t clientId);
+    bool hasDatagramAddress(uint64_t clientId) const;
+
+    // Send one unreliable datagram (header + payload <= MAX_DATAGRAM_SIZE).
+    // Returns false while the client's UDP address is unknown; use
+    // sendPacket for anything that has to arrive.
+    bool sendDatagram(uint64_t clientId, PacketType type, const void* payload, uint32_t payloadSize);
+
+    template <typename T>
+    bool sendDatagramMessage(uint64_t clientId, PacketType type, const T& message);
+
     // Check if client is connected
     bool isClientConnected(uint64_t clientId) const;
 
@@ -39,42 +120,146 @@ public:
     // Disconnect client
     void disconnectClient(uint64_t clientId);
 
-    // Packet queue for processing
-    struct ReceivedPacket {
-        uint64_t clientId;
-        PacketType type;
-        std::vector<uint8_t> payload;
-        uint64_t sessionToken;
-    };
+    // Outbound bytes waiting for the socket
+    size_t getQueuedBytes(uint64_t clientId) const;
+    size_t getTotalQueuedBytes() const;
+
+    // Smoothed heartbeat round trip, 0 until the first echo
+    uint32_t getRttMicros(uint64_t clientId) const;
+
+    // One connection's traffic since it connected. False if unknown.
+    bool getConnectionStats(uint64_t clientId, NetworkTrafficStats& out) const;
+
+    // Every connection since start(), closed ones included
+    void getNetworkStats(NetworkTrafficStats& out) const;
 
-    // Get all received packets
-    std::vector<ReceivedPacket> getReceivedPackets();
+    // Rates since the previous call, RTT over the live connections and the
+    // clients with the worst RTT
+    void logNetworkStats();
+
+    // Hand over all received packets by swapping queues. outPackets is
+    // cleared first and its capacity becomes the next receive queue, so a
+    // caller that reuses one vector causes no allocations.
+    void getReceivedPackets(std::vector<PacketView>& outPackets);
 
 private:
-    struct ClientConnection {
-        SOCKET socket;
-        uint64_t clientId;
+    struct ClientInfo {
         std::string ipAddress;
-        bool connected;
-        uint32_t sequenceIn;
-        uint32_t sequenceOut;
-        std::vector<uint8_t> receiveBuffer;
+        std::shared_ptr<ConnectionStats> stats;
+
+        // Datagram channel
+        uint64_t datagramToken = 0;         // Bound session token, 0 if none
+        bool hasDatagramAddress = false;
+        sockaddr_in datagramAddress = {};
+        uint32_t datagramSequenceIn = 0;    // Newest accepted
+        uint32_t datagramSequenceOut = 0;
+        TrafficCounters datagramsIn;
+        TrafficCounters datagramsOut;
+    };
+
+    struct CompressionStats {
+        uint64_t packets = 0;           // Sent compressed
+        uint64_t rawBytes = 0;          // Their payload sizes before
+        uint64_t compressedBytes = 0;   // and after
+    };
 
-        ClientConnection() : socket(INVALID_SOCKET), clientId(0), connected(true),
-                            sequenceIn(0), sequenceOut(0) {}
+    struct DatagramStats {
+        uint64_t accepted = 0;
+        uint64_t stale = 0;             // Older than one already accepted
+        uint64_t unknownSession = 0;
+        uint64_t disallowedType = 0;    // Not an isDatagramPacketType()
     };
 
-    SOCKET listenSocket;
-    std::map<uint64_t, ClientConnection> clients;
-    std::vector<ReceivedPacket> receivedPackets;
-    uint64_t nextClientId = 1;
+    PayloadPool payloadPool;    // Outbound payloads; declared first so it outlives the reactors
+    ActivitySignal activity;
+    std::vector<std::unique_ptr<NetworkReactor>> reactors;
+    std::vector<bool> reactorHasCommands;   // Reactors to wake on the next flush
+    std::map<uint64_t, ClientInfo> clients;
+    std::map<uint64_t, uint64_t> datagramSessions;     // Session token -> clientId
+    DatagramStats datagramStats;
+    NetworkTrafficStats closedConnectionStats;     // Folded in as clients are removed
+    NetworkTrafficStats lastLoggedStats;            // Totals at the previous logNetworkStats()
+    uint64_t lastLoggedNanos = 0;
+    std::vector<PacketView> receivedPackets;
+    std::vector<uint8_t> encodeBuffer;     // Scratch for sendMessage & co (game thread)
+    std::vector<uint8_t> compressBuffer;   // Scratch for makePayload (game thread)
+    CompressionDictionary compressionDictionary;
+    CompressionStats compressionStats;
+    bool compressionEnabled = true;
+    bool threaded = false;
     int serverPort = 0;
     bool initialized;
     bool running;
 
-    void acceptNewConnections();
-    void receiveFromAllClients();
-    void receiveFromClient(ClientConnection& client);
-    void parseClientPackets(ClientConnection& client);
-    void removeDisconnectedClients();
+    std::unique_ptr<PacketCaptureWriter> capture;
+
+    struct ReplayStats {
+        uint64_t records = 0;
+        uint64_t packets = 0;
+        uint64_t sentPackets = 0;       // Outbound packets built and dropped
+        uint64_t sentBytes = 0;
+        uint64_t startNanos = 0;
+        uint64_t endNanos = 0;
+    };
+
+    std::unique_ptr<PacketCaptureReader> replay;
+    bool replayRealtime = false;
+    bool replayFinished = false;
+    uint64_t replayFirstTimestamp = 0;              // Capture time of the first record
+    std::map<uint64_t, uint64_t> replayTokens;      // Captured session token -> live token
+    std::map<uint64_t, uint64_t> replayLogins;      // clientId -> live token not yet seen in a packet
+    ReplayStats replayStats;
+
+    template <typename T>
+    uint32_t encodeMessage(PacketType type, const T& message);
+    void logEncodeFailure(PacketType type);
+
+    PayloadRef makePayload(PacketType type, const void* payload, uint32_t payloadSize, bool& outCompressed);
+    void postCommand(OutboundCommand&& command);
+    void captureEvent(const InboundEvent& event);
+    void captureSent(uint64_t clientId, PacketType type, uint64_t sessionToken, const void* payload, uint32_t payloadSize);
+    void sendCompressionDictionary(uint64_t clientId);
+    bool acceptDatagram(InboundEvent& event);
+    void addClientStats(const ClientInfo& info, NetworkTrafficStats& out) const;
+    // Forget a client and queue a DISCONNECT for the game layer, so its
+    // session ends whether or not the client said goodbye
+    void removeClient(uint64_t clientId);
+    void pumpReplay();
 };
+
+template <typename T>
+uint32_t NetworkServer::encodeMessage(PacketType type, const T& message) {
+    size_t size = encodePacket(message, encodeBuffer.data(), encodeBuffer.size());
+    if (size == 0) {
+        logEncodeFailure(type);
+    }
+    return static_cast<uint32_t>(size);
+}
+
+template <typename T>
+bool NetworkServer::sendMessage(uint64_t clientId, PacketType type, const T& message, uint64_t sessionToken) {
+    uint32_t size = encodeMessage(type, message);
+    return size > 0 && sendPacket(clientId, type, encodeBuffer.data(), size, sessionToken);
+}
+
+template <typename T>
+void NetworkServer::broadcastMessage(PacketType type, const T& message, uint64_t sessionToken) {
+    uint32_t size = encodeMessage(type, message);
+    if (size > 0) {
+        broadcastPacket(type, encodeBuffer.data(), size, sessionToken);
+    }
+}
+
+template <typename T>
+void NetworkServer::broadcastMessageToClients(const std::vector<uint64_t>& clientIds, PacketType type, const T& message, uint64_t sessionToken) {
+    uint32_t size = encodeMessage(type, message);
+    if (size > 0) {
+        broadcastToClients(clientIds, type, encodeBuffer.data(), size, sessionToken);
+    }
+}
+
+template <typename T>
+bool NetworkServer::sendDatagramMessage(uint64_t clientId, PacketType type, const T& message) {
+    uint32_t size = encodeMessage(type, message);
+    return size > 0 && sendDatagram(clientId, type, encodeBuffer.data(), size);
+}
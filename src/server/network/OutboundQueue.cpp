@@ -0,0 +1,115 @@
+#include "OutboundQueue.h"
+#include <cstring>
+
+#ifndef PLATFORM_WINDOWS
+#include <sys/uio.h>
+#endif
+
+void OutboundQueue::push(const PacketHeader& header, const PayloadRef& payload) {
+    frames.push_back(Frame{ header, payload });
+    queuedBytes += frames.back().totalSize();
+}
+
+OutboundQueue::FlushResult OutboundQueue::flush(SOCKET socket, int& outError) {
+    outError = 0;
+
+    while (!empty()) {
+        // Gather up to MAX_IOV buffers, starting mid-frame after a short write
+#ifdef PLATFORM_WINDOWS
+        WSABUF buffers[MAX_IOV];
+#else
+        iovec buffers[MAX_IOV];
+#endif
+        int count = 0;
+
+        for (size_t i = head; i < frames.size() && count + 2 <= MAX_IOV; i++) {
+            Frame& frame = frames[i];
+            uint32_t skip = (i == head) ? headOffset : 0;
+
+            const uint8_t* headerBytes = reinterpret_cast<const uint8_t*>(&frame.header);
+            const uint8_t* segments[2] = { headerBytes, frame.payload.data() };
+            uint32_t lengths[2] = { static_cast<uint32_t>(sizeof(PacketHeader)), frame.payload.size() };
+
+            for (int s = 0; s < 2; s++) {
+                if (skip >= lengths[s]) {
+                    skip -= lengths[s];
+                    continue;
+                }
+#ifdef PLATFORM_WINDOWS
+                buffers[count].buf = (char*)(segments[s] + skip);
+                buffers[count].len = lengths[s] - skip;
+#else
+                buffers[count].iov_base = (void*)(segments[s] + skip);
+                buffers[count].iov_len = lengths[s] - skip;
+#endif
+                count++;
+                skip = 0;
+            }
+        }
+
+        size_t written = 0;
+#ifdef PLATFORM_WINDOWS
+        DWORD sent = 0;
+        if (WSASend(socket, buffers, count, &sent, 0, NULL, NULL) == SOCKET_ERROR) {
+            int error = WSAGetLastError();
+            if (error == WSAEWOULDBLOCK) return FlushResult::PENDING;
+            outError = error;
+            return FlushResult::FAILED;
+        }
+        written = sent;
+#else
+        msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = buffers;
+        msg.msg_iovlen = count;
+
+        ssize_t sent = sendmsg(socket, &msg, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return FlushResult::PENDING;
+            outError = errno;
+            return FlushResult::FAILED;
+        }
+        written = static_cast<size_t>(sent);
+#endif
+
+        advance(written);
+    }
+
+    return FlushResult::DRAINED;
+}
+
+void OutboundQueue::advance(size_t bytesWritten) {
+    queuedBytes -= bytesWritten;
+
+    while (bytesWritten > 0 && head < frames.size()) {
+        uint32_t remaining = frames[head].totalSize() - headOffset;
+        if (bytesWritten < remaining) {
+            headOffset += static_cast<uint32_t>(bytesWritten);
+            return;
+        }
+
+        bytesWritten -= remaining;
+        frames[head].payload.reset();   // Slab goes back to the pool now
+        head++;
+        headOffset = 0;
+    }
+
+    // Fully drained: reuse the vector's storage from the start
+    if (head == frames.size()) {
+        frames.clear();
+        head = 0;
+    }
+    // A connection that never fully drains still shouldn't grow forever
+    else if (head >= 64 && head * 2 >= frames.size()) {
+        frames.erase(frames.begin(), frames.begin() + head);
+        head = 0;
+    }
+}
+
+void OutboundQueue::clear() {
+    frames.clear();
+    head = 0;
+    headOffset = 0;
+    queuedBytes = 0;
+}
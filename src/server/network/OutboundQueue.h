@@ -0,0 +1,50 @@
+#pragma once
+#include "../../engine/core/Platform.h"
+#include "../../common/NetworkProtocol.h"
+#include "PacketView.h"
+#include <vector>
+
+// Per-connection send queue. Packets are queued as (header, payload) pairs
+// and written with one scatter-gather call per flush, so many small lobby
+// responses share a single syscall. A short write leaves the remainder at
+// the head of the queue and the next flush resumes from the exact byte.
+class OutboundQueue {
+public:
+    enum class FlushResult {
+        DRAINED,        // Everything written
+        PENDING,        // Socket would block; data remains queued
+        FAILED          // Socket error; connection should be dropped
+    };
+
+    OutboundQueue() : head(0), headOffset(0), queuedBytes(0) {}
+
+    // Queue one packet. The payload reference is shared, not copied.
+    void push(const PacketHeader& header, const PayloadRef& payload);
+
+    // Write as much as the socket accepts
+    FlushResult flush(SOCKET socket, int& outError);
+
+    bool empty() const { return head == frames.size(); }
+    size_t getQueuedBytes() const { return queuedBytes; }
+    size_t getQueuedPackets() const { return frames.size() - head; }
+
+    void clear();
+
+private:
+    struct Frame {
+        PacketHeader header;
+        PayloadRef payload;
+
+        uint32_t totalSize() const { return static_cast<uint32_t>(sizeof(PacketHeader)) + payload.size(); }
+    };
+
+    // Max buffers handed to one writev/WSASend call (2 per frame)
+    static constexpr int MAX_IOV = 64;
+
+    std::vector<Frame> frames;
+    size_t head;            // First unsent frame
+    uint32_t headOffset;    // Bytes of frames[head] already written
+    size_t queuedBytes;
+
+    void advance(size_t bytesWritten);
+};
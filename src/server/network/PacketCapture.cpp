@@ -0,0 +1,178 @@
+#include "PacketCapture.h"
+#include <chrono>
+#include <cstring>
+
+namespace {
+    const char CAPTURE_MAGIC[8] = { 'T', 'D', 'S', 'C', 'A', 'P', 0, 0 };
+}
+
+// ============================================================================
+// WRITER
+// ============================================================================
+
+PacketCaptureWriter::~PacketCaptureWriter() {
+    close();
+}
+
+bool PacketCaptureWriter::open(const std::string& path, uint64_t start, std::string& errorMsg) {
+    close();
+
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        errorMsg = "Cannot create capture file " + path;
+        return false;
+    }
+
+    CaptureFileHeader header;
+    memcpy(header.magic, CAPTURE_MAGIC, sizeof(header.magic));
+    header.version = VERSION;
+    header.reserved = 0;
+    header.startUnixMillis = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    buffer.reserve(BUFFER_SIZE);
+    startNanos = start;
+    lastFlushNanos = start;
+    recordCount = 0;
+    byteCount = sizeof(header);
+    return true;
+}
+
+void PacketCaptureWriter::close() {
+    if (!file.is_open()) return;
+    flushBuffer();
+    file.close();
+}
+
+void PacketCaptureWriter::writeConnected(uint64_t timestampNanos, uint64_t clientId, const char* ipAddress) {
+    uint32_t length = static_cast<uint32_t>(strlen(ipAddress));
+    writeRecord(CaptureRecord::Kind::CONNECTED, timestampNanos, clientId, PacketType::INVALID_PACKET, 0, ipAddress, length);
+}
+
+void PacketCaptureWriter::writeDisconnected(uint64_t timestampNanos, uint64_t clientId) {
+    writeRecord(CaptureRecord::Kind::DISCONNECTED, timestampNanos, clientId, PacketType::INVALID_PACKET, 0, nullptr, 0);
+}
+
+void PacketCaptureWriter::writePacket(uint64_t timestampNanos, const PacketView& packet) {
+    writeRecord(CaptureRecord::Kind::PACKET, timestampNanos, packet.clientId, packet.type,
+                packet.sessionToken, packet.data(), packet.size());
+}
+
+void PacketCaptureWriter::writeSent(uint64_t timestampNanos, uint64_t clientId, PacketType type, uint64_t sessionToken,
+                                    const void* payload, uint32_t payloadSize) {
+    writeRecord(CaptureRecord::Kind::SENT, timestampNanos, clientId, type, sessionToken, payload, payloadSize);
+}
+
+void PacketCaptureWriter::writeRecord(CaptureRecord::Kind kind, uint64_t timestampNanos, uint64_t clientId,
+                                      PacketType type, uint64_t sessionToken, const void* payload, uint32_t payloadSize) {
+    if (!file.is_open()) return;
+
+    CaptureRecordHeader header;
+    header.timestampNanos = timestampNanos > startNanos ? timestampNanos - startNanos : 0;
+    header.clientId = clientId;
+    header.sessionToken = sessionToken;
+    header.payloadSize = payloadSize;
+    header.type = static_cast<uint16_t>(type);
+    header.kind = static_cast<uint8_t>(kind);
+    header.reserved = 0;
+
+    size_t recordSize = sizeof(header) + payloadSize;
+    if (buffer.size() + recordSize > BUFFER_SIZE) {
+        flushBuffer();
+    }
+
+    const uint8_t* headerBytes = reinterpret_cast<const uint8_t*>(&header);
+    buffer.insert(buffer.end(), headerBytes, headerBytes + sizeof(header));
+    if (payloadSize > 0) {
+        const uint8_t* payloadBytes = static_cast<const uint8_t*>(payload);
+        buffer.insert(buffer.end(), payloadBytes, payloadBytes + payloadSize);
+    }
+
+    recordCount++;
+    byteCount += recordSize;
+
+    if (timestampNanos >= lastFlushNanos + FLUSH_INTERVAL_NANOS) {
+        flushBuffer();
+        file.flush();
+        lastFlushNanos = timestampNanos;
+    }
+}
+
+void PacketCaptureWriter::flushBuffer() {
+    if (buffer.empty()) return;
+    file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+}
+
+// ============================================================================
+// READER
+// ============================================================================
+
+bool PacketCaptureReader::open(const std::string& path, std::string& errorMsg) {
+    file.open(path, std::ios::binary);
+    if (!file.is_open()) {
+        errorMsg = "Cannot open capture file " + path;
+        return false;
+    }
+
+    CaptureFileHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        memcmp(header.magic, CAPTURE_MAGIC, sizeof(header.magic)) != 0) {
+        errorMsg = path + " is not a packet capture";
+        file.close();
+        return false;
+    }
+
+    if (header.version < PacketCaptureWriter::OLDEST_READABLE_VERSION || header.version > PacketCaptureWriter::VERSION) {
+        errorMsg = "Unsupported capture version " + std::to_string(header.version);
+        file.close();
+        return false;
+    }
+
+    hasPendingHeader = false;
+    return true;
+}
+
+bool PacketCaptureReader::readHeader() {
+    if (hasPendingHeader) return true;
+    if (!file.read(reinterpret_cast<char*>(&pendingHeader), sizeof(pendingHeader))) {
+        return false;
+    }
+    hasPendingHeader = true;
+    return true;
+}
+
+bool PacketCaptureReader::peekTimestamp(uint64_t& outNanos) {
+    if (!readHeader()) return false;
+    outNanos = pendingHeader.timestampNanos;
+    return true;
+}
+
+bool PacketCaptureReader::next(CaptureRecord& out) {
+    if (!readHeader()) return false;
+    hasPendingHeader = false;
+
+    const CaptureRecordHeader& header = pendingHeader;
+    if (header.payloadSize > MAX_PACKET_SIZE) {
+        return false;   // Corrupt record; treat as the end
+    }
+
+    out.kind = static_cast<CaptureRecord::Kind>(header.kind);
+    out.timestampNanos = header.timestampNanos;
+    out.packet.clientId = header.clientId;
+    out.packet.type = static_cast<PacketType>(header.type);
+    out.packet.sessionToken = header.sessionToken;
+    out.packet.payload.reset();
+    out.ipAddress.clear();
+
+    if (header.payloadSize == 0) return true;
+
+    if (out.kind == CaptureRecord::Kind::CONNECTED) {
+        out.ipAddress.resize(header.payloadSize);
+        return static_cast<bool>(file.read(&out.ipAddress[0], header.payloadSize));
+    }
+
+    out.packet.payload = pool.acquire(header.payloadSize);
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(out.packet.payload.data()), header.payloadSize));
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include "PacketView.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// PACKET CAPTURE
+// Binary recording of everything the game thread receives: connects,
+// disconnects and every inbound frame, each stamped with its receive time
+// and clientId. NetworkServer writes captures while serving and replays them
+// in place of its sockets. Packets the server sent are recorded too (before
+// compression, clientId 0 for broadcasts) as sample traffic for training
+// compression dictionaries; replay skips them.
+//
+// File layout (little-endian, packed):
+//   CaptureFileHeader
+//   CaptureRecordHeader + payload, repeated until EOF
+// A CONNECTED record's payload is the client's IP address as text.
+// ============================================================================
+
+#pragma pack(push, 1)
+struct CaptureFileHeader {
+    char magic[8];              // "TDSCAP\0\0"
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t startUnixMillis;   // Wall-clock start, for reference only
+};
+
+struct CaptureRecordHeader {
+    uint64_t timestampNanos;    // Since the start of the capture
+    uint64_t clientId;
+    uint64_t sessionToken;
+    uint32_t payloadSize;
+    uint16_t type;              // PacketType (PACKET records)
+    uint8_t kind;               // CaptureRecord::Kind
+    uint8_t reserved;
+};
+#pragma pack(pop)
+
+struct CaptureRecord {
+    enum class Kind : uint8_t {
+        PACKET,
+        CONNECTED,
+        DISCONNECTED,
+        SENT                    // Outbound packet
+    };
+
+    Kind kind = Kind::PACKET;
+    uint64_t timestampNanos = 0;
+    PacketView packet;          // clientId always set; payload for PACKET and SENT
+    std::string ipAddress;      // CONNECTED only
+};
+
+// Buffered capture writer; game thread only
+class PacketCaptureWriter {
+public:
+    // 2: payloads are schema-encoded (Serialization.h) rather than raw structs
+    // 3: SENT records
+    static constexpr uint32_t VERSION = 3;
+    static constexpr uint32_t OLDEST_READABLE_VERSION = 2;
+
+    PacketCaptureWriter() = default;
+    ~PacketCaptureWriter();
+
+    PacketCaptureWriter(const PacketCaptureWriter&) = delete;
+    PacketCaptureWriter& operator=(const PacketCaptureWriter&) = delete;
+
+    // startNanos is the steady-clock time that record timestamps count from
+    bool open(const std::string& path, uint64_t startNanos, std::string& errorMsg);
+    void close();
+    bool isOpen() const { return file.is_open(); }
+
+    void writeConnected(uint64_t timestampNanos, uint64_t clientId, const char* ipAddress);
+    void writeDisconnected(uint64_t timestampNanos, uint64_t clientId);
+    void writePacket(uint64_t timestampNanos, const PacketView& packet);
+    void writeSent(uint64_t timestampNanos, uint64_t clientId, PacketType type, uint64_t sessionToken,
+                   const void* payload, uint32_t payloadSize);
+
+    uint64_t getRecordCount() const { return recordCount; }
+    uint64_t getByteCount() const { return byteCount; }
+
+private:
+    // Records are gathered here and written in large chunks, or at least
+    // once a second so a killed server loses little of its capture
+    static constexpr size_t BUFFER_SIZE = 1024 * 1024;
+    static constexpr uint64_t FLUSH_INTERVAL_NANOS = 1000000000ull;
+
+    std::ofstream file;
+    std::vector<uint8_t> buffer;
+    uint64_t startNanos = 0;
+    uint64_t lastFlushNanos = 0;
+    uint64_t recordCount = 0;
+    uint64_t byteCount = 0;
+
+    void writeRecord(CaptureRecord::Kind kind, uint64_t timestampNanos, uint64_t clientId,
+                     PacketType type, uint64_t sessionToken, const void* payload, uint32_t payloadSize);
+    void flushBuffer();
+};
+
+// Sequential capture reader. Payloads land in slabs from the caller's pool,
+// so replayed packets look exactly like received ones.
+class PacketCaptureReader {
+public:
+    explicit PacketCaptureReader(PayloadPool& pool) : pool(pool) {}
+
+    bool open(const std::string& path, std::string& errorMsg);
+    void close() { file.close(); }
+
+    // Next record, or false at the end of the file (or a truncated record)
+    bool next(CaptureRecord& out);
+
+    // Timestamp of the record next() will return; false at the end
+    bool peekTimestamp(uint64_t& outNanos);
+
+private:
+    PayloadPool& pool;
+    std::ifstream file;
+    CaptureRecordHeader pendingHeader;
+    bool hasPendingHeader = false;
+
+    bool readHeader();
+};
@@ -0,0 +1,86 @@
+#include "PacketDispatcher.h"
+#include "../../common/Logger.h"
+#include <cstdio>
+#include <chrono>
+
+namespace {
+    LogCategory dispatcherLog("PacketDispatcher");
+}
+
+PacketDispatcher::PacketDispatcher(const PacketDispatchTable& table, SessionValidator validateSession, RejectHandler onReject)
+    : table(table), validateSession(validateSession), onReject(onReject), stats{} {
+}
+
+void PacketDispatcher::dispatch(const PacketView& packet) {
+    size_t slot = static_cast<size_t>(packet.type);
+    if (slot >= PACKET_TYPE_LIMIT) {
+        reject(packet, outOfRange, PacketReject::UNHANDLED);
+        return;
+    }
+
+    const PacketRoute& route = table[slot];
+    TypeStats& typeStats = stats[slot];
+
+    if (route.invoke == nullptr) {
+        reject(packet, typeStats, PacketReject::UNHANDLED);
+        return;
+    }
+
+    uint64_t accountId = 0;
+    if (route.auth == PacketAuth::SESSION && !validateSession(packet.sessionToken, accountId)) {
+        reject(packet, typeStats, PacketReject::INVALID_SESSION);
+        return;
+    }
+
+    PacketContext context{ packet, packet.clientId, accountId };
+
+    auto start = std::chrono::steady_clock::now();
+    if (!route.invoke(context)) {
+        reject(packet, typeStats, PacketReject::MALFORMED);
+        return;
+    }
+    uint64_t nanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+
+    typeStats.calls++;
+    typeStats.totalNanos += nanos;
+    if (nanos > typeStats.maxNanos) {
+        typeStats.maxNanos = nanos;
+    }
+}
+
+void PacketDispatcher::reject(const PacketView& packet, TypeStats& typeStats, PacketReject reason) {
+    typeStats.rejected++;
+    if (onReject) {
+        onReject(packet, reason);
+    }
+}
+
+const PacketDispatcher::TypeStats& PacketDispatcher::getStats(PacketType type) const {
+    size_t slot = static_cast<size_t>(type);
+    return slot < PACKET_TYPE_LIMIT ? stats[slot] : outOfRange;
+}
+
+void PacketDispatcher::logStats() const {
+    LOG_INFO(dispatcherLog, "Handler stats (calls / rejected / avg us / max us):");
+    for (size_t slot = 0; slot < PACKET_TYPE_LIMIT; slot++) {
+        const TypeStats& s = stats[slot];
+        if (s.calls == 0 && s.rejected == 0) continue;
+
+        double avgMicros = s.calls > 0 ? static_cast<double>(s.totalNanos) / s.calls / 1000.0 : 0.0;
+        char line[128];
+        snprintf(line, sizeof(line), "  %-28s %10llu %8llu %10.1f %10.1f",
+                 packetTypeToString(static_cast<PacketType>(slot)),
+                 static_cast<unsigned long long>(s.calls), static_cast<unsigned long long>(s.rejected),
+                 avgMicros, s.maxNanos / 1000.0);
+        LOG_INFO(dispatcherLog, "{}", line);
+    }
+    if (outOfRange.rejected > 0) {
+        LOG_INFO(dispatcherLog, "  (out-of-range types) rejected {}", outOfRange.rejected);
+    }
+}
+
+void PacketDispatcher::resetStats() {
+    stats.fill(TypeStats());
+    outOfRange = TypeStats();
+}
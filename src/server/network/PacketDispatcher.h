@@ -0,0 +1,130 @@
+#pragma once
+#include "../../common/NetworkProtocol.h"
+#include "PacketView.h"
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+// Session requirement of a route, checked before the handler runs
+enum class PacketAuth : uint8_t {
+    NONE,
+    SESSION
+};
+
+// Why a packet never reached a handler
+enum class PacketReject : uint8_t {
+    UNHANDLED,
+    MALFORMED,
+    INVALID_SESSION
+};
+
+// What a handler gets besides its decoded payload
+struct PacketContext {
+    const PacketView& packet;
+    uint64_t clientId;
+    uint64_t accountId;     // Set for PacketAuth::SESSION routes, else 0
+};
+
+// One entry of the dispatch table. `invoke` is a thunk that decodes the
+// payload into the route's struct and calls the typed handler; it returns
+// false if the payload does not decode.
+struct PacketRoute {
+    using Thunk = bool (*)(const PacketContext& context);
+
+    PacketType type = PacketType::INVALID_PACKET;
+    PacketAuth auth = PacketAuth::NONE;
+    Thunk invoke = nullptr;
+};
+
+namespace detail {
+    template <typename Payload, void (*Handler)(const PacketContext&, const Payload&)>
+    bool invokeTyped(const PacketContext& context) {
+        Payload payload{};
+        if (!decodePacket(context.packet.data(), context.packet.size(), payload)) {
+            return false;
+        }
+        Handler(context, payload);
+        return true;
+    }
+
+    template <void (*Handler)(const PacketContext&)>
+    bool invokeBare(const PacketContext& context) {
+        Handler(context);
+        return true;
+    }
+}
+
+// Route for a packet carrying a protocol struct:
+//   makeRoute<PacketType::LOGIN_REQUEST, PacketAuth::NONE, LoginRequest, &handleLoginRequest>()
+template <PacketType Type, PacketAuth Auth, typename Payload, void (*Handler)(const PacketContext&, const Payload&)>
+constexpr PacketRoute makeRoute() {
+    PacketRoute route;
+    route.type = Type;
+    route.auth = Auth;
+    route.invoke = &detail::invokeTyped<Payload, Handler>;
+    return route;
+}
+
+// Route for a packet without payload
+template <PacketType Type, PacketAuth Auth, void (*Handler)(const PacketContext&)>
+constexpr PacketRoute makeRoute() {
+    PacketRoute route;
+    route.type = Type;
+    route.auth = Auth;
+    route.invoke = &detail::invokeBare<Handler>;
+    return route;
+}
+
+// Every PacketType value is below this; the table has one slot per value
+constexpr size_t PACKET_TYPE_LIMIT = 1024;
+using PacketDispatchTable = std::array<PacketRoute, PACKET_TYPE_LIMIT>;
+
+// Build the dense table at compile time. A duplicate or out-of-range type
+// makes the constant expression ill-formed, so it fails the build.
+template <size_t N>
+constexpr PacketDispatchTable buildDispatchTable(const PacketRoute (&routes)[N]) {
+    PacketDispatchTable table{};
+    for (size_t i = 0; i < N; i++) {
+        size_t slot = static_cast<size_t>(routes[i].type);
+        if (slot >= PACKET_TYPE_LIMIT || table[slot].invoke != nullptr) {
+            throw "duplicate or out-of-range packet route";
+        }
+        table[slot] = routes[i];
+    }
+    return table;
+}
+
+// Runs each received packet through the dispatch table: one indexed load,
+// the declared session check, then the payload decode and the handler. Keeps call
+// counts and handler latency per packet type.
+class PacketDispatcher {
+public:
+    using SessionValidator = bool (*)(uint64_t sessionToken, uint64_t& outAccountId);
+    using RejectHandler = void (*)(const PacketView& packet, PacketReject reason);
+
+    struct TypeStats {
+        uint64_t calls = 0;
+        uint64_t rejected = 0;
+        uint64_t totalNanos = 0;
+        uint64_t maxNanos = 0;
+    };
+
+    PacketDispatcher(const PacketDispatchTable& table, SessionValidator validateSession, RejectHandler onReject);
+
+    void dispatch(const PacketView& packet);
+
+    const TypeStats& getStats(PacketType type) const;
+
+    // Print stats for every type seen since the last reset
+    void logStats() const;
+    void resetStats();
+
+private:
+    const PacketDispatchTable& table;
+    SessionValidator validateSession;
+    RejectHandler onReject;
+    std::array<TypeStats, PACKET_TYPE_LIMIT> stats;
+    TypeStats outOfRange;   // Types past PACKET_TYPE_LIMIT
+
+    void reject(const PacketView& packet, TypeStats& typeStats, PacketReject reason);
+};
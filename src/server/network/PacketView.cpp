@@ -0,0 +1,71 @@
+#include "PacketView.h"
+#include <new>
+
+constexpr uint32_t PayloadPool::SIZE_CLASSES[PayloadPool::SIZE_CLASS_COUNT];
+
+PayloadPool::~PayloadPool() {
+    reclaimReturned();
+    for (auto& freeList : freeLists) {
+        for (PayloadSlab* slab : freeList) {
+            slab->~PayloadSlab();
+            ::operator delete(slab);
+        }
+        freeList.clear();
+    }
+}
+
+PayloadRef PayloadPool::acquire(uint32_t size) {
+    uint32_t sizeClass = 0;
+    while (sizeClass + 1 < SIZE_CLASS_COUNT && SIZE_CLASSES[sizeClass] < size) {
+        sizeClass++;
+    }
+
+    PayloadSlab* slab;
+    auto& freeList = freeLists[sizeClass];
+    if (freeList.empty()) {
+        reclaimReturned();
+    }
+    if (!freeList.empty()) {
+        slab = freeList.back();
+        freeList.pop_back();
+    } else {
+        void* memory = ::operator new(sizeof(PayloadSlab) + SIZE_CLASSES[sizeClass]);
+        slab = new (memory) PayloadSlab();
+        slab->pool = this;
+        slab->sizeClass = sizeClass;
+    }
+
+    slab->next = nullptr;
+    slab->refCount.store(1, std::memory_order_relaxed);
+    slab->size = size;
+    liveCount.fetch_add(1, std::memory_order_relaxed);
+    return PayloadRef(slab);
+}
+
+void PayloadPool::release(PayloadSlab* slab) {
+    liveCount.fetch_sub(1, std::memory_order_relaxed);
+
+    // Push-only Treiber stack; the owner takes the whole stack at once,
+    // so there is no ABA on pop
+    PayloadSlab* head = returned.load(std::memory_order_relaxed);
+    do {
+        slab->next = head;
+    } while (!returned.compare_exchange_weak(head, slab, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void PayloadPool::reclaimReturned() {
+    PayloadSlab* slab = returned.exchange(nullptr, std::memory_order_acquire);
+    while (slab) {
+        PayloadSlab* next = slab->next;
+        freeLists[slab->sizeClass].push_back(slab);
+        slab = next;
+    }
+}
+
+size_t PayloadPool::getFreeCount() const {
+    size_t count = 0;
+    for (const auto& freeList : freeLists) {
+        count += freeList.size();
+    }
+    return count;
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include "../../common/NetworkProtocol.h"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <atomic>
+
+class PayloadPool;
+
+// Refcounted payload storage handed out by PayloadPool. The bytes follow the
+// header directly and start 16-byte aligned.
+struct alignas(16) PayloadSlab {
+    PayloadPool* pool;
+    PayloadSlab* next;      // Link in the pool's return stack
+    std::atomic<uint32_t> refCount;
+    uint32_t sizeClass;     // Index into PayloadPool::SIZE_CLASSES
+    uint32_t size;          // Bytes in use
+
+    uint8_t* data() { return reinterpret_cast<uint8_t*>(this + 1); }
+    const uint8_t* data() const { return reinterpret_cast<const uint8_t*>(this + 1); }
+};
+
+// Intrusive handle to a PayloadSlab; the slab returns to its pool when the
+// last handle goes away. Handles may be copied and dropped on any thread.
+class PayloadRef {
+public:
+    PayloadRef() : slab(nullptr) {}
+    explicit PayloadRef(PayloadSlab* s) : slab(s) {}
+    PayloadRef(const PayloadRef& other) : slab(other.slab) { retain(); }
+    PayloadRef(PayloadRef&& other) noexcept : slab(other.slab) { other.slab = nullptr; }
+    ~PayloadRef() { reset(); }
+
+    PayloadRef& operator=(const PayloadRef& other) {
+        if (this != &other) {
+            reset();
+            slab = other.slab;
+            retain();
+        }
+        return *this;
+    }
+
+    PayloadRef& operator=(PayloadRef&& other) noexcept {
+        if (this != &other) {
+            reset();
+            slab = other.slab;
+            other.slab = nullptr;
+        }
+        return *this;
+    }
+
+    void reset();
+
+    uint8_t* data() { return slab ? slab->data() : nullptr; }
+    const uint8_t* data() const { return slab ? slab->data() : nullptr; }
+    uint32_t size() const { return slab ? slab->size : 0; }
+
+private:
+    PayloadSlab* slab;
+
+    void retain() {
+        if (slab) slab->refCount.fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+// Free-list pool of payload slabs in a few size classes. After warm-up a
+// packet costs no heap allocation. acquire() belongs to the owning thread;
+// release() may come from any thread and lands on a lock-free return stack
+// that the owner reclaims when its free list runs dry. Slabs must not
+// outlive the pool.
+class PayloadPool {
+public:
+    static constexpr size_t SIZE_CLASS_COUNT = 5;
+    static constexpr uint32_t SIZE_CLASSES[SIZE_CLASS_COUNT] = { 64, 256, 1024, 4096, MAX_PACKET_SIZE };
+
+    PayloadPool() = default;
+    ~PayloadPool();
+
+    PayloadPool(const PayloadPool&) = delete;
+    PayloadPool& operator=(const PayloadPool&) = delete;
+
+    // Get a slab with room for `size` bytes (size <= MAX_PACKET_SIZE)
+    PayloadRef acquire(uint32_t size);
+
+    // Called by PayloadRef when the last reference drops (any thread)
+    void release(PayloadSlab* slab);
+
+    // Slabs currently handed out / sitting in the owner's free lists
+    size_t getLiveCount() const { return liveCount.load(std::memory_order_relaxed); }
+    size_t getFreeCount() const;
+
+private:
+    std::vector<PayloadSlab*> freeLists[SIZE_CLASS_COUNT];
+    std::atomic<PayloadSlab*> returned{ nullptr };
+    std::atomic<size_t> liveCount{ 0 };
+
+    void reclaimReturned();
+};
+
+inline void PayloadRef::reset() {
+    if (slab && slab->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        slab->pool->release(slab);
+    }
+    slab = nullptr;
+}
+
+// A received packet as handed to the game thread: header fields plus a
+// reference to its encoded payload bytes, which the dispatcher decodes
+// before calling a handler.
+struct PacketView {
+    PacketType type;
+    uint64_t clientId;
+    uint64_t sessionToken;
+    PayloadRef payload;
+
+    PacketView() : type(PacketType::INVALID_PACKET), clientId(0), sessionToken(0) {}
+
+    const uint8_t* data() const { return payload.data(); }
+    uint32_t size() const { return payload.size(); }
+};
@@ -0,0 +1,355 @@
+// ============================================================================
+// ALLOCATION CHECK
+// Counts heap allocations on the server's receive path. A loopback client
+// streams PLAYER_MOVE frames into a real NetworkServer; the game side takes
+// them with getReceivedPackets() into one reused vector and runs each through
+// a PacketDispatcher route that decodes the move, as server/main.cpp does.
+//
+// Global operator new is replaced by a counting one (all threads, reactors
+// included). A warm-up round fills the payload pool, the queues and the
+// logger's per-thread buffers and lasts past the first heartbeat; after it
+// the measured frames must not allocate at all. Exits non-zero if they do,
+// or if a frame is lost or rejected.
+//
+// Linux only. Build from the repository root:
+//   g++ -std=c++17 -O2 -pthread src/tools/alloccheck/main.cpp src/server/network/*.cpp
+//       src/common/Logger.cpp src/common/Compression.cpp -o alloccheck
+//
+// Example: 10,000 frames through one I/O thread
+//   ./alloccheck --frames 10000 --io-threads 1
+// ============================================================================
+
+#include "../../common/Logger.h"
+#include "../../common/NetworkProtocol.h"
+#include "../../server/network/NetworkServer.h"
+#include "../../server/network/PacketDispatcher.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <vector>
+
+namespace {
+    std::atomic<uint64_t> allocationCount{ 0 };
+    std::atomic<uint64_t> allocatedBytes{ 0 };
+
+    void* countedAlloc(size_t size) {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+        return malloc(size ? size : 1);
+    }
+
+    void* countedAlignedAlloc(size_t size, size_t alignment) {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+        // aligned_alloc wants a multiple of the alignment
+        return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    }
+}
+
+void* operator new(size_t size) {
+    if (void* p = countedAlloc(size)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    if (void* p = countedAlloc(size)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    if (void* p = countedAlignedAlloc(size, static_cast<size_t>(alignment))) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    if (void* p = countedAlignedAlloc(size, static_cast<size_t>(alignment))) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { free(p); }
+
+namespace {
+    struct CheckConfig {
+        int port = 7790;
+        int ioThreads = 1;
+        int frames = 10000;             // Measured
+        int warmupFrames = 10000;
+        int warmupMillis = 1500;        // Covers the first heartbeat round
+        int batch = 100;                // Frames sent before the game side drains them
+        uint32_t seed = 1;
+    };
+
+    struct HandlerCounts {
+        uint64_t moves = 0;
+        uint64_t rejected = 0;
+        float checksum = 0.0f;          // Keeps the decode from being optimized out
+    };
+
+    HandlerCounts counts;
+
+    void handleMove(const PacketContext& /*ctx*/, const PlayerMove& move) {
+        counts.moves++;
+        counts.checksum += move.x + move.z;
+    }
+
+    bool validateNoSession(uint64_t /*sessionToken*/, uint64_t& outAccountId) {
+        outAccountId = 0;
+        return false;
+    }
+
+    void countReject(const PacketView& /*packet*/, PacketReject /*reason*/) {
+        counts.rejected++;
+    }
+
+    constexpr PacketRoute CHECK_ROUTES[] = {
+        makeRoute<PacketType::PLAYER_MOVE, PacketAuth::NONE, PlayerMove, &handleMove>()
+    };
+
+    constexpr PacketDispatchTable CHECK_DISPATCH_TABLE = buildDispatchTable(CHECK_ROUTES);
+
+    uint64_t nowNanos() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    void printUsage(const char* program) {
+        printf("Usage: %s [options]\n"
+               "  --frames <n>          measured PLAYER_MOVE frames (10000)\n"
+               "  --warmup <n>          minimum warm-up frames (10000)\n"
+               "  --warmup-ms <ms>      minimum warm-up time (1500)\n"
+               "  --batch <n>           frames sent per drain (100)\n"
+               "  --io-threads <n>      server I/O threads, 0 = game thread (1)\n"
+               "  --port <port>         loopback port (7790)\n"
+               "  --seed <n>            move values seed (1)\n",
+               program);
+    }
+
+    bool parseArgs(int argc, char* argv[], CheckConfig& config) {
+        for (int i = 1; i < argc; i++) {
+            const char* arg = argv[i];
+            const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+            if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) return false;
+            if (!value) {
+                fprintf(stderr, "Missing value for %s\n", arg);
+                return false;
+            }
+            i++;
+
+            if (strcmp(arg, "--frames") == 0) config.frames = atoi(value);
+            else if (strcmp(arg, "--warmup") == 0) config.warmupFrames = atoi(value);
+            else if (strcmp(arg, "--warmup-ms") == 0) config.warmupMillis = atoi(value);
+            else if (strcmp(arg, "--batch") == 0) config.batch = atoi(value);
+            else if (strcmp(arg, "--io-threads") == 0) config.ioThreads = atoi(value);
+            else if (strcmp(arg, "--port") == 0) config.port = atoi(value);
+            else if (strcmp(arg, "--seed") == 0) config.seed = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+            else {
+                fprintf(stderr, "Unknown option %s\n", arg);
+                return false;
+            }
+        }
+
+        if (config.frames < 1 || config.warmupFrames < 0 || config.warmupMillis < 0 ||
+            config.batch < 1 || config.ioThreads < 0 || config.port < 1 || config.port > 65535) {
+            fprintf(stderr, "Invalid option value\n");
+            return false;
+        }
+        return true;
+    }
+
+    // One batch of encoded frames, sent as a single write so the server
+    // parses them back to back out of its receive ring
+    std::vector<uint8_t> encodeBatch(int frames, uint32_t seed) {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> horizontal(-MAP_EXTENT, MAP_EXTENT);
+        std::uniform_real_distribution<float> height(MAP_MIN_HEIGHT, MAP_MAX_HEIGHT);
+        std::uniform_real_distribution<float> yaw(0.0f, 360.0f);
+        std::uniform_real_distribution<float> pitch(-90.0f, 90.0f);
+
+        std::vector<uint8_t> bytes;
+        uint8_t payload[32];
+        for (int i = 0; i < frames; i++) {
+            PlayerMove move;
+            move.x = horizontal(rng);
+            move.y = height(rng);
+            move.z = horizontal(rng);
+            move.yaw = yaw(rng);
+            move.pitch = pitch(rng);
+            move.movementFlags = static_cast<uint8_t>(rng() & 7);
+            size_t size = encodePacket(move, payload, sizeof(payload));
+
+            PacketHeader header;
+            header.type = static_cast<uint16_t>(PacketType::PLAYER_MOVE);
+            header.payloadSize = static_cast<uint32_t>(size);
+            header.sessionToken = 0;
+            header.sequence = static_cast<uint32_t>(i);
+            const uint8_t* headerBytes = reinterpret_cast<const uint8_t*>(&header);
+            bytes.insert(bytes.end(), headerBytes, headerBytes + sizeof(header));
+            bytes.insert(bytes.end(), payload, payload + size);
+        }
+        return bytes;
+    }
+
+    int connectLoopback(int port) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) return -1;
+
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(port));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            close(fd);
+            return -1;
+        }
+
+        int noDelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        return fd;
+    }
+
+    bool sendAll(int fd, const uint8_t* data, size_t size) {
+        while (size > 0) {
+            ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+            if (sent <= 0) return false;
+            data += sent;
+            size -= static_cast<size_t>(sent);
+        }
+        return true;
+    }
+
+    class ReceivePath {
+    public:
+        ReceivePath(NetworkServer& server, int fd, const std::vector<uint8_t>& batchBytes, int batchFrames)
+            : server(server), fd(fd), batchBytes(batchBytes), batchFrames(batchFrames),
+              dispatcher(CHECK_DISPATCH_TABLE, &validateNoSession, &countReject) {}
+
+        // Send and drain one batch; false if it did not all arrive in time
+        bool runBatch() {
+            if (!sendAll(fd, batchBytes.data(), batchBytes.size())) return false;
+
+            uint64_t target = counts.moves + counts.rejected + static_cast<uint64_t>(batchFrames);
+            uint64_t deadline = nowNanos() + 5000000000ull;
+            while (counts.moves + counts.rejected < target) {
+                if (nowNanos() > deadline) return false;
+                server.waitForActivity(10);
+                server.update();
+                server.getReceivedPackets(packets);
+                for (const PacketView& packet : packets) {
+                    dispatcher.dispatch(packet);
+                }
+                server.flushOutbound();
+            }
+            return true;
+        }
+
+    private:
+        NetworkServer& server;
+        int fd;
+        const std::vector<uint8_t>& batchBytes;
+        int batchFrames;
+        PacketDispatcher dispatcher;
+        std::vector<PacketView> packets;    // Reused, as processPackets() does
+    };
+}
+
+int main(int argc, char* argv[]) {
+    CheckConfig config;
+    if (!parseArgs(argc, argv, config)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // Connection notices would only interleave with the report
+    Logger::setLevel(LogLevel::WARN);
+
+    NetworkServer server;
+    if (!server.start(config.port, config.ioThreads)) {
+        fprintf(stderr, "Could not start the server on port %d\n", config.port);
+        return 1;
+    }
+
+    int fd = connectLoopback(config.port);
+    if (fd < 0) {
+        fprintf(stderr, "Could not connect to port %d\n", config.port);
+        return 1;
+    }
+    uint64_t connectDeadline = nowNanos() + 5000000000ull;
+    while (server.getClientCount() == 0) {
+        if (nowNanos() > connectDeadline) {
+            fprintf(stderr, "Server never accepted the connection\n");
+            return 1;
+        }
+        server.waitForActivity(10);
+        server.update();
+    }
+
+    printf("Allocation check: %d PLAYER_MOVE frames in batches of %d, %d I/O thread(s)\n",
+           config.frames, config.batch, config.ioThreads);
+
+    std::vector<uint8_t> batchBytes = encodeBatch(config.batch, config.seed);
+    ReceivePath path(server, fd, batchBytes, config.batch);
+
+    uint64_t warmupStart = nowNanos();
+    uint64_t warmupEnd = warmupStart + static_cast<uint64_t>(config.warmupMillis) * 1000000ull;
+    int warmed = 0;
+    while (warmed < config.warmupFrames || nowNanos() < warmupEnd) {
+        if (!path.runBatch()) {
+            fprintf(stderr, "Warm-up frames did not arrive\n");
+            return 1;
+        }
+        warmed += config.batch;
+    }
+    printf("Warm-up: %d frames in %.0f ms, %llu allocations\n", warmed, (nowNanos() - warmupStart) / 1e6,
+           static_cast<unsigned long long>(allocationCount.load()));
+
+    uint64_t movesBefore = counts.moves;
+    uint64_t rejectedBefore = counts.rejected;
+    uint64_t allocationsBefore = allocationCount.load();
+    uint64_t bytesBefore = allocatedBytes.load();
+    uint64_t start = nowNanos();
+
+    int batches = (config.frames + config.batch - 1) / config.batch;
+    for (int i = 0; i < batches; i++) {
+        if (!path.runBatch()) {
+            fprintf(stderr, "Measured frames did not arrive\n");
+            return 1;
+        }
+    }
+
+    double millis = (nowNanos() - start) / 1e6;
+    uint64_t allocations = allocationCount.load() - allocationsBefore;
+    uint64_t bytes = allocatedBytes.load() - bytesBefore;
+    uint64_t moves = counts.moves - movesBefore;
+    uint64_t rejected = counts.rejected - rejectedBefore;
+
+    server.shutdown();
+    close(fd);
+
+    printf("Measured: %llu frames handled, %llu rejected in %.1f ms (checksum %.1f)\n",
+           static_cast<unsigned long long>(moves), static_cast<unsigned long long>(rejected), millis, counts.checksum);
+    printf("Heap: %llu allocations, %llu bytes\n",
+           static_cast<unsigned long long>(allocations), static_cast<unsigned long long>(bytes));
+
+    bool ok = allocations == 0 && rejected == 0 && moves == static_cast<uint64_t>(batches) * config.batch;
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,272 @@
+// ============================================================================
+// BIT STREAM CHECK
+// Round-trips random PLAYER_MOVE and PLAYER_SHOOT messages through
+// encodePacket/decodePacket and checks the bit-packed encoding against the
+// bounds its schemas promise:
+//   PlayerMove    9 bytes; x/y/z within 0.005 m, yaw within 0.088 deg
+//                 (11 bits per turn), pitch within 0.18 deg, flags exact
+//   PlayerShoot   12 bytes for weapon ids below 128; origin within 0.005 m,
+//                 direction within 0.0005, weapon id exact
+// Out-of-range values must clamp to the edge of their range (angles wrap),
+// and every truncated prefix of a payload must fail to decode. Exits
+// non-zero if any check fails.
+//
+// Build from the repository root:
+//   g++ -std=c++17 -O2 src/tools/bitstreamcheck/main.cpp -o bitstreamcheck
+//
+// Example: one million messages of each type
+//   ./bitstreamcheck --count 1000000
+// ============================================================================
+
+#include "../../common/NetworkProtocol.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+namespace {
+    struct CheckConfig {
+        int count = 1000000;        // Random messages per type
+        uint32_t seed = 1;
+    };
+
+    // Decoding computes min + steps * precision in float, which can land a
+    // rounding step past precision / 2 at the far end of the range
+    constexpr float FLOAT_SLACK = 1e-4f;
+
+    constexpr float POSITION_BOUND = POSITION_PRECISION / 2.0f + FLOAT_SLACK;
+    constexpr float YAW_BOUND = 360.0f / 2048.0f / 2.0f + FLOAT_SLACK;
+    constexpr float PITCH_BOUND = 0.36f / 2.0f + FLOAT_SLACK;
+    constexpr float DIRECTION_BOUND = 0.001f / 2.0f + FLOAT_SLACK;
+
+    constexpr size_t PLAYER_MOVE_SIZE = 9;
+    constexpr size_t PLAYER_SHOOT_SIZE = 12;
+
+    int failures = 0;
+
+    void fail(const char* what) {
+        if (failures < 20) fprintf(stderr, "FAIL: %s\n", what);
+        failures++;
+    }
+
+    // Shortest distance between two angles in degrees
+    float angleError(float a, float b) {
+        float difference = std::fmod(std::fabs(a - b), 360.0f);
+        return difference > 180.0f ? 360.0f - difference : difference;
+    }
+
+    struct ErrorStats {
+        float max = 0.0f;
+
+        void add(float error) {
+            if (error > max) max = error;
+        }
+    };
+
+    void printUsage(const char* program) {
+        printf("Usage: %s [options]\n"
+               "  --count <n>           random messages per type (1000000)\n"
+               "  --seed <n>            random seed (1)\n",
+               program);
+    }
+
+    bool parseArgs(int argc, char* argv[], CheckConfig& config) {
+        for (int i = 1; i < argc; i++) {
+            const char* arg = argv[i];
+            const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+            if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) return false;
+            if (!value) {
+                fprintf(stderr, "Missing value for %s\n", arg);
+                return false;
+            }
+            i++;
+
+            if (strcmp(arg, "--count") == 0) config.count = atoi(value);
+            else if (strcmp(arg, "--seed") == 0) config.seed = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+            else {
+                fprintf(stderr, "Unknown option %s\n", arg);
+                return false;
+            }
+        }
+
+        if (config.count < 1) {
+            fprintf(stderr, "Invalid option value\n");
+            return false;
+        }
+        return true;
+    }
+
+    // Every prefix shorter than the payload has to be rejected
+    template <typename T>
+    bool rejectsTruncated(const uint8_t* payload, size_t size) {
+        for (size_t length = 0; length < size; length++) {
+            T decoded{};
+            if (decodePacket(payload, length, decoded)) return false;
+        }
+        return true;
+    }
+
+    template <typename T>
+    bool roundTrip(const T& message, T& decoded, size_t expectedSize) {
+        uint8_t payload[64];
+        size_t size = encodePacket(message, payload, sizeof(payload));
+        if (size != expectedSize) {
+            fail("encoded size");
+            return false;
+        }
+        if (!decodePacket(payload, size, decoded)) {
+            fail("decode");
+            return false;
+        }
+        return true;
+    }
+
+    void checkMoves(const CheckConfig& config, std::mt19937& rng) {
+        std::uniform_real_distribution<float> horizontal(-MAP_EXTENT, MAP_EXTENT);
+        std::uniform_real_distribution<float> height(MAP_MIN_HEIGHT, MAP_MAX_HEIGHT);
+        std::uniform_real_distribution<float> yaw(0.0f, 360.0f);
+        std::uniform_real_distribution<float> pitch(-90.0f, 90.0f);
+
+        ErrorStats position, yawError, pitchError;
+        for (int i = 0; i < config.count; i++) {
+            PlayerMove move;
+            move.x = horizontal(rng);
+            move.y = height(rng);
+            move.z = horizontal(rng);
+            move.yaw = yaw(rng);
+            move.pitch = pitch(rng);
+            move.movementFlags = static_cast<uint8_t>(rng() & 7);
+
+            PlayerMove decoded;
+            if (!roundTrip(move, decoded, PLAYER_MOVE_SIZE)) continue;
+            position.add(std::fabs(decoded.x - move.x));
+            position.add(std::fabs(decoded.y - move.y));
+            position.add(std::fabs(decoded.z - move.z));
+            yawError.add(angleError(decoded.yaw, move.yaw));
+            pitchError.add(std::fabs(decoded.pitch - move.pitch));
+            if (decoded.movementFlags != move.movementFlags) fail("PlayerMove flags");
+        }
+
+        printf("PlayerMove:  %d round trips, %zu bytes, max error x/y/z %.4f m, yaw %.4f deg, pitch %.4f deg\n",
+               config.count, PLAYER_MOVE_SIZE, position.max, yawError.max, pitchError.max);
+        if (position.max > POSITION_BOUND) fail("PlayerMove position error");
+        if (yawError.max > YAW_BOUND) fail("PlayerMove yaw error");
+        if (pitchError.max > PITCH_BOUND) fail("PlayerMove pitch error");
+
+        // Out of range: positions and pitch clamp, yaw wraps
+        PlayerMove wild;
+        wild.x = 1.0e6f;
+        wild.y = -500.0f;
+        wild.z = -250.0f;
+        wild.yaw = -90.0f;
+        wild.pitch = 135.0f;
+        wild.movementFlags = 7;
+        PlayerMove decoded;
+        if (roundTrip(wild, decoded, PLAYER_MOVE_SIZE)) {
+            if (std::fabs(decoded.x - MAP_EXTENT) > POSITION_BOUND) fail("PlayerMove x clamp");
+            if (std::fabs(decoded.y - MAP_MIN_HEIGHT) > POSITION_BOUND) fail("PlayerMove y clamp");
+            if (std::fabs(decoded.z + MAP_EXTENT) > POSITION_BOUND) fail("PlayerMove z clamp");
+            if (angleError(decoded.yaw, 270.0f) > YAW_BOUND) fail("PlayerMove yaw wrap");
+            if (std::fabs(decoded.pitch - 90.0f) > PITCH_BOUND) fail("PlayerMove pitch clamp");
+        }
+        wild.y = 1000.0f;
+        wild.pitch = -400.0f;
+        if (roundTrip(wild, decoded, PLAYER_MOVE_SIZE)) {
+            if (std::fabs(decoded.y - MAP_MAX_HEIGHT) > POSITION_BOUND) fail("PlayerMove y clamp");
+            if (std::fabs(decoded.pitch + 90.0f) > PITCH_BOUND) fail("PlayerMove pitch clamp");
+        }
+
+        uint8_t payload[64];
+        size_t size = encodePacket(wild, payload, sizeof(payload));
+        if (!rejectsTruncated<PlayerMove>(payload, size)) fail("PlayerMove truncated payload decoded");
+    }
+
+    void checkShots(const CheckConfig& config, std::mt19937& rng) {
+        std::uniform_real_distribution<float> horizontal(-MAP_EXTENT, MAP_EXTENT);
+        std::uniform_real_distribution<float> height(MAP_MIN_HEIGHT, MAP_MAX_HEIGHT);
+        std::normal_distribution<float> axis(0.0f, 1.0f);
+
+        ErrorStats origin, direction;
+        for (int i = 0; i < config.count; i++) {
+            PlayerShoot shot;
+            shot.originX = horizontal(rng);
+            shot.originY = height(rng);
+            shot.originZ = horizontal(rng);
+            float dx = axis(rng), dy = axis(rng), dz = axis(rng);
+            float length = std::sqrt(dx * dx + dy * dy + dz * dz);
+            if (length < 1e-6f) {
+                dx = 1.0f;
+                length = 1.0f;
+            }
+            shot.dirX = dx / length;
+            shot.dirY = dy / length;
+            shot.dirZ = dz / length;
+            shot.weaponId = rng() % 128;
+
+            PlayerShoot decoded;
+            if (!roundTrip(shot, decoded, PLAYER_SHOOT_SIZE)) continue;
+            origin.add(std::fabs(decoded.originX - shot.originX));
+            origin.add(std::fabs(decoded.originY - shot.originY));
+            origin.add(std::fabs(decoded.originZ - shot.originZ));
+            direction.add(std::fabs(decoded.dirX - shot.dirX));
+            direction.add(std::fabs(decoded.dirY - shot.dirY));
+            direction.add(std::fabs(decoded.dirZ - shot.dirZ));
+            if (decoded.weaponId != shot.weaponId) fail("PlayerShoot weapon id");
+        }
+
+        printf("PlayerShoot: %d round trips, %zu bytes, max error origin %.4f m, direction %.5f\n",
+               config.count, PLAYER_SHOOT_SIZE, origin.max, direction.max);
+        if (origin.max > POSITION_BOUND) fail("PlayerShoot origin error");
+        if (direction.max > DIRECTION_BOUND) fail("PlayerShoot direction error");
+
+        // Out of range clamps; large weapon ids still round-trip, just longer
+        PlayerShoot wild;
+        wild.originX = -1.0e6f;
+        wild.originY = 500.0f;
+        wild.originZ = 300.0f;
+        wild.dirX = 2.0f;
+        wild.dirY = -2.0f;
+        wild.dirZ = 0.0f;
+        wild.weaponId = 127;
+        PlayerShoot decoded;
+        if (roundTrip(wild, decoded, PLAYER_SHOOT_SIZE)) {
+            if (std::fabs(decoded.originX + MAP_EXTENT) > POSITION_BOUND) fail("PlayerShoot x clamp");
+            if (std::fabs(decoded.originY - MAP_MAX_HEIGHT) > POSITION_BOUND) fail("PlayerShoot y clamp");
+            if (std::fabs(decoded.originZ - MAP_EXTENT) > POSITION_BOUND) fail("PlayerShoot z clamp");
+            if (std::fabs(decoded.dirX - 1.0f) > DIRECTION_BOUND) fail("PlayerShoot direction clamp");
+            if (std::fabs(decoded.dirY + 1.0f) > DIRECTION_BOUND) fail("PlayerShoot direction clamp");
+        }
+
+        uint8_t payload[64];
+        size_t size = encodePacket(wild, payload, sizeof(payload));
+        if (!rejectsTruncated<PlayerShoot>(payload, size)) fail("PlayerShoot truncated payload decoded");
+
+        wild.weaponId = 0xFFFFFFFFu;
+        size = encodePacket(wild, payload, sizeof(payload));
+        if (size == 0 || !decodePacket(payload, size, decoded) || decoded.weaponId != wild.weaponId) {
+            fail("PlayerShoot large weapon id");
+        } else if (!rejectsTruncated<PlayerShoot>(payload, size)) {
+            fail("PlayerShoot truncated payload decoded");
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    CheckConfig config;
+    if (!parseArgs(argc, argv, config)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::mt19937 rng(config.seed);
+    checkMoves(config, rng);
+    checkShots(config, rng);
+
+    if (failures > 0) {
+        printf("FAIL (%d checks)\n", failures);
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
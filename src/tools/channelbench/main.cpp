@@ -0,0 +1,528 @@
+// ============================================================================
+// CHANNEL BENCHMARK
+// Position-update latency over the TCP control connection versus the UDP
+// gameplay channel when the link drops packets. A sender streams PLAYER_MOVE
+// at a fixed rate through an in-process relay that adds one-way delay and
+// loss, and a receiver measures how long each update takes to be superseded
+// on its side: the time until it, or a newer one, arrives.
+//
+// Loopback never loses TCP segments, so the relay plays the lossy link for
+// TCP too: a "lost" packet is delivered once the sender would have
+// retransmitted it (fast retransmit after three later packets plus a round
+// trip, or the RTO, whichever is first), and everything behind it in the
+// stream waits, as TCP's in-order delivery requires. UDP losses are simply
+// dropped and the next datagram supersedes them.
+//
+// Linux only. Build from the repository root:
+//   g++ -std=c++17 -O2 -pthread src/tools/channelbench/main.cpp -o channelbench
+//
+// Example: 60 Hz moves for 30 s over 2% loss and a 10 ms one-way delay
+//   ./channelbench --rate 60 --duration 30 --loss 2 --delay 10
+// ============================================================================
+
+#include "../../common/NetworkProtocol.h"
+#include "../../common/LatencyHistogram.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+    struct BenchConfig {
+        int rate = 60;              // PLAYER_MOVE per second
+        int durationSeconds = 30;
+        double lossPercent = 2.0;
+        int delayMillis = 10;       // One way; the round trip is twice this
+        int rtoMillis = 200;        // Linux TCP_RTO_MIN
+        uint32_t seed = 1;
+    };
+
+    enum class Channel : uint8_t {
+        TCP,
+        UDP
+    };
+
+    const char* channelToString(Channel channel) {
+        return channel == Channel::TCP ? "tcp" : "udp";
+    }
+
+    uint64_t nowNanos() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    void printUsage(const char* program) {
+        printf("Usage: %s [options]\n"
+               "  --rate <hz>           PLAYER_MOVE rate (60)\n"
+               "  --duration <s>        run time per channel in seconds (30)\n"
+               "  --loss <percent>      packet loss on the relay (2)\n"
+               "  --delay <ms>          one-way delay on the relay (10)\n"
+               "  --rto <ms>            TCP retransmission timeout floor (200)\n"
+               "  --seed <n>            loss pattern seed, same for both channels (1)\n",
+               program);
+    }
+
+    bool parseArgs(int argc, char* argv[], BenchConfig& config) {
+        for (int i = 1; i < argc; i++) {
+            const char* arg = argv[i];
+            const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+            if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) return false;
+            if (!value) {
+                fprintf(stderr, "Missing value for %s\n", arg);
+                return false;
+            }
+            i++;
+
+            if (strcmp(arg, "--rate") == 0) config.rate = atoi(value);
+            else if (strcmp(arg, "--duration") == 0) config.durationSeconds = atoi(value);
+            else if (strcmp(arg, "--loss") == 0) config.lossPercent = atof(value);
+            else if (strcmp(arg, "--delay") == 0) config.delayMillis = atoi(value);
+            else if (strcmp(arg, "--rto") == 0) config.rtoMillis = atoi(value);
+            else if (strcmp(arg, "--seed") == 0) config.seed = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+            else {
+                fprintf(stderr, "Unknown option %s\n", arg);
+                return false;
+            }
+        }
+
+        if (config.rate < 1 || config.durationSeconds < 1 || config.lossPercent < 0.0 ||
+            config.lossPercent >= 100.0 || config.delayMillis < 0 || config.rtoMillis < 1) {
+            fprintf(stderr, "Invalid option value\n");
+            return false;
+        }
+        return true;
+    }
+
+    sockaddr_in loopbackAddress(uint16_t port) {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port);
+        return address;
+    }
+
+    uint16_t localPort(int fd) {
+        sockaddr_in address{};
+        socklen_t length = sizeof(address);
+        getsockname(fd, (sockaddr*)&address, &length);
+        return ntohs(address.sin_port);
+    }
+
+    // Socket bound to an ephemeral loopback port
+    int bindLoopback(int type) {
+        int fd = socket(AF_INET, type, 0);
+        if (fd < 0) return -1;
+        sockaddr_in address = loopbackAddress(0);
+        if (bind(fd, (sockaddr*)&address, sizeof(address)) != 0) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    bool sendAll(int fd, const uint8_t* data, size_t size) {
+        while (size > 0) {
+            ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+            if (sent <= 0) return false;
+            data += sent;
+            size -= static_cast<size_t>(sent);
+        }
+        return true;
+    }
+
+    bool recvAll(int fd, uint8_t* data, size_t size) {
+        while (size > 0) {
+            ssize_t received = recv(fd, data, size, 0);
+            if (received <= 0) return false;
+            data += received;
+            size -= static_cast<size_t>(received);
+        }
+        return true;
+    }
+
+    void setNoDelay(int fd) {
+        int flag = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+    }
+
+    // ------------------------------------------------------------------------
+    // One run: sender -> relay -> receiver over one channel
+    // ------------------------------------------------------------------------
+
+    struct RunResult {
+        LatencyHistogram delivered;     // Send to arrival, for updates that arrived (us)
+        LatencyHistogram superseded;    // Send to arrival of it or a newer one (us)
+        uint64_t sent = 0;
+        uint64_t arrived = 0;
+        uint64_t dropped = 0;           // Relay losses (retransmitted for TCP)
+    };
+
+    class ChannelRun {
+    public:
+        ChannelRun(const BenchConfig& config, Channel channel)
+            : config(config), channel(channel),
+              updateCount(static_cast<uint32_t>(config.rate) * static_cast<uint32_t>(config.durationSeconds)),
+              sendTimes(new std::atomic<uint64_t>[updateCount]) {
+            for (uint32_t i = 0; i < updateCount; i++) {
+                sendTimes[i].store(0, std::memory_order_relaxed);
+            }
+        }
+
+        bool run(RunResult& result) {
+            if (!openSockets()) {
+                closeSockets();
+                return false;
+            }
+
+            std::thread relay([this] { channel == Channel::TCP ? relayStream() : relayDatagrams(); });
+            std::thread receiver([this, &result] { receive(result); });
+            sendUpdates(result);
+
+            relay.join();
+            receiver.join();
+            closeSockets();
+            result.dropped = dropped;
+            return true;
+        }
+
+    private:
+        // Relay release queue entry; `data` is one framed packet or datagram
+        struct Delivery {
+            uint64_t releaseNanos;
+            std::vector<uint8_t> data;
+        };
+
+        const BenchConfig& config;
+        Channel channel;
+        uint32_t updateCount;
+        std::unique_ptr<std::atomic<uint64_t>[]> sendTimes;
+        uint64_t dropped = 0;
+
+        // TCP: sender -> relayIn, relayOut -> receiver. UDP: sender and
+        // relayOut send datagrams to relayIn and receiverFd.
+        int senderFd = -1;
+        int relayInFd = -1;
+        int relayOutFd = -1;
+        int receiverFd = -1;
+
+        bool openSockets() {
+            if (channel == Channel::UDP) {
+                senderFd = bindLoopback(SOCK_DGRAM);
+                relayInFd = bindLoopback(SOCK_DGRAM);
+                relayOutFd = bindLoopback(SOCK_DGRAM);
+                receiverFd = bindLoopback(SOCK_DGRAM);
+                if (senderFd < 0 || relayInFd < 0 || relayOutFd < 0 || receiverFd < 0) return false;
+
+                sockaddr_in relay = loopbackAddress(localPort(relayInFd));
+                sockaddr_in receiver = loopbackAddress(localPort(receiverFd));
+                return connect(senderFd, (sockaddr*)&relay, sizeof(relay)) == 0 &&
+                       connect(relayOutFd, (sockaddr*)&receiver, sizeof(receiver)) == 0;
+            }
+
+            return connectPair(senderFd, relayInFd) && connectPair(relayOutFd, receiverFd);
+        }
+
+        // Loopback TCP connection; `client` connects, `accepted` is its peer
+        static bool connectPair(int& client, int& accepted) {
+            int listenFd = bindLoopback(SOCK_STREAM);
+            if (listenFd < 0 || listen(listenFd, 1) != 0) {
+                if (listenFd >= 0) close(listenFd);
+                return false;
+            }
+
+            sockaddr_in address = loopbackAddress(localPort(listenFd));
+            client = socket(AF_INET, SOCK_STREAM, 0);
+            bool ok = client >= 0 && connect(client, (sockaddr*)&address, sizeof(address)) == 0;
+            if (ok) {
+                accepted = accept(listenFd, nullptr, nullptr);
+                ok = accepted >= 0;
+            }
+            close(listenFd);
+
+            if (ok) {
+                setNoDelay(client);
+                setNoDelay(accepted);
+            }
+            return ok;
+        }
+
+        void closeSockets() {
+            for (int* fd : { &senderFd, &relayInFd, &relayOutFd, &receiverFd }) {
+                if (*fd >= 0) {
+                    close(*fd);
+                    *fd = -1;
+                }
+            }
+        }
+
+        // Wire format matches the game: PacketHeader frames on TCP,
+        // DatagramHeader datagrams on UDP, schema-encoded PlayerMove payload
+        size_t buildPacket(uint32_t sequence, uint8_t* buffer, size_t capacity) const {
+            PlayerMove move{};
+            move.x = static_cast<float>(sequence) * 0.1f;
+            move.yaw = static_cast<float>(sequence % 360);
+
+            size_t headerSize = channel == Channel::TCP ? sizeof(PacketHeader) : sizeof(DatagramHeader);
+            size_t payloadSize = encodePacket(move, buffer + headerSize, capacity - headerSize);
+
+            if (channel == Channel::TCP) {
+                PacketHeader header;
+                header.type = static_cast<uint16_t>(PacketType::PLAYER_MOVE);
+                header.payloadSize = static_cast<uint32_t>(payloadSize);
+                header.sessionToken = 1;
+                header.sequence = sequence;
+                memcpy(buffer, &header, sizeof(header));
+            } else {
+                DatagramHeader header;
+                header.sessionToken = 1;
+                header.type = static_cast<uint16_t>(PacketType::PLAYER_MOVE);
+                header.sequence = sequence;
+                memcpy(buffer, &header, sizeof(header));
+            }
+            return headerSize + payloadSize;
+        }
+
+        void sendUpdates(RunResult& result) {
+            uint8_t buffer[MAX_DATAGRAM_SIZE];
+            uint64_t intervalNanos = 1000000000ull / static_cast<uint64_t>(config.rate);
+            uint64_t start = nowNanos();
+
+            for (uint32_t sequence = 0; sequence < updateCount; sequence++) {
+                uint64_t due = start + sequence * intervalNanos;
+                uint64_t now = nowNanos();
+                if (due > now) {
+                    std::this_thread::sleep_for(std::chrono::nanoseconds(due - now));
+                }
+
+                size_t size = buildPacket(sequence, buffer, sizeof(buffer));
+                sendTimes[sequence].store(nowNanos(), std::memory_order_release);
+                if (channel == Channel::TCP) {
+                    if (!sendAll(senderFd, buffer, size)) break;
+                } else {
+                    send(senderFd, buffer, size, 0);
+                }
+                result.sent++;
+            }
+
+            // Closing the stream, or an empty datagram, ends the relay
+            if (channel == Channel::TCP) {
+                shutdown(senderFd, SHUT_WR);
+            } else {
+                send(senderFd, buffer, 0, 0);
+            }
+        }
+
+        // Wait on `fd` until data or the next release, whichever is first
+        static bool waitReadable(int fd, const std::deque<Delivery>& pending) {
+            int timeoutMs = -1;
+            if (!pending.empty()) {
+                uint64_t now = nowNanos();
+                uint64_t release = pending.front().releaseNanos;
+                timeoutMs = release > now ? static_cast<int>((release - now + 999999) / 1000000) : 0;
+            }
+            pollfd pfd{ fd, POLLIN, 0 };
+            return poll(&pfd, 1, timeoutMs) > 0;
+        }
+
+        void releaseDue(std::deque<Delivery>& pending) {
+            uint64_t now = nowNanos();
+            while (!pending.empty() && pending.front().releaseNanos <= now) {
+                const std::vector<uint8_t>& data = pending.front().data;
+                if (channel == Channel::TCP) {
+                    sendAll(relayOutFd, data.data(), data.size());
+                } else {
+                    send(relayOutFd, data.data(), data.size(), 0);
+                }
+                pending.pop_front();
+            }
+        }
+
+        void relayStream() {
+            std::mt19937 rng(config.seed);
+            std::uniform_real_distribution<double> roll(0.0, 100.0);
+            uint64_t delayNanos = static_cast<uint64_t>(config.delayMillis) * 1000000ull;
+            uint64_t intervalNanos = 1000000000ull / static_cast<uint64_t>(config.rate);
+
+            // A lost segment is resent on the third duplicate ACK (three more
+            // packets, then an ACK round trip) or at the RTO, if sooner
+            uint64_t fastRetransmitNanos = 3 * intervalNanos + 2 * delayNanos;
+            uint64_t rtoNanos = static_cast<uint64_t>(config.rtoMillis) * 1000000ull;
+            uint64_t retransmitNanos = fastRetransmitNanos < rtoNanos ? fastRetransmitNanos : rtoNanos;
+
+            std::deque<Delivery> pending;
+            std::vector<uint8_t> frame;
+            uint64_t lastRelease = 0;
+            bool open = true;
+
+            while (open || !pending.empty()) {
+                if (open && waitReadable(relayInFd, pending)) {
+                    PacketHeader header;
+                    if (!recvAll(relayInFd, (uint8_t*)&header, sizeof(header))) {
+                        open = false;
+                    } else {
+                        frame.resize(sizeof(header) + header.payloadSize);
+                        memcpy(frame.data(), &header, sizeof(header));
+                        if (!recvAll(relayInFd, frame.data() + sizeof(header), header.payloadSize)) {
+                            open = false;
+                        } else {
+                            uint64_t release = nowNanos() + delayNanos;
+                            if (roll(rng) < config.lossPercent) {
+                                release += retransmitNanos;
+                                dropped++;
+                            }
+                            // In-order delivery: nothing passes a missing segment
+                            if (release < lastRelease) release = lastRelease;
+                            lastRelease = release;
+                            pending.push_back({ release, frame });
+                        }
+                    }
+                } else if (!open && !pending.empty()) {
+                    uint64_t now = nowNanos();
+                    if (pending.front().releaseNanos > now) {
+                        std::this_thread::sleep_for(std::chrono::nanoseconds(pending.front().releaseNanos - now));
+                    }
+                }
+                releaseDue(pending);
+            }
+            shutdown(relayOutFd, SHUT_WR);
+        }
+
+        void relayDatagrams() {
+            std::mt19937 rng(config.seed);
+            std::uniform_real_distribution<double> roll(0.0, 100.0);
+            uint64_t delayNanos = static_cast<uint64_t>(config.delayMillis) * 1000000ull;
+
+            // Constant delay keeps the queue in release order
+            std::deque<Delivery> pending;
+            uint8_t datagram[MAX_DATAGRAM_SIZE];
+            bool open = true;
+
+            while (open || !pending.empty()) {
+                if (open && waitReadable(relayInFd, pending)) {
+                    ssize_t received = recv(relayInFd, datagram, sizeof(datagram), 0);
+                    if (received == 0) {
+                        open = false;
+                    } else if (received > 0) {
+                        if (roll(rng) < config.lossPercent) {
+                            dropped++;
+                        } else {
+                            pending.push_back({ nowNanos() + delayNanos,
+                                                std::vector<uint8_t>(datagram, datagram + received) });
+                        }
+                    }
+                } else if (!open && !pending.empty()) {
+                    uint64_t now = nowNanos();
+                    if (pending.front().releaseNanos > now) {
+                        std::this_thread::sleep_for(std::chrono::nanoseconds(pending.front().releaseNanos - now));
+                    }
+                }
+                releaseDue(pending);
+            }
+            send(relayOutFd, datagram, 0, 0);
+        }
+
+        void receive(RunResult& result) {
+            // Every update up to the newest one arrived counts as superseded
+            uint32_t nextUnresolved = 0;
+            uint8_t buffer[MAX_PACKET_SIZE];
+
+            while (true) {
+                uint32_t sequence;
+                if (channel == Channel::TCP) {
+                    PacketHeader header;
+                    if (!recvAll(receiverFd, (uint8_t*)&header, sizeof(header)) ||
+                        header.payloadSize > sizeof(buffer) ||
+                        !recvAll(receiverFd, buffer, header.payloadSize)) {
+                        break;
+                    }
+                    sequence = header.sequence;
+                } else {
+                    ssize_t received = recv(receiverFd, buffer, sizeof(buffer), 0);
+                    if (received <= 0) break;
+                    if (static_cast<size_t>(received) < sizeof(DatagramHeader)) continue;
+                    DatagramHeader header;
+                    memcpy(&header, buffer, sizeof(header));
+                    sequence = header.sequence;
+                }
+
+                uint64_t now = nowNanos();
+                if (sequence >= updateCount) continue;
+                result.arrived++;
+                result.delivered.record((now - sendTimes[sequence].load(std::memory_order_acquire)) / 1000);
+
+                // Late datagrams are superseded already (never happens with a fixed delay)
+                for (; nextUnresolved <= sequence; nextUnresolved++) {
+                    result.superseded.record((now - sendTimes[nextUnresolved].load(std::memory_order_acquire)) / 1000);
+                }
+            }
+        }
+    };
+
+    void printRow(const char* label, Channel channel, const LatencyHistogram& histogram) {
+        printf("%-4s %-11s %8.2f %8.2f %8.2f %8.2f %8.2f %8.2f\n",
+               channelToString(channel), label,
+               histogram.getMean() / 1000.0,
+               histogram.getPercentile(50) / 1000.0,
+               histogram.getPercentile(90) / 1000.0,
+               histogram.getPercentile(99) / 1000.0,
+               histogram.getPercentile(99.9) / 1000.0,
+               histogram.getMax() / 1000.0);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    if (!parseArgs(argc, argv, config)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    printf("Channel benchmark: PLAYER_MOVE at %d Hz for %d s per channel, %.1f%% loss, %d ms one-way delay, RTO %d ms\n",
+           config.rate, config.durationSeconds, config.lossPercent, config.delayMillis, config.rtoMillis);
+
+    RunResult results[2];
+    const Channel channels[2] = { Channel::TCP, Channel::UDP };
+    for (int i = 0; i < 2; i++) {
+        printf("Running %s...\n", channelToString(channels[i]));
+        fflush(stdout);
+
+        ChannelRun run(config, channels[i]);
+        if (!run.run(results[i])) {
+            fprintf(stderr, "Could not open %s loopback sockets\n", channelToString(channels[i]));
+            return 1;
+        }
+    }
+
+    printf("\n=== Position-update latency (ms) ===\n");
+    printf("%-4s %-11s %8s %8s %8s %8s %8s %8s\n", "", "measure", "mean", "p50", "p90", "p99", "p99.9", "max");
+    for (int i = 0; i < 2; i++) {
+        printRow("superseded", channels[i], results[i].superseded);
+    }
+    for (int i = 0; i < 2; i++) {
+        printRow("delivered", channels[i], results[i].delivered);
+    }
+
+    printf("\n=== Packets ===\n");
+    for (int i = 0; i < 2; i++) {
+        printf("%-4s sent %8llu  arrived %8llu  lost on link %6llu\n", channelToString(channels[i]),
+               static_cast<unsigned long long>(results[i].sent),
+               static_cast<unsigned long long>(results[i].arrived),
+               static_cast<unsigned long long>(results[i].dropped));
+    }
+    printf("\n'superseded' is the time from sending an update until the receiver holds\n"
+           "it or a newer one; 'delivered' only counts updates that arrived.\n");
+    return 0;
+}
@@ -0,0 +1,465 @@
+// ============================================================================
+// COMPRESSION BENCHMARK
+// Ratio and throughput of Compression.h on game traffic. Payloads come from
+// a server capture (--capture: the packets the server sent, recorded with
+// its --capture option) or are synthesized from the protocol structs: stash
+// syncs (PLAYER_DATA_RESPONSE followed by one ItemData per stash item),
+// merchant catalogs and friend lists.
+//
+// Samples are grouped into transfers (a client's traffic, or one synthetic
+// sync or list). Even transfers train a dictionary and odd ones are
+// measured, so the dictionary never sees the data it is scored on:
+//   plain    one compressPayload() frame per message; as on the wire, messages
+//            below the threshold or that don't shrink count at their own size
+//   dict     the same against the trained dictionary
+//   stream   each transfer through its own CompressionStream, a frame per message
+// A per-size table compresses every message regardless of the threshold,
+// which is what the thresholds in Compression.h are chosen from. Throughput counts
+// uncompressed bytes. --train writes a dictionary trained on all samples for
+// the server's --compression-dictionary option.
+//
+// Build from the repository root:
+//   g++ -std=c++17 -O2 src/tools/compressbench/main.cpp src/common/Compression.cpp
+//       src/server/network/PacketCapture.cpp src/server/network/PacketView.cpp -o compressbench
+//
+// Example: measure on a capture and write an 8 KB dictionary from it
+//   ./compressbench --capture server.cap --dictionary-size 8192 --train server.dict
+// ============================================================================
+
+#include "../../common/Compression.h"
+#include "../../common/ItemDatabase.h"
+#include "../../common/NetworkProtocol.h"
+#include "../../server/network/PacketCapture.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    struct BenchConfig {
+        std::string capturePath;
+        std::string trainPath;          // Write the dictionary here
+        int players = 200;              // Synthetic stash syncs and friend lists
+        size_t dictionarySize = 8192;
+        double seconds = 0.5;           // Minimum time per throughput measurement
+        uint32_t seed = 1;
+    };
+
+    struct Sample {
+        std::string label;              // Packet type
+        uint64_t transfer;              // Samples of one transfer go through one stream
+        std::vector<uint8_t> payload;
+    };
+
+    struct SizeBucket {
+        const char* label;
+        size_t limit;                   // Exclusive upper bound
+    };
+
+    constexpr SizeBucket SIZE_BUCKETS[] = {
+        { "< 16", 16 },
+        { "16-31", 32 },
+        { "32-63", 64 },
+        { "64-127", 128 },
+        { "128-255", 256 },
+        { "256-1023", 1024 },
+        { "1024-4095", 4096 },
+        { ">= 4096", SIZE_MAX }
+    };
+
+    uint64_t nowNanos() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    void printUsage(const char* program) {
+        printf("Usage: %s [options]\n"
+               "  --capture <file>          server capture to take sent packets from (synthetic traffic if omitted)\n"
+               "  --players <n>             synthetic stash syncs and friend lists (200)\n"
+               "  --dictionary-size <bytes> trained dictionary size, at most %zu (8192)\n"
+               "  --train <file>            write a dictionary trained on every sample\n"
+               "  --seconds <s>             minimum time per throughput measurement (0.5)\n"
+               "  --seed <n>                synthetic traffic seed (1)\n",
+               program, MAX_DICTIONARY_SIZE);
+    }
+
+    bool parseArgs(int argc, char* argv[], BenchConfig& config) {
+        for (int i = 1; i < argc; i++) {
+            const char* arg = argv[i];
+            const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+            if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) return false;
+            if (!value) {
+                fprintf(stderr, "Missing value for %s\n", arg);
+                return false;
+            }
+            i++;
+
+            if (strcmp(arg, "--capture") == 0) config.capturePath = value;
+            else if (strcmp(arg, "--train") == 0) config.trainPath = value;
+            else if (strcmp(arg, "--players") == 0) config.players = atoi(value);
+            else if (strcmp(arg, "--dictionary-size") == 0) config.dictionarySize = strtoul(value, nullptr, 10);
+            else if (strcmp(arg, "--seconds") == 0) config.seconds = atof(value);
+            else if (strcmp(arg, "--seed") == 0) config.seed = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+            else {
+                fprintf(stderr, "Unknown option %s\n", arg);
+                return false;
+            }
+        }
+
+        if (config.players < 2 || config.dictionarySize < 64 || config.dictionarySize > MAX_DICTIONARY_SIZE ||
+            config.seconds <= 0.0) {
+            fprintf(stderr, "Invalid option value\n");
+            return false;
+        }
+        return true;
+    }
+
+    // ========================================================================
+    // SAMPLES
+    // ========================================================================
+
+    bool loadCapture(const std::string& path, std::vector<Sample>& samples) {
+        PayloadPool pool;
+        PacketCaptureReader reader(pool);
+        std::string errorMsg;
+        if (!reader.open(path, errorMsg)) {
+            fprintf(stderr, "%s\n", errorMsg.c_str());
+            return false;
+        }
+
+        CaptureRecord record;
+        while (reader.next(record)) {
+            if (record.kind != CaptureRecord::Kind::SENT || record.packet.size() == 0) continue;
+
+            Sample sample;
+            const char* name = packetTypeToString(record.packet.type);
+            sample.label = strcmp(name, "UNKNOWN") != 0 ? name : "type " + std::to_string(static_cast<int>(record.packet.type));
+            sample.transfer = record.packet.clientId;
+            sample.payload.assign(record.packet.data(), record.packet.data() + record.packet.size());
+            samples.push_back(std::move(sample));
+        }
+        return true;
+    }
+
+    template <typename T>
+    void addMessage(std::vector<Sample>& samples, const char* label, uint64_t transfer, const T& message) {
+        static std::vector<uint8_t> buffer(MAX_PACKET_SIZE);
+        size_t size = encodePacket(message, buffer.data(), buffer.size());
+        if (size == 0) return;
+        samples.push_back({ label, transfer, std::vector<uint8_t>(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(size)) });
+    }
+
+    void copyName(char* dst, size_t dstSize, const std::string& src) {
+        size_t length = std::min(src.size(), dstSize - 1);
+        memcpy(dst, src.data(), length);
+        dst[length] = '\0';
+    }
+
+    std::string randomUsername(std::mt19937& rng) {
+        static const char* const PREFIXES[] = { "Shadow", "Tarkov", "Ghost", "Raider", "Scav", "Wolf", "Viper", "Bear" };
+        std::string name = PREFIXES[rng() % 8];
+        name += std::to_string(rng() % 10000);
+        return name;
+    }
+
+    void synthesize(const BenchConfig& config, std::vector<Sample>& samples) {
+        std::mt19937 rng(config.seed);
+        auto& itemDb = ItemDatabase::getInstance();
+        std::vector<std::string> itemIds = itemDb.getAllItemIds();
+        std::sort(itemIds.begin(), itemIds.end());
+        uint64_t transfer = 0;
+
+        for (int player = 0; player < config.players; player++) {
+            // Stash sync: the player record, then every stash item
+            PlayerDataResponse data{};
+            data.accountId = 1000 + static_cast<uint64_t>(player);
+            copyName(data.username, sizeof(data.username), randomUsername(rng));
+            data.stats.level = 1 + static_cast<int>(rng() % 60);
+            data.stats.experience = static_cast<int>(rng() % 2000000);
+            data.stats.roubles = static_cast<int>(rng() % 5000000);
+            data.stats.raidsCompleted = static_cast<int>(rng() % 500);
+            data.stats.raidsExtracted = data.stats.raidsCompleted / 2;
+            data.stats.raidsDied = data.stats.raidsCompleted - data.stats.raidsExtracted;
+            data.stats.kills = static_cast<int>(rng() % 2000);
+            data.stats.deaths = data.stats.raidsDied;
+            data.stats.survivalRate = 0.5f;
+            data.stashItemCount = static_cast<uint16_t>(20 + rng() % 280);
+            addMessage(samples, "PLAYER_DATA_RESPONSE", transfer, data);
+
+            for (uint16_t i = 0; i < data.stashItemCount; i++) {
+                Item* item = itemDb.getItemTemplate(itemIds[rng() % itemIds.size()]);
+                ItemData entry{};
+                entry.itemId = static_cast<uint32_t>(std::lower_bound(itemIds.begin(), itemIds.end(), item->id) - itemIds.begin()) + 1;
+                copyName(entry.itemName, sizeof(entry.itemName), item->name);
+                entry.stackSize = static_cast<uint16_t>(item->maxStack > 1 ? 1 + rng() % item->maxStack : 1);
+                entry.foundInRaid = rng() % 2 == 0;
+                entry.currentAmmo = static_cast<uint16_t>(item->magazineSize > 0 ? rng() % (item->magazineSize + 1) : 0);
+                entry.durability = static_cast<uint16_t>(50 + rng() % 51);
+                addMessage(samples, "ITEM_DATA", transfer, entry);
+            }
+            transfer++;
+
+            // Friend list
+            FriendListResponse friends{};
+            friends.friendCount = static_cast<uint8_t>(5 + rng() % 96);
+            for (uint8_t i = 0; i < friends.friendCount; i++) {
+                friends.friends[i].accountId = 1000 + rng() % 100000;
+                copyName(friends.friends[i].username, sizeof(friends.friends[i].username), randomUsername(rng));
+                friends.friends[i].isOnline = rng() % 3 == 0;
+                friends.friends[i].lobbyId = friends.friends[i].isOnline && rng() % 2 ? 1 + rng() % 5000 : 0;
+            }
+            addMessage(samples, "FRIEND_LIST_RESPONSE", transfer++, friends);
+
+            // Merchant catalog, a few per player as stock and prices move
+            if (player % 4 == 0) {
+                MerchantListResponse catalog{};
+                catalog.merchantId = static_cast<uint8_t>(rng() % 4);
+                catalog.itemCount = static_cast<uint16_t>(std::min<size_t>(itemIds.size(), 200));
+                for (uint16_t i = 0; i < catalog.itemCount; i++) {
+                    Item* item = itemDb.getItemTemplate(itemIds[i]);
+                    catalog.items[i].itemId = i + 1u;
+                    copyName(catalog.items[i].itemName, sizeof(catalog.items[i].itemName), item->name);
+                    catalog.items[i].price = static_cast<uint32_t>(item->value * (90 + rng() % 40) / 100);
+                    catalog.items[i].stock = static_cast<uint16_t>(rng() % 4 == 0 ? 0 : rng() % 50);
+                }
+                addMessage(samples, "MERCHANT_LIST_RESPONSE", transfer++, catalog);
+            }
+        }
+    }
+
+    // ========================================================================
+    // MEASUREMENT
+    // ========================================================================
+
+    struct ModeResult {
+        uint64_t rawBytes = 0;
+        uint64_t wireBytes = 0;
+        uint64_t compressedMessages = 0;    // Frames not stored raw
+        double compressGBps = 0.0;
+        double decompressGBps = 0.0;
+    };
+
+    // Run `pass` until at least `seconds` have gone by; GB/s of `bytes` per pass
+    template <typename Pass>
+    double measure(double seconds, uint64_t bytes, Pass pass) {
+        uint64_t start = nowNanos();
+        uint64_t passes = 0;
+        uint64_t elapsed = 0;
+        do {
+            pass();
+            passes++;
+            elapsed = nowNanos() - start;
+        } while (elapsed < static_cast<uint64_t>(seconds * 1e9));
+        return static_cast<double>(bytes) * passes / static_cast<double>(elapsed);
+    }
+
+    bool measureFrames(const BenchConfig& config, const std::vector<const Sample*>& samples,
+                       const CompressionDictionary* dictionary, ModeResult& result) {
+        std::vector<std::vector<uint8_t>> frames(samples.size());
+        // As NetworkServer sends them: the frame if it compressed, else the payload as is
+        for (size_t i = 0; i < samples.size(); i++) {
+            const auto& payload = samples[i]->payload;
+            bool compressed = compressPayload(payload.data(), payload.size(), frames[i], dictionary);
+            result.compressedMessages += compressed ? 1 : 0;
+            result.rawBytes += payload.size();
+            result.wireBytes += compressed ? frames[i].size() : payload.size();
+        }
+
+        std::vector<uint8_t> frame;
+        result.compressGBps = measure(config.seconds, result.rawBytes, [&]() {
+            for (const Sample* sample : samples) {
+                compressPayload(sample->payload.data(), sample->payload.size(), frame, dictionary);
+            }
+        });
+
+        std::vector<uint8_t> out;
+        bool ok = true;
+        result.decompressGBps = measure(config.seconds, result.rawBytes, [&]() {
+            for (size_t i = 0; i < frames.size(); i++) {
+                ok &= decompressPayload(frames[i].data(), frames[i].size(), out, dictionary) &&
+                      out.size() == samples[i]->payload.size();
+            }
+        });
+        return ok;
+    }
+
+    bool measureStreams(const BenchConfig& config, const std::vector<const Sample*>& samples, ModeResult& result) {
+        // Consecutive samples of a transfer form one stream
+        std::vector<std::vector<const Sample*>> transfers;
+        for (const Sample* sample : samples) {
+            if (transfers.empty() || transfers.back().back()->transfer != sample->transfer) transfers.emplace_back();
+            transfers.back().push_back(sample);
+        }
+
+        std::vector<std::vector<std::vector<uint8_t>>> frames(transfers.size());
+        for (size_t t = 0; t < transfers.size(); t++) {
+            CompressionStream stream;
+            for (const Sample* sample : transfers[t]) {
+                frames[t].emplace_back();
+                stream.compress(sample->payload.data(), sample->payload.size(), frames[t].back());
+                result.rawBytes += sample->payload.size();
+                result.wireBytes += frames[t].back().size();
+            }
+        }
+        result.compressedMessages = samples.size();
+
+        std::vector<uint8_t> frame;
+        result.compressGBps = measure(config.seconds, result.rawBytes, [&]() {
+            for (const auto& transfer : transfers) {
+                CompressionStream stream;
+                for (const Sample* sample : transfer) {
+                    frame.clear();
+                    stream.compress(sample->payload.data(), sample->payload.size(), frame);
+                }
+            }
+        });
+
+        std::vector<uint8_t> out;
+        bool ok = true;
+        result.decompressGBps = measure(config.seconds, result.rawBytes, [&]() {
+            for (size_t t = 0; t < transfers.size(); t++) {
+                DecompressionStream stream;
+                for (size_t i = 0; i < frames[t].size(); i++) {
+                    out.clear();
+                    ok &= stream.decompress(frames[t][i].data(), frames[t][i].size(), out) &&
+                          out == transfers[t][i]->payload;
+                }
+            }
+        });
+        return ok;
+    }
+
+    void printMode(const char* name, const ModeResult& result, size_t messages) {
+        printf("%-8s %10.3f %10llu %10llu %9.1f%% %10.2f %10.2f\n", name,
+               result.wireBytes > 0 ? static_cast<double>(result.rawBytes) / result.wireBytes : 0.0,
+               static_cast<unsigned long long>(result.rawBytes), static_cast<unsigned long long>(result.wireBytes),
+               messages > 0 ? 100.0 * result.compressedMessages / messages : 0.0,
+               result.compressGBps, result.decompressGBps);
+    }
+
+    // Block-only ratio, threshold ignored
+    double blockRatio(const std::vector<const Sample*>& samples, const CompressionDictionary* dictionary) {
+        uint64_t raw = 0;
+        uint64_t compressed = 0;
+        std::vector<uint8_t> block;
+        for (const Sample* sample : samples) {
+            block.resize(compressBound(sample->payload.size()));
+            raw += sample->payload.size();
+            compressed += compressBlock(sample->payload.data(), sample->payload.size(), block.data(), block.size(), dictionary);
+        }
+        return compressed > 0 ? static_cast<double>(raw) / compressed : 0.0;
+    }
+
+    bool writeDictionary(const std::string& path, const CompressionDictionary& dictionary) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return false;
+        file.write(reinterpret_cast<const char*>(dictionary.data()), static_cast<std::streamsize>(dictionary.size()));
+        return static_cast<bool>(file);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    if (!parseArgs(argc, argv, config)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::vector<Sample> samples;
+    if (!config.capturePath.empty()) {
+        if (!loadCapture(config.capturePath, samples)) return 1;
+        printf("Compression benchmark: %zu sent packets from %s\n", samples.size(), config.capturePath.c_str());
+    } else {
+        synthesize(config, samples);
+        printf("Compression benchmark: %zu synthetic messages for %d players\n", samples.size(), config.players);
+    }
+
+    // Even transfers train, odd ones are measured. A capture from a single
+    // client has one transfer; split its packets instead.
+    std::vector<std::vector<uint8_t>> training;
+    std::vector<const Sample*> test;
+    bool byTransfer = std::any_of(samples.begin(), samples.end(), [](const Sample& s) { return s.transfer % 2 == 0; }) &&
+                      std::any_of(samples.begin(), samples.end(), [](const Sample& s) { return s.transfer % 2 == 1; });
+    for (size_t i = 0; i < samples.size(); i++) {
+        bool train = byTransfer ? samples[i].transfer % 2 == 0 : i % 2 == 0;
+        if (train) training.push_back(samples[i].payload);
+        else test.push_back(&samples[i]);
+    }
+    if (training.empty() || test.empty()) {
+        fprintf(stderr, "Not enough samples to train and measure\n");
+        return 1;
+    }
+
+    uint64_t trainStart = nowNanos();
+    CompressionDictionary dictionary = CompressionDictionary::train(training, config.dictionarySize);
+    double trainMillis = (nowNanos() - trainStart) / 1e6;
+    printf("Dictionary: %zu bytes from %zu samples in %.1f ms; measuring %zu messages\n",
+           dictionary.size(), training.size(), trainMillis, test.size());
+
+    ModeResult plain, dict, stream;
+    bool ok = measureFrames(config, test, nullptr, plain);
+    ok &= measureFrames(config, test, &dictionary, dict);
+    ok &= measureStreams(config, test, stream);
+    if (!ok) {
+        fprintf(stderr, "Round trip mismatch\n");
+        return 1;
+    }
+
+    printf("\n=== Modes (threshold %zu bytes, %zu with the dictionary) ===\n",
+           COMPRESSION_THRESHOLD, DICTIONARY_COMPRESSION_THRESHOLD);
+    printf("%-8s %10s %10s %10s %10s %10s %10s\n", "mode", "ratio", "raw", "wire", "compressed", "comp GB/s", "decomp GB/s");
+    printMode("plain", plain, test.size());
+    printMode("dict", dict, test.size());
+    printMode("stream", stream, test.size());
+
+    printf("\n=== Block ratio by message size (no threshold) ===\n");
+    printf("%-10s %8s %10s %10s\n", "bytes", "messages", "plain", "dict");
+    size_t lower = 0;
+    for (const SizeBucket& bucket : SIZE_BUCKETS) {
+        std::vector<const Sample*> inBucket;
+        for (const Sample* sample : test) {
+            if (sample->payload.size() >= lower && sample->payload.size() < bucket.limit) inBucket.push_back(sample);
+        }
+        lower = bucket.limit;
+        if (inBucket.empty()) continue;
+        printf("%-10s %8zu %10.3f %10.3f\n", bucket.label, inBucket.size(), blockRatio(inBucket, nullptr), blockRatio(inBucket, &dictionary));
+    }
+
+    printf("\n=== Wire ratio by type ===\n");
+    printf("%-24s %8s %10s %10s %10s\n", "type", "messages", "avg bytes", "plain", "dict");
+    std::map<std::string, std::vector<const Sample*>> byType;
+    for (const Sample* sample : test) {
+        byType[sample->label].push_back(sample);
+    }
+    for (const auto& pair : byType) {
+        uint64_t raw = 0, plainBytes = 0, dictBytes = 0;
+        std::vector<uint8_t> frame;
+        for (const Sample* sample : pair.second) {
+            size_t size = sample->payload.size();
+            raw += size;
+            plainBytes += compressPayload(sample->payload.data(), size, frame) ? frame.size() : size;
+            dictBytes += compressPayload(sample->payload.data(), size, frame, &dictionary) ? frame.size() : size;
+        }
+        printf("%-24s %8zu %10.1f %10.3f %10.3f\n", pair.first.c_str(), pair.second.size(),
+               static_cast<double>(raw) / pair.second.size(),
+               static_cast<double>(raw) / plainBytes, static_cast<double>(raw) / dictBytes);
+    }
+
+    if (!config.trainPath.empty()) {
+        std::vector<std::vector<uint8_t>> all;
+        for (const Sample& sample : samples) all.push_back(sample.payload);
+        CompressionDictionary full = CompressionDictionary::train(all, config.dictionarySize);
+        if (!writeDictionary(config.trainPath, full)) {
+            fprintf(stderr, "Cannot write %s\n", config.trainPath.c_str());
+            return 1;
+        }
+        printf("\nWrote %zu byte dictionary %u to %s\n", full.size(), full.id(), config.trainPath.c_str());
+    }
+    return 0;
+}
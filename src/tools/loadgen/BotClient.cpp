@@ -0,0 +1,636 @@
+#include "BotClient.h"
+#include "LoadWorker.h"
+#include "../../common/Compression.h"
+#include "../../common/PlayerMovement.h"
+#include "../../common/Utils.h"
+#include "../../common/WorldSnapshot.h"
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+    constexpr size_t HEADER_SIZE = sizeof(PacketHeader);
+    constexpr uint64_t NANOS_PER_SECOND = 1000000000ull;
+    constexpr uint64_t HEARTBEAT_INTERVAL_NANOS = NANOS_PER_SECOND;
+    constexpr uint64_t MOVEMENT_STEP_NANOS = NANOS_PER_SECOND / MOVEMENT_TICK_RATE;
+
+    // Unsent bytes above this mean the server stopped draining the socket;
+    // moves are skipped (and counted) instead of queued without bound
+    constexpr size_t MAX_SEND_BACKLOG = 256 * 1024;
+
+    static_assert(sizeof(PacketHeader) == 18, "PacketHeader layout changed");
+
+    void copyString(char* dst, size_t dstSize, const std::string& src) {
+        size_t length = src.size() < dstSize - 1 ? src.size() : dstSize - 1;
+        memcpy(dst, src.data(), length);
+        dst[length] = '\0';
+    }
+
+    template <typename T>
+    bool readPayload(const PacketHeader& header, const uint8_t* payload, T& out) {
+        return decodePacket(payload, header.payloadSize, out);
+    }
+
+    // Bots on one worker thread share this; payloads are copied out at once
+    thread_local uint8_t encodeBuffer[MAX_PACKET_SIZE];
+
+    // Every bot is sent the same dictionary; keep one copy per worker thread
+    std::shared_ptr<const CompressionDictionary> sharedDictionary(const uint8_t* data, size_t size) {
+        thread_local std::shared_ptr<const CompressionDictionary> cached;
+        if (!cached || cached->size() != size || memcmp(cached->data(), data, size) != 0) {
+            cached = std::make_shared<const CompressionDictionary>(data, size);
+        }
+        return cached;
+    }
+}
+
+BotClient::BotClient(LoadWorker& worker, const LoadConfig& config, LoadStats& stats,
+                     const std::string& username, Party& party, uint32_t seed)
+    : worker(worker), config(config), stats(stats), username(username), party(party), rng(seed) {
+    party.members.push_back(this);
+    isLeader = party.members.size() == 1;
+}
+
+BotClient::~BotClient() {
+    close();
+}
+
+bool BotClient::connect(int epoll, const sockaddr_in& address) {
+    socketFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (socketFd < 0) {
+        stats.connectFailures++;
+        fail();
+        return false;
+    }
+
+    int noDelay = 1;
+    setsockopt(socketFd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+    epollFd = epoll;
+    if (::connect(socketFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0 && errno != EINPROGRESS) {
+        stats.connectFailures++;
+        fail();
+        return false;
+    }
+
+    // Writable once the handshake finishes
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLOUT;
+    event.data.ptr = this;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, socketFd, &event);
+    wantWrite = true;
+    state = State::CONNECTING;
+    return true;
+}
+
+void BotClient::close() {
+    if (socketFd >= 0) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, socketFd, nullptr);
+        ::close(socketFd);
+        socketFd = -1;
+    }
+    state = State::CLOSED;
+    pending.clear();
+    sendBuffer.clear();
+    sendOffset = 0;
+}
+
+void BotClient::fail() {
+    close();
+
+    // Followers would otherwise wait for a lobby that is never created
+    if (isLeader && party.lobbyId == 0 && !party.lobbyFailed) {
+        party.lobbyFailed = true;
+        for (BotClient* member : party.members) {
+            if (member != this) member->onPartyChanged();
+        }
+    }
+    settle();
+}
+
+void BotClient::settle() {
+    if (settled) return;
+    settled = true;
+    party.settled++;
+
+    BotClient* leader = party.members.front();
+    if (leader != this) leader->onPartyChanged();
+}
+
+void BotClient::onPartyChanged() {
+    if (state == State::WAITING_FOR_LOBBY) {
+        if (party.lobbyId != 0) {
+            LobbyJoinRequest req{};
+            req.lobbyId = party.lobbyId;
+            sendRequest(PacketType::LOBBY_JOIN, req, PacketType::LOBBY_JOIN_RESPONSE, RequestKind::LOBBY_JOIN);
+            state = State::ENTERING_LOBBY;
+        } else if (party.lobbyFailed) {
+            settle();
+            startPlaying();
+        }
+    } else if (state == State::WAITING_FOR_PARTY && party.settled == party.members.size()) {
+        sendStartQueue();
+    }
+}
+
+// ============================================================================
+// SOCKET I/O
+// ============================================================================
+
+void BotClient::onWritable() {
+    if (state == State::CONNECTING) {
+        int error = 0;
+        socklen_t length = sizeof(error);
+        getsockopt(socketFd, SOL_SOCKET, SO_ERROR, &error, &length);
+        if (error != 0) {
+            stats.connectFailures++;
+            fail();
+            return;
+        }
+
+        stats.connects++;
+        sendRegister();
+        return;
+    }
+
+    flushSendBuffer();
+}
+
+void BotClient::onReadable() {
+    if (state == State::CONNECTING) {
+        // Connect errors are reported as EPOLLERR, which lands here
+        onWritable();
+        if (state == State::CLOSED) return;
+    }
+
+    static thread_local uint8_t scratch[65536];
+
+    while (socketFd >= 0) {
+        ssize_t received = recv(socketFd, scratch, sizeof(scratch), 0);
+        if (received == 0) {
+            stats.disconnects++;
+            fail();
+            return;
+        }
+        if (received < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+            if (errno == EINTR) continue;
+            stats.disconnects++;
+            fail();
+            return;
+        }
+        stats.bytesReceived += static_cast<uint64_t>(received);
+
+        // Parse straight out of the scratch buffer; only a trailing partial
+        // packet is copied into recvBuffer
+        const uint8_t* data = scratch;
+        size_t length = static_cast<size_t>(received);
+        if (!recvBuffer.empty()) {
+            recvBuffer.insert(recvBuffer.end(), scratch, scratch + received);
+            data = recvBuffer.data();
+            length = recvBuffer.size();
+        }
+
+        size_t consumed = 0;
+        while (length - consumed >= HEADER_SIZE) {
+            PacketHeader header;
+            memcpy(&header, data + consumed, HEADER_SIZE);
+            if (header.payloadSize > MAX_PACKET_SIZE) {
+                stats.disconnects++;
+                fail();
+                return;
+            }
+            if (length - consumed < HEADER_SIZE + header.payloadSize) break;
+
+            handlePacket(header, data + consumed + HEADER_SIZE);
+            if (state == State::CLOSED) return;
+            consumed += HEADER_SIZE + header.payloadSize;
+        }
+
+        if (!recvBuffer.empty()) {
+            recvBuffer.erase(recvBuffer.begin(), recvBuffer.begin() + static_cast<ptrdiff_t>(consumed));
+        } else if (consumed < length) {
+            recvBuffer.assign(data + consumed, data + length);
+        }
+    }
+}
+
+bool BotClient::sendPacket(PacketType type, const void* payload, uint32_t size) {
+    if (socketFd < 0) return false;
+
+    PacketHeader header;
+    header.type = static_cast<uint16_t>(type);
+    header.payloadSize = size;
+    header.sessionToken = sessionToken;
+    header.sequence = sequence++;
+
+    const uint8_t* headerBytes = reinterpret_cast<const uint8_t*>(&header);
+    sendBuffer.insert(sendBuffer.end(), headerBytes, headerBytes + HEADER_SIZE);
+    if (size > 0) {
+        const uint8_t* payloadBytes = static_cast<const uint8_t*>(payload);
+        sendBuffer.insert(sendBuffer.end(), payloadBytes, payloadBytes + size);
+    }
+
+    stats.packetsSent++;
+    stats.bytesSent += HEADER_SIZE + size;
+    return flushSendBuffer();
+}
+
+void BotClient::sendRequest(PacketType type, const void* payload, uint32_t size, PacketType expected, RequestKind kind) {
+    pending.push_back(PendingRequest{ expected, kind, steadyNanos() });
+    sendPacket(type, payload, size);
+}
+
+template <typename T>
+bool BotClient::sendMessage(PacketType type, const T& message) {
+    size_t size = encodePacket(message, encodeBuffer, sizeof(encodeBuffer));
+    return size > 0 && sendPacket(type, encodeBuffer, static_cast<uint32_t>(size));
+}
+
+template <typename T>
+void BotClient::sendRequest(PacketType type, const T& message, PacketType expected, RequestKind kind) {
+    pending.push_back(PendingRequest{ expected, kind, steadyNanos() });
+    sendMessage(type, message);
+}
+
+bool BotClient::flushSendBuffer() {
+    while (sendOffset < sendBuffer.size()) {
+        ssize_t sent = send(socketFd, sendBuffer.data() + sendOffset, sendBuffer.size() - sendOffset, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            if (errno == EINTR) continue;
+            stats.disconnects++;
+            fail();
+            return false;
+        }
+        sendOffset += static_cast<size_t>(sent);
+    }
+
+    if (sendOffset == sendBuffer.size()) {
+        sendBuffer.clear();
+        sendOffset = 0;
+    } else if (sendOffset > MAX_SEND_BACKLOG) {
+        sendBuffer.erase(sendBuffer.begin(), sendBuffer.begin() + static_cast<ptrdiff_t>(sendOffset));
+        sendOffset = 0;
+    }
+
+    updateWriteInterest();
+    return true;
+}
+
+void BotClient::updateWriteInterest() {
+    bool want = sendOffset < sendBuffer.size();
+    if (want == wantWrite || socketFd < 0) return;
+
+    epoll_event event{};
+    event.events = want ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+    event.data.ptr = this;
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, socketFd, &event);
+    wantWrite = want;
+}
+
+// ============================================================================
+// SCRIPT
+// ============================================================================
+
+void BotClient::handlePacket(const PacketHeader& header, const uint8_t* payload) {
+    if (header.type & PACKET_FLAG_COMPRESSED) {
+        // Handle the decompressed packet as if it had arrived that way
+        thread_local std::vector<uint8_t> decompressed;
+        if (!decompressPayload(payload, header.payloadSize, decompressed, dictionary.get()) ||
+            decompressed.size() > MAX_PACKET_SIZE) {
+            stats.disconnects++;
+            fail();
+            return;
+        }
+        PacketHeader inner = header;
+        inner.type = static_cast<uint16_t>(header.type & ~PACKET_FLAG_COMPRESSED);
+        inner.payloadSize = static_cast<uint32_t>(decompressed.size());
+        handlePacket(inner, decompressed.data());
+        return;
+    }
+
+    uint64_t now = steadyNanos();
+    PacketType type = static_cast<PacketType>(header.type);
+    stats.packetsReceived++;
+
+    if (type == PacketType::COMPRESSION_DICTIONARY) {
+        dictionary = sharedDictionary(payload, header.payloadSize);
+        return;
+    }
+
+    // Server RTT probe: echo as a real client does
+    if (type == PacketType::HEARTBEAT && header.payloadSize > 0) {
+        sendPacket(PacketType::HEARTBEAT, payload, header.payloadSize);
+        return;
+    }
+
+    if (type == PacketType::WORLD_SNAPSHOT) {
+        stats.snapshotsReceived++;
+        stats.snapshotBytes += HEADER_SIZE + header.payloadSize;
+        handleSnapshot(payload, header.payloadSize);
+        return;
+    }
+
+    if (type == PacketType::MATCH_FOUND) {
+        if (party.queuedAtNanos != 0 && !matched) {
+            matched = true;
+            stats[RequestKind::MATCHMAKING].latencyMicros.record((now - party.queuedAtNanos) / 1000);
+        }
+        return;
+    }
+
+    // Oldest request waiting for this type; errors answer the oldest request
+    auto it = pending.begin();
+    if (type != PacketType::ERROR_RESPONSE) {
+        while (it != pending.end() && it->expected != type) ++it;
+    }
+    if (it == pending.end()) return;    // Unsolicited (e.g. LOBBY_UPDATE broadcast)
+
+    PendingRequest request = *it;
+    pending.erase(it);
+
+    bool success = false;
+    uint64_t createdLobbyId = 0;
+    switch (type) {
+        case PacketType::REGISTER_RESPONSE: {
+            RegisterResponse resp;
+            success = readPayload(header, payload, resp) && resp.success;
+            break;
+        }
+        case PacketType::LOGIN_RESPONSE: {
+            LoginResponse resp;
+            success = readPayload(header, payload, resp) && resp.success;
+            if (success) {
+                sessionToken = resp.sessionToken;
+                accountId = resp.accountId;
+            }
+            break;
+        }
+        case PacketType::LOBBY_CREATE_RESPONSE: {
+            LobbyCreateResponse resp;
+            success = readPayload(header, payload, resp) && resp.success;
+            if (success) createdLobbyId = resp.lobbyId;
+            break;
+        }
+        case PacketType::LOBBY_JOIN_RESPONSE: {
+            LobbyJoinResponse resp;
+            success = readPayload(header, payload, resp) && resp.success;
+            break;
+        }
+        case PacketType::MERCHANT_TRANSACTION_RESPONSE: {
+            MerchantTransactionResponse resp;
+            success = readPayload(header, payload, resp) && resp.success;
+            break;
+        }
+        case PacketType::LOBBY_UPDATE:
+            success = true;
+            break;
+        default:
+            break;
+    }
+
+    RequestStats& requestStats = stats[request.kind];
+    requestStats.latencyMicros.record((now - request.sentNanos) / 1000);
+    if (!success) requestStats.failed++;
+
+    switch (request.kind) {
+        case RequestKind::REGISTER:
+            // Already registered by an earlier run is fine; log in either way
+            sendLogin();
+            break;
+
+        case RequestKind::LOGIN:
+            if (success) {
+                enterLobby();
+            } else {
+                fail();
+            }
+            break;
+
+        case RequestKind::LOBBY_CREATE:
+            if (success) {
+                party.lobbyId = createdLobbyId;
+                sendReady();
+            } else {
+                party.lobbyFailed = true;
+                settle();
+                startPlaying();
+            }
+            for (BotClient* member : party.members) {
+                if (member != this) member->onPartyChanged();
+            }
+            break;
+
+        case RequestKind::LOBBY_JOIN:
+            if (success) {
+                sendReady();
+            } else {
+                settle();
+                startPlaying();
+            }
+            break;
+
+        case RequestKind::LOBBY_READY:
+            settle();
+            if (isLeader) {
+                state = State::WAITING_FOR_PARTY;
+                onPartyChanged();
+            } else {
+                startPlaying();
+            }
+            break;
+
+        case RequestKind::LOBBY_QUEUE:
+            startPlaying();
+            break;
+
+        default:
+            break;
+    }
+}
+
+void BotClient::expireRequests(uint64_t nowNanos) {
+    uint64_t timeout = static_cast<uint64_t>(config.requestTimeoutMillis) * 1000000ull;
+
+    while (!pending.empty() && nowNanos > pending.front().sentNanos + timeout) {
+        RequestKind kind = pending.front().kind;
+        pending.pop_front();
+        stats[kind].timedOut++;
+
+        // Move the script along as if the request had failed.
+        // LOBBY_START_QUEUE gets no answer at all when the server refuses it.
+        switch (kind) {
+            case RequestKind::REGISTER: sendLogin(); break;
+            case RequestKind::LOGIN: fail(); return;
+            case RequestKind::LOBBY_CREATE:
+            case RequestKind::LOBBY_JOIN:
+            case RequestKind::LOBBY_READY:
+                if (isLeader && party.lobbyId == 0) {
+                    party.lobbyFailed = true;
+                    for (BotClient* member : party.members) {
+                        if (member != this) member->onPartyChanged();
+                    }
+                }
+                settle();
+                startPlaying();
+                break;
+            case RequestKind::LOBBY_QUEUE: startPlaying(); break;
+            default: break;
+        }
+    }
+}
+
+void BotClient::sendRegister() {
+    RegisterRequest req{};
+    copyString(req.username, sizeof(req.username), username);
+    copyString(req.passwordHash, sizeof(req.passwordHash), simpleHash(username));
+    copyString(req.email, sizeof(req.email), username + "@loadtest.local");
+
+    state = State::REGISTERING;
+    sendRequest(PacketType::REGISTER_REQUEST, req, PacketType::REGISTER_RESPONSE, RequestKind::REGISTER);
+}
+
+void BotClient::sendLogin() {
+    LoginRequest req{};
+    copyString(req.username, sizeof(req.username), username);
+    copyString(req.passwordHash, sizeof(req.passwordHash), simpleHash(username));
+
+    state = State::LOGGING_IN;
+    sendRequest(PacketType::LOGIN_REQUEST, req, PacketType::LOGIN_RESPONSE, RequestKind::LOGIN);
+}
+
+void BotClient::enterLobby() {
+    if (isLeader) {
+        LobbyCreateRequest req{};
+        copyString(req.lobbyName, sizeof(req.lobbyName), username);
+        req.maxPlayers = static_cast<uint8_t>(party.members.size());
+        req.isPrivate = false;
+
+        state = State::ENTERING_LOBBY;
+        sendRequest(PacketType::LOBBY_CREATE, req, PacketType::LOBBY_CREATE_RESPONSE, RequestKind::LOBBY_CREATE);
+        return;
+    }
+
+    state = State::WAITING_FOR_LOBBY;
+    onPartyChanged();
+}
+
+void BotClient::sendReady() {
+    LobbyReady req{};
+    req.ready = true;
+
+    state = State::READYING;
+    sendRequest(PacketType::LOBBY_READY, req, PacketType::LOBBY_UPDATE, RequestKind::LOBBY_READY);
+}
+
+void BotClient::sendStartQueue() {
+    state = State::QUEUEING;
+    party.queuedAtNanos = steadyNanos();
+    sendRequest(PacketType::LOBBY_START_QUEUE, nullptr, 0, PacketType::LOBBY_UPDATE, RequestKind::LOBBY_QUEUE);
+}
+
+void BotClient::sendBuy() {
+    // The server resolves every buy to an AK-74, which only Prapor stocks
+    MerchantBuy req{};
+    req.merchantId = static_cast<uint8_t>(MerchantType::PRAPOR);
+    req.itemId = 1;
+    req.quantity = 1;
+    sendRequest(PacketType::MERCHANT_BUY, req, PacketType::MERCHANT_TRANSACTION_RESPONSE, RequestKind::MERCHANT_BUY);
+}
+
+// ============================================================================
+// GAMEPLAY STREAM
+// ============================================================================
+
+void BotClient::handleSnapshot(const uint8_t* payload, uint32_t size) {
+    uint32_t snapshotSequence, baselineSequence;
+    if (!peekSnapshotBaseline(payload, size, snapshotSequence, baselineSequence)) return;
+
+    // Bots keep no baselines or world state, but acking makes the server
+    // encode deltas exactly as for a real client
+    SnapshotAck ack;
+    ack.sequence = snapshotSequence;
+    sendMessage(PacketType::SNAPSHOT_ACK, ack);
+}
+
+void BotClient::startPlaying() {
+    if (state == State::PLAYING || state == State::CLOSED) return;
+    state = State::PLAYING;
+
+    std::uniform_int_distribution<int> rateDist(config.moveRateMin, config.moveRateMax);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    movePeriodNanos = NANOS_PER_SECOND / static_cast<uint64_t>(rateDist(rng));
+    yaw = unit(rng) * 360.0f;
+
+    // Spread the first move over one period so bots that entered together
+    // do not send in lockstep
+    uint64_t now = steadyNanos();
+    nextMoveNanos = now + static_cast<uint64_t>(unit(rng) * movePeriodNanos);
+    inputNanos = now;
+    nextHeartbeatNanos = now + HEARTBEAT_INTERVAL_NANOS;
+    nextBuyNanos = now;
+
+    worker.schedule(this, nextMoveNanos);
+}
+
+uint64_t BotClient::onTimer(uint64_t nowNanos) {
+    if (state != State::PLAYING) return 0;
+
+    if (nowNanos >= nextBuyNanos) {
+        bool buyPending = false;
+        for (const PendingRequest& request : pending) {
+            if (request.kind == RequestKind::MERCHANT_BUY) buyPending = true;
+        }
+        if (!buyPending) sendBuy();
+        nextBuyNanos = nowNanos + static_cast<uint64_t>(config.buyIntervalMillis) * 1000000ull;
+    }
+
+    if (nowNanos >= nextHeartbeatNanos) {
+        sendPacket(PacketType::HEARTBEAT, nullptr, 0);
+        nextHeartbeatNanos += HEARTBEAT_INTERVAL_NANOS;
+    }
+    if (state != State::PLAYING) return 0;
+
+    if (sendBuffer.size() - sendOffset > MAX_SEND_BACKLOG) {
+        stats.movesSkipped++;
+    } else {
+        // Wander around the map: walk forward, turning a little each send.
+        // One command per movement step since the last send; bots don't
+        // resend, their TCP stream loses nothing.
+        std::uniform_real_distribution<float> turn(-15.0f, 15.0f);
+        yaw = std::fmod(yaw + turn(rng) + 360.0f, 360.0f);
+
+        uint64_t steps = (nowNanos - inputNanos) / MOVEMENT_STEP_NANOS;
+        inputNanos += steps * MOVEMENT_STEP_NANOS;
+        if (steps > MAX_INPUT_COMMANDS) steps = MAX_INPUT_COMMANDS;   // Stalled worker: let those go
+
+        if (steps > 0) {
+            PlayerInput input;
+            input.firstSequence = inputSequence;
+            input.commandCount = static_cast<uint8_t>(steps);
+            for (uint64_t i = 0; i < steps; i++) {
+                input.commands[i].buttons = MOVE_FORWARD;
+                input.commands[i].yaw = quantizeAngle(yaw);
+                input.commands[i].pitch = 0;
+            }
+            inputSequence += static_cast<uint32_t>(steps);
+
+            if (sendMessage(PacketType::PLAYER_INPUT, input)) {
+                stats.movesSent++;
+            }
+        }
+    }
+    if (state != State::PLAYING) return 0;
+
+    // Keep to the schedule, but don't burst to make up for a stalled worker
+    nextMoveNanos += movePeriodNanos;
+    if (nextMoveNanos <= nowNanos) nextMoveNanos = nowNanos + movePeriodNanos;
+    return nextMoveNanos;
+}
@@ -0,0 +1,162 @@
+#pragma once
+#include "LoadStats.h"
+#include "../../common/NetworkProtocol.h"
+#include "../../common/Compression.h"
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <netinet/in.h>
+
+class LoadWorker;
+class BotClient;
+
+struct LoadConfig {
+    std::string host = "127.0.0.1";
+    int port = 7777;
+    int bots = 100;
+    int threads = 0;            // 0 = one per core
+    int partySize = 4;          // Bots per lobby (1-5)
+    int moveRateMin = 20;       // PLAYER_INPUT rate per bot, picked uniformly in [min, max] Hz
+    int moveRateMax = 60;
+    int durationSeconds = 30;
+    int rampSeconds = 5;        // Connections are spread evenly over this window
+    int buyIntervalMillis = 5000;
+    int requestTimeoutMillis = 10000;
+    int sloMillis = 50;         // p99 above this marks an interval as saturated
+    std::string prefix = "bot";
+};
+
+// Bots that share a lobby. The leader creates it, the others join once the
+// lobby id is known, and the leader queues after everyone has readied (or
+// given up). All members live on the same worker thread.
+struct Party {
+    std::vector<BotClient*> members;
+    uint64_t lobbyId = 0;
+    bool lobbyFailed = false;
+    size_t settled = 0;             // Members that readied or dropped out
+    uint64_t queuedAtNanos = 0;
+};
+
+// One simulated player on a non-blocking TCP connection, scripted through
+// register -> login -> lobby create/join -> ready -> queue -> merchant buy,
+// then streaming PLAYER_INPUT at its move rate with a periodic MERCHANT_BUY
+// to keep measuring request latency under load. Each packet carries the
+// movement commands for the steps since the last one, so the server
+// simulates a bot walking around at full speed whatever the rate. In the
+// raid it acknowledges every WORLD_SNAPSHOT so the server sends deltas as it
+// would to a real client.
+//
+// Responses are matched to the oldest outstanding request expecting that
+// packet type; ERROR_RESPONSE answers the oldest request. LOBBY_UPDATE is
+// the only answer to LOBBY_READY and LOBBY_START_QUEUE but is also broadcast
+// when other members change, so those two timings can read slightly low.
+class BotClient {
+public:
+    enum class State : uint8_t {
+        IDLE,
+        CONNECTING,
+        REGISTERING,
+        LOGGING_IN,
+        WAITING_FOR_LOBBY,
+        ENTERING_LOBBY,
+        READYING,
+        WAITING_FOR_PARTY,
+        QUEUEING,
+        PLAYING,
+        CLOSED
+    };
+
+    BotClient(LoadWorker& worker, const LoadConfig& config, LoadStats& stats,
+              const std::string& username, Party& party, uint32_t seed);
+    ~BotClient();
+
+    BotClient(const BotClient&) = delete;
+    BotClient& operator=(const BotClient&) = delete;
+
+    // Start a non-blocking connect; false if the socket could not be created
+    bool connect(int epollFd, const sockaddr_in& address);
+    void close();
+
+    void onReadable();
+    void onWritable();
+
+    // Periodic traffic while PLAYING. Returns when it wants to run next.
+    uint64_t onTimer(uint64_t nowNanos);
+
+    // Drop requests that have waited longer than the timeout
+    void expireRequests(uint64_t nowNanos);
+
+    // The party's lobby id became known, or every member settled
+    void onPartyChanged();
+
+    State getState() const { return state; }
+    bool isConnected() const { return state != State::IDLE && state != State::CONNECTING && state != State::CLOSED; }
+
+private:
+    struct PendingRequest {
+        PacketType expected;
+        RequestKind kind;
+        uint64_t sentNanos;
+    };
+
+    LoadWorker& worker;
+    const LoadConfig& config;
+    LoadStats& stats;
+    std::string username;
+    Party& party;
+    bool isLeader;
+    bool settled = false;
+    bool matched = false;
+
+    int socketFd = -1;
+    int epollFd = -1;
+    State state = State::IDLE;
+    bool wantWrite = false;
+
+    uint64_t sessionToken = 0;
+    uint64_t accountId = 0;
+    uint32_t sequence = 0;
+    std::deque<PendingRequest> pending;
+
+    std::vector<uint8_t> recvBuffer;    // Trailing partial packet only
+    std::vector<uint8_t> sendBuffer;
+    std::shared_ptr<const CompressionDictionary> dictionary;   // Sent by the server on connect, if any
+    size_t sendOffset = 0;
+
+    // PLAYING
+    std::mt19937 rng;
+    uint64_t movePeriodNanos = 0;
+    uint64_t nextMoveNanos = 0;
+    uint64_t nextHeartbeatNanos = 0;
+    uint64_t nextBuyNanos = 0;
+    uint64_t inputNanos = 0;            // Time covered by the commands sent so far
+    uint32_t inputSequence = 1;         // Next movement command
+    float yaw = 0.0f;
+
+    bool sendPacket(PacketType type, const void* payload, uint32_t size);
+    void sendRequest(PacketType type, const void* payload, uint32_t size, PacketType expected, RequestKind kind);
+
+    // Protocol structs, encoded through their PacketSchema
+    template <typename T>
+    bool sendMessage(PacketType type, const T& message);
+    template <typename T>
+    void sendRequest(PacketType type, const T& message, PacketType expected, RequestKind kind);
+    bool flushSendBuffer();
+    void updateWriteInterest();
+
+    void handlePacket(const PacketHeader& header, const uint8_t* payload);
+    void handleSnapshot(const uint8_t* payload, uint32_t size);
+
+    void sendRegister();
+    void sendLogin();
+    void enterLobby();
+    void sendReady();
+    void sendStartQueue();
+    void sendBuy();
+    void startPlaying();
+    void settle();
+    void fail();
+};
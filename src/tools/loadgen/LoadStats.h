@@ -0,0 +1,102 @@
+#pragma once
+#include "../../common/LatencyHistogram.h"
+#include <chrono>
+#include <cstdint>
+
+// Request/response pairs the bots time. MATCHMAKING runs from
+// LOBBY_START_QUEUE until MATCH_FOUND arrives, so it includes the wait for
+// the server's next matchmaking tick.
+enum class RequestKind : uint8_t {
+    REGISTER,
+    LOGIN,
+    LOBBY_CREATE,
+    LOBBY_JOIN,
+    LOBBY_READY,
+    LOBBY_QUEUE,
+    MATCHMAKING,
+    MERCHANT_BUY,
+    COUNT
+};
+
+inline const char* requestKindToString(RequestKind kind) {
+    switch (kind) {
+        case RequestKind::REGISTER: return "register";
+        case RequestKind::LOGIN: return "login";
+        case RequestKind::LOBBY_CREATE: return "lobby create";
+        case RequestKind::LOBBY_JOIN: return "lobby join";
+        case RequestKind::LOBBY_READY: return "lobby ready";
+        case RequestKind::LOBBY_QUEUE: return "lobby queue";
+        case RequestKind::MATCHMAKING: return "matchmaking";
+        case RequestKind::MERCHANT_BUY: return "merchant buy";
+        default: return "unknown";
+    }
+}
+
+constexpr int REQUEST_KIND_COUNT = static_cast<int>(RequestKind::COUNT);
+
+struct RequestStats {
+    LatencyHistogram latencyMicros;
+    uint64_t failed = 0;        // Answered with success = false or ERROR_RESPONSE
+    uint64_t timedOut = 0;      // No answer within the request timeout
+
+    void merge(const RequestStats& other) {
+        latencyMicros.merge(other.latencyMicros);
+        failed += other.failed;
+        timedOut += other.timedOut;
+    }
+};
+
+// Counters for one reporting interval (or the whole run, once merged)
+struct LoadStats {
+    RequestStats requests[REQUEST_KIND_COUNT];
+
+    uint64_t packetsSent = 0;
+    uint64_t bytesSent = 0;
+    uint64_t packetsReceived = 0;
+    uint64_t bytesReceived = 0;
+    uint64_t movesSent = 0;
+    uint64_t movesSkipped = 0;      // Socket backed up: the server is not draining us
+    uint64_t snapshotsReceived = 0; // WORLD_SNAPSHOT packets
+    uint64_t snapshotBytes = 0;     // Including packet headers
+    uint64_t connects = 0;
+    uint64_t connectFailures = 0;
+    uint64_t disconnects = 0;
+
+    RequestStats& operator[](RequestKind kind) { return requests[static_cast<int>(kind)]; }
+    const RequestStats& operator[](RequestKind kind) const { return requests[static_cast<int>(kind)]; }
+
+    void merge(const LoadStats& other) {
+        for (int i = 0; i < REQUEST_KIND_COUNT; i++) {
+            requests[i].merge(other.requests[i]);
+        }
+        packetsSent += other.packetsSent;
+        bytesSent += other.bytesSent;
+        packetsReceived += other.packetsReceived;
+        bytesReceived += other.bytesReceived;
+        movesSent += other.movesSent;
+        movesSkipped += other.movesSkipped;
+        snapshotsReceived += other.snapshotsReceived;
+        snapshotBytes += other.snapshotBytes;
+        connects += other.connects;
+        connectFailures += other.connectFailures;
+        disconnects += other.disconnects;
+    }
+
+    void reset() {
+        for (int i = 0; i < REQUEST_KIND_COUNT; i++) {
+            requests[i].latencyMicros.reset();
+            requests[i].failed = 0;
+            requests[i].timedOut = 0;
+        }
+        packetsSent = bytesSent = 0;
+        packetsReceived = bytesReceived = 0;
+        movesSent = movesSkipped = 0;
+        snapshotsReceived = snapshotBytes = 0;
+        connects = connectFailures = disconnects = 0;
+    }
+};
+
+inline uint64_t steadyNanos() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
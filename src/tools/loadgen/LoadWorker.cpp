@@ -0,0 +1,133 @@
+#include "LoadWorker.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+namespace {
+    constexpr int MAX_EVENTS = 256;
+    constexpr uint64_t HOUSEKEEPING_INTERVAL_NANOS = 1000000000ull;
+}
+
+LoadWorker::LoadWorker(const LoadConfig& config, const sockaddr_in& address)
+    : config(config), address(address) {
+}
+
+LoadWorker::~LoadWorker() {
+    stop();
+    bots.clear();
+    if (epollFd >= 0) {
+        close(epollFd);
+    }
+}
+
+void LoadWorker::addParty(const std::vector<std::string>& usernames, uint64_t connectDelayNanos, uint32_t seed) {
+    parties.push_back(std::make_unique<Party>());
+    Party& party = *parties.back();
+
+    for (size_t i = 0; i < usernames.size(); i++) {
+        bots.push_back(std::make_unique<BotClient>(*this, config, stats, usernames[i], party, seed + static_cast<uint32_t>(i)));
+        connects.push_back(PendingConnect{ connectDelayNanos, bots.back().get() });
+    }
+}
+
+bool LoadWorker::start(std::string& errorMsg) {
+    epollFd = epoll_create1(0);
+    if (epollFd < 0) {
+        errorMsg = "epoll_create1 failed: " + std::string(strerror(errno));
+        return false;
+    }
+
+    std::stable_sort(connects.begin(), connects.end(), [](const PendingConnect& a, const PendingConnect& b) {
+        return a.delayNanos < b.delayNanos;
+    });
+
+    running = true;
+    thread = std::thread(&LoadWorker::run, this);
+    return true;
+}
+
+void LoadWorker::stop() {
+    running = false;
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+void LoadWorker::collectStats(LoadStats& out) {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    out.merge(stats);
+    stats.reset();
+}
+
+void LoadWorker::schedule(BotClient* bot, uint64_t dueNanos) {
+    timers.push(Timer{ dueNanos, bot });
+}
+
+void LoadWorker::run() {
+    epoll_event events[MAX_EVENTS];
+    uint64_t startNanos = steadyNanos();
+    uint64_t nextHousekeeping = startNanos + HOUSEKEEPING_INTERVAL_NANOS;
+
+    while (running) {
+        // Sleep until the next connect, timer or housekeeping pass
+        uint64_t now = steadyNanos();
+        uint64_t wakeAt = nextHousekeeping;
+        if (nextConnect < connects.size()) {
+            wakeAt = std::min(wakeAt, startNanos + connects[nextConnect].delayNanos);
+        }
+        if (!timers.empty()) {
+            wakeAt = std::min(wakeAt, timers.top().dueNanos);
+        }
+        int timeoutMillis = wakeAt > now ? static_cast<int>((wakeAt - now + 999999) / 1000000) : 0;
+        if (timeoutMillis > 100) timeoutMillis = 100;
+
+        int count = epoll_wait(epollFd, events, MAX_EVENTS, timeoutMillis);
+        if (count < 0 && errno != EINTR) break;
+
+        std::lock_guard<std::mutex> lock(statsMutex);
+        now = steadyNanos();
+
+        for (int i = 0; i < count; i++) {
+            BotClient* bot = static_cast<BotClient*>(events[i].data.ptr);
+            if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) {
+                bot->onReadable();
+            }
+            if ((events[i].events & EPOLLOUT) && bot->getState() != BotClient::State::CLOSED) {
+                bot->onWritable();
+            }
+        }
+
+        while (nextConnect < connects.size() && startNanos + connects[nextConnect].delayNanos <= now) {
+            connects[nextConnect].bot->connect(epollFd, address);
+            nextConnect++;
+        }
+
+        while (!timers.empty() && timers.top().dueNanos <= now) {
+            BotClient* bot = timers.top().bot;
+            timers.pop();
+
+            uint64_t next = bot->onTimer(now);
+            if (next != 0) {
+                timers.push(Timer{ next, bot });
+            }
+        }
+
+        if (now >= nextHousekeeping) {
+            size_t connected = 0;
+            for (auto& bot : bots) {
+                bot->expireRequests(now);
+                if (bot->isConnected()) connected++;
+            }
+            connectedCount.store(connected, std::memory_order_relaxed);
+            nextHousekeeping = now + HOUSEKEEPING_INTERVAL_NANOS;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    for (auto& bot : bots) {
+        bot->close();
+    }
+    connectedCount.store(0, std::memory_order_relaxed);
+}
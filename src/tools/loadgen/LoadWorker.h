@@ -0,0 +1,70 @@
+#pragma once
+#include "BotClient.h"
+#include "LoadStats.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+// One load-generator thread: an epoll loop over its bots' sockets plus a
+// timer heap for the PLAYER_INPUT streams. Stats are recorded under statsMutex,
+// which the loop holds while handling a batch of events so the reporting
+// thread can swap out a consistent interval between batches.
+class LoadWorker {
+public:
+    LoadWorker(const LoadConfig& config, const sockaddr_in& address);
+    ~LoadWorker();
+
+    LoadWorker(const LoadWorker&) = delete;
+    LoadWorker& operator=(const LoadWorker&) = delete;
+
+    // Add a party; its bots connect together once `connectDelayNanos` has
+    // passed since start(). Call before start().
+    void addParty(const std::vector<std::string>& usernames, uint64_t connectDelayNanos, uint32_t seed);
+
+    bool start(std::string& errorMsg);
+    void stop();
+
+    // Merge the stats gathered since the last call into `out` and reset them
+    void collectStats(LoadStats& out);
+
+    size_t getConnectedCount() const { return connectedCount.load(std::memory_order_relaxed); }
+
+    // Run bot->onTimer() at `dueNanos`
+    void schedule(BotClient* bot, uint64_t dueNanos);
+
+private:
+    struct PendingConnect {
+        uint64_t delayNanos;
+        BotClient* bot;
+    };
+
+    struct Timer {
+        uint64_t dueNanos;
+        BotClient* bot;
+        bool operator>(const Timer& other) const { return dueNanos > other.dueNanos; }
+    };
+
+    const LoadConfig& config;
+    sockaddr_in address;
+    int epollFd = -1;
+
+    std::vector<std::unique_ptr<Party>> parties;
+    std::vector<std::unique_ptr<BotClient>> bots;
+    std::vector<PendingConnect> connects;
+    size_t nextConnect = 0;
+
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers;
+
+    std::mutex statsMutex;
+    LoadStats stats;
+
+    std::thread thread;
+    std::atomic<bool> running{ false };
+    std::atomic<size_t> connectedCount{ 0 };
+
+    void run();
+};
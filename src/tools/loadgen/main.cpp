@@ -0,0 +1,309 @@
+// ============================================================================
+// LOAD GENERATOR
+// Headless bots that drive the server through the real protocol: register,
+// login, lobby create/join/ready/queue, merchant buy, then PLAYER_INPUT
+// streams. Reports request latency percentiles every second and a summary
+// with the throughput the server sustained before latency broke the SLO.
+//
+// Linux only. Build from the repository root:
+//   g++ -std=c++17 -O2 -pthread src/tools/loadgen/*.cpp src/common/Compression.cpp -o loadgen
+//
+// Example: 2000 bots in parties of 4, ramped in over 20 s, run for 60 s
+//   ./loadgen --bots 2000 --ramp 20 --duration 60
+// ============================================================================
+
+#include "LoadWorker.h"
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <sys/resource.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr int SNAPSHOT_RATE_HZ = 20;    // Server's SNAPSHOT_RATE
+
+    void printUsage(const char* program) {
+        printf("Usage: %s [options]\n"
+               "  --host <addr>         server address (127.0.0.1)\n"
+               "  --port <n>            server port (7777)\n"
+               "  --bots <n>            number of bots (100)\n"
+               "  --threads <n>         worker threads, 0 = one per core (0)\n"
+               "  --party <n>           bots per lobby, 1-5 (4)\n"
+               "  --move-rate <lo-hi>   PLAYER_INPUT rate per bot in Hz (20-60)\n"
+               "  --duration <s>        run time in seconds, including ramp (30)\n"
+               "  --ramp <s>            spread connections over this many seconds (5)\n"
+               "  --buy-interval <ms>   merchant buy probe interval per bot (5000)\n"
+               "  --timeout <ms>        request timeout (10000)\n"
+               "  --slo <ms>            p99 latency target used to find the ceiling (50)\n"
+               "  --prefix <name>       username prefix (bot)\n",
+               program);
+    }
+
+    bool parseArgs(int argc, char* argv[], LoadConfig& config) {
+        for (int i = 1; i < argc; i++) {
+            const char* arg = argv[i];
+            const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+            if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) return false;
+            if (!value) {
+                fprintf(stderr, "Missing value for %s\n", arg);
+                return false;
+            }
+            i++;
+
+            if (strcmp(arg, "--host") == 0) config.host = value;
+            else if (strcmp(arg, "--port") == 0) config.port = atoi(value);
+            else if (strcmp(arg, "--bots") == 0) config.bots = atoi(value);
+            else if (strcmp(arg, "--threads") == 0) config.threads = atoi(value);
+            else if (strcmp(arg, "--party") == 0) config.partySize = atoi(value);
+            else if (strcmp(arg, "--duration") == 0) config.durationSeconds = atoi(value);
+            else if (strcmp(arg, "--ramp") == 0) config.rampSeconds = atoi(value);
+            else if (strcmp(arg, "--buy-interval") == 0) config.buyIntervalMillis = atoi(value);
+            else if (strcmp(arg, "--timeout") == 0) config.requestTimeoutMillis = atoi(value);
+            else if (strcmp(arg, "--slo") == 0) config.sloMillis = atoi(value);
+            else if (strcmp(arg, "--prefix") == 0) config.prefix = value;
+            else if (strcmp(arg, "--move-rate") == 0) {
+                if (sscanf(value, "%d-%d", &config.moveRateMin, &config.moveRateMax) == 1) {
+                    config.moveRateMax = config.moveRateMin;
+                }
+            } else {
+                fprintf(stderr, "Unknown option %s\n", arg);
+                return false;
+            }
+        }
+
+        if (config.bots < 1 || config.partySize < 1 || config.partySize > 5 ||
+            config.moveRateMin < 1 || config.moveRateMax < config.moveRateMin ||
+            config.durationSeconds < 1 || config.rampSeconds < 0 || config.buyIntervalMillis < 1) {
+            fprintf(stderr, "Invalid option value\n");
+            return false;
+        }
+        if (config.threads <= 0) {
+            config.threads = static_cast<int>(std::thread::hardware_concurrency());
+            if (config.threads < 1) config.threads = 1;
+        }
+        return true;
+    }
+
+    bool resolve(const LoadConfig& config, sockaddr_in& address) {
+        addrinfo hints{};
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+
+        addrinfo* result = nullptr;
+        if (getaddrinfo(config.host.c_str(), nullptr, &hints, &result) != 0 || !result) {
+            return false;
+        }
+        address = *reinterpret_cast<sockaddr_in*>(result->ai_addr);
+        address.sin_port = htons(static_cast<uint16_t>(config.port));
+        freeaddrinfo(result);
+        return true;
+    }
+
+    // Thousands of sockets need more than the default 1024 descriptors
+    void raiseDescriptorLimit(int bots) {
+        rlimit limit;
+        if (getrlimit(RLIMIT_NOFILE, &limit) != 0) return;
+
+        rlim_t wanted = static_cast<rlim_t>(bots) + 64;
+        if (limit.rlim_cur >= wanted) return;
+
+        limit.rlim_cur = limit.rlim_max < wanted ? limit.rlim_max : wanted;
+        setrlimit(RLIMIT_NOFILE, &limit);
+        if (limit.rlim_cur < wanted) {
+            fprintf(stderr, "Warning: descriptor limit %llu is below %d bots\n",
+                    static_cast<unsigned long long>(limit.rlim_cur), bots);
+        }
+    }
+
+    // Latency across every timed request except MATCHMAKING, which is
+    // dominated by the server's matchmaking tick
+    LatencyHistogram requestLatency(const LoadStats& stats) {
+        LatencyHistogram combined;
+        for (int i = 0; i < REQUEST_KIND_COUNT; i++) {
+            if (static_cast<RequestKind>(i) == RequestKind::MATCHMAKING) continue;
+            combined.merge(stats.requests[i].latencyMicros);
+        }
+        return combined;
+    }
+
+    uint64_t timeouts(const LoadStats& stats) {
+        uint64_t total = 0;
+        for (int i = 0; i < REQUEST_KIND_COUNT; i++) {
+            total += stats.requests[i].timedOut;
+        }
+        return total;
+    }
+
+    void printSummary(const LoadConfig& config, const LoadStats& total, double seconds) {
+        printf("\n=== Requests (latency in ms) ===\n");
+        printf("%-14s %9s %7s %7s %8s %8s %8s %8s %8s\n",
+               "request", "count", "failed", "timeout", "p50", "p90", "p99", "p99.9", "max");
+        for (int i = 0; i < REQUEST_KIND_COUNT; i++) {
+            const RequestStats& s = total.requests[i];
+            if (s.latencyMicros.getCount() == 0 && s.timedOut == 0) continue;
+            printf("%-14s %9llu %7llu %7llu %8.2f %8.2f %8.2f %8.2f %8.2f\n",
+                   requestKindToString(static_cast<RequestKind>(i)),
+                   static_cast<unsigned long long>(s.latencyMicros.getCount()),
+                   static_cast<unsigned long long>(s.failed),
+                   static_cast<unsigned long long>(s.timedOut),
+                   s.latencyMicros.getPercentile(50) / 1000.0,
+                   s.latencyMicros.getPercentile(90) / 1000.0,
+                   s.latencyMicros.getPercentile(99) / 1000.0,
+                   s.latencyMicros.getPercentile(99.9) / 1000.0,
+                   s.latencyMicros.getMax() / 1000.0);
+        }
+
+        printf("\n=== Traffic (%.1f s, %d bots) ===\n", seconds, config.bots);
+        printf("sent      %12llu packets  %10.0f pkt/s  %8.2f MB/s\n",
+               static_cast<unsigned long long>(total.packetsSent), total.packetsSent / seconds,
+               total.bytesSent / seconds / (1024.0 * 1024.0));
+        printf("received  %12llu packets  %10.0f pkt/s  %8.2f MB/s\n",
+               static_cast<unsigned long long>(total.packetsReceived), total.packetsReceived / seconds,
+               total.bytesReceived / seconds / (1024.0 * 1024.0));
+        printf("moves     %12llu sent, %llu skipped on backpressure\n",
+               static_cast<unsigned long long>(total.movesSent), static_cast<unsigned long long>(total.movesSkipped));
+        if (total.snapshotsReceived > 0) {
+            double average = static_cast<double>(total.snapshotBytes) / total.snapshotsReceived;
+            printf("snapshots %12llu received, %.1f B avg, %.0f B/s per raid player at %d Hz\n",
+                   static_cast<unsigned long long>(total.snapshotsReceived), average,
+                   average * SNAPSHOT_RATE_HZ, SNAPSHOT_RATE_HZ);
+        }
+        printf("sockets   %12llu connected, %llu failed, %llu dropped by server\n",
+               static_cast<unsigned long long>(total.connects), static_cast<unsigned long long>(total.connectFailures),
+               static_cast<unsigned long long>(total.disconnects));
+    }
+}
+
+int main(int argc, char* argv[]) {
+    LoadConfig config;
+    if (!parseArgs(argc, argv, config)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    sockaddr_in address{};
+    if (!resolve(config, address)) {
+        fprintf(stderr, "Could not resolve %s\n", config.host.c_str());
+        return 1;
+    }
+    raiseDescriptorLimit(config.bots);
+
+    // Usernames are unique per run so accounts from earlier runs don't collide
+    unsigned runId = static_cast<unsigned>(std::chrono::system_clock::now().time_since_epoch().count() / 1000000 % 0xFFFFFF);
+
+    std::vector<std::unique_ptr<LoadWorker>> workers;
+    for (int i = 0; i < config.threads; i++) {
+        workers.push_back(std::make_unique<LoadWorker>(config, address));
+    }
+
+    // Parties are dealt round-robin to workers and connect at evenly spaced
+    // points across the ramp
+    int partyCount = (config.bots + config.partySize - 1) / config.partySize;
+    uint64_t rampNanos = static_cast<uint64_t>(config.rampSeconds) * 1000000000ull;
+    int botIndex = 0;
+    for (int p = 0; p < partyCount; p++) {
+        std::vector<std::string> usernames;
+        for (int m = 0; m < config.partySize && botIndex < config.bots; m++, botIndex++) {
+            char name[32];
+            snprintf(name, sizeof(name), "%s%06x_%d", config.prefix.c_str(), runId, botIndex);
+            usernames.push_back(name);
+        }
+        uint64_t delay = partyCount > 1 ? rampNanos * p / partyCount : 0;
+        workers[p % workers.size()]->addParty(usernames, delay, runId * 7919u + static_cast<uint32_t>(botIndex));
+    }
+
+    printf("Load test: %d bots (parties of %d) on %d threads against %s:%d for %d s, ramp %d s, moves %d-%d Hz\n",
+           config.bots, config.partySize, config.threads, config.host.c_str(), config.port,
+           config.durationSeconds, config.rampSeconds, config.moveRateMin, config.moveRateMax);
+
+    for (auto& worker : workers) {
+        std::string errorMsg;
+        if (!worker->start(errorMsg)) {
+            fprintf(stderr, "Worker failed to start: %s\n", errorMsg.c_str());
+            return 1;
+        }
+    }
+
+    // Per-second report. An interval is saturated when request p99 exceeds
+    // the SLO, a request times out, or moves back up in the socket; the
+    // ceiling is the highest send rate seen before the first saturated one.
+    LoadStats total;
+    LoadStats interval;
+    double peakSendRate = 0.0;
+    double ceilingSendRate = 0.0;
+    size_t ceilingBots = 0;
+    bool saturated = false;
+    double saturatedSendRate = 0.0;
+    size_t saturatedBots = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    auto last = start;
+    for (int second = 1; second <= config.durationSeconds; second++) {
+        std::this_thread::sleep_until(start + std::chrono::seconds(second));
+        auto now = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double>(now - last).count();
+        last = now;
+
+        interval.reset();
+        size_t connected = 0;
+        for (auto& worker : workers) {
+            worker->collectStats(interval);
+            connected += worker->getConnectedCount();
+        }
+        total.merge(interval);
+
+        LatencyHistogram latency = requestLatency(interval);
+        double sendRate = interval.packetsSent / elapsed;
+        double recvRate = interval.packetsReceived / elapsed;
+        uint64_t intervalTimeouts = timeouts(interval);
+
+        printf("%4ds  bots %6zu  sent %9.0f pkt/s  recv %8.0f pkt/s  req %6llu  p50 %7.2f  p99 %7.2f  max %7.2f ms",
+               second, connected, sendRate, recvRate,
+               static_cast<unsigned long long>(latency.getCount()),
+               latency.getPercentile(50) / 1000.0, latency.getPercentile(99) / 1000.0, latency.getMax() / 1000.0);
+        if (interval.movesSkipped > 0) printf("  skipped %llu", static_cast<unsigned long long>(interval.movesSkipped));
+        if (intervalTimeouts > 0) printf("  timeouts %llu", static_cast<unsigned long long>(intervalTimeouts));
+        printf("\n");
+        fflush(stdout);
+
+        if (sendRate > peakSendRate) peakSendRate = sendRate;
+
+        bool over = latency.getPercentile(99) > static_cast<uint64_t>(config.sloMillis) * 1000 ||
+                    intervalTimeouts > 0 || interval.movesSkipped > 0;
+        if (over && !saturated) {
+            saturated = true;
+            saturatedSendRate = sendRate;
+            saturatedBots = connected;
+        } else if (!saturated && sendRate > ceilingSendRate) {
+            ceilingSendRate = sendRate;
+            ceilingBots = connected;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (auto& worker : workers) {
+        worker->stop();
+    }
+    interval.reset();
+    for (auto& worker : workers) {
+        worker->collectStats(interval);
+    }
+    total.merge(interval);
+
+    printSummary(config, total, seconds);
+
+    printf("\n=== Throughput ceiling (p99 SLO %d ms) ===\n", config.sloMillis);
+    if (saturated) {
+        printf("held     %10.0f pkt/s with %zu bots\n", ceilingSendRate, ceilingBots);
+        printf("broke at %10.0f pkt/s with %zu bots\n", saturatedSendRate, saturatedBots);
+    } else {
+        printf("not reached: peak %.0f pkt/s stayed within the SLO; add bots or raise --move-rate\n", peakSendRate);
+    }
+    return 0;
+}
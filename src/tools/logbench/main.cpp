@@ -0,0 +1,370 @@
+// ============================================================================
+// LOGGING BENCHMARK
+// Echo throughput of a real NetworkServer with per-packet logging on and
+// off. Loopback clients each keep --window PLAYER_MOVE packets in flight;
+// the game loop logs a "Received" line per packet and echoes it back. Modes:
+//   off      no per-packet line
+//   logger   LOG_INFO through the asynchronous logger (common/Logger.h)
+//   cout     std::cout << ... << std::endl, as the server logged before it
+// Log lines go to --output (stdout is redirected there, as the server's
+// would be); the report goes to the terminal. For the logger mode the
+// lines it had to drop because a ring was full are reported as well.
+//
+// Linux only. Build from the repository root:
+//   g++ -std=c++17 -O2 -pthread src/tools/logbench/main.cpp src/server/network/*.cpp
+//       src/common/Logger.cpp src/common/Compression.cpp -o logbench
+//
+// Example: 64 clients x 2000 packets, all three modes, on the game thread
+//   ./logbench --clients 64 --packets 2000 --mode all --io-threads 0
+// ============================================================================
+
+#include "../../common/Logger.h"
+#include "../../common/NetworkProtocol.h"
+#include "../../common/RingBuffer.h"
+#include "../../server/network/NetworkServer.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    LogCategory benchLog("Echo");
+
+    enum class LogMode : uint8_t {
+        OFF,
+        LOGGER,
+        COUT
+    };
+
+    const char* logModeToString(LogMode mode) {
+        switch (mode) {
+            case LogMode::OFF: return "off";
+            case LogMode::LOGGER: return "logger";
+            case LogMode::COUT: return "cout";
+        }
+        return "?";
+    }
+
+    struct BenchConfig {
+        int port = 7792;
+        int ioThreads = 0;              // Single core, as the server's default on Windows
+        int clients = 64;
+        int packets = 2000;             // Echoes per client
+        int window = 1;                 // Packets in flight per client
+        std::string output = "logbench.log";
+        std::vector<LogMode> modes = { LogMode::OFF, LogMode::LOGGER, LogMode::COUT };
+    };
+
+    struct RunResult {
+        double seconds = 0.0;
+        uint64_t echoes = 0;
+        uint64_t dropped = 0;           // Logger lines lost to full rings
+        bool ok = false;
+    };
+
+    uint64_t nowNanos() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    void printUsage(const char* program) {
+        printf("Usage: %s [options]\n"
+               "  --clients <n>         loopback clients (64)\n"
+               "  --packets <n>         echoes per client (2000)\n"
+               "  --window <n>          packets in flight per client (1)\n"
+               "  --mode <m>            off, logger, cout or all (all)\n"
+               "  --io-threads <n>      server I/O threads, 0 = game thread (0)\n"
+               "  --output <file>       where log lines are written (logbench.log)\n"
+               "  --port <port>         loopback port (7792)\n",
+               program);
+    }
+
+    bool parseArgs(int argc, char* argv[], BenchConfig& config) {
+        for (int i = 1; i < argc; i++) {
+            const char* arg = argv[i];
+            const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+            if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) return false;
+            if (!value) {
+                fprintf(stderr, "Missing value for %s\n", arg);
+                return false;
+            }
+            i++;
+
+            if (strcmp(arg, "--clients") == 0) config.clients = atoi(value);
+            else if (strcmp(arg, "--packets") == 0) config.packets = atoi(value);
+            else if (strcmp(arg, "--window") == 0) config.window = atoi(value);
+            else if (strcmp(arg, "--io-threads") == 0) config.ioThreads = atoi(value);
+            else if (strcmp(arg, "--output") == 0) config.output = value;
+            else if (strcmp(arg, "--port") == 0) config.port = atoi(value);
+            else if (strcmp(arg, "--mode") == 0) {
+                if (strcmp(value, "off") == 0) config.modes = { LogMode::OFF };
+                else if (strcmp(value, "logger") == 0) config.modes = { LogMode::LOGGER };
+                else if (strcmp(value, "cout") == 0) config.modes = { LogMode::COUT };
+                else if (strcmp(value, "all") == 0) config.modes = { LogMode::OFF, LogMode::LOGGER, LogMode::COUT };
+                else {
+                    fprintf(stderr, "Unknown mode %s\n", value);
+                    return false;
+                }
+            }
+            else {
+                fprintf(stderr, "Unknown option %s\n", arg);
+                return false;
+            }
+        }
+
+        if (config.clients < 1 || config.packets < 1 || config.window < 1 || config.ioThreads < 0 ||
+            config.port < 1 || config.port > 65535) {
+            fprintf(stderr, "Invalid option value\n");
+            return false;
+        }
+        return true;
+    }
+
+    // Client side, on its own thread: every connection sends its window,
+    // then one more packet per echo until it has sent its share
+    class EchoClients {
+    public:
+        EchoClients(const BenchConfig& config) : config(config) {
+            PlayerMove move = {};
+            move.x = 12.5f;
+            move.z = -40.0f;
+            move.yaw = 90.0f;
+            uint8_t payload[32];
+            size_t size = encodePacket(move, payload, sizeof(payload));
+
+            PacketHeader header;
+            header.type = static_cast<uint16_t>(PacketType::PLAYER_MOVE);
+            header.payloadSize = static_cast<uint32_t>(size);
+            header.sessionToken = 0;
+            header.sequence = 0;
+            const uint8_t* headerBytes = reinterpret_cast<const uint8_t*>(&header);
+            frame.assign(headerBytes, headerBytes + sizeof(header));
+            frame.insert(frame.end(), payload, payload + size);
+        }
+
+        bool connectAll() {
+            for (int i = 0; i < config.clients; i++) {
+                int fd = socket(AF_INET, SOCK_STREAM, 0);
+                if (fd < 0) return false;
+
+                sockaddr_in address = {};
+                address.sin_family = AF_INET;
+                address.sin_port = htons(static_cast<uint16_t>(config.port));
+                address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+                if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+                    close(fd);
+                    return false;
+                }
+                int noDelay = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+                connections.emplace_back(fd);
+            }
+            return true;
+        }
+
+        // Blocks until every echo is back (true) or nothing arrived for 5 s
+        bool run(uint64_t& outEchoes) {
+            std::vector<pollfd> fds(connections.size());
+            for (size_t i = 0; i < connections.size(); i++) {
+                fds[i].fd = connections[i].fd;
+                fds[i].events = POLLIN;
+                for (int w = 0; w < config.window && connections[i].sent < config.packets; w++) {
+                    if (!sendFrame(connections[i])) return false;
+                }
+            }
+
+            uint64_t expected = static_cast<uint64_t>(config.clients) * config.packets;
+            uint64_t echoes = 0;
+            while (echoes < expected) {
+                int ready = poll(fds.data(), fds.size(), 5000);
+                if (ready <= 0) break;
+
+                for (size_t i = 0; i < fds.size(); i++) {
+                    if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+                    int received = receive(connections[i]);
+                    if (received < 0) return false;
+                    echoes += static_cast<uint64_t>(received);
+                }
+            }
+            outEchoes = echoes;
+            return echoes == expected;
+        }
+
+        void closeAll() {
+            for (auto& connection : connections) {
+                close(connection.fd);
+            }
+            connections.clear();
+        }
+
+    private:
+        struct Connection {
+            int fd;
+            int sent = 0;
+            RingBuffer ring;
+
+            explicit Connection(int fd) : fd(fd), ring(65536) {}
+        };
+
+        const BenchConfig& config;
+        std::vector<uint8_t> frame;
+        std::vector<Connection> connections;
+
+        bool sendFrame(Connection& connection) {
+            const uint8_t* data = frame.data();
+            size_t size = frame.size();
+            while (size > 0) {
+                ssize_t sent = send(connection.fd, data, size, MSG_NOSIGNAL);
+                if (sent <= 0) return false;
+                data += sent;
+                size -= static_cast<size_t>(sent);
+            }
+            connection.sent++;
+            return true;
+        }
+
+        // Echoes framed from what the socket had; -1 on error or close
+        int receive(Connection& connection) {
+            size_t freeLength;
+            uint8_t* region = connection.ring.writeRegion(freeLength);
+            ssize_t result = recv(connection.fd, region, freeLength, MSG_DONTWAIT);
+            if (result <= 0) return result < 0 && errno == EAGAIN ? 0 : -1;
+            connection.ring.commitWrite(static_cast<size_t>(result));
+
+            int echoes = 0;
+            while (connection.ring.size() >= sizeof(PacketHeader)) {
+                PacketHeader header;
+                connection.ring.peek(0, &header, sizeof(header));
+                size_t totalSize = sizeof(PacketHeader) + header.payloadSize;
+                if (connection.ring.size() < totalSize) break;
+                connection.ring.consume(totalSize);
+
+                // Heartbeat probes and anything else the server sends are skipped
+                if (header.type != static_cast<uint16_t>(PacketType::PLAYER_MOVE)) continue;
+                echoes++;
+                if (connection.sent < config.packets && !sendFrame(connection)) return -1;
+            }
+            return echoes;
+        }
+    };
+
+    void logReceived(LogMode mode, const PacketView& packet) {
+        switch (mode) {
+            case LogMode::OFF:
+                break;
+            case LogMode::LOGGER:
+                LOG_INFO(benchLog, "Received {} from client {}", packetTypeToString(packet.type), packet.clientId);
+                break;
+            case LogMode::COUT:
+                std::cout << "[NetworkServer] Received " << packetTypeToString(packet.type)
+                          << " from client " << packet.clientId << std::endl;
+                break;
+        }
+    }
+
+    RunResult runMode(NetworkServer& server, const BenchConfig& config, LogMode mode) {
+        RunResult result;
+        EchoClients clients(config);
+        std::atomic<bool> connected{ false };
+        std::atomic<bool> done{ false };
+        uint64_t startNanos = 0;
+        uint64_t endNanos = 0;
+        bool clientsOk = false;
+
+        std::thread clientThread([&]() {
+            if (clients.connectAll()) {
+                connected = true;
+                startNanos = nowNanos();
+                clientsOk = clients.run(result.echoes);
+                endNanos = nowNanos();
+            }
+            clients.closeAll();
+            done = true;
+        });
+
+        uint64_t droppedBefore = Logger::getDroppedCount();
+        std::vector<PacketView> packets;
+        while (!done) {
+            server.waitForActivity(1);
+            server.update();
+            server.getReceivedPackets(packets);
+            for (const PacketView& packet : packets) {
+                if (packet.type != PacketType::PLAYER_MOVE) continue;
+                logReceived(mode, packet);
+                server.sendPacket(packet.clientId, PacketType::PLAYER_MOVE, packet.data(), packet.size());
+            }
+            server.flushOutbound();
+        }
+        clientThread.join();
+
+        // Let the server see the disconnects before the next mode connects
+        for (int i = 0; i < 50 && server.getClientCount() > 0; i++) {
+            server.waitForActivity(10);
+            server.update();
+            server.getReceivedPackets(packets);
+        }
+        Logger::flush();
+
+        result.ok = connected && clientsOk;
+        result.seconds = (endNanos - startNanos) / 1e9;
+        result.dropped = Logger::getDroppedCount() - droppedBefore;
+        return result;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    if (!parseArgs(argc, argv, config)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // The report stays on the terminal; log lines go where stdout would
+    // go on a server, a file
+    std::FILE* report = fdopen(dup(fileno(stdout)), "w");
+    if (!report || !std::freopen(config.output.c_str(), "w", stdout)) {
+        fprintf(stderr, "Cannot write %s\n", config.output.c_str());
+        return 1;
+    }
+
+    NetworkServer server;
+    if (!server.start(config.port, config.ioThreads)) {
+        fprintf(stderr, "Could not start the server on port %d\n", config.port);
+        return 1;
+    }
+
+    fprintf(report, "Logging benchmark: %d clients x %d echoes, window %d, %d I/O thread(s), log lines to %s\n",
+            config.clients, config.packets, config.window, config.ioThreads, config.output.c_str());
+    fprintf(report, "\n%-8s %10s %12s %10s\n", "mode", "seconds", "packets/s", "dropped");
+
+    bool ok = true;
+    for (LogMode mode : config.modes) {
+        RunResult result = runMode(server, config, mode);
+        if (!result.ok) {
+            fprintf(report, "%-8s echoes stalled after %llu packets\n", logModeToString(mode),
+                    static_cast<unsigned long long>(result.echoes));
+            ok = false;
+            continue;
+        }
+        fprintf(report, "%-8s %10.2f %12.0f %10llu\n", logModeToString(mode), result.seconds,
+                result.echoes / result.seconds, static_cast<unsigned long long>(result.dropped));
+        fflush(report);
+    }
+
+    server.shutdown();
+    Logger::shutdown();
+    fclose(report);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,269 @@
+// ============================================================================
+// PARSE BENCHMARK
+// Stream framing cost of the receive path: the fixed RingBuffer that client
+// connections frame in place (common/RingBuffer.h) against the growable
+// vector it replaced, which appended every recv() and erased each packet
+// from the front.
+//
+// A pre-encoded stream of pipelined PLAYER_MOVE frames is fed to both paths
+// as the sockets would deliver it: each readiness event makes --burst bytes
+// available, the vector path takes them in 4 KB recv() calls before framing
+// (as it did), and the ring path recv()s into its free region, framing
+// whenever the ring fills. Both hand every payload to the same sink, so the
+// difference is the framing alone. Best of --runs.
+//
+// Build from the repository root:
+//   g++ -std=c++17 -O2 src/tools/parsebench/main.cpp -o parsebench
+//
+// Example: one million frames arriving 64 KB at a time
+//   ./parsebench --packets 1000000 --burst 65536
+// ============================================================================
+
+#include "../../common/NetworkProtocol.h"
+#include "../../common/RingBuffer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+    struct BenchConfig {
+        int packets = 1000000;
+        size_t burst = 65536;           // Bytes available per readiness event
+        size_t ringSize = 32768;        // NetworkReactor::RECEIVE_BUFFER_SIZE
+        int runs = 5;
+        uint32_t seed = 1;
+    };
+
+    // The vector path's recv() buffer
+    constexpr size_t RECV_CHUNK = 4096;
+
+    // Stands in for the handler side: touches every payload byte
+    struct PacketSink {
+        uint64_t packets = 0;
+        uint64_t checksum = 0;
+        uint8_t scratch[MAX_PACKET_SIZE];
+
+        void deliver(const PacketHeader& header) {
+            packets++;
+            checksum += header.type + header.payloadSize;
+            for (uint32_t i = 0; i < header.payloadSize; i++) {
+                checksum += scratch[i];
+            }
+        }
+    };
+
+    struct RunResult {
+        double millis = 0.0;
+        uint64_t packets = 0;
+        uint64_t checksum = 0;
+    };
+
+    uint64_t nowNanos() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    void printUsage(const char* program) {
+        printf("Usage: %s [options]\n"
+               "  --packets <n>         pipelined PLAYER_MOVE frames (1000000)\n"
+               "  --burst <bytes>       bytes available per readiness event (65536)\n"
+               "  --ring <bytes>        receive ring capacity (32768)\n"
+               "  --runs <n>            repetitions, best is reported (5)\n"
+               "  --seed <n>            move values seed (1)\n",
+               program);
+    }
+
+    bool parseArgs(int argc, char* argv[], BenchConfig& config) {
+        for (int i = 1; i < argc; i++) {
+            const char* arg = argv[i];
+            const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+            if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0) return false;
+            if (!value) {
+                fprintf(stderr, "Missing value for %s\n", arg);
+                return false;
+            }
+            i++;
+
+            if (strcmp(arg, "--packets") == 0) config.packets = atoi(value);
+            else if (strcmp(arg, "--burst") == 0) config.burst = strtoul(value, nullptr, 10);
+            else if (strcmp(arg, "--ring") == 0) config.ringSize = strtoul(value, nullptr, 10);
+            else if (strcmp(arg, "--runs") == 0) config.runs = atoi(value);
+            else if (strcmp(arg, "--seed") == 0) config.seed = static_cast<uint32_t>(strtoul(value, nullptr, 10));
+            else {
+                fprintf(stderr, "Unknown option %s\n", arg);
+                return false;
+            }
+        }
+
+        if (config.packets < 1 || config.burst < 1 || config.runs < 1 ||
+            config.ringSize < sizeof(PacketHeader) + MAX_PACKET_SIZE) {
+            fprintf(stderr, "Invalid option value\n");
+            return false;
+        }
+        return true;
+    }
+
+    std::vector<uint8_t> encodeStream(const BenchConfig& config) {
+        std::mt19937 rng(config.seed);
+        std::uniform_real_distribution<float> horizontal(-MAP_EXTENT, MAP_EXTENT);
+        std::uniform_real_distribution<float> height(MAP_MIN_HEIGHT, MAP_MAX_HEIGHT);
+        std::uniform_real_distribution<float> yaw(0.0f, 360.0f);
+        std::uniform_real_distribution<float> pitch(-90.0f, 90.0f);
+
+        std::vector<uint8_t> stream;
+        uint8_t payload[32];
+        for (int i = 0; i < config.packets; i++) {
+            PlayerMove move;
+            move.x = horizontal(rng);
+            move.y = height(rng);
+            move.z = horizontal(rng);
+            move.yaw = yaw(rng);
+            move.pitch = pitch(rng);
+            move.movementFlags = static_cast<uint8_t>(rng() & 7);
+            size_t size = encodePacket(move, payload, sizeof(payload));
+
+            PacketHeader header;
+            header.type = static_cast<uint16_t>(PacketType::PLAYER_MOVE);
+            header.payloadSize = static_cast<uint32_t>(size);
+            header.sessionToken = 0;
+            header.sequence = static_cast<uint32_t>(i);
+            const uint8_t* headerBytes = reinterpret_cast<const uint8_t*>(&header);
+            stream.insert(stream.end(), headerBytes, headerBytes + sizeof(header));
+            stream.insert(stream.end(), payload, payload + size);
+        }
+        return stream;
+    }
+
+    // The pre-ring path: append each recv() to a vector, then frame from the
+    // front and erase every packet, shifting everything behind it
+    class VectorPath {
+    public:
+        void receive(const uint8_t* data, size_t length, PacketSink& sink) {
+            while (length > 0) {
+                size_t chunk = std::min(length, RECV_CHUNK);
+                buffer.insert(buffer.end(), data, data + chunk);
+                data += chunk;
+                length -= chunk;
+            }
+            parse(sink);
+        }
+
+    private:
+        std::vector<uint8_t> buffer;
+
+        void parse(PacketSink& sink) {
+            while (buffer.size() >= sizeof(PacketHeader)) {
+                PacketHeader header;
+                memcpy(&header, buffer.data(), sizeof(PacketHeader));
+
+                size_t totalSize = sizeof(PacketHeader) + header.payloadSize;
+                if (buffer.size() < totalSize) break;
+
+                memcpy(sink.scratch, buffer.data() + sizeof(PacketHeader), header.payloadSize);
+                sink.deliver(header);
+
+                buffer.erase(buffer.begin(), buffer.begin() + totalSize);
+            }
+        }
+    };
+
+    // NetworkReactor::receiveFromClient/parseClientPackets without the socket
+    class RingPath {
+    public:
+        explicit RingPath(size_t capacity) : ring(capacity) {}
+
+        void receive(const uint8_t* data, size_t length, PacketSink& sink) {
+            while (length > 0) {
+                size_t freeLength;
+                uint8_t* region = ring.writeRegion(freeLength);
+                if (freeLength == 0) {
+                    parse(sink);
+                    continue;
+                }
+                size_t chunk = std::min(length, freeLength);
+                memcpy(region, data, chunk);
+                ring.commitWrite(chunk);
+                data += chunk;
+                length -= chunk;
+            }
+            parse(sink);
+        }
+
+    private:
+        RingBuffer ring;
+
+        void parse(PacketSink& sink) {
+            while (ring.size() >= sizeof(PacketHeader)) {
+                PacketHeader header;
+                ring.peek(0, &header, sizeof(PacketHeader));
+
+                size_t totalSize = sizeof(PacketHeader) + header.payloadSize;
+                if (ring.size() < totalSize) break;
+
+                ring.peek(sizeof(PacketHeader), sink.scratch, header.payloadSize);
+                sink.deliver(header);
+
+                ring.consume(totalSize);
+            }
+        }
+    };
+
+    template <typename Path>
+    RunResult run(const BenchConfig& config, const std::vector<uint8_t>& stream, Path&& path) {
+        PacketSink sink;
+        uint64_t start = nowNanos();
+        for (size_t offset = 0; offset < stream.size(); offset += config.burst) {
+            size_t length = std::min(config.burst, stream.size() - offset);
+            path.receive(stream.data() + offset, length, sink);
+        }
+
+        RunResult result;
+        result.millis = (nowNanos() - start) / 1e6;
+        result.packets = sink.packets;
+        result.checksum = sink.checksum;
+        return result;
+    }
+
+    void printRow(const char* label, const RunResult& result, size_t streamBytes) {
+        printf("%-8s %10.1f %10.1f %10.0f %12llu\n", label, result.millis,
+               result.millis * 1e6 / static_cast<double>(result.packets),
+               streamBytes / (result.millis / 1e3) / 1e6,
+               static_cast<unsigned long long>(result.packets));
+    }
+}
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    if (!parseArgs(argc, argv, config)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::vector<uint8_t> stream = encodeStream(config);
+    printf("Parse benchmark: %d pipelined PLAYER_MOVE frames (%zu bytes), %zu bytes per burst, %zu byte ring\n",
+           config.packets, stream.size(), config.burst, config.ringSize);
+
+    RunResult bestVector, bestRing;
+    for (int i = 0; i < config.runs; i++) {
+        RunResult vector = run(config, stream, VectorPath());
+        RunResult ring = run(config, stream, RingPath(config.ringSize));
+        if (i == 0 || vector.millis < bestVector.millis) bestVector = vector;
+        if (i == 0 || ring.millis < bestRing.millis) bestRing = ring;
+    }
+
+    if (bestVector.packets != static_cast<uint64_t>(config.packets) || bestRing.packets != bestVector.packets ||
+        bestRing.checksum != bestVector.checksum) {
+        fprintf(stderr, "The paths framed different packets\n");
+        return 1;
+    }
+
+    printf("\n%-8s %10s %10s %10s %12s\n", "path", "ms", "ns/packet", "MB/s", "packets");
+    printRow("vector", bestVector, stream.size());
+    printRow("ring", bestRing, stream.size());
+    printf("\nRing speedup: %.2fx\n", bestVector.millis / bestRing.millis);
+    return 0;
+}